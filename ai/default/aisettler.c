@@ -783,23 +783,27 @@ static struct cityresult *settler_map_iterate(struct ai_type *ait,
   struct cityresult *cr = NULL, *best = NULL;
   int best_turn = 0; /* Which turn we found the best fit */
   struct player *pplayer = unit_owner(punit);
+  Continent_id unit_continent = tile_continent(unit_tile(punit));
+  int plrno = player_number(pplayer);
   struct pf_map *pfm;
 
   pfm = pf_map_new(parameter);
   pf_map_move_costs_iterate(pfm, ptile, move_cost, FALSE) {
+    int tindex = tile_index(ptile);
     int turns;
 
     if (boat_cost == 0 && unit_class_get(punit)->adv.sea_move == MOVE_NONE
-        && tile_continent(ptile) != tile_continent(unit_tile(punit))) {
+        && map_packed_continent(tindex) != unit_continent) {
       /* We have an accidential land bridge. Ignore it. It will in all
        * likelihood go away next turn, or even in a few nanoseconds. */
       continue;
     }
     if (BORDERS_DISABLED != game.info.borders) {
-      struct player *powner = tile_owner(ptile);
-      if (NULL != powner
-       && powner != pplayer
-       && pplayers_in_peace(powner, pplayer)) {
+      int owner = map_packed_owner(tindex);
+
+      if (MAP_TILE_OWNER_NULL != owner
+       && plrno != owner
+       && pplayers_in_peace(player_by_number(owner), pplayer)) {
         /* Land theft does not make for good neighbours. */
         continue;
       }
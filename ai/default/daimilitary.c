@@ -19,6 +19,7 @@
 
 /* utility */
 #include "log.h"
+#include "mem.h"
 
 /* common */
 #include "combat.h"
@@ -69,6 +70,32 @@
 
 #include "daimilitary.h"
 
+/* A unit which may attack a city, see assess_danger_gather(). */
+struct danger_threat {
+  struct unit *punit;
+  unsigned int vulnerability;
+  int move_time;
+};
+
+/* The threats to a city. */
+struct danger_threats {
+  struct danger_threat *threats;
+  int num;
+  int size;
+};
+
+/* Data shared by the jobs of dai_assess_danger_player(). */
+struct danger_jobs {
+  struct ai_type *ait;
+  struct city **cities;
+  struct danger_threats *threats;
+  struct player **dangerous;
+  int num_dangerous;
+};
+
+static unsigned int assess_danger_apply(struct ai_type *ait,
+                                        struct city *pcity,
+                                        const struct danger_threats *pthreats);
 static unsigned int assess_danger(struct ai_type *ait, struct city *pcity);
 
 /**************************************************************************
@@ -393,19 +420,159 @@ static unsigned int assess_danger_unit(const struct city *pcity,
   return danger * 100 / MAX(mod, 1);
 }
 
+/****************************************************************************
+  Fill 'dangerous' with the players pplayer is afraid of. Returns their
+  number.
+****************************************************************************/
+static int assess_danger_players(struct player *pplayer,
+                                 struct player **dangerous)
+{
+  int num = 0;
+
+  players_iterate(aplayer) {
+    if (adv_is_player_dangerous(pplayer, aplayer)) {
+      dangerous[num++] = aplayer;
+    }
+  } players_iterate_end;
+
+  return num;
+}
+
+/****************************************************************************
+  Find the units of the 'dangerous' players which may reach the city, and
+  store how dangerous and far they are in 'pthreats'.
+
+  This doesn't modify anything but 'pthreats', so it may run for several
+  cities at once in the worker threads.
+****************************************************************************/
+static void assess_danger_gather(struct ai_type *ait, struct city *pcity,
+                                 struct player **dangerous,
+                                 int num_dangerous,
+                                 struct danger_threats *pthreats)
+{
+  struct player *pplayer = city_owner(pcity);
+  int assess_turns;
+  bool omnimap;
+  int i;
+
+  if (player_is_cpuhog(pplayer)) {
+    assess_turns = 6;
+  } else {
+    assess_turns = 3;
+  }
+
+  omnimap = !has_handicap(pplayer, H_MAP);
+
+  pthreats->num = 0;
+  for (i = 0; i < num_dangerous; i++) {
+    struct player *aplayer = dangerous[i];
+    struct pf_reverse_map *pcity_map;
+
+    /* Note that we still consider the units of players we are not (yet)
+     * at war with. */
+
+    pcity_map = pf_reverse_map_new_for_city(pcity, aplayer, assess_turns,
+                                            omnimap);
+
+    unit_list_iterate(aplayer->units, punit) {
+      int move_time;
+      unsigned int vulnerability;
+      struct unit_type *utype = unit_type_get(punit);
+      struct unit_type_ai *utai = utype_ai_data(utype, ait);
+      struct danger_threat *pthreat;
+
+      if (!utai->carries_occupiers
+          && !utype_acts_hostile(utype)
+          && (utype_has_flag(utype, UTYF_CIVILIAN)
+              || (!utype_can_do_action(utype, ACTION_ATTACK)
+                  && !utype_can_take_over(utype)))) {
+        /* Harmless unit. */
+        continue;
+      }
+
+      vulnerability = assess_danger_unit(pcity, pcity_map,
+                                         punit, &move_time);
+
+      if (PF_IMPOSSIBLE_MC == move_time) {
+        continue;
+      }
+
+      if (pthreats->num == pthreats->size) {
+        pthreats->size = MAX(2 * pthreats->size, 16);
+        pthreats->threats = fc_realloc(pthreats->threats,
+                                       pthreats->size
+                                       * sizeof(*pthreats->threats));
+      }
+      pthreat = pthreats->threats + pthreats->num++;
+      pthreat->punit = punit;
+      pthreat->vulnerability = vulnerability;
+      pthreat->move_time = move_time;
+    } unit_list_iterate_end;
+
+    pf_reverse_map_destroy(pcity_map);
+  }
+}
+
+/****************************************************************************
+  Worker job of dai_assess_danger_player(): gather the threats to one city.
+****************************************************************************/
+static void assess_danger_job(int job, void *data)
+{
+  struct danger_jobs *jobs = data;
+
+  assess_danger_gather(jobs->ait, jobs->cities[job], jobs->dangerous,
+                       jobs->num_dangerous, jobs->threats + job);
+}
+
 /****************************************************************************
   Call assess_danger() for all cities owned by pplayer.
 
   This is necessary to initialize some ai data before some ai calculations.
+
+  The threats to the cities are gathered in parallel by the worker threads
+  (see the 'workers' server setting), then the cities are updated one
+  after the other, so that the result doesn't depend on the threads.
 ****************************************************************************/
 void dai_assess_danger_player(struct ai_type *ait, struct player *pplayer)
 {
+  struct danger_jobs jobs;
+  struct player *dangerous[MAX_NUM_PLAYER_SLOTS];
+  int num_cities, i;
+
   /* Do nothing if game is not running */
-  if (S_S_RUNNING == server_state()) {
-    city_list_iterate(pplayer->cities, pcity) {
-      (void) assess_danger(ait, pcity);
-    } city_list_iterate_end;
+  if (S_S_RUNNING != server_state()) {
+    return;
+  }
+
+  num_cities = city_list_size(pplayer->cities);
+  if (0 == num_cities) {
+    return;
+  }
+
+  TIMING_LOG(AIT_DANGER, TIMER_START);
+
+  jobs.ait = ait;
+  jobs.cities = fc_malloc(num_cities * sizeof(*jobs.cities));
+  jobs.threats = fc_calloc(num_cities, sizeof(*jobs.threats));
+  jobs.dangerous = dangerous;
+  jobs.num_dangerous = assess_danger_players(pplayer, dangerous);
+
+  i = 0;
+  city_list_iterate(pplayer->cities, pcity) {
+    jobs.cities[i++] = pcity;
+  } city_list_iterate_end;
+
+  server_workpool_run(num_cities, assess_danger_job, &jobs);
+
+  for (i = 0; i < num_cities; i++) {
+    (void) assess_danger_apply(ait, jobs.cities[i], jobs.threats + i);
+    free(jobs.threats[i].threats);
   }
+
+  free(jobs.cities);
+  free(jobs.threats);
+
+  TIMING_LOG(AIT_DANGER, TIMER_STOP);
 }
 
 /********************************************************************** 
@@ -462,7 +629,9 @@ static void dai_reevaluate_building(struct city *pcity, adv_want *value,
   afraid of a boat laden with enemies if it stands on the coast (i.e.
   is directly reachable by this boat).
 ****************************************************************************/
-static unsigned int assess_danger(struct ai_type *ait, struct city *pcity)
+static unsigned int assess_danger_apply(struct ai_type *ait,
+                                        struct city *pcity,
+                                        const struct danger_threats *pthreats)
 {
   struct player *pplayer = city_owner(pcity);
   struct tile *ptile = city_tile(pcity);
@@ -476,10 +645,6 @@ static unsigned int assess_danger(struct ai_type *ait, struct city *pcity)
   int total_danger = 0;
   int defense_bonuses[U_LAST];
   bool defender_type_handled[U_LAST];
-  int assess_turns;
-  bool omnimap;
-
-  TIMING_LOG(AIT_DANGER, TIMER_START);
 
   /* Initialize data. */
   memset(&danger_reduced, 0, sizeof(danger_reduced));
@@ -524,97 +689,58 @@ static unsigned int assess_danger(struct ai_type *ait, struct city *pcity)
     }
   } unit_list_iterate_end;
 
-  if (player_is_cpuhog(pplayer)) {
-    assess_turns = 6;
-  } else {
-    assess_turns = 3;
-  }
-
-  omnimap = !has_handicap(pplayer, H_MAP);
-
   /* Check. */
-  players_iterate(aplayer) {
-    struct pf_reverse_map *pcity_map;
-
-    if (!adv_is_player_dangerous(pplayer, aplayer)) {
-      continue;
-    }
-    /* Note that we still consider the units of players we are not (yet)
-     * at war with. */
-
-    pcity_map = pf_reverse_map_new_for_city(pcity, aplayer, assess_turns,
-                                            omnimap);
-
-    unit_list_iterate(aplayer->units, punit) {
-      int move_time;
-      unsigned int vulnerability;
-      int defbonus;
-      struct unit_type *utype = unit_type_get(punit);
-      struct unit_type_ai *utai = utype_ai_data(utype, ait);
-
-      if (!utai->carries_occupiers
-          && !utype_acts_hostile(utype)
-          && (utype_has_flag(utype, UTYF_CIVILIAN)
-              || (!utype_can_do_action(utype, ACTION_ATTACK)
-                  && !utype_can_take_over(utype)))) {
-        /* Harmless unit. */
-        continue;
-      }
-
-      vulnerability = assess_danger_unit(pcity, pcity_map,
-                                         punit, &move_time);
-
-      if (PF_IMPOSSIBLE_MC == move_time) {
-        continue;
-      }
-
-      if ((0 < vulnerability && unit_can_take_over(punit))
-          || utai->carries_occupiers) {
-        if (3 >= move_time) {
-          urgency++;
-          if (1 >= move_time) {
-            city_data->grave_danger++;
-          }
+  for (i = 0; i < pthreats->num; i++) {
+    struct unit *punit = pthreats->threats[i].punit;
+    int move_time = pthreats->threats[i].move_time;
+    unsigned int vulnerability = pthreats->threats[i].vulnerability;
+    int defbonus;
+    struct unit_type *utype = unit_type_get(punit);
+    struct unit_type_ai *utai = utype_ai_data(utype, ait);
+
+    if ((0 < vulnerability && unit_can_take_over(punit))
+        || utai->carries_occupiers) {
+      if (3 >= move_time) {
+        urgency++;
+        if (1 >= move_time) {
+          city_data->grave_danger++;
         }
       }
+    }
 
-      defbonus = defense_bonuses[utype_index(utype)];
-      if (defbonus > 1) {
-        defbonus = (defbonus + 1) / 2;
-      }
-      vulnerability /= (defbonus + 1);
-      (void) dai_wants_defender_against(ait, pplayer, pcity, utype,
-                                        vulnerability / MAX(move_time, 1));
+    defbonus = defense_bonuses[utype_index(utype)];
+    if (defbonus > 1) {
+      defbonus = (defbonus + 1) / 2;
+    }
+    vulnerability /= (defbonus + 1);
+    (void) dai_wants_defender_against(ait, pplayer, pcity, utype,
+                                      vulnerability / MAX(move_time, 1));
 
-      if (utype_acts_hostile(unit_type_get(punit)) && 2 >= move_time) {
-        city_data->diplomat_threat = TRUE;
-      }
+    if (utype_acts_hostile(unit_type_get(punit)) && 2 >= move_time) {
+      city_data->diplomat_threat = TRUE;
+    }
 
-      vulnerability *= vulnerability; /* positive feedback */
-      if (1 < move_time) {
-        vulnerability /= move_time;
-      }
+    vulnerability *= vulnerability; /* positive feedback */
+    if (1 < move_time) {
+      vulnerability /= move_time;
+    }
 
-      if (unit_can_do_action(punit, ACTION_NUKE)) {
-        defender = dai_find_source_building(pcity, EFT_NUKE_PROOF,
-                                            unit_type_get(punit));
-        if (defender != B_LAST) {
-          danger_reduced[defender] += vulnerability / MAX(move_time, 1);
-        }
-      } else {
-        defender = dai_find_source_building(pcity, EFT_DEFEND_BONUS,
-                                            unit_type_get(punit));
-        if (defender != B_LAST) {
-          danger_reduced[defender] += vulnerability / MAX(move_time, 1);
-        }
+    if (unit_can_do_action(punit, ACTION_NUKE)) {
+      defender = dai_find_source_building(pcity, EFT_NUKE_PROOF,
+                                          unit_type_get(punit));
+      if (defender != B_LAST) {
+        danger_reduced[defender] += vulnerability / MAX(move_time, 1);
       }
+    } else {
+      defender = dai_find_source_building(pcity, EFT_DEFEND_BONUS,
+                                          unit_type_get(punit));
+      if (defender != B_LAST) {
+        danger_reduced[defender] += vulnerability / MAX(move_time, 1);
+      }
+    }
 
-      total_danger += vulnerability;
-    } unit_list_iterate_end;
-
-    pf_reverse_map_destroy(pcity_map);
-
-  } players_iterate_end;
+    total_danger += vulnerability;
+  }
 
   if (total_danger) {
     city_data->wallvalue = 90;
@@ -651,6 +777,26 @@ static unsigned int assess_danger(struct ai_type *ait, struct city *pcity)
   }
   city_data->urgency = urgency;
 
+  return urgency;
+}
+
+/****************************************************************************
+  Assess the danger to one city. See assess_danger_apply().
+****************************************************************************/
+static unsigned int assess_danger(struct ai_type *ait, struct city *pcity)
+{
+  struct player *dangerous[MAX_NUM_PLAYER_SLOTS];
+  struct danger_threats threats = { NULL, 0, 0 };
+  unsigned int urgency;
+
+  TIMING_LOG(AIT_DANGER, TIMER_START);
+
+  assess_danger_gather(ait, pcity, dangerous,
+                       assess_danger_players(city_owner(pcity), dangerous),
+                       &threats);
+  urgency = assess_danger_apply(ait, pcity, &threats);
+  free(threats.threats);
+
   TIMING_LOG(AIT_DANGER, TIMER_STOP);
 
   return urgency;
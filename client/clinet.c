@@ -341,8 +341,8 @@ static int read_from_connection(struct connection *pc, bool block)
   for (;;) {
     fd_set readfs, writefs, exceptfs;
     int socket_fd = pc->sock;
-    bool have_data_for_server = (pc->used && pc->send_buffer
-                                 && 0 < pc->send_buffer->ndata);
+    bool have_data_for_server = (pc->used
+                                 && 0 < connection_send_pending(pc));
     int n;
     fc_timeval tv;
 
@@ -1465,7 +1465,7 @@ bool send_goto_tile(struct unit *punit, struct tile *ptile)
   struct pf_path *path;
 
   goto_fill_parameter_base(&parameter, punit);
-  pfm = pf_map_new(&parameter);
+  pfm = pf_map_new_targeted(&parameter, ptile);
   path = pf_map_path(pfm, ptile);
   pf_map_destroy(pfm);
 
@@ -1492,7 +1492,7 @@ bool send_attack_tile(struct unit *punit, struct tile *ptile)
   parameter.move_rate = 0;
   parameter.is_pos_dangerous = NULL;
   parameter.get_moves_left_req = NULL;
-  pfm = pf_map_new(&parameter);
+  pfm = pf_map_new_targeted(&parameter, ptile);
   path = pf_map_path(pfm, ptile);
   pf_map_destroy(pfm);
 
@@ -1848,7 +1848,7 @@ struct tile *tile_before_end_path(struct unit *punit, struct tile *ptile)
   parameter.move_rate = 0;
   parameter.is_pos_dangerous = NULL;
   parameter.get_moves_left_req = NULL;
-  pfm = pf_map_new(&parameter);
+  pfm = pf_map_new_targeted(&parameter, ptile);
   path = pf_map_path(pfm, ptile);
   if (path == NULL) {
     return NULL;
@@ -3265,7 +3265,7 @@ void mr_menu::save_game_as()
   } strvec_iterate_end;
 
   str = QString(_("Save Games"))
-        + QString(" (*.sav *.sav.bz2 *.sav.gz *.sav.xz)");
+        + QString(" (*.sav *.sav.bz2 *.sav.gz *.sav.xz *.sav.zst *.sav.lz4)");
   current_file = QFileDialog::getSaveFileName(gui()->central_wdg,
                                               _("Save Game As..."),
                                               location, str);
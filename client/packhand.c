@@ -2982,6 +2982,8 @@ void handle_tile_info(const struct packet_tile_info *packet)
 
   ptile->continent = packet->continent;
   wld.map.num_continents = MAX(ptile->continent, wld.map.num_continents);
+  /* The extras and the continent were written directly above. */
+  map_packed_update_tile(ptile);
 
   if (packet->label[0] == '\0') {
     if (ptile->label != NULL) {
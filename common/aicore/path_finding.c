@@ -91,11 +91,33 @@ struct pf_map {
   /* Private data. */
   struct tile *tile;          /* The current position (aka iterator). */
   struct pf_parameter params; /* Initial parameters. */
+
+  /* Set when the map is owned by the pf_map pool. See
+   * pf_map_pool_get(). */
+  struct pf_map_pool_entry *pool_entry;
 };
 
 /* Down-cast macro. */
 #define PF_MAP(pfm) ((struct pf_map *) (pfm))
 
+/* A slot of the pf_map pool. The tiles returned by the iterator are
+ * recorded, so a map handed to a new user can replay the iteration from
+ * the start tile before it resumes the search. */
+struct pf_map_pool_entry {
+  struct pf_map *pfm;           /* The pooled map. */
+  bool in_use;                  /* Between pf_map_pool_get() and
+                                 * pf_map_destroy(). */
+  bool dirty;                   /* A touched tile changed. Must rebuild. */
+  unsigned int last_use;        /* For eviction of the oldest entry. */
+
+  struct tile **iter_tiles;     /* Tiles returned by the iterator. */
+  int iter_num;                 /* Number of tiles in 'iter_tiles'. */
+  int iter_size;                /* Allocated size of 'iter_tiles'. */
+  int iter_pos;                 /* Replay position in 'iter_tiles'. */
+  bool iter_end;                /* The iteration ended after 'iter_num'
+                                 * tiles. */
+};
+
 /* ========================== Common functions =========================== */
 
 /****************************************************************************
@@ -193,6 +215,7 @@ static inline void pf_finalize_position(const struct pf_parameter *param,
 
 static struct pf_path *
 pf_path_new_to_start_tile(const struct pf_parameter *param);
+static void pf_map_pool_release(struct pf_map *pfm);
 static void pf_position_fill_start_tile(struct pf_position *pos,
                                         const struct pf_parameter *param);
 
@@ -230,6 +253,11 @@ struct pf_normal_map {
                                * processed yet (NS_NEW), sorted by their
                                * total_CC. */
   struct pf_normal_node *lattice; /* Lattice of nodes. */
+
+  struct tile *target;      /* Targeted map only, else NULL. See
+                             * pf_map_new_targeted(). */
+  int min_step_cost;        /* Cheapest single move of the unit type, used
+                             * by the targeted map heuristic. */
 };
 
 /* Up-cast macro. */
@@ -499,6 +527,109 @@ static int pf_normal_map_adjust_cost(int cost, int moves_left)
   return MIN(cost, moves_left);
 }
 
+/****************************************************************************
+  Return the cheapest move cost the ruleset can give for a single step of
+  the unit type (see tile_move_cost_ptrs()). This is used as a lower bound
+  for the targeted map heuristic. Roads which are not built anywhere yet
+  are not considered, so that a railroad in the ruleset doesn't make the
+  heuristic useless for the whole game.
+****************************************************************************/
+static int pf_min_step_cost(const struct pf_parameter *param)
+{
+  const struct unit_type *utype = param->utype;
+  const struct unit_class *pclass = utype_class(utype);
+  int cost = MIN(SINGLE_MOVE, utype->unknown_move_cost);
+
+  /* Attacks may cost the whole move rate. */
+  cost = MIN(cost, param->move_rate);
+
+  if (uclass_has_flag(pclass, UCF_TERRAIN_SPEED)) {
+    terrain_type_iterate(pterrain) {
+      if (is_native_to_class(pclass, pterrain, NULL)) {
+        cost = MIN(cost, pterrain->movement_cost * SINGLE_MOVE);
+      }
+    } terrain_type_iterate_end;
+
+    if (utype_has_flag(utype, UTYF_IGTER)) {
+      cost = MIN(cost, MOVE_COST_IGTER);
+    }
+
+    extra_type_list_iterate(pclass->cache.bonus_roads, pextra) {
+      int road_cost = extra_road_get(pextra)->move_cost;
+
+      if (road_cost < cost
+          && 0 < map_packed_extra_tiles(extra_index(pextra))) {
+        cost = road_cost;
+      }
+    } extra_type_list_iterate_end;
+  }
+
+  return MAX(cost, 0);
+}
+
+/****************************************************************************
+  Return the lowest cost at which the target of the targeted map could be
+  reached from a node of cost 'cost', 'dist' steps away from it. Every
+  step is assumed to cost 'min_step_cost', adjusted with
+  pf_normal_map_adjust_cost(). As the result never decreases when 'cost'
+  grows, the heuristic is consistent and the nodes are still processed
+  with their best cost.
+****************************************************************************/
+static int pf_normal_map_estimate(const struct pf_normal_map *pfnm,
+                                  int cost, int dist)
+{
+  const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfnm));
+  int move_rate = pf_move_rate(params);
+  int step = pfnm->min_step_cost;
+  int moves_left, steps, per_turn;
+
+  if (0 == dist || 0 >= step || 0 >= move_rate) {
+    return cost;
+  }
+
+  moves_left = pf_moves_left(params, cost);
+  steps = (moves_left + step - 1) / step;
+  if (dist <= steps) {
+    /* The target may be reached this turn. */
+    return cost + MIN(dist * step, moves_left);
+  }
+
+  /* Use all moves left, then as many full turns as needed. */
+  dist -= steps + 1;
+  per_turn = (move_rate + step - 1) / step;
+  return (cost + moves_left + (dist / per_turn) * move_rate
+          + MIN((dist % per_turn + 1) * step, move_rate));
+}
+
+/****************************************************************************
+  Return the priority of a node reached with the cost 'cost' and the extra
+  cost 'extra'. For a flood map, the nodes are ordered by cost of path. For
+  a targeted map, they are ordered by estimated cost to the target, then
+  by distance to the target.
+****************************************************************************/
+static inline int pf_normal_map_priority(const struct pf_normal_map *pfnm,
+                                         const struct tile *ptile,
+                                         int cost, int extra)
+{
+  const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfnm));
+  int dist, estimate;
+
+  if (NULL == pfnm->target) {
+    return pf_total_CC(params, cost, extra);
+  }
+
+  dist = real_map_distance(ptile, pfnm->target);
+  /* Stay in the range of 'cost' in the lattice, see pf_normal_node. */
+  estimate = MIN(pf_normal_map_estimate(pfnm, cost, dist), 0x7FFF);
+
+  if (NULL != params->get_EC) {
+    return pf_total_CC(params, estimate, extra);
+  } else {
+    /* Prefer the nodes closer to the target on equal estimate. */
+    return PF_TURN_FACTOR * estimate + MIN(dist, PF_TURN_FACTOR - 1);
+  }
+}
+
 /****************************************************************************
   Bare-bones PF iterator. All Freeciv rules logic is hidden in 'get_costs'
   callback (compare to pf_normal_map_iterate function). This function is
@@ -710,7 +841,9 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
         node1->cost = cost;
         node1->dir_to_here = dir;
         /* As we prefer lower costs, let's reverse the cost of the path. */
-        map_index_pq_insert(pfnm->queue, tindex1, -cost_of_path);
+        map_index_pq_insert(pfnm->queue, tindex1,
+                            -pf_normal_map_priority(pfnm, tile1,
+                                                    cost, extra));
       } else if (cost_of_path < pf_total_CC(params, node1->cost,
                                             node1->extra_cost)) {
         /* We found a better route to 'tile1'. Let's register 'tindex1' to
@@ -720,7 +853,9 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
         node1->cost = cost;
         node1->dir_to_here = dir;
         /* As we prefer lower costs, let's reverse the cost of the path. */
-        map_index_pq_replace(pfnm->queue, tindex1, -cost_of_path);
+        map_index_pq_replace(pfnm->queue, tindex1,
+                             -pf_normal_map_priority(pfnm, tile1,
+                                                     cost, extra));
       }
     } adjc_dir_iterate_end;
   }
@@ -864,10 +999,13 @@ static struct pf_map *pf_normal_map_new(const struct pf_parameter *parameter)
   /* Set the mode, used for cast check. */
   base_map->mode = PF_NORMAL;
 #endif /* PF_DEBUG */
+  base_map->pool_entry = NULL;
 
   /* Allocate the map. */
   pfnm->lattice = fc_calloc(MAP_INDEX_SIZE, sizeof(struct pf_normal_node));
   pfnm->queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
+  pfnm->target = NULL;
+  pfnm->min_step_cost = 0;
 
   if (NULL == parameter->get_costs) {
     /* 'get_MC' callback must be set. */
@@ -1868,6 +2006,7 @@ static struct pf_map *pf_danger_map_new(const struct pf_parameter *parameter)
   /* Set the mode, used for cast check. */
   base_map->mode = PF_DANGER;
 #endif /* PF_DEBUG */
+  base_map->pool_entry = NULL;
 
   /* Allocate the map. */
   pfdm->lattice = fc_calloc(MAP_INDEX_SIZE, sizeof(struct pf_danger_node));
@@ -3066,6 +3205,7 @@ static struct pf_map *pf_fuel_map_new(const struct pf_parameter *parameter)
   /* Set the mode, used for cast check. */
   base_map->mode = PF_FUEL;
 #endif /* PF_DEBUG */
+  base_map->pool_entry = NULL;
 
   /* Allocate the map. */
   pffm->lattice = fc_calloc(MAP_INDEX_SIZE, sizeof(struct pf_fuel_node));
@@ -3121,6 +3261,251 @@ static struct pf_map *pf_fuel_map_new(const struct pf_parameter *parameter)
 
 
 
+/* ========================= pf_map pool functions ======================= */
+
+/* The pf_map pool keeps normal maps alive between the users asking for the
+ * same parameter, typically the different advisors looking at the same
+ * unit during a phase. A pooled map is invalidated when a tile it has
+ * already reached (or one adjacent to it, for ZoC) changes; otherwise the
+ * next user continues the search where the previous one stopped. */
+
+#define PF_MAP_POOL_SIZE 16
+
+static struct {
+  struct pf_map_pool_entry entries[PF_MAP_POOL_SIZE];
+  int num;                      /* Number of used entries. */
+  unsigned int clock;           /* Incremented at every pf_map_pool_get(). */
+  struct pf_map_pool_stats stats;
+} pf_pool;
+
+/****************************************************************************
+  Returns TRUE if the two parameters would build identical maps.
+****************************************************************************/
+static bool pf_parameter_equal(const struct pf_parameter *param1,
+                               const struct pf_parameter *param2)
+{
+  return (param1->start_tile == param2->start_tile
+          && param1->moves_left_initially == param2->moves_left_initially
+          && param1->fuel_left_initially == param2->fuel_left_initially
+          && param1->transported_by_initially
+             == param2->transported_by_initially
+          && param1->cargo_depth == param2->cargo_depth
+          && BV_ARE_EQUAL(param1->cargo_types, param2->cargo_types)
+          && param1->move_rate == param2->move_rate
+          && param1->fuel == param2->fuel
+          && param1->utype == param2->utype
+          && param1->owner == param2->owner
+          && param1->omniscience == param2->omniscience
+          && param1->get_MC == param2->get_MC
+          && param1->get_move_scope == param2->get_move_scope
+          && param1->ignore_none_scopes == param2->ignore_none_scopes
+          && param1->get_TB == param2->get_TB
+          && param1->get_EC == param2->get_EC
+          && param1->get_action == param2->get_action
+          && param1->actions == param2->actions
+          && param1->is_action_possible == param2->is_action_possible
+          && param1->get_zoc == param2->get_zoc
+          && param1->is_pos_dangerous == param2->is_pos_dangerous
+          && param1->get_moves_left_req == param2->get_moves_left_req
+          && param1->get_costs == param2->get_costs
+          && param1->data == param2->data);
+}
+
+/****************************************************************************
+  Returns TRUE if the search of the pooled map reached 'ptile' or one of
+  its adjacent tiles, i.e. if a change at 'ptile' can affect the results.
+****************************************************************************/
+static bool pf_map_pool_tile_touched(const struct pf_map *pfm,
+                                     const struct tile *ptile)
+{
+  const struct pf_normal_node *lattice =
+      ((const struct pf_normal_map *) pfm)->lattice;
+
+  if (NS_UNINIT != lattice[tile_index(ptile)].status) {
+    return TRUE;
+  }
+
+  adjc_iterate(ptile, adjc_tile) {
+    if (NS_UNINIT != lattice[tile_index(adjc_tile)].status) {
+      return TRUE;
+    }
+  } adjc_iterate_end;
+
+  return FALSE;
+}
+
+/****************************************************************************
+  Really destroy the map of the entry, and remove it from the pool.
+****************************************************************************/
+static void pf_map_pool_remove(struct pf_map_pool_entry *entry)
+{
+  int i = entry - pf_pool.entries;
+
+  fc_assert_ret(0 <= i && i < pf_pool.num);
+
+  entry->pfm->destroy(entry->pfm);
+  free(entry->iter_tiles);
+
+  /* Keep the used entries packed. */
+  pf_pool.num--;
+  if (i != pf_pool.num) {
+    *entry = pf_pool.entries[pf_pool.num];
+    entry->pfm->pool_entry = entry;
+  }
+}
+
+/****************************************************************************
+  Attach a new map to the entry.
+****************************************************************************/
+static void pf_map_pool_entry_init(struct pf_map_pool_entry *entry,
+                                   const struct pf_parameter *parameter)
+{
+  entry->pfm = pf_map_new(parameter);
+  entry->pfm->pool_entry = entry;
+  entry->in_use = TRUE;
+  entry->dirty = FALSE;
+  entry->last_use = pf_pool.clock;
+  entry->iter_num = 0;
+  entry->iter_pos = 0;
+  entry->iter_end = FALSE;
+}
+
+/****************************************************************************
+  Returns a map for 'parameter', reusing a pooled map built for an equal
+  parameter if there is one. The map must be given back with
+  pf_map_destroy() as usual, which keeps it in the pool.
+
+  Only parameters whose callbacks depend on the tile they are called for
+  (and its adjacent tiles) may be used here, since the pool cannot know
+  about anything else. Danger, fuel and jumbo maps are never pooled.
+****************************************************************************/
+struct pf_map *pf_map_pool_get(const struct pf_parameter *parameter)
+{
+  struct pf_map_pool_entry *entry, *oldest = NULL;
+  int i;
+
+  if (NULL != parameter->is_pos_dangerous
+      || NULL != parameter->get_moves_left_req
+      || NULL != parameter->get_costs) {
+    pf_pool.stats.misses++;
+    return pf_map_new(parameter);
+  }
+
+  pf_pool.clock++;
+
+  for (i = 0; i < pf_pool.num; i++) {
+    entry = pf_pool.entries + i;
+
+    if (entry->in_use) {
+      continue;
+    }
+
+    if (pf_parameter_equal(parameter, pf_map_parameter(entry->pfm))) {
+      if (entry->dirty) {
+        entry->pfm->destroy(entry->pfm);
+        pf_map_pool_entry_init(entry, parameter);
+        pf_pool.stats.rebuilds++;
+      } else {
+        /* Rewind the iterator. */
+        entry->pfm->tile = parameter->start_tile;
+        entry->iter_pos = 0;
+        entry->in_use = TRUE;
+        entry->last_use = pf_pool.clock;
+        pf_pool.stats.hits++;
+      }
+      return entry->pfm;
+    }
+
+    if (NULL == oldest || entry->last_use < oldest->last_use) {
+      oldest = entry;
+    }
+  }
+
+  pf_pool.stats.misses++;
+
+  if (PF_MAP_POOL_SIZE <= pf_pool.num) {
+    if (NULL == oldest) {
+      /* All maps in use, don't pool this one. */
+      return pf_map_new(parameter);
+    }
+    pf_map_pool_remove(oldest);
+  }
+
+  entry = pf_pool.entries + pf_pool.num++;
+  entry->iter_tiles = NULL;
+  entry->iter_size = 0;
+  pf_map_pool_entry_init(entry, parameter);
+
+  return entry->pfm;
+}
+
+/****************************************************************************
+  Gives a pooled map back. Called by pf_map_destroy().
+****************************************************************************/
+static void pf_map_pool_release(struct pf_map *pfm)
+{
+  struct pf_map_pool_entry *entry = pfm->pool_entry;
+
+  entry->in_use = FALSE;
+  if (entry->dirty) {
+    pf_map_pool_remove(entry);
+  }
+}
+
+/****************************************************************************
+  Must be called when something changed at 'ptile' which could modify the
+  move costs or the behavior of the tile for the path-finding: terrain,
+  extras, owner, city, units or known status.
+****************************************************************************/
+void pf_map_pool_tile_changed(const struct tile *ptile)
+{
+  int i;
+
+  for (i = 0; i < pf_pool.num; i++) {
+    struct pf_map_pool_entry *entry = pf_pool.entries + i;
+
+    if (!entry->dirty && pf_map_pool_tile_touched(entry->pfm, ptile)) {
+      entry->dirty = TRUE;
+    }
+  }
+}
+
+/****************************************************************************
+  Invalidate all pooled maps, e.g. at phase change or when the diplomatic
+  states changed. Maps currently in use are destroyed when released.
+****************************************************************************/
+void pf_map_pool_flush(void)
+{
+  int i;
+
+  for (i = pf_pool.num - 1; i >= 0; i--) {
+    struct pf_map_pool_entry *entry = pf_pool.entries + i;
+
+    if (entry->in_use) {
+      entry->dirty = TRUE;
+    } else {
+      pf_map_pool_remove(entry);
+    }
+  }
+}
+
+/****************************************************************************
+  Returns the pool statistics.
+****************************************************************************/
+const struct pf_map_pool_stats *pf_map_pool_stats(void)
+{
+  return &pf_pool.stats;
+}
+
+/****************************************************************************
+  Reset the pool statistics.
+****************************************************************************/
+void pf_map_pool_stats_reset(void)
+{
+  memset(&pf_pool.stats, 0, sizeof(pf_pool.stats));
+}
+
+
 /* ====================== pf_map public functions ======================= */
 
 /****************************************************************************
@@ -3148,6 +3533,38 @@ struct pf_map *pf_map_new(const struct pf_parameter *parameter)
   return pf_normal_map_new(parameter);
 }
 
+/****************************************************************************
+  Create a new map for a search to the single tile 'target'. The nodes are
+  expanded in the direction of the target (A* search), so reaching it
+  usually costs a fraction of the iterations of a map made by
+  pf_map_new(). Does not do any iterations.
+
+  Only the parameters of normal maps without 'get_EC' and 'get_costs'
+  callbacks get a targeted map, others get the map pf_map_new() would
+  make. The 'get_MC' callback must not return less than the move cost of
+  the unit type by the ruleset, like the ones of "pf_tools.[ch]".
+****************************************************************************/
+struct pf_map *pf_map_new_targeted(const struct pf_parameter *parameter,
+                                   struct tile *target)
+{
+  struct pf_map *pfm;
+  struct pf_normal_map *pfnm;
+
+  if (NULL == target
+      || NULL != parameter->is_pos_dangerous
+      || NULL != parameter->get_moves_left_req
+      || NULL != parameter->get_costs) {
+    return pf_map_new(parameter);
+  }
+
+  pfm = pf_normal_map_new(parameter);
+  pfnm = PF_NORMAL_MAP(pfm);
+  pfnm->target = target;
+  pfnm->min_step_cost = pf_min_step_cost(parameter);
+
+  return pfm;
+}
+
 /****************************************************************************
   After usage the map must be destroyed.
 ****************************************************************************/
@@ -3156,7 +3573,11 @@ void pf_map_destroy(struct pf_map *pfm)
 #ifdef PF_DEBUG
   fc_assert_ret(NULL != pfm);
 #endif
-  pfm->destroy(pfm);
+  if (NULL != pfm->pool_entry) {
+    pf_map_pool_release(pfm);
+  } else {
+    pfm->destroy(pfm);
+  }
 }
 
 /****************************************************************************
@@ -3234,22 +3655,47 @@ bool pf_map_position(struct pf_map *pfm, struct tile *ptile,
 ****************************************************************************/
 bool pf_map_iterate(struct pf_map *pfm)
 {
+  struct pf_map_pool_entry *entry;
+
 #ifdef PF_DEBUG
   fc_assert_ret_val(NULL != pfm, FALSE);
 #endif
 
-  if (NULL == pfm->tile) {
+  entry = pfm->pool_entry;
+  if (NULL != entry && entry->iter_pos < entry->iter_num) {
+    /* Replay what a previous user of this pooled map already iterated. */
+    pfm->tile = entry->iter_tiles[entry->iter_pos++];
+    return TRUE;
+  }
+
+  if (NULL == pfm->tile
+      || (NULL != entry && entry->iter_end)) {
     /* The end of the iteration was already reached. Don't try to iterate
      * again. */
+    pfm->tile = NULL;
     return FALSE;
   }
 
   if (!pfm->iterate(pfm)) {
     /* End of iteration. */
     pfm->tile = NULL;
+    if (NULL != entry) {
+      entry->iter_end = TRUE;
+    }
     return FALSE;
   }
 
+  if (NULL != entry) {
+    if (entry->iter_num >= entry->iter_size) {
+      entry->iter_size = MAX(2 * entry->iter_size, INITIAL_QUEUE_SIZE);
+      entry->iter_tiles = fc_realloc(entry->iter_tiles,
+                                     entry->iter_size
+                                     * sizeof(*entry->iter_tiles));
+    }
+    entry->iter_tiles[entry->iter_num++] = pfm->tile;
+    entry->iter_pos = entry->iter_num;
+  }
+
   return TRUE;
 }
 
@@ -244,6 +244,35 @@ extern "C" {
  * controls if the start tile of the pf_parameter should iterated or not.
  *
  *
+ * POOLED MAPS:
+ * When several callers are likely to build a map for the same parameter
+ * (e.g. all the advisors looking at the same unit during a phase), the map
+ * can be taken with pf_map_pool_get() instead of pf_map_new(). If a map
+ * for an equal parameter was given back to the pool, it is reused: the
+ * iteration restarts from the start tile, replaying the tiles already
+ * found, then the search continues. It is still given back with
+ * pf_map_destroy().
+ *
+ * The server notifies the pool with pf_map_pool_tile_changed() whenever
+ * a tile changes, and only maps which already reached that tile (or one
+ * adjacent to it) are rebuilt. pf_map_pool_flush() drops all maps; it is
+ * called at phase change and when diplomatic states change. This means
+ * the callbacks of a pooled parameter must only depend on the state of
+ * the tile they are called for and of its adjacent tiles.
+ *
+ *
+ * TARGETED MAPS:
+ * In the case A), when only the path to 'ptile' is wanted, the map can be
+ * made with pf_map_new_targeted(&parameter, ptile) instead. The search is
+ * then guided towards 'ptile' by an estimate of the remaining cost (the
+ * distance to 'ptile' times the cheapest move of the unit type), and it
+ * usually stops after a fraction of the iterations. pf_map_path(),
+ * pf_map_move_cost() and pf_map_position() give the same costs for any
+ * tile (the path may be another one of equal cost), but the iteration of
+ * the case B) does not follow the increasing costs anymore and must not
+ * be used with such a map.
+ *
+ *
  * FILLING the struct pf_parameter:
  * This can either be done by hand or using the pft_* functions from
  * "common/aicore/pf_tools.h" or a mix of these.
@@ -465,6 +494,13 @@ struct pf_map;
 /* The reverse map strucure. Opaque type. */
 struct pf_reverse_map;
 
+/* Statistics of the pf_map pool. */
+struct pf_map_pool_stats {
+  int hits;             /* A pooled map was reused as is. */
+  int misses;           /* A new map was built. */
+  int rebuilds;         /* A pooled map was invalidated and rebuilt. */
+};
+
 
 
 /* ========================= Public Interface ============================ */
@@ -472,6 +508,9 @@ struct pf_reverse_map;
 /* Create and free. */
 struct pf_map *pf_map_new(const struct pf_parameter *parameter)
                fc__warn_unused_result;
+struct pf_map *pf_map_new_targeted(const struct pf_parameter *parameter,
+                                   struct tile *target)
+               fc__warn_unused_result;
 void pf_map_destroy(struct pf_map *pfm);
 
 /* Method A) functions. */
@@ -493,6 +532,15 @@ void pf_map_iter_position(struct pf_map *pfm, struct pf_position *pos);
 /* Other related functions. */
 const struct pf_parameter *pf_map_parameter(const struct pf_map *pfm);
 
+/* Pooled maps. Maps got with pf_map_pool_get() are given back with
+ * pf_map_destroy(). */
+struct pf_map *pf_map_pool_get(const struct pf_parameter *parameter)
+               fc__warn_unused_result;
+void pf_map_pool_tile_changed(const struct tile *ptile);
+void pf_map_pool_flush(void);
+const struct pf_map_pool_stats *pf_map_pool_stats(void);
+void pf_map_pool_stats_reset(void);
+
 
 /* Paths functions. */
 void pf_path_destroy(struct pf_path *path);
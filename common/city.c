@@ -3192,6 +3192,7 @@ void city_add_improvement(struct city *pcity,
     /* Client just read the info from the packets. */
     wonder_built(pcity, pimprove);
   }
+  effect_cache_invalidate();
 }
 
 /**************************************************************************
@@ -3209,6 +3210,7 @@ void city_remove_improvement(struct city *pcity,
     /* Client just read the info from the packets. */
     wonder_destroyed(pcity, pimprove);
   }
+  effect_cache_invalidate();
 }
 
 /**************************************************************************
@@ -466,6 +466,7 @@ extern struct output_type output_types[];
 /* get 'struct city_list' and related functions: */
 #define SPECLIST_TAG city
 #define SPECLIST_TYPE struct city
+#define SPECLIST_POOLED
 #include "speclist.h"
 
 #define city_list_iterate(citylist, pcity) \
@@ -122,6 +122,229 @@ static struct {
 } ruleset_cache;
 
 
+/**************************************************************************
+  Effect value cache. get_target_bonus_effects() is by far the most
+  called function of the effects code: every city refresh, AI evaluation
+  and unit move asks it for the same few values over and over again.
+  On the server, the sum of the effects of a type is memoised for a
+  target as long as nothing it can depend on changes.
+
+  Only the effect types whose requirements all are of a kind (and at a
+  range) that can change in a known way are cached; for the others, the
+  effects are always evaluated. The government of the target player and
+  the id of the target city are part of the key, so government changes
+  (which the AI simulates a lot) and reused city memory need no care.
+  Every other change of state an effect type can depend on (techs,
+  buildings, city owners, diplomatic relations, players) must call
+  effect_cache_invalidate(), which drops all the cached values at once
+  by bumping a generation counter.
+
+  While the cache is frozen (see effect_cache_freeze()), it is only read
+  from, so that several threads can query the effects at the same time
+  as long as nobody modifies the game.
+**************************************************************************/
+#define EFFECT_CACHE_BITS 14
+#define EFFECT_CACHE_SIZE (1 << EFFECT_CACHE_BITS)
+
+struct effect_cache_entry {
+  unsigned int generation;      /* 0 for an unused entry. */
+  enum effect_type type;
+  int city_id;
+  int value;
+  const struct player *target_player;
+  const struct player *other_player;
+  const struct government *government;
+  const struct city *target_city;
+  const struct impr_type *target_building;
+  const struct tile *target_tile;
+  const struct unit_type *target_unittype;
+  const struct output_type *target_output;
+  const struct specialist *target_specialist;
+};
+
+static struct {
+  struct effect_cache_entry *entries;
+  unsigned int generation;
+  bool frozen;
+  /* TRI_MAYBE until checked. */
+  enum fc_tristate cacheable[EFT_COUNT];
+  struct effect_cache_stats stats;
+} effect_cache = { .generation = 1 };
+
+/**************************************************************************
+  Forget about which effect types can be cached, because the effects
+  changed.
+**************************************************************************/
+static void effect_cache_reset_types(void)
+{
+  int i;
+
+  fc_assert_ret(!effect_cache.frozen);
+
+  for (i = 0; i < ARRAY_SIZE(effect_cache.cacheable); i++) {
+    effect_cache.cacheable[i] = TRI_MAYBE;
+  }
+  effect_cache_invalidate();
+}
+
+/**************************************************************************
+  Return TRUE iff the value of the requirement only changes along with
+  the key of the cache, or with a change effect_cache_invalidate() is
+  called for.
+**************************************************************************/
+static bool is_req_cacheable(const struct requirement *preq, int depth)
+{
+  switch (preq->source.kind) {
+  case VUT_NONE:
+  case VUT_ADVANCE:
+  case VUT_TECHFLAG:
+  case VUT_GOVERNMENT:
+  case VUT_NATION:
+  case VUT_NATIONGROUP:
+  case VUT_DIPLREL:
+  case VUT_UTYPE:
+  case VUT_UTFLAG:
+  case VUT_UCLASS:
+  case VUT_UCFLAG:
+  case VUT_OTYPE:
+  case VUT_SPECIALIST:
+  case VUT_IMPR_GENUS:
+    return TRUE;
+  case VUT_IMPROVEMENT:
+    /* Buildings elsewhere on the continent or in the trade partners
+     * don't tell when they come and go. */
+    if (preq->range == REQ_RANGE_CONTINENT
+        || preq->range == REQ_RANGE_TRADEROUTE
+        || preq->range == REQ_RANGE_CADJACENT
+        || preq->range == REQ_RANGE_ADJACENT) {
+      return FALSE;
+    }
+    /* Whether the building is there also depends on its obsolescence.
+     * Avoid looping on buildings obsoleting each other. */
+    if (depth > 4) {
+      return FALSE;
+    }
+    requirement_vector_iterate(&preq->source.value.building->obsolete_by,
+                               pobs) {
+      if (!is_req_cacheable(pobs, depth + 1)) {
+        return FALSE;
+      }
+    } requirement_vector_iterate_end;
+    return TRUE;
+  default:
+    return FALSE;
+  }
+}
+
+/**************************************************************************
+  Return TRUE iff the values of the effect type can be cached.
+**************************************************************************/
+static bool is_effect_type_cacheable(enum effect_type effect_type)
+{
+  bool cacheable = TRUE;
+
+  if (TRI_MAYBE != effect_cache.cacheable[effect_type]) {
+    return TRI_YES == effect_cache.cacheable[effect_type];
+  }
+
+  effect_list_iterate(get_effects(effect_type), peffect) {
+    if (NULL != peffect->multiplier) {
+      /* Multipliers are changed by the players at any time. */
+      cacheable = FALSE;
+      break;
+    }
+    requirement_vector_iterate(&peffect->reqs, preq) {
+      if (!is_req_cacheable(preq, 0)) {
+        cacheable = FALSE;
+        break;
+      }
+    } requirement_vector_iterate_end;
+    if (!cacheable) {
+      break;
+    }
+  } effect_list_iterate_end;
+
+  if (!effect_cache.frozen) {
+    effect_cache.cacheable[effect_type] = (cacheable ? TRI_YES : TRI_NO);
+  }
+
+  return cacheable;
+}
+
+/**************************************************************************
+  Return the entry the target would be cached in.
+**************************************************************************/
+static struct effect_cache_entry *
+effect_cache_slot(enum effect_type effect_type,
+                  const struct player *target_player,
+                  const struct player *other_player,
+                  const struct city *target_city,
+                  const struct impr_type *target_building,
+                  const struct tile *target_tile,
+                  const struct unit_type *target_unittype,
+                  const struct output_type *target_output,
+                  const struct specialist *target_specialist)
+{
+  const void *parts[] = {
+    target_player, other_player, target_city, target_building,
+    target_tile, target_unittype, target_output, target_specialist
+  };
+  size_t hash = effect_type;
+  int i;
+
+  for (i = 0; i < ARRAY_SIZE(parts); i++) {
+    hash = (hash ^ (size_t) parts[i]) * 0x9E3779B1;
+    hash ^= hash >> 15;
+  }
+
+  return &effect_cache.entries[hash & (EFFECT_CACHE_SIZE - 1)];
+}
+
+/**************************************************************************
+  Drop all the cached effect values. To be called whenever something the
+  cached effect types depend on changes.
+**************************************************************************/
+void effect_cache_invalidate(void)
+{
+  fc_assert_ret(!effect_cache.frozen);
+
+  effect_cache.stats.invalidations++;
+  if (0 == ++effect_cache.generation) {
+    /* Wrapped around; make sure no old entry looks current. */
+    if (NULL != effect_cache.entries) {
+      memset(effect_cache.entries, 0,
+             EFFECT_CACHE_SIZE * sizeof(*effect_cache.entries));
+    }
+    effect_cache.generation = 1;
+  }
+}
+
+/**************************************************************************
+  Freeze or thaw the effect cache. A frozen cache is only read, so it
+  is safe to query effects from several threads. Nothing must call
+  effect_cache_invalidate() while the cache is frozen.
+**************************************************************************/
+void effect_cache_freeze(bool frozen)
+{
+  effect_cache.frozen = frozen;
+}
+
+/**************************************************************************
+  Get the effect cache statistics.
+**************************************************************************/
+void effect_cache_stats_get(struct effect_cache_stats *stats)
+{
+  *stats = effect_cache.stats;
+}
+
+/**************************************************************************
+  Reset the effect cache statistics.
+**************************************************************************/
+void effect_cache_stats_reset(void)
+{
+  memset(&effect_cache.stats, 0, sizeof(effect_cache.stats));
+}
+
 /**************************************************************************
   Get a list of effects of this type.
 **************************************************************************/
@@ -180,10 +403,12 @@ struct effect *effect_new(enum effect_type type, int value,
   peffect->multiplier = pmul;
 
   requirement_vector_init(&peffect->reqs);
+  peffect->plan = req_plan_new(&peffect->reqs);
 
   /* Now add the effect to the ruleset cache. */
   effect_list_append(ruleset_cache.tracker, peffect);
   effect_list_append(get_effects(type), peffect);
+  effect_cache_reset_types();
 
   return peffect;
 }
@@ -211,6 +436,9 @@ void effect_req_append(struct effect *peffect, struct requirement req)
   struct effect_list *eff_list = get_req_source_effects(&req.source);
 
   requirement_vector_append(&peffect->reqs, req);
+  req_plan_destroy(peffect->plan);
+  peffect->plan = req_plan_new(&peffect->reqs);
+  effect_cache_reset_types();
 
   if (eff_list) {
     effect_list_append(eff_list, peffect);
@@ -242,6 +470,8 @@ void ruleset_cache_init(void)
   for (i = 0; i < ARRAY_SIZE(ruleset_cache.reqs.advances); i++) {
     ruleset_cache.reqs.advances[i] = effect_list_new();
   }
+
+  effect_cache_reset_types();
 }
 
 /**************************************************************************
@@ -256,6 +486,7 @@ void ruleset_cache_free(void)
   if (tracker_list) {
     effect_list_iterate(tracker_list, peffect) {
       requirement_vector_free(&peffect->reqs);
+      req_plan_destroy(peffect->plan);
       free(peffect);
     } effect_list_iterate_end;
     effect_list_destroy(tracker_list);
@@ -298,6 +529,10 @@ void ruleset_cache_free(void)
     }
   }
 
+  effect_cache_reset_types();
+  free(effect_cache.entries);
+  effect_cache.entries = NULL;
+
   initialized = FALSE;
 }
 
@@ -528,16 +763,67 @@ int get_target_bonus_effects(struct effect_list *plist,
                              const struct action *target_action,
                              enum effect_type effect_type)
 {
+  struct effect_cache_entry *pentry = NULL;
+  const struct government *gov = NULL;
+  int city_id = IDENTITY_NUMBER_ZERO;
   int bonus = 0;
 
+  /* Lists of active effects and unit or action targets are never cached.
+   * Neither are virtual cities, as they come and go without notice. */
+  if (NULL == plist && NULL == target_unit && NULL == target_action
+      && is_server()
+      && (NULL == target_city || IDENTITY_NUMBER_ZERO != target_city->id)
+      && (NULL != effect_cache.entries || !effect_cache.frozen)
+      && is_effect_type_cacheable(effect_type)) {
+    if (NULL != target_player) {
+      gov = target_player->government;
+    }
+    if (NULL != target_city) {
+      city_id = target_city->id;
+    }
+    if (NULL == effect_cache.entries) {
+      effect_cache.entries = fc_calloc(EFFECT_CACHE_SIZE,
+                                       sizeof(*effect_cache.entries));
+    }
+    pentry = effect_cache_slot(effect_type, target_player, other_player,
+                               target_city, target_building, target_tile,
+                               target_unittype, target_output,
+                               target_specialist);
+    if (pentry->generation == effect_cache.generation
+        && pentry->type == effect_type
+        && pentry->target_player == target_player
+        && pentry->other_player == other_player
+        && pentry->government == gov
+        && pentry->target_city == target_city
+        && pentry->city_id == city_id
+        && pentry->target_building == target_building
+        && pentry->target_tile == target_tile
+        && pentry->target_unittype == target_unittype
+        && pentry->target_output == target_output
+        && pentry->target_specialist == target_specialist) {
+      if (!effect_cache.frozen) {
+        effect_cache.stats.hits++;
+      }
+      return pentry->value;
+    }
+  }
+
+  if (!effect_cache.frozen && is_server()) {
+    if (NULL != pentry) {
+      effect_cache.stats.misses++;
+    } else {
+      effect_cache.stats.uncached++;
+    }
+  }
+
   /* Loop over all effects of this type. */
   effect_list_iterate(get_effects(effect_type), peffect) {
     /* For each effect, see if it is active. */
-    if (are_reqs_active(target_player, other_player, target_city,
+    if (req_plan_active(target_player, other_player, target_city,
                         target_building, target_tile,
                         target_unit, target_unittype,
                         target_output, target_specialist, target_action,
-			&peffect->reqs, RPT_CERTAIN)) {
+                        peffect->plan, RPT_CERTAIN)) {
       /* This code will add value of effect. If there's multiplier for 
        * effect and target_player aren't null, then value is multiplied
        * by player's multiplier factor. */
@@ -557,6 +843,22 @@ int get_target_bonus_effects(struct effect_list *plist,
     }
   } effect_list_iterate_end;
 
+  if (NULL != pentry && !effect_cache.frozen) {
+    pentry->generation = effect_cache.generation;
+    pentry->type = effect_type;
+    pentry->city_id = city_id;
+    pentry->value = bonus;
+    pentry->target_player = target_player;
+    pentry->other_player = other_player;
+    pentry->government = gov;
+    pentry->target_city = target_city;
+    pentry->target_building = target_building;
+    pentry->target_tile = target_tile;
+    pentry->target_unittype = target_unittype;
+    pentry->target_output = target_output;
+    pentry->target_specialist = target_specialist;
+  }
+
   return bonus;
 }
 
@@ -314,6 +314,9 @@ struct effect {
   /* An effect can have multiple requirements.  The effect will only be
    * active if all of these requirement are met. */
   struct requirement_vector reqs;
+
+  /* The requirements compiled by req_plan_new(). */
+  struct req_plan *plan;
 };
 
 /* An effect_list is a list of effects. */
@@ -418,6 +421,19 @@ struct effect_list *get_effects(enum effect_type effect_type);
 typedef bool (*iec_cb)(struct effect*, void *data);
 bool iterate_effect_cache(iec_cb cb, void *data);
 
+/* Memoised results of get_target_bonus_effects(), see effects.c. */
+struct effect_cache_stats {
+  unsigned long hits;
+  unsigned long misses;
+  unsigned long uncached;
+  unsigned long invalidations;
+};
+
+void effect_cache_invalidate(void);
+void effect_cache_freeze(bool frozen);
+void effect_cache_stats_get(struct effect_cache_stats *stats);
+void effect_cache_stats_reset(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
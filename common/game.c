@@ -397,8 +397,11 @@ static void game_defaults(void)
     sz_strlcpy(game.server.rulesetdir, GAME_DEFAULT_RULESETDIR);
     game.server.save_compress_level = GAME_DEFAULT_COMPRESS_LEVEL;
     game.server.save_compress_type = GAME_DEFAULT_COMPRESS_TYPE;
+    game.server.save_compress_long = GAME_DEFAULT_COMPRESS_LONG;
+    game.server.save_binary = GAME_DEFAULT_SAVE_BINARY;
     sz_strlcpy(game.server.save_name, GAME_DEFAULT_SAVE_NAME);
     game.server.save_nturns       = GAME_DEFAULT_SAVETURNS;
+    game.server.save_deltas       = GAME_DEFAULT_SAVEDELTAS;
     game.server.save_options.save_known = TRUE;
     game.server.save_options.save_private_map = TRUE;
     game.server.save_options.save_starts = TRUE;
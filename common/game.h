@@ -172,6 +172,9 @@ struct civ_game {
       bool threaded_save;
       int save_compress_level;
       enum fz_method save_compress_type;
+      bool save_compress_long;
+      bool save_binary;
+      int save_deltas;
       int save_nturns;
       int save_frequency;
       unsigned autosaves; /* FIXME: char would be enough, but current settings.c code wants to
@@ -191,6 +194,7 @@ struct civ_game {
       int unitwaittime;   /* minimal time between two movements of a unit */
       int upgrade_veteran_loss;
       bool vision_reveal_tiles;
+      int workers;        /* Threads for parallel computations. */
 
       bool debug[DEBUG_LAST];
       int timeoutint;     /* increase timeout every N turns... */
@@ -601,6 +605,9 @@ extern struct world wld;
 #define GAME_DEFAULT_SAVETURNS       1
 #define GAME_MIN_SAVETURNS           1
 #define GAME_MAX_SAVETURNS           200
+#define GAME_DEFAULT_SAVEDELTAS      0
+#define GAME_MIN_SAVEDELTAS          0
+#define GAME_MAX_SAVEDELTAS          100
 #define GAME_DEFAULT_SAVEFREQUENCY   15
 #define GAME_MIN_SAVEFREQUENCY       2
 #define GAME_MAX_SAVEFREQUENCY       1440
@@ -613,6 +620,10 @@ extern struct world wld;
 
 #define GAME_DEFAULT_THREADED_SAVE   FALSE
 
+#define GAME_DEFAULT_WORKERS         0
+#define GAME_MIN_WORKERS             0
+#define GAME_MAX_WORKERS             64
+
 #define GAME_DEFAULT_USER_META_MESSAGE ""
 
 #define GAME_DEFAULT_SKILL_LEVEL     AI_LEVEL_EASY
@@ -646,6 +657,10 @@ extern struct world wld;
 #  define GAME_DEFAULT_COMPRESS_TYPE FZ_PLAIN
 #endif
 
+#define GAME_DEFAULT_COMPRESS_LONG FALSE
+
+#define GAME_DEFAULT_SAVE_BINARY FALSE
+
 #define GAME_DEFAULT_ALLOWED_CITY_NAMES CNM_PLAYER_UNIQUE
 
 #define GAME_DEFAULT_PLRCOLORMODE PLRCOL_PLR_ORDER
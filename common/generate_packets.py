@@ -1047,8 +1047,10 @@ static char *stats_%(name)s_names[] = {%(names)s};
                 delta_header=""
                 body="#if 1 /* To match endif */"
             body=body+"\n"
+            puts=""
             for field in self.fields:
-                body=body+field.get_put(0)+"\n"
+                puts=puts+field.get_put(0)+"\n"
+            body=body+self.get_broadcast_wrapper(puts,"NULL, 0")
             body=body+"\n#endif\n"
         else:
             body=""
@@ -1116,7 +1118,7 @@ static char *stats_%(name)s_names[] = {%(names)s};
   }
 '''%self.get_dict(vars())
 
-        body=body+'''
+        puts='''
 #ifdef FREECIV_JSON_CONNECTION
   field_addr.name = "fields";
 #endif /* FREECIV_JSON_CONNECTION */
@@ -1124,12 +1126,21 @@ static char *stats_%(name)s_names[] = {%(names)s};
 '''
 
         for field in self.key_fields:
-            body=body+field.get_put(1)+"\n"
-        body=body+"\n"
+            puts=puts+field.get_put(1)+"\n"
+        puts=puts+"\n"
 
         for i in range(len(self.other_fields)):
             field=self.other_fields[i]
-            body=body+field.get_put_wrapper(self,i,1)
+            puts=puts+field.get_put_wrapper(self,i,1)
+
+        # Array diffs depend on the old values, not only on the fields
+        # bitvector; such packets are serialised for every connection.
+        if len(list(filter(lambda x:x.diff and x.is_array==1,
+                           self.other_fields)))==0:
+            body=body+self.get_broadcast_wrapper(puts,
+                                                 "&fields, sizeof(fields)")
+        else:
+            body=body+puts
         body=body+'''
   *old = *real_packet;
 '''
@@ -1146,6 +1157,21 @@ static char *stats_%(name)s_names[] = {%(names)s};
 
         return intro+body
 
+    # Helper for get_send(). Returns the serialisation code 'puts'
+    # skipped when the packet was already serialised for an equivalent
+    # connection during a broadcast. 'key' identifies the delta state.
+    def get_broadcast_wrapper(self,puts,key):
+        if self.no_packet or self.want_pre_send:
+            return puts
+        lines=map(lambda x: x and "  "+x or x,puts.split("\n"))
+        return '''
+  pbuf = packet_broadcast_find(pc, packet, %(type)s, %(no)d,
+                               %(key)s);
+  if (NULL == pbuf) {
+%(puts)s
+  }
+'''%self.get_dict({"key":key,"puts":"\n".join(lines)})
+
     # Returns a code fragment which is the implementation of the receive
     # function. This is one of the two real functions. So it is rather
     # complex to create.
@@ -1501,14 +1527,22 @@ class Packet:
     # lsend function.
     def get_lsend(self):
         if not self.want_lsend: return ""
+        if self.no_packet:
+            packet="NULL"
+        else:
+            packet="packet"
         return '''%(lsend_prototype)s
 {
+  struct packet_broadcast broadcast;
+
+  packet_broadcast_begin(&broadcast, dest, %(packet)s);
   conn_list_iterate(dest, pconn) {
     send_%(name)s(pconn%(extra_send_args2)s);
   } conn_list_iterate_end;
+  packet_broadcast_end(&broadcast);
 }
 
-'''%self.__dict__
+'''%self.get_dict(vars())
 
     # Returns a code fragment which is the implementation of the
     # dsend function.
@@ -158,6 +158,10 @@ void map_init(void)
   wld.map.num_continents = 0;
   wld.map.num_oceans = 0;
   wld.map.tiles = NULL;
+  wld.map.packed_terrains = NULL;
+  wld.map.packed_owners = NULL;
+  wld.map.packed_continents = NULL;
+  wld.map.packed_extras = NULL;
   wld.map.startpos_table = NULL;
   wld.map.iterate_outwards_indices = NULL;
 
@@ -489,6 +493,17 @@ void map_allocate(void)
 
   fc_assert_ret(NULL == wld.map.tiles);
   wld.map.tiles = fc_calloc(MAP_INDEX_SIZE, sizeof(*wld.map.tiles));
+  wld.map.packed_terrains = fc_malloc(MAP_INDEX_SIZE
+                                      * sizeof(*wld.map.packed_terrains));
+  wld.map.packed_owners = fc_malloc(MAP_INDEX_SIZE
+                                    * sizeof(*wld.map.packed_owners));
+  wld.map.packed_continents = fc_malloc(MAP_INDEX_SIZE
+                                        * sizeof(*wld.map.packed_continents));
+  /* Zeroed, as map_packed_update_tile() counts the extras which change. */
+  wld.map.packed_extras = fc_calloc(MAP_INDEX_SIZE,
+                                    sizeof(*wld.map.packed_extras));
+  memset(wld.map.packed_extra_tiles, 0,
+         sizeof(wld.map.packed_extra_tiles));
 
   /* Note this use of whole_map_iterate may be a bit sketchy, since the
    * tile values (ptile->index, etc.) haven't been set yet.  It might be
@@ -497,6 +512,7 @@ void map_allocate(void)
     ptile->index = ptile - wld.map.tiles;
     CHECK_INDEX(tile_index(ptile));
     tile_init(ptile);
+    map_packed_update_tile(ptile);
   } whole_map_iterate_end;
 
   generate_city_map_indices();
@@ -508,6 +524,60 @@ void map_allocate(void)
   wld.map.startpos_table = startpos_hash_new();
 }
 
+/****************************************************************************
+  Copy the terrain, owner, continent and extras of the tile to the packed
+  map arrays. Virtual tiles are ignored.
+****************************************************************************/
+void map_packed_update_tile(const struct tile *ptile)
+{
+  int idx = tile_index(ptile);
+  int byte, bit;
+
+  if (NULL == wld.map.packed_terrains
+      || 0 > idx || MAP_INDEX_SIZE <= idx
+      || ptile != wld.map.tiles + idx) {
+    return;
+  }
+
+  /* Count the extras added to or removed from the tile. */
+  for (byte = 0; byte < ARRAY_SIZE(ptile->extras.vec); byte++) {
+    unsigned char changed = (wld.map.packed_extras[idx].vec[byte]
+                             ^ ptile->extras.vec[byte]);
+
+    for (bit = 0; 0 != changed; bit++, changed >>= 1) {
+      if (changed & 1) {
+        wld.map.packed_extra_tiles[byte * 8 + bit]
+          += (BV_ISSET(ptile->extras, byte * 8 + bit) ? 1 : -1);
+      }
+    }
+  }
+
+  wld.map.packed_terrains[idx] = (NULL != ptile->terrain
+                                  ? terrain_number(ptile->terrain)
+                                  : MAP_PACKED_TERRAIN_UNKNOWN);
+  wld.map.packed_owners[idx] = (NULL != ptile->owner
+                                ? player_number(ptile->owner)
+                                : MAP_TILE_OWNER_NULL);
+  wld.map.packed_continents[idx] = ptile->continent;
+  wld.map.packed_extras[idx] = ptile->extras;
+}
+
+/****************************************************************************
+  Refresh the packed map arrays from the tiles. To be called after the
+  tiles were changed in bulk without the tile setters, e.g. when loading
+  a savegame.
+****************************************************************************/
+void map_packed_update_all(void)
+{
+  if (NULL == wld.map.tiles) {
+    return;
+  }
+
+  whole_map_iterate(ptile) {
+    map_packed_update_tile(ptile);
+  } whole_map_iterate_end;
+}
+
 /***************************************************************
   Frees the allocated memory of the map.
 ***************************************************************/
@@ -522,6 +592,12 @@ void map_free(void)
 
     free(wld.map.tiles);
     wld.map.tiles = NULL;
+    FC_FREE(wld.map.packed_terrains);
+    FC_FREE(wld.map.packed_owners);
+    FC_FREE(wld.map.packed_continents);
+    FC_FREE(wld.map.packed_extras);
+    memset(wld.map.packed_extra_tiles, 0,
+           sizeof(wld.map.packed_extra_tiles));
 
     if (wld.map.startpos_table) {
       startpos_hash_destroy(wld.map.startpos_table);
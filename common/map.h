@@ -534,6 +534,36 @@ extern struct terrain_misc terrain_control;
   }									    \
 }
 
+/* Packed copies of the terrain, owner, continent and extras of every map
+ * tile, indexed by tile index. Whole-map scans that only need these
+ * fields should read them here instead of walking the tiles. The tile
+ * setters (tile_set_terrain(), tile_set_owner(), tile_set_continent(),
+ * tile_add_extra(), ...) keep them up to date; code writing the tile
+ * fields directly must call map_packed_update_tile() (or
+ * map_packed_update_all() after a bulk change). */
+#define MAP_PACKED_TERRAIN_UNKNOWN -1
+
+#define map_packed_terrain(_index) (wld.map.packed_terrains[_index])
+#define map_packed_owner(_index) (wld.map.packed_owners[_index])
+#define map_packed_continent(_index) (wld.map.packed_continents[_index])
+#define map_packed_extras(_index) (&wld.map.packed_extras[_index])
+/* Number of map tiles with the extra of that index. */
+#define map_packed_extra_tiles(_extra_index) \
+  (wld.map.packed_extra_tiles[_extra_index])
+
+/* Iterate over all tile indices, for scans of the packed arrays. */
+#define whole_map_index_iterate(_index)                                     \
+{                                                                           \
+  int _index;                                                               \
+  for (_index = 0; _index < MAP_INDEX_SIZE; _index++) {
+
+#define whole_map_index_iterate_end                                         \
+  }                                                                         \
+}
+
+void map_packed_update_tile(const struct tile *ptile);
+void map_packed_update_all(void);
+
 BV_DEFINE(dir_vector, 8);
 
 /* return the reverse of the direction */
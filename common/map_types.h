@@ -74,6 +74,15 @@ struct civ_map {
   struct tile *tiles;
   struct startpos_hash *startpos_table;
 
+  /* Packed copies of the tile fields most used by whole-map scans,
+   * indexed by tile index. See map_packed_terrain() and friends. */
+  signed char *packed_terrains;
+  unsigned char *packed_owners;
+  Continent_id *packed_continents;
+  bv_extras *packed_extras;
+  /* Number of tiles with each extra, kept with packed_extras. */
+  int packed_extra_tiles[MAX_EXTRA_TYPES];
+
   union {
     struct {
       enum mapsize_type mapsize; /* how the map size is defined */
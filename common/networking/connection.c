@@ -47,6 +47,13 @@
 #include "connection.h"
 
 
+/* Maximum number of pieces given to a single vectored write. */
+#define MAX_SEND_IOVEC 64
+
+/* Shared data smaller than this is copied into the send buffer, as
+ * queuing a reference to it would cost more than the copy. */
+#define SHARED_COPY_LIMIT 64
+
 static void default_conn_close_callback(struct connection *pconn);
 
 /* String used for connection.addr and related cases to indicate
@@ -156,19 +163,108 @@ int read_socket_data(int sock, struct socket_packet_buffer *buffer)
   return -1;
 }
 
+/**************************************************************************
+  Return the number of bytes waiting in the send buffer.
+**************************************************************************/
+static inline int send_buffer_pending(const struct socket_packet_buffer *buf)
+{
+  return buf->ndata + buf->nshared;
+}
+
+/**************************************************************************
+  Fill 'iov' with the data of the send buffer, in sending order. Returns
+  the number of pieces used, at most 'max'.
+**************************************************************************/
+static int send_buffer_iovec(const struct socket_packet_buffer *buf,
+                             struct fc_iovec *iov, int max)
+{
+  int n = 0, pos = 0, i;
+
+  for (i = 0; i < buf->nchunks && n < max; i++) {
+    const struct packet_chunk *chunk = buf->chunks + i;
+    int skip = (0 == i ? buf->chunk_sent : 0);
+
+    if (chunk->pos > pos) {
+      iov[n].base = buf->data + pos;
+      iov[n].len = chunk->pos - pos;
+      pos = chunk->pos;
+      if (++n == max) {
+        return n;
+      }
+    }
+    iov[n].base = chunk->pbuf->data + skip;
+    iov[n].len = chunk->pbuf->size - skip;
+    n++;
+  }
+
+  if (n < max && buf->ndata > pos) {
+    iov[n].base = buf->data + pos;
+    iov[n].len = buf->ndata - pos;
+    n++;
+  }
+
+  return n;
+}
+
+/**************************************************************************
+  Remove the first 'len' bytes sent from the send buffer.
+**************************************************************************/
+static void send_buffer_consume(struct socket_packet_buffer *buf, int len)
+{
+  int own = 0, i;
+
+  while (0 < len && 0 < buf->nchunks) {
+    struct packet_chunk *chunk = buf->chunks;
+    int part = MIN(len, chunk->pos - own);
+
+    own += part;
+    len -= part;
+    if (0 == len) {
+      break;
+    }
+
+    part = chunk->pbuf->size - buf->chunk_sent;
+    if (len < part) {
+      buf->chunk_sent += len;
+      buf->nshared -= len;
+      len = 0;
+      break;
+    }
+
+    len -= part;
+    buf->nshared -= part;
+    buf->chunk_sent = 0;
+    packet_buffer_unref(chunk->pbuf);
+    buf->nchunks--;
+    memmove(buf->chunks, buf->chunks + 1,
+            buf->nchunks * sizeof(*buf->chunks));
+  }
+
+  own += len;
+  fc_assert_ret(own <= buf->ndata);
+  if (0 < own) {
+    buf->ndata -= own;
+    memmove(buf->data, buf->data + own, buf->ndata);
+    for (i = 0; i < buf->nchunks; i++) {
+      buf->chunks[i].pos -= own;
+    }
+  }
+}
+
 /**************************************************************************
   write wrapper function -vasc
 **************************************************************************/
 static int write_socket_data(struct connection *pc,
 			     struct socket_packet_buffer *buf, int limit)
 {
-  int start, nput, nblock;
+  bool written = FALSE;
+  int nput;
 
   if (is_server() && pc->server.is_closing) {
     return 0;
   }
 
-  for (start=0; buf->ndata-start>limit;) {
+  while (send_buffer_pending(buf) > limit) {
     fd_set writefs, exceptfs;
     fc_timeval tv;
 
@@ -195,10 +291,11 @@ static int write_socket_data(struct connection *pc,
     }
 
     if (FD_ISSET(pc->sock, &writefs)) {
-      nblock=MIN(buf->ndata-start, MAX_LEN_PACKET);
-      log_debug("trying to write %d limit=%d", nblock, limit);
-      if ((nput = fc_writesocket(pc->sock, 
-                                 (const char *)buf->data+start, nblock)) == -1) {
+      struct fc_iovec iov[MAX_SEND_IOVEC];
+      int niov = send_buffer_iovec(buf, iov, ARRAY_SIZE(iov));
+
+      log_debug("trying to write %d pieces limit=%d", niov, limit);
+      if ((nput = fc_writevsocket(pc->sock, iov, niov)) == -1) {
 #ifdef NONBLOCKING_SOCKETS
 	if (errno == EWOULDBLOCK || errno == EAGAIN) {
 	  break;
@@ -207,13 +304,14 @@ static int write_socket_data(struct connection *pc,
         connection_close(pc, _("lagging connection"));
         return -1;
       }
-      start += nput;
+      if (0 < nput) {
+        send_buffer_consume(buf, nput);
+        written = TRUE;
+      }
     }
   }
 
-  if (start > 0) {
-    buf->ndata -= start;
-    memmove(buf->data, buf->data+start, buf->ndata);
+  if (written) {
     pc->last_write = timer_renew(pc->last_write, TIMER_USER, TIMER_ACTIVE);
     timer_start(pc->last_write);
   }
@@ -226,11 +324,11 @@ static int write_socket_data(struct connection *pc,
 **************************************************************************/
 void flush_connection_send_buffer_all(struct connection *pc)
 {
-  if (pc && pc->used && pc->send_buffer->ndata > 0) {
+  if (pc && pc->used && 0 < send_buffer_pending(pc->send_buffer)) {
     write_socket_data(pc, pc->send_buffer, 0);
     if (pc->notify_of_writable_data) {
       pc->notify_of_writable_data(pc, pc->send_buffer
-                                  && pc->send_buffer->ndata > 0);
+                                  && 0 < send_buffer_pending(pc->send_buffer));
     }
   }
 }
@@ -241,21 +339,33 @@ void flush_connection_send_buffer_all(struct connection *pc)
 #ifndef FREECIV_JSON_CONNECTION
 static void flush_connection_send_buffer_packets(struct connection *pc)
 {
-  if (pc && pc->used && pc->send_buffer->ndata >= MAX_LEN_PACKET) {
+  if (pc && pc->used
+      && MAX_LEN_PACKET <= send_buffer_pending(pc->send_buffer)) {
     write_socket_data(pc, pc->send_buffer, MAX_LEN_PACKET-1);
     if (pc->notify_of_writable_data) {
       pc->notify_of_writable_data(pc, pc->send_buffer
-                                  && pc->send_buffer->ndata > 0);
+                                  && 0 < send_buffer_pending(pc->send_buffer));
     }
   }
 }
 #endif /* FREECIV_JSON_CONNECTION */
 
 /****************************************************************************
-  Add data to send to the connection.
+  Return the number of bytes waiting to be sent to the connection.
+****************************************************************************/
+int connection_send_pending(const struct connection *pconn)
+{
+  return (NULL != pconn->send_buffer
+          ? send_buffer_pending(pconn->send_buffer) : 0);
+}
+
+/****************************************************************************
+  Add data to send to the connection. Shared data is queued by reference
+  unless it is so small that copying it is cheaper.
 ****************************************************************************/
 static bool add_connection_data(struct connection *pconn,
-                                const unsigned char *data, int len)
+                                const unsigned char *data, int len,
+                                struct packet_buffer *pbuf)
 {
   struct socket_packet_buffer *buf;
 
@@ -267,6 +377,24 @@ static bool add_connection_data(struct connection *pconn,
 
   buf = pconn->send_buffer;
   log_debug("add %d bytes to %d (space =%d)", len, buf->ndata, buf->nsize);
+  if (send_buffer_pending(buf) + len > MAX_LEN_BUFFER) {
+    connection_close(pconn, _("buffer overflow"));
+    return FALSE;
+  }
+
+  if (NULL != pbuf && SHARED_COPY_LIMIT <= len) {
+    if (buf->nchunks == buf->chunks_size) {
+      buf->chunks_size = MAX(16, 2 * buf->chunks_size);
+      buf->chunks = fc_realloc(buf->chunks,
+                               buf->chunks_size * sizeof(*buf->chunks));
+    }
+    buf->chunks[buf->nchunks].pbuf = packet_buffer_ref(pbuf);
+    buf->chunks[buf->nchunks].pos = buf->ndata;
+    buf->nchunks++;
+    buf->nshared += len;
+    return TRUE;
+  }
+
   if (!buffer_ensure_free_extra_space(buf, len)) {
     connection_close(pconn, _("buffer overflow"));
     return FALSE;
@@ -278,10 +406,12 @@ static bool add_connection_data(struct connection *pconn,
 }
 
 /****************************************************************************
-  Write data to socket. Return TRUE on success.
+  Queue data to send to the connection, flushing what can be. Return TRUE
+  on success.
 ****************************************************************************/
-bool connection_send_data(struct connection *pconn,
-                          const unsigned char *data, int len)
+static bool connection_queue_data(struct connection *pconn,
+                                  const unsigned char *data, int len,
+                                  struct packet_buffer *pbuf)
 {
   if (NULL == pconn
       || !pconn->used
@@ -294,7 +424,7 @@ bool connection_send_data(struct connection *pconn,
 #ifndef FREECIV_JSON_CONNECTION
   if (0 < pconn->send_buffer->do_buffer_sends) {
     flush_connection_send_buffer_packets(pconn);
-    if (!add_connection_data(pconn, data, len)) {
+    if (!add_connection_data(pconn, data, len, pbuf)) {
       log_verbose("cut connection %s due to huge send buffer (1)",
                   conn_description(pconn));
       return FALSE;
@@ -304,7 +434,7 @@ bool connection_send_data(struct connection *pconn,
 #endif /* FREECIV_JSON_CONNECTION */
   {
     flush_connection_send_buffer_all(pconn);
-    if (!add_connection_data(pconn, data, len)) {
+    if (!add_connection_data(pconn, data, len, pbuf)) {
       log_verbose("cut connection %s due to huge send buffer (2)",
                   conn_description(pconn));
       return FALSE;
@@ -314,6 +444,26 @@ bool connection_send_data(struct connection *pconn,
   return TRUE;
 }
 
+/****************************************************************************
+  Write data to socket. Return TRUE on success.
+****************************************************************************/
+bool connection_send_data(struct connection *pconn,
+                          const unsigned char *data, int len)
+{
+  return connection_queue_data(pconn, data, len, NULL);
+}
+
+/****************************************************************************
+  Write shared data to socket. The connection keeps a reference to 'pbuf'
+  until the data is sent instead of copying it, so the same serialised
+  data can be queued to many connections. Return TRUE on success.
+****************************************************************************/
+bool connection_send_shared(struct connection *pconn,
+                            struct packet_buffer *pbuf)
+{
+  return connection_queue_data(pconn, pbuf->data, pbuf->size, pbuf);
+}
+
 /**************************************************************************
   Turn on buffering, using a counter so that calls may be nested.
 **************************************************************************/
@@ -431,7 +581,7 @@ struct socket_packet_buffer *new_socket_packet_buffer(void)
 {
   struct socket_packet_buffer *buf;
 
-  buf = fc_malloc(sizeof(*buf));
+  buf = fc_calloc(1, sizeof(*buf));
   buf->ndata = 0;
   buf->do_buffer_sends = 0;
   buf->nsize = 10*MAX_LEN_PACKET;
@@ -445,13 +595,55 @@ struct socket_packet_buffer *new_socket_packet_buffer(void)
 static void free_socket_packet_buffer(struct socket_packet_buffer *buf)
 {
   if (buf) {
+    int i;
+
     if (buf->data) {
       free(buf->data);
     }
+    for (i = 0; i < buf->nchunks; i++) {
+      packet_buffer_unref(buf->chunks[i].pbuf);
+    }
+    free(buf->chunks);
     free(buf);
   }
 }
 
+/**************************************************************************
+  Return a new packet buffer holding a copy of 'data', with a single
+  reference owned by the caller.
+**************************************************************************/
+struct packet_buffer *packet_buffer_new(const unsigned char *data, int len)
+{
+  struct packet_buffer *pbuf = fc_malloc(sizeof(*pbuf) + len);
+
+  pbuf->refcount = 1;
+  pbuf->size = len;
+  pbuf->data = (unsigned char *) (pbuf + 1);
+  memcpy(pbuf->data, data, len);
+
+  return pbuf;
+}
+
+/**************************************************************************
+  Take a new reference to the packet buffer.
+**************************************************************************/
+struct packet_buffer *packet_buffer_ref(struct packet_buffer *pbuf)
+{
+  pbuf->refcount++;
+  return pbuf;
+}
+
+/**************************************************************************
+  Release a reference to the packet buffer, freeing it with the last one.
+**************************************************************************/
+void packet_buffer_unref(struct packet_buffer *pbuf)
+{
+  fc_assert_ret(0 < pbuf->refcount);
+  if (0 == --pbuf->refcount) {
+    free(pbuf);
+  }
+}
+
 /**************************************************************************
   Return pointer to static string containing a description for this
   connection, based on pconn->name, pconn->addr, and (if applicable)
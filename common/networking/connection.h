@@ -50,6 +50,7 @@ extern "C" {
 struct conn_pattern_list;
 struct genhash;
 struct packet_handlers;
+struct tile_info_queue;
 struct timer_list;
 
 /* Used in the network protocol. */
@@ -114,6 +115,23 @@ struct connection;
     TYPED_LIST_ITERATE(struct connection, connlist, pconn)
 #define conn_list_iterate_end  LIST_ITERATE_END
 
+/***********************************************************
+  Reference counted packet data, serialised once and queued
+  for sending to any number of connections without copying.
+***********************************************************/
+struct packet_buffer {
+  int refcount;
+  int size;
+  unsigned char *data;
+};
+
+/* A packet_buffer queued in a send buffer, to be sent after the
+ * first 'pos' bytes of the buffer's own data. */
+struct packet_chunk {
+  struct packet_buffer *pbuf;
+  int pos;
+};
+
 /***********************************************************
   This is a buffer where the data is first collected,
   whenever it arrives to the client/server.
@@ -123,6 +141,13 @@ struct socket_packet_buffer {
   int do_buffer_sends;
   int nsize;
   unsigned char *data;
+
+  /* Send buffers only: shared data queued between the own data. */
+  struct packet_chunk *chunks;
+  int nchunks;
+  int chunks_size;
+  int nshared;          /* Bytes of the chunks still to send. */
+  int chunk_sent;       /* Bytes of chunks[0] already sent. */
 };
 
 struct packet_header {
@@ -228,6 +253,9 @@ struct connection {
       /* The list of ignored connection patterns. */
       struct conn_pattern_list *ignore_list;
 
+      /* The tiles whose info is still to be sent. */
+      struct tile_info_queue *tile_info_queue;
+
       /* Something has occurred that means the connection should be closed,
        * but the closing has been postponed. */
       bool is_closing;
@@ -285,6 +313,13 @@ int read_socket_data(int sock, struct socket_packet_buffer *buffer);
 void flush_connection_send_buffer_all(struct connection *pc);
 bool connection_send_data(struct connection *pconn,
                           const unsigned char *data, int len);
+bool connection_send_shared(struct connection *pconn,
+                            struct packet_buffer *pbuf);
+int connection_send_pending(const struct connection *pconn);
+
+struct packet_buffer *packet_buffer_new(const unsigned char *data, int len);
+struct packet_buffer *packet_buffer_ref(struct packet_buffer *pbuf);
+void packet_buffer_unref(struct packet_buffer *pbuf);
 
 void connection_do_buffer(struct connection *pc);
 void connection_do_unbuffer(struct connection *pc);
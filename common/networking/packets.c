@@ -83,6 +83,9 @@ extern const char *const packet_functional_capability;
 
 static struct packet_handler_hash *packet_handlers = NULL;
 
+/* The current broadcast, see packet_broadcast_begin(). */
+static struct packet_broadcast *broadcast = NULL;
+
 #ifdef USE_COMPRESSION
 static int stat_size_alone = 0;
 static int stat_size_uncompressed = 0;
@@ -200,10 +203,14 @@ bool conn_compression_thaw(struct connection *pconn)
 
 
 /**************************************************************************
+  Send the serialised packet 'data' to the connection. If 'pbuf' is not
+  NULL, it holds the same data and may be queued instead of a copy.
   It returns the request id of the outgoing packet (or 0 if is_server()).
 **************************************************************************/
-int send_packet_data(struct connection *pc, unsigned char *data, int len,
-                     enum packet_type packet_type)
+static int send_packet_data_real(struct connection *pc,
+                                 const unsigned char *data, int len,
+                                 enum packet_type packet_type,
+                                 struct packet_buffer *pbuf)
 {
   /* default for the server */
   int result = 0;
@@ -261,7 +268,11 @@ int send_packet_data(struct connection *pc, unsigned char *data, int len,
       stat_size_alone += size;
       log_compress("COMPRESS: sending %s alone (%d bytes total)",
                    packet_name(packet_type), stat_size_alone);
-      connection_send_data(pc, data, len);
+      if (NULL != pbuf) {
+        connection_send_shared(pc, pbuf);
+      } else {
+        connection_send_data(pc, data, len);
+      }
     }
 
     log_compress2("COMPRESS: STATS: alone=%d compression-expand=%d "
@@ -270,7 +281,11 @@ int send_packet_data(struct connection *pc, unsigned char *data, int len,
                   stat_size_uncompressed, stat_size_compressed);
   }
 #else  /* USE_COMPRESSION */
-  connection_send_data(pc, data, len);
+  if (NULL != pbuf) {
+    connection_send_shared(pc, pbuf);
+  } else {
+    connection_send_data(pc, data, len);
+  }
 #endif /* USE_COMPRESSION */
 
 #if PACKET_SIZE_STATISTICS
@@ -358,6 +373,160 @@ int send_packet_data(struct connection *pc, unsigned char *data, int len,
   return result;
 }
 
+/**************************************************************************
+  It returns the request id of the outgoing packet (or 0 if is_server()).
+**************************************************************************/
+int send_packet_data(struct connection *pc, unsigned char *data, int len,
+                     enum packet_type packet_type)
+{
+  return send_packet_data_real(pc, data, len, packet_type, NULL);
+}
+
+/**************************************************************************
+  Send a packet serialised in a shared buffer. Same as send_packet_data(),
+  but the data is not copied unless it has to be compressed.
+**************************************************************************/
+int send_packet_data_shared(struct connection *pc,
+                            struct packet_buffer *pbuf,
+                            enum packet_type packet_type)
+{
+  return send_packet_data_real(pc, pbuf->data, pbuf->size, packet_type,
+                               pbuf);
+}
+
+/**************************************************************************
+  Start broadcasting 'packet' (may be NULL) to the connections of 'dest'.
+  Until packet_broadcast_end(), the packet is serialised once for all the
+  connections using the same packet variant, header format and delta
+  state, and they all share the bytes. Calls may be nested; the inner
+  broadcast hides the outer one.
+**************************************************************************/
+void packet_broadcast_begin(struct packet_broadcast *pbc,
+                            const struct conn_list *dest,
+                            const void *packet)
+{
+  pbc->prev = broadcast;
+#ifdef FREECIV_JSON_CONNECTION
+  pbc->active = FALSE;
+#else  /* FREECIV_JSON_CONNECTION */
+  pbc->active = (1 < conn_list_size(dest));
+#endif /* FREECIV_JSON_CONNECTION */
+  pbc->num_packets = 0;
+  pbc->num_groups = 0;
+  pbc->has_pending = FALSE;
+  broadcast = pbc;
+
+  if (NULL != packet) {
+    packet_broadcast_add(pbc, packet);
+  }
+}
+
+/**************************************************************************
+  Add another packet sent to several connections during the broadcast.
+**************************************************************************/
+void packet_broadcast_add(struct packet_broadcast *pbc, const void *packet)
+{
+  if (pbc->active && PACKET_BROADCAST_PACKETS > pbc->num_packets) {
+    pbc->packets[pbc->num_packets++] = packet;
+  }
+}
+
+/**************************************************************************
+  Finish the broadcast started by packet_broadcast_begin().
+**************************************************************************/
+void packet_broadcast_end(struct packet_broadcast *pbc)
+{
+  int i;
+
+  fc_assert_ret(broadcast == pbc);
+
+  for (i = 0; i < pbc->num_groups; i++) {
+    packet_buffer_unref(pbc->groups[i].pbuf);
+  }
+  broadcast = pbc->prev;
+}
+
+/**************************************************************************
+  Return the serialised form of 'packet' already made for a connection
+  equivalent to 'pc', or NULL if the packet has to be serialised. 'key'
+  identifies the delta state, e.g. the set of changed fields. On a miss,
+  the key is remembered for packet_broadcast_send().
+**************************************************************************/
+struct packet_buffer *packet_broadcast_find(const struct connection *pc,
+                                            const void *packet,
+                                            enum packet_type type,
+                                            int variant, const void *key,
+                                            int key_size)
+{
+  struct packet_broadcast_group *group;
+  int i;
+
+  if (NULL == broadcast || NULL == packet
+      || PACKET_BROADCAST_KEY_SIZE < key_size) {
+    return NULL;
+  }
+
+  for (i = 0; i < broadcast->num_packets; i++) {
+    if (broadcast->packets[i] == packet) {
+      break;
+    }
+  }
+  if (i == broadcast->num_packets) {
+    return NULL;
+  }
+
+  for (i = 0; i < broadcast->num_groups; i++) {
+    group = broadcast->groups + i;
+    if (group->packet == packet
+        && group->type == type
+        && group->variant == variant
+        && group->header.length == pc->packet_header.length
+        && group->header.type == pc->packet_header.type
+        && group->key_size == key_size
+        && 0 == memcmp(group->key, key, key_size)) {
+      return group->pbuf;
+    }
+  }
+
+  group = &broadcast->pending;
+  group->packet = packet;
+  group->type = type;
+  group->variant = variant;
+  group->header = pc->packet_header;
+  group->key_size = key_size;
+  memcpy(group->key, key, key_size);
+  broadcast->has_pending = TRUE;
+
+  return NULL;
+}
+
+/**************************************************************************
+  Send a freshly serialised packet. During a broadcast, the data is kept
+  in a shared buffer for the other connections of its group.
+**************************************************************************/
+int packet_broadcast_send(struct connection *pc, unsigned char *data,
+                          int len, enum packet_type packet_type)
+{
+  struct packet_broadcast_group *group;
+
+  if (NULL == broadcast
+      || !broadcast->has_pending
+      || broadcast->pending.type != packet_type) {
+    return send_packet_data(pc, data, len, packet_type);
+  }
+
+  broadcast->has_pending = FALSE;
+  if (PACKET_BROADCAST_GROUPS <= broadcast->num_groups) {
+    return send_packet_data(pc, data, len, packet_type);
+  }
+
+  group = broadcast->groups + broadcast->num_groups++;
+  *group = broadcast->pending;
+  group->pbuf = packet_buffer_new(data, len);
+
+  return send_packet_data_shared(pc, group->pbuf, packet_type);
+}
+
 /**************************************************************************
   Read and return a packet from the connection 'pc'. The type of the
   packet is written in 'ptype'. On error, the connection is closed and
@@ -99,6 +99,51 @@ struct packet_handlers {
   void *(*receive[PACKET_LAST])(struct connection *pconn);
 };
 
+/* Number of packets and of differently serialised forms of them kept
+ * while broadcasting to a connection list. */
+#define PACKET_BROADCAST_PACKETS 4
+#define PACKET_BROADCAST_GROUPS 8
+#define PACKET_BROADCAST_KEY_SIZE 32
+
+/* The serialisation of a packet for the connections having the same
+ * packet variant, header format and delta state. */
+struct packet_broadcast_group {
+  const void *packet;
+  enum packet_type type;
+  int variant;
+  struct packet_header header;
+  int key_size;
+  unsigned char key[PACKET_BROADCAST_KEY_SIZE];
+  struct packet_buffer *pbuf;
+};
+
+/* State of a broadcast, e.g. an lsend_packet_*() call: the packets are
+ * serialised once per group of equivalent connections and the bytes are
+ * shared. The packets must not change until the broadcast ends. */
+struct packet_broadcast {
+  struct packet_broadcast *prev;
+  bool active;
+  int num_packets;
+  const void *packets[PACKET_BROADCAST_PACKETS];
+  int num_groups;
+  struct packet_broadcast_group groups[PACKET_BROADCAST_GROUPS];
+  struct packet_broadcast_group pending;
+  bool has_pending;
+};
+
+void packet_broadcast_begin(struct packet_broadcast *pbc,
+                            const struct conn_list *dest,
+                            const void *packet);
+void packet_broadcast_add(struct packet_broadcast *pbc, const void *packet);
+void packet_broadcast_end(struct packet_broadcast *pbc);
+struct packet_buffer *packet_broadcast_find(const struct connection *pc,
+                                            const void *packet,
+                                            enum packet_type type,
+                                            int variant, const void *key,
+                                            int key_size);
+int packet_broadcast_send(struct connection *pc, unsigned char *data,
+                          int len, enum packet_type packet_type);
+
 void *get_packet_from_connection_raw(struct connection *pc,
                                      enum packet_type *ptype);
 
@@ -146,6 +191,7 @@ void packets_deinit(void);
 #define SEND_PACKET_START(packet_type) \
   unsigned char buffer[MAX_LEN_PACKET]; \
   struct raw_data_out dout; \
+  struct packet_buffer *pbuf = NULL; \
   \
   dio_output_init(&dout, buffer, sizeof(buffer)); \
   dio_put_type_raw(&dout, pc->packet_header.length, 0); \
@@ -155,10 +201,13 @@ void packets_deinit(void);
   { \
     size_t size = dio_output_used(&dout); \
     \
+    if (NULL != pbuf) { \
+      return send_packet_data_shared(pc, pbuf, packet_type); \
+    } \
     dio_output_rewind(&dout); \
     dio_put_type_raw(&dout, pc->packet_header.length, size); \
     fc_assert(!dout.too_short); \
-    return send_packet_data(pc, buffer, size, packet_type); \
+    return packet_broadcast_send(pc, buffer, size, packet_type); \
   }
 
 #define RECEIVE_PACKET_START(packet_type, result) \
@@ -193,6 +242,9 @@ void packets_deinit(void);
 
 int send_packet_data(struct connection *pc, unsigned char *data, int len,
                      enum packet_type packet_type);
+int send_packet_data_shared(struct connection *pc,
+                            struct packet_buffer *pbuf,
+                            enum packet_type packet_type);
 bool packet_check(struct data_in *din, struct connection *pc);
 
 /* Utilities to exchange strings and string vectors. */
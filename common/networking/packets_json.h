@@ -29,6 +29,7 @@ void *get_packet_from_connection_json(struct connection *pc,
   struct plocation pid_addr; \
   char *json_buffer = NULL; \
   struct json_data_out dout; \
+  struct packet_buffer *pbuf = NULL; \
   dout.json = json_object(); \
   \
   dio_output_init(&(dout.raw), buffer, sizeof(buffer)); \
@@ -309,6 +309,7 @@ struct player {
                             * (Previously 'capital'.) */
 
       struct player_tile *private_map;
+      struct tile_hash *private_sites; /* Vision sites of private_map */
 
       /* Player can see inside his borders. */
       bool border_vision;
@@ -2736,6 +2736,28 @@ is_achievement_in_range(const struct player *target_player,
   }
 }
 
+/****************************************************************************
+  Turn the evaluation of the requirement source into whether the
+  requirement is active.
+****************************************************************************/
+static inline bool is_req_eval_active(enum fc_tristate eval,
+                                      const struct requirement *req,
+                                      const enum req_problem_type prob_type)
+{
+  if (eval == TRI_MAYBE) {
+    if (prob_type == RPT_POSSIBLE) {
+      return TRUE;
+    } else {
+      return FALSE;
+    }
+  }
+  if (req->present) {
+    return (eval == TRI_YES);
+  } else {
+    return (eval == TRI_NO);
+  }
+}
+
 /****************************************************************************
   Checks the requirement to see if it is active on the given target.
 
@@ -3071,18 +3093,7 @@ bool is_req_active(const struct player *target_player,
     return FALSE;
   }
 
-  if (eval == TRI_MAYBE) {
-    if (prob_type == RPT_POSSIBLE) {
-      return TRUE;
-    } else {
-      return FALSE;
-    }
-  }
-  if (req->present) {
-    return (eval == TRI_YES);
-  } else {
-    return (eval == TRI_NO);
-  }
+  return is_req_eval_active(eval, req, prob_type);
 }
 
 /****************************************************************************
@@ -3123,6 +3134,295 @@ bool are_reqs_active(const struct player *target_player,
   return TRUE;
 }
 
+/****************************************************************************
+  Requirement plans. A plan is a requirement vector compiled for fast
+  evaluation by req_plan_active():
+  - Requirements that are always fulfilled are dropped, and the plan of
+    a vector with a requirement that can never be fulfilled is constant.
+  - Duplicated requirements are only checked once.
+  - The requirements are checked from the cheapest to the most
+    expensive, so that the evaluation stops as early as possible. The
+    evaluation of a requirement has no side effect, so the result is the
+    same as the one of are_reqs_active().
+  - The most common requirements are evaluated by dedicated operations
+    instead of the generic is_req_active().
+  The requirements is_req_unchanging() reports are not folded into
+  constants: their value depends on the target (output type, specialist,
+  action, tile, nation, style or AI level of the player) or on the map
+  topology, which can be changed until the game starts. Most of them are
+  among the cheapest requirements, so they are checked first.
+  A plan keeps a copy of the requirements; it must be rebuilt when the
+  vector (or the obsolescence of a building it refers to) changes.
+****************************************************************************/
+enum req_plan_op {
+  RPO_GENERIC,          /* is_req_active() */
+  RPO_OTYPE,
+  RPO_SPECIALIST,
+  RPO_GOVERNMENT,
+  RPO_PLAYER_TECH,      /* Non-surviving tech at player range. */
+  RPO_CITY_BUILDING     /* Non-surviving, never obsolete building at
+                         * city range. */
+};
+
+struct req_plan_step {
+  enum req_plan_op op;
+  int cost;
+  struct requirement req;
+};
+
+struct req_plan {
+  bool never_active;
+  int num_steps;
+  struct req_plan_step *steps;
+};
+
+/****************************************************************************
+  Return a rough estimation of the cost of evaluating the requirement.
+  Local checks come first, then checks of the target itself, then checks
+  of the target surroundings and finally checks of other players.
+****************************************************************************/
+static int req_plan_cost(const struct requirement *req)
+{
+  int cost;
+
+  switch (req->source.kind) {
+  case VUT_OTYPE:
+  case VUT_SPECIALIST:
+  case VUT_ACTION:
+  case VUT_UTYPE:
+  case VUT_UTFLAG:
+  case VUT_UCLASS:
+  case VUT_UCFLAG:
+  case VUT_IMPR_GENUS:
+  case VUT_GOVERNMENT:
+  case VUT_STYLE:
+  case VUT_AI_LEVEL:
+  case VUT_MINYEAR:
+  case VUT_MINCALFRAG:
+  case VUT_TOPO:
+  case VUT_MINVETERAN:
+  case VUT_MINMOVES:
+  case VUT_MINHP:
+  case VUT_UNITSTATE:
+  case VUT_AGE:
+    return 0;
+  case VUT_IMPROVEMENT:
+    /* Obsolescence is checked first. */
+    cost = 1 + requirement_vector_size(&req->source.value.building
+                                       ->obsolete_by);
+    break;
+  default:
+    cost = 1;
+    break;
+  }
+
+  switch (req->range) {
+  case REQ_RANGE_LOCAL:
+    break;
+  case REQ_RANGE_CADJACENT:
+  case REQ_RANGE_ADJACENT:
+    cost += 2;
+    break;
+  case REQ_RANGE_CITY:
+    if (VUT_IMPROVEMENT != req->source.kind
+        && VUT_MINSIZE != req->source.kind
+        && VUT_NATIONALITY != req->source.kind
+        && VUT_MINCULTURE != req->source.kind) {
+      /* Walks the city map. */
+      cost += 4;
+    }
+    break;
+  case REQ_RANGE_PLAYER:
+    break;
+  case REQ_RANGE_TRADEROUTE:
+  case REQ_RANGE_CONTINENT:
+  case REQ_RANGE_TEAM:
+  case REQ_RANGE_ALLIANCE:
+  case REQ_RANGE_WORLD:
+    if (!req->survives) {
+      cost += 8;
+    }
+    break;
+  case REQ_RANGE_COUNT:
+    break;
+  }
+
+  return cost;
+}
+
+/****************************************************************************
+  Return the operation evaluating the requirement.
+****************************************************************************/
+static enum req_plan_op req_plan_op(const struct requirement *req)
+{
+  switch (req->source.kind) {
+  case VUT_OTYPE:
+    return RPO_OTYPE;
+  case VUT_SPECIALIST:
+    return RPO_SPECIALIST;
+  case VUT_GOVERNMENT:
+    return RPO_GOVERNMENT;
+  case VUT_ADVANCE:
+    if (REQ_RANGE_PLAYER == req->range && !req->survives) {
+      return RPO_PLAYER_TECH;
+    }
+    break;
+  case VUT_IMPROVEMENT:
+    if (REQ_RANGE_CITY == req->range && !req->survives
+        && 0 == requirement_vector_size(&req->source.value.building
+                                        ->obsolete_by)) {
+      return RPO_CITY_BUILDING;
+    }
+    break;
+  default:
+    break;
+  }
+
+  return RPO_GENERIC;
+}
+
+/****************************************************************************
+  Compile the requirement vector. The plan must be freed with
+  req_plan_destroy().
+****************************************************************************/
+struct req_plan *req_plan_new(const struct requirement_vector *reqs)
+{
+  struct req_plan *plan = fc_calloc(1, sizeof(*plan));
+  int i, j;
+
+  plan->steps = fc_malloc(MAX(1, requirement_vector_size(reqs))
+                          * sizeof(*plan->steps));
+
+  requirement_vector_iterate(reqs, preq) {
+    bool duplicate = FALSE;
+
+    if (VUT_NONE == preq->source.kind) {
+      if (!preq->present) {
+        plan->never_active = TRUE;
+      }
+      continue;
+    }
+
+    for (i = 0; i < plan->num_steps; i++) {
+      if (are_requirements_equal(&plan->steps[i].req, preq)) {
+        duplicate = TRUE;
+        break;
+      }
+    }
+    if (duplicate) {
+      continue;
+    }
+
+    /* Insertion sort, keeping the ruleset order of equally expensive
+     * requirements. */
+    j = req_plan_cost(preq);
+    for (i = plan->num_steps; 0 < i && plan->steps[i - 1].cost > j; i--) {
+      plan->steps[i] = plan->steps[i - 1];
+    }
+    plan->steps[i].op = req_plan_op(preq);
+    plan->steps[i].cost = j;
+    plan->steps[i].req = *preq;
+    plan->num_steps++;
+  } requirement_vector_iterate_end;
+
+  if (plan->never_active) {
+    plan->num_steps = 0;
+  }
+
+  return plan;
+}
+
+/****************************************************************************
+  Free the plan.
+****************************************************************************/
+void req_plan_destroy(struct req_plan *plan)
+{
+  free(plan->steps);
+  free(plan);
+}
+
+/****************************************************************************
+  Same as are_reqs_active() for the compiled requirement vector.
+****************************************************************************/
+bool req_plan_active(const struct player *target_player,
+                     const struct player *other_player,
+                     const struct city *target_city,
+                     const struct impr_type *target_building,
+                     const struct tile *target_tile,
+                     const struct unit *target_unit,
+                     const struct unit_type *target_unittype,
+                     const struct output_type *target_output,
+                     const struct specialist *target_specialist,
+                     const struct action *target_action,
+                     const struct req_plan *plan,
+                     const enum   req_problem_type prob_type)
+{
+  const struct req_plan_step *step = plan->steps;
+  const struct req_plan_step *end = plan->steps + plan->num_steps;
+  enum fc_tristate eval;
+
+  if (plan->never_active) {
+    return FALSE;
+  }
+
+  for (; step < end; step++) {
+    const struct requirement *req = &step->req;
+
+    switch (step->op) {
+    case RPO_OTYPE:
+      eval = BOOL_TO_TRISTATE(target_output
+                              && target_output->index
+                                 == req->source.value.outputtype);
+      break;
+    case RPO_SPECIALIST:
+      eval = BOOL_TO_TRISTATE(target_specialist
+                              && target_specialist
+                                 == req->source.value.specialist);
+      break;
+    case RPO_GOVERNMENT:
+      if (NULL == target_player) {
+        eval = TRI_MAYBE;
+      } else {
+        eval = BOOL_TO_TRISTATE(government_of_player(target_player)
+                                == req->source.value.govern);
+      }
+      break;
+    case RPO_PLAYER_TECH:
+      if (NULL == target_player) {
+        eval = TRI_MAYBE;
+      } else {
+        eval = BOOL_TO_TRISTATE(TECH_KNOWN == research_invention_state
+                                  (research_get(target_player),
+                                   advance_number(req->source.value.advance)));
+      }
+      break;
+    case RPO_CITY_BUILDING:
+      if (NULL == target_city) {
+        eval = TRI_MAYBE;
+      } else {
+        eval = BOOL_TO_TRISTATE(num_city_buildings(target_city,
+                                  req->source.value.building) > 0);
+      }
+      break;
+    case RPO_GENERIC:
+    default:
+      if (!is_req_active(target_player, other_player, target_city,
+                         target_building, target_tile, target_unit,
+                         target_unittype, target_output, target_specialist,
+                         target_action, req, prob_type)) {
+        return FALSE;
+      }
+      continue;
+    }
+
+    if (!is_req_eval_active(eval, req, prob_type)) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
 /****************************************************************************
   Return TRUE if this is an "unchanging" requirement.  This means that
   if a target can't meet the requirement now, it probably won't ever be able
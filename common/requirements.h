@@ -135,6 +135,24 @@ bool are_reqs_active(const struct player *target_player,
                      const struct requirement_vector *reqs,
                      const enum   req_problem_type prob_type);
 
+/* Requirement vectors compiled for faster evaluation. */
+struct req_plan;
+
+struct req_plan *req_plan_new(const struct requirement_vector *reqs);
+void req_plan_destroy(struct req_plan *plan);
+bool req_plan_active(const struct player *target_player,
+                     const struct player *other_player,
+                     const struct city *target_city,
+                     const struct impr_type *target_building,
+                     const struct tile *target_tile,
+                     const struct unit *target_unit,
+                     const struct unit_type *target_unittype,
+                     const struct output_type *target_output,
+                     const struct specialist *target_specialist,
+                     const struct action *target_action,
+                     const struct req_plan *plan,
+                     const enum   req_problem_type prob_type);
+
 bool is_req_unchanging(const struct requirement *req);
 
 bool is_req_in_vec(const struct requirement *req,
@@ -22,6 +22,7 @@
 #include "support.h"
 
 /* common */
+#include "effects.h"
 #include "fc_types.h"
 #include "game.h"
 #include "player.h"
@@ -575,6 +576,8 @@ void research_update(struct research *presearch)
   enum tech_flag_id flag;
   int techs_researched;
 
+  effect_cache_invalidate();
+
   advance_index_iterate(A_FIRST, i) {
     enum tech_state state = presearch->inventions[i].state;
     bool root_reqs_known = TRUE;
@@ -709,6 +712,7 @@ enum tech_state research_invention_set(struct research *presearch,
     return old;
   }
   presearch->inventions[tech].state = value;
+  effect_cache_invalidate();
 
   if (value == TECH_KNOWN) {
     if (!game.info.global_advances[tech]) {
@@ -72,6 +72,7 @@ void tile_set_owner(struct tile *ptile, struct player *pplayer,
   if (BORDERS_DISABLED != game.info.borders) {
     ptile->owner = pplayer;
     ptile->claimer = claimer;
+    map_packed_update_tile(ptile);
   }
 }
 
@@ -151,6 +152,7 @@ void tile_set_terrain(struct tile *ptile, struct terrain *pterrain)
       BV_CLR(ptile->extras, extra_index(ptile->resource));
     }
   }
+  map_packed_update_tile(ptile);
 }
 
 /****************************************************************************
@@ -409,6 +411,7 @@ Continent_id tile_continent(const struct tile *ptile)
 void tile_set_continent(struct tile *ptile, Continent_id val)
 {
   ptile->continent = val;
+  map_packed_update_tile(ptile);
 }
 
 /****************************************************************************
@@ -963,6 +966,7 @@ void tile_add_extra(struct tile *ptile, const struct extra_type *pextra)
 {
   if (pextra != NULL) {
     BV_SET(ptile->extras, extra_index(pextra));
+    map_packed_update_tile(ptile);
   }
 }
 
@@ -973,6 +977,7 @@ void tile_remove_extra(struct tile *ptile, const struct extra_type *pextra)
 {
   if (pextra != NULL) {
     BV_CLR(ptile->extras, extra_index(pextra));
+    map_packed_update_tile(ptile);
   }
 }
 
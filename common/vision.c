@@ -39,6 +39,8 @@ struct vision *vision_new(struct player *pplayer, struct tile *ptile)
   vision->can_reveal_tiles = TRUE;
   vision->radius_sq[V_MAIN] = -1;
   vision->radius_sq[V_INVIS] = -1;
+  vision->replaces = NULL;
+  vision->replaced_by = NULL;
 
   return vision;
 }
@@ -50,6 +52,8 @@ void vision_free(struct vision *vision)
 {
   fc_assert(-1 == vision->radius_sq[V_MAIN]);
   fc_assert(-1 == vision->radius_sq[V_INVIS]);
+  fc_assert(NULL == vision->replaces);
+  fc_assert(NULL == vision->replaced_by);
   free(vision);
 }
 
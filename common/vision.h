@@ -68,6 +68,12 @@ extern "C" {
   note that for all the code in the middle both the new and the old
   vision sources are active.  The same process applies when transferring
   a unit or city between players, etc.
+
+  When the new vision source has the same owner as the old one, as for a
+  moving unit, vision_replace_sight can be called instead of
+  vision_change_sight to fill out the new sight.  It leaves the tiles both
+  sources see alone, so only the tiles entering and leaving the sight are
+  updated then and when the old source is cleared.
 ****************************************************************************/
 
 /* Invariants: V_MAIN vision ranges must always be more than V_INVIS
@@ -94,6 +100,10 @@ struct vision {
 
   /* The radius of the vision source. */
   v_radius_t radius_sq;
+
+  /* Set by vision_replace_sight() until either vision changes. */
+  struct vision *replaces;
+  struct vision *replaced_by;
 };
 
 /* Initialize a vision radius array. */
@@ -17,6 +17,7 @@
 
 /* common */
 #include "actions.h"
+#include "effects.h"
 
 /* server */
 #include "aiiface.h"
@@ -60,6 +61,7 @@ static void action_give_casus_belli(struct player *offender,
     player_diplstate_get(victim_player, offender)->has_reason_to_cancel =
         2;
   }
+  effect_cache_invalidate();
 }
 
 /**************************************************************************
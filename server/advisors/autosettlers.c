@@ -429,7 +429,7 @@ int settler_evaluate_improvements(struct unit *punit,
   pft_fill_unit_parameter(&parameter, punit);
   parameter.omniscience = !has_handicap(pplayer, H_MAP);
   parameter.get_TB = autosettler_tile_behavior;
-  pfm = pf_map_new(&parameter);
+  pfm = pf_map_pool_get(&parameter);
 
   city_list_iterate(pplayer->cities, pcity) {
     struct tile *pcenter = city_tile(pcity);
@@ -758,7 +758,7 @@ struct city *settler_evaluate_city_requests(struct unit *punit,
   pft_fill_unit_parameter(&parameter, punit);
   parameter.omniscience = !has_handicap(pplayer, H_MAP);
   parameter.get_TB = autosettler_tile_behavior;
-  pfm = pf_map_new(&parameter);
+  pfm = pf_map_pool_get(&parameter);
 
   /* Have nearby cities requests? */
   city_list_iterate(pplayer->cities, pcity) {
@@ -989,7 +989,7 @@ bool auto_settler_setup_work(struct player *pplayer, struct unit *punit,
       pft_fill_unit_parameter(&parameter, punit);
       parameter.omniscience = !has_handicap(pplayer, H_MAP);
       parameter.get_TB = autosettler_tile_behavior;
-      pfm = pf_map_new(&parameter);
+      pfm = pf_map_pool_get(&parameter);
       path = pf_map_path(pfm, best_tile);
     }
 
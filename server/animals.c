@@ -16,6 +16,7 @@
 
 /* common */
 #include "ai.h"
+#include "effects.h"
 #include "game.h"
 #include "map.h"
 #include "movement.h"
@@ -140,6 +141,7 @@ void create_animals(void)
       player_diplstate_get(plr, pplayer)->type = DS_WAR;
     }
   } players_iterate_end;
+  effect_cache_invalidate();
 
   CALL_PLR_AI_FUNC(gained_control, plr, plr);
 
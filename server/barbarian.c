@@ -105,6 +105,7 @@ struct player *create_barbarian_player(enum barbarian_type type)
       if (!old_barbs->is_alive) {
         old_barbs->economic.gold = 0;
         old_barbs->is_alive = TRUE;
+        effect_cache_invalidate();
         player_status_reset(old_barbs);
 
         /* Free old name so pick_random_player_name() can select it again.
@@ -185,6 +186,7 @@ struct player *create_barbarian_player(enum barbarian_type type)
       player_diplstate_get(barbarians, pplayer)->type = DS_WAR;
     }
   } players_iterate_end;
+  effect_cache_invalidate();
 
   CALL_PLR_AI_FUNC(gained_control, barbarians, barbarians);
 
@@ -34,6 +34,7 @@
 #include "citizens.h"
 #include "city.h"
 #include "culture.h"
+#include "effects.h"
 #include "events.h"
 #include "game.h"
 #include "government.h"
@@ -52,6 +53,9 @@
 #include "unitlist.h"
 #include "vision.h"
 
+/* common/aicore */
+#include "path_finding.h"
+
 /* common/scriptcore */
 #include "luascript_types.h"
 
@@ -1161,10 +1165,13 @@ bool transfer_city(struct player *ptaker, struct city *pcity,
 
   /* Has to follow the unfog call above. */
   city_list_remove(pgiver->cities, pcity);
+  /* The border is claimed again below, send the tiles only then. */
+  map_borders_freeze();
   map_clear_border(pcenter);
   /* city_thaw_workers_queue() later */
 
   pcity->owner = ptaker;
+  effect_cache_invalidate();
   map_claim_ownership(pcenter, ptaker, pcenter, TRUE);
   city_list_prepend(ptaker->cities, pcity);
 
@@ -1294,6 +1301,7 @@ bool transfer_city(struct player *ptaker, struct city *pcity,
     city_refresh_queue_add(pcity);
     /* no sanity check here as the city is not refreshed! */
   }
+  map_borders_thaw();
 
   if (city_remains) {
     /* Send city with updated owner information to giver and to everyone
@@ -1780,6 +1788,7 @@ void remove_city(struct city *pcity)
   fc_allocate_mutex(&game.server.mutexes.city_list);
   game_remove_city(pcity);
   fc_release_mutex(&game.server.mutexes.city_list);
+  pf_map_pool_tile_changed(pcenter);
 
   /* Remove any extras that were only there because the city was there. */
   extra_type_iterate(pextra) {
@@ -2544,7 +2553,7 @@ bool update_dumb_city(struct player *pplayer, struct city *pcity)
 
   if (NULL == pdcity) {
     pdcity = vision_site_new_from_city(pcity);
-    change_playertile_site(map_get_player_tile(pcenter, pplayer), pdcity);
+    change_playertile_site(pcenter, pplayer, pdcity);
   } else if (pdcity->location != pcenter) {
     log_error("Trying to update bad city (wrong location) "
               "at %i,%i for player %s",
@@ -2591,12 +2600,8 @@ void reality_check_city(struct player *pplayer, struct tile *ptile)
     struct city *pcity = tile_city(ptile);
 
     if (!pcity || pcity->id != pdcity->identity) {
-      struct player_tile *playtile = map_get_player_tile(ptile, pplayer);
-
       dlsend_packet_city_remove(pplayer->connections, pdcity->identity);
-      fc_assert_ret(playtile->site == pdcity);
-      playtile->site = NULL;
-      vision_site_destroy(pdcity);
+      change_playertile_site(ptile, pplayer, NULL);
     }
   }
 }
@@ -2609,12 +2614,8 @@ void remove_dumb_city(struct player *pplayer, struct tile *ptile)
   struct vision_site *pdcity = map_get_player_city(ptile, pplayer);
 
   if (pdcity) {
-    struct player_tile *playtile = map_get_player_tile(ptile, pplayer);
-
     dlsend_packet_city_remove(pplayer->connections, pdcity->identity);
-    fc_assert_ret(playtile->site == pdcity);
-    playtile->site = NULL;
-    vision_site_destroy(pdcity);
+    change_playertile_site(ptile, pplayer, NULL);
   }
 }
 
@@ -2704,8 +2705,7 @@ struct trade_route *remove_trade_route(struct city *pc1, struct trade_route *pro
   if (announce) {
     announce_trade_route_removal(pc1, pc2, source_gone);
 
-    city_refresh(pc2);
-    send_city_info(city_owner(pc2), pc2);
+    city_refresh_schedule(pc2);
   }
 
   return back_route;
@@ -82,6 +82,12 @@
 /* Queue for pending city_refresh() */
 static struct city_list *city_refresh_queue = NULL;
 
+/* If > 0, city_refresh_schedule() queues the refreshes until the queue is
+ * thawed. */
+static int city_refresh_queue_frozen = 0;
+
+static struct city_refresh_stats city_refresh_stats;
+
 /* The game is currently considering to remove the listed units because of
  * missing gold upkeep. A unit ends up here if it has gold upkeep that
  * can't be payed. A random unit in the list will be removed until the
@@ -190,12 +196,19 @@ void city_refresh_for_player(struct player *pplayer)
 ****************************************************************************/
 void city_refresh_queue_add(struct city *pcity)
 {
+  city_refresh_stats.requested++;
+
+  if (pcity->server.needs_refresh) {
+    /* Already pending. */
+    return;
+  }
+
   if (NULL == city_refresh_queue) {
     city_refresh_queue = city_list_new();
-  } else if (city_list_find_number(city_refresh_queue, pcity->id)) {
-    return;
   }
 
+  /* A city refreshed directly since it was queued has needs_refresh
+   * cleared and may be listed again; only the first entry is processed. */
   city_list_prepend(city_refresh_queue, pcity);
   pcity->server.needs_refresh = TRUE;
 }
@@ -206,21 +219,81 @@ void city_refresh_queue_add(struct city *pcity)
 *************************************************************************/
 void city_refresh_queue_processing(void)
 {
-  if (NULL == city_refresh_queue) {
+  while (NULL != city_refresh_queue) {
+    /* Refreshing may queue more cities. */
+    struct city_list *queue = city_refresh_queue;
+
+    city_refresh_queue = NULL;
+    city_list_iterate(queue, pcity) {
+      if (pcity->server.needs_refresh) {
+        city_refresh_stats.performed++;
+        if (city_refresh(pcity)) {
+          auto_arrange_workers(pcity);
+        }
+        send_city_info(city_owner(pcity), pcity);
+      }
+    } city_list_iterate_end;
+
+    city_list_destroy(queue);
+  }
+}
+
+/*************************************************************************
+  Refresh the city and send it to its owner. While the queue is frozen,
+  this is delayed until it is thawed, so a city is refreshed only once
+  however many times it is scheduled meanwhile.
+*************************************************************************/
+void city_refresh_schedule(struct city *pcity)
+{
+  if (0 < city_refresh_queue_frozen) {
+    city_refresh_queue_add(pcity);
     return;
   }
 
-  city_list_iterate(city_refresh_queue, pcity) {
-    if (pcity->server.needs_refresh) {
-      if (city_refresh(pcity)) {
-        auto_arrange_workers(pcity);
-      }
-      send_city_info(city_owner(pcity), pcity);
-    }
-  } city_list_iterate_end;
+  city_refresh_stats.requested++;
+  city_refresh_stats.performed++;
+  if (city_refresh(pcity)) {
+    auto_arrange_workers(pcity);
+  }
+  send_city_info(city_owner(pcity), pcity);
+}
+
+/*************************************************************************
+  Start queueing the refreshes scheduled with city_refresh_schedule().
+  Calls can be nested.
+*************************************************************************/
+void city_refresh_queue_freeze(void)
+{
+  city_refresh_queue_frozen++;
+}
+
+/*************************************************************************
+  Stop queueing the scheduled refreshes. When the outermost freeze ends,
+  the queued cities are refreshed.
+*************************************************************************/
+void city_refresh_queue_thaw(void)
+{
+  fc_assert_ret(0 < city_refresh_queue_frozen);
 
-  city_list_destroy(city_refresh_queue);
-  city_refresh_queue = NULL;
+  if (0 == --city_refresh_queue_frozen) {
+    city_refresh_queue_processing();
+  }
+}
+
+/*************************************************************************
+  Fill in the statistics of the refresh scheduler.
+*************************************************************************/
+void city_refresh_stats_get(struct city_refresh_stats *stats)
+{
+  *stats = city_refresh_stats;
+}
+
+/*************************************************************************
+  Reset the statistics of the refresh scheduler.
+*************************************************************************/
+void city_refresh_stats_reset(void)
+{
+  memset(&city_refresh_stats, 0, sizeof(city_refresh_stats));
 }
 
 /**************************************************************************
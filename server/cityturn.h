@@ -27,6 +27,19 @@ void city_refresh_for_player(struct player *pplayer); /* tax/govt changed */
 void city_refresh_queue_add(struct city *pcity);
 void city_refresh_queue_processing(void);
 
+void city_refresh_schedule(struct city *pcity);
+void city_refresh_queue_freeze(void);
+void city_refresh_queue_thaw(void);
+
+/* Refreshes asked through the queue, and the ones actually done. */
+struct city_refresh_stats {
+  unsigned long requested;
+  unsigned long performed;
+};
+
+void city_refresh_stats_get(struct city_refresh_stats *stats);
+void city_refresh_stats_reset(void);
+
 void auto_arrange_workers(struct city *pcity); /* will arrange the workers */
 void apply_cmresult_to_city(struct city *pcity, const struct cm_result *cmr);
 
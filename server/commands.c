@@ -204,6 +204,11 @@ static struct command commands[] = {
       "debug units <x> <y>\n"
       "debug unit <id>\n"
       "debug timing\n"
+      "debug pathfinding [queries-per-unit]\n"
+      "debug effects [reset]\n"
+      "debug cityrefresh [reset]\n"
+      "debug sniff [reset]\n"
+      "debug requirements [rounds]\n"
       "debug info"),
    N_("Turn on or off AI debugging of given entity."),
    N_("Print AI debug information about given entity and turn continuous "
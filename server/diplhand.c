@@ -27,6 +27,7 @@
 /* common */
 #include "ai.h"
 #include "diptreaty.h"
+#include "effects.h"
 #include "events.h"
 #include "game.h"
 #include "map.h"
@@ -35,6 +36,9 @@
 #include "research.h"
 #include "unit.h"
 
+/* common/aicore */
+#include "path_finding.h"
+
 /* common/scriptcore */
 #include "luascript_types.h"
 
@@ -547,6 +551,7 @@ void handle_diplomacy_accept_treaty_req(struct player *pplayer,
         ds_giverdest->turns_left = TURNS_LEFT;
         ds_destgiver->type = DS_CEASEFIRE;
         ds_destgiver->turns_left = TURNS_LEFT;
+        effect_cache_invalidate();
         notify_player(pgiver, NULL, E_TREATY_CEASEFIRE, ftc_server,
                       _("You agree on a cease-fire with %s."),
                       player_name(pdest));
@@ -570,6 +575,7 @@ void handle_diplomacy_accept_treaty_req(struct player *pplayer,
         }
         ds_giverdest->type = DS_ARMISTICE;
         ds_destgiver->type = DS_ARMISTICE;
+        effect_cache_invalidate();
         ds_giverdest->turns_left = TURNS_LEFT;
         ds_destgiver->turns_left = TURNS_LEFT;
         ds_giverdest->max_state = dst_closest(DS_PEACE,
@@ -613,6 +619,7 @@ void handle_diplomacy_accept_treaty_req(struct player *pplayer,
       case CLAUSE_ALLIANCE:
         ds_giverdest->type = DS_ALLIANCE;
         ds_destgiver->type = DS_ALLIANCE;
+        effect_cache_invalidate();
         ds_giverdest->max_state = dst_closest(DS_ALLIANCE,
                                               ds_giverdest->max_state);
         ds_destgiver->max_state = dst_closest(DS_ALLIANCE,
@@ -645,6 +652,9 @@ void handle_diplomacy_accept_treaty_req(struct player *pplayer,
 
     } clause_list_iterate_end;
 
+    /* The diplomatic states may have changed. */
+    pf_map_pool_flush();
+
     /* In theory, we would need refresh only receiving party of
      * CLAUSE_MAP, CLAUSE_SEAMAP and CLAUSE_VISION clauses.
      * It's quite unlikely that there is such a clause going one
@@ -672,6 +682,7 @@ void establish_embassy(struct player *pplayer, struct player *aplayer)
 {
   /* Establish the embassy. */
   BV_SET(pplayer->real_embassy, player_index(aplayer));
+  effect_cache_invalidate();
   send_player_all_c(pplayer, pplayer->connections);
   /* update player dialog with embassy */
   send_player_all_c(pplayer, aplayer->connections);
@@ -25,6 +25,7 @@
 #include "support.h"
 
 /* common */
+#include "effects.h"
 #include "events.h"
 #include "game.h"
 #include "government.h"
@@ -458,6 +459,7 @@ void handle_edit_unit_create(struct connection *pc, int owner, int tile,
 
   if (count > 0 && !pplayer->is_alive) {
     pplayer->is_alive = TRUE;
+    effect_cache_invalidate();
     send_player_info_c(pplayer, NULL);
   }
 
@@ -662,6 +664,7 @@ void handle_edit_city_create(struct connection *pc, int owner, int tile,
 
   if (!pplayer->is_alive) {
     pplayer->is_alive = TRUE;
+    effect_cache_invalidate();
     send_player_info_c(pplayer, NULL);
   }
 
@@ -55,6 +55,19 @@ static float hmap_pole_factor(struct tile *ptile)
   return factor;
 }
 
+/****************************************************************************
+  Lower the height of one tile, see normalize_hmap_poles().
+****************************************************************************/
+static void normalize_hmap_pole_tile(struct tile *ptile, void *data)
+{
+  if (map_colatitude(ptile) <= 2.5 * ICE_BASE_LEVEL) {
+    hmap(ptile) *= hmap_pole_factor(ptile);
+  } else if (near_singularity(ptile)) {
+    /* Near map edge but not near pole. */
+    hmap(ptile) = 0;
+  }
+}
+
 /****************************************************************************
   Lower the land near the map edges and (optionally) the polar region to
   avoid too much land there.
@@ -63,14 +76,7 @@ static float hmap_pole_factor(struct tile *ptile)
 ****************************************************************************/
 void normalize_hmap_poles(void)
 {
-  whole_map_iterate(ptile) {
-    if (map_colatitude(ptile) <= 2.5 * ICE_BASE_LEVEL) {
-      hmap(ptile) *= hmap_pole_factor(ptile);
-    } else if (near_singularity(ptile)) {
-      /* Near map edge but not near pole. */
-      hmap(ptile) = 0;
-    }
-  } whole_map_iterate_end;
+  whole_map_run(normalize_hmap_pole_tile, NULL);
 }
 
 /****************************************************************************
@@ -28,6 +28,7 @@
 #include "mem.h"
 #include "rand.h"
 #include "shared.h"
+#include "timing.h"
 
 /* common */
 #include "game.h"
@@ -52,6 +53,25 @@ static void mapgenerator4(void);
 static bool map_generate_fair_islands(void);
 static void adjust_terrain_param(void);
 
+/*
+ * Run a stage of the map generation and log how long it took, so one can
+ * see where the generation time goes (use '-d 3').
+ */
+#ifdef LOG_TIMERS
+#define MAPGEN_TIMED(_what, _step)                                          \
+{                                                                           \
+  struct timer *_timer = timer_new(TIMER_USER, TIMER_ACTIVE);               \
+                                                                            \
+  timer_start(_timer);                                                      \
+  _step;                                                                    \
+  log_verbose("Map generation, %s: %.3f seconds.", _what,                   \
+              timer_read_seconds(_timer));                                  \
+  timer_destroy(_timer);                                                    \
+}
+#else  /* LOG_TIMERS */
+#define MAPGEN_TIMED(_what, _step) _step
+#endif /* LOG_TIMERS */
+
 /* common variables for generator 2, 3 and 4 */
 struct gen234_state {
   int isleindex, n, e, s, w;
@@ -110,10 +130,14 @@ static bool make_island(int islemass, int starters,
 #define RIVERS_MAXTRIES 32767
 /* This struct includes two dynamic bitvectors. They are needed to mark
    tiles as blocked to prevent a river from falling into itself, and for
-   storing rivers temporarly. */
+   storing rivers temporarly. The tiles marked in 'ok' are also listed in
+   'path', so that a river can be applied or dropped without scanning the
+   whole map. */
 struct river_map {
   struct dbv blocked;
   struct dbv ok;
+  int *path;
+  int path_len, path_size;
 };
 
 static int river_test_blocked(struct river_map *privermap,
@@ -145,6 +169,7 @@ static int river_test_height_map(struct river_map *privermap,
                                  struct extra_type *priver);
 static void river_blockmark(struct river_map *privermap,
                             struct tile *ptile);
+static void river_mark_ok(struct river_map *privermap, struct tile *ptile);
 static bool make_river(struct river_map *privermap,
                        struct tile *ptile,
                        struct extra_type *priver);
@@ -671,6 +696,20 @@ static void river_blockmark(struct river_map *privermap,
   } cardinal_adjc_iterate_end;
 }
 
+/*********************************************************************
+  Called from make_river. Marks the tile as part of the river.
+*********************************************************************/
+static void river_mark_ok(struct river_map *privermap, struct tile *ptile)
+{
+  if (privermap->path_len == privermap->path_size) {
+    privermap->path_size = MAX(64, 2 * privermap->path_size);
+    privermap->path = fc_realloc(privermap->path, privermap->path_size
+                                 * sizeof(*privermap->path));
+  }
+  privermap->path[privermap->path_len++] = tile_index(ptile);
+  dbv_set(&privermap->ok, tile_index(ptile));
+}
+
 struct test_func {
   int (*func)(struct river_map *privermap, struct tile *ptile, struct extra_type *priver);
   bool fatal;
@@ -793,7 +832,7 @@ static bool make_river(struct river_map *privermap, struct tile *ptile,
 
   while (TRUE) {
     /* Mark the current tile as river. */
-    dbv_set(&privermap->ok, tile_index(ptile));
+    river_mark_ok(privermap, ptile);
     log_debug("The tile at (%d, %d) has been marked as river in river_map.",
               TILE_XY(ptile));
 
@@ -888,6 +927,14 @@ static bool make_river(struct river_map *privermap, struct tile *ptile,
   } /* end while; (Make a river.) */
 }
 
+/**************************************************************************
+  Compare two tile indexes, for qsort().
+**************************************************************************/
+static int compare_tile_indexes(const void *a, const void *b)
+{
+  return *(const int *) a - *(const int *) b;
+}
+
 /**************************************************************************
   Calls make_river until there are enough river tiles on the map. It stops
   when it has tried to create RIVERS_MAXTRIES rivers.           -Erik Sigra
@@ -898,6 +945,11 @@ static void make_rivers(void)
   struct terrain *pterrain;
   struct river_map rivermap;
   struct extra_type *road_river = NULL;
+  /* For each river type, the tiles with another road or river type,
+   * which its rivers must not enter. Kept up to date as the rivers are
+   * applied, instead of scanning the map for every river. */
+  struct dbv other_roads[MAX_ROAD_TYPES];
+  int river_type, i, j;
 
   /* Formula to make the river density similar om different sized maps. Avoids
      too few rivers on large maps and too many rivers on small maps. */
@@ -930,6 +982,24 @@ static void make_rivers(void)
 
   dbv_init(&rivermap.blocked, MAP_INDEX_SIZE);
   dbv_init(&rivermap.ok, MAP_INDEX_SIZE);
+  rivermap.path = NULL;
+  rivermap.path_len = 0;
+  rivermap.path_size = 0;
+
+  for (i = 0; i < river_type_count; i++) {
+    dbv_init(&other_roads[i], MAP_INDEX_SIZE);
+  }
+  whole_map_iterate(rtile) {
+    extra_type_by_cause_iterate(EC_ROAD, oriver) {
+      if (tile_has_extra(rtile, oriver)) {
+        for (i = 0; i < river_type_count; i++) {
+          if (oriver != river_types[i]) {
+            dbv_set(&other_roads[i], tile_index(rtile));
+          }
+        }
+      }
+    } extra_type_by_cause_iterate_end;
+  } whole_map_iterate_end;
 
   /* The main loop in this function. */
   while (current_riverlength < desirable_riverlength
@@ -977,29 +1047,24 @@ static void make_rivers(void)
 	&& (pterrain->property[MG_DRY] == 0
 	    || iteration_counter >= RIVERS_MAXTRIES / 10 * 9)) {
 
-      /* Reset river map before making a new river. */
-      dbv_clr_all(&rivermap.blocked);
-      dbv_clr_all(&rivermap.ok);
+      river_type = fc_rand(river_type_count);
+      road_river = river_types[river_type];
 
-      road_river = river_types[fc_rand(river_type_count)];
-
-      extra_type_by_cause_iterate(EC_ROAD, oriver) {
-        if (oriver != road_river) {
-          whole_map_iterate(rtile) {
-            if (tile_has_extra(rtile, oriver)) {
-              dbv_set(&rivermap.blocked, tile_index(rtile));
-            }
-          } whole_map_iterate_end;
-        }
-      } extra_type_by_cause_iterate_end;
+      /* Reset river map before making a new river. 'ok' was cleared
+       * when the previous river was applied or dropped. */
+      dbv_copy(&rivermap.blocked, &other_roads[river_type]);
 
       log_debug("Found a suitable starting tile for a river at (%d, %d)."
                 " Starting to make it.", TILE_XY(ptile));
 
-      /* Try to make a river. If it is OK, apply it to the map. */
+      /* Try to make a river. If it is OK, apply it to the map, in map
+       * order as pick_terrain_by_flag() draws random numbers. */
       if (make_river(&rivermap, ptile, road_river)) {
-        whole_map_iterate(ptile1) {
-          if (dbv_isset(&rivermap.ok, tile_index(ptile1))) {
+        qsort(rivermap.path, rivermap.path_len, sizeof(*rivermap.path),
+              compare_tile_indexes);
+        for (i = 0; i < rivermap.path_len; i++) {
+          if (dbv_isset(&rivermap.ok, rivermap.path[i])) {
+            struct tile *ptile1 = index_to_tile(rivermap.path[i]);
             struct terrain *river_terrain = tile_terrain(ptile1);
 
             if (!terrain_has_flag(river_terrain, TER_CAN_HAVE_RIVER)) {
@@ -1011,15 +1076,25 @@ static void make_rivers(void)
             }
 
             tile_add_extra(ptile1, road_river);
+            for (j = 0; j < river_type_count; j++) {
+              if (j != river_type) {
+                dbv_set(&other_roads[j], rivermap.path[i]);
+              }
+            }
             current_riverlength++;
             map_set_placed(ptile1);
             log_debug("Applied a river to (%d, %d).", TILE_XY(ptile1));
           }
-        } whole_map_iterate_end;
+          dbv_clr(&rivermap.ok, rivermap.path[i]);
+        }
       } else {
         log_debug("mapgen.c: A river failed. It might have gotten stuck "
                   "in a helix.");
+        for (i = 0; i < rivermap.path_len; i++) {
+          dbv_clr(&rivermap.ok, rivermap.path[i]);
+        }
       }
+      rivermap.path_len = 0;
     } /* end if; */
     iteration_counter++;
     log_debug("current_riverlength: %d; desirable_riverlength: %d; "
@@ -1029,6 +1104,10 @@ static void make_rivers(void)
 
   dbv_free(&rivermap.blocked);
   dbv_free(&rivermap.ok);
+  free(rivermap.path);
+  for (i = 0; i < river_type_count; i++) {
+    dbv_free(&other_roads[i]);
+  }
 
   destroy_placed_map();
 }
@@ -1119,7 +1198,7 @@ static void make_land(void)
   /* destroy old dummy temperature map ... */
   destroy_tmap();
   /* ... and create a real temperature map (needs hmap and oceans) */
-  create_tmap(TRUE);
+  MAPGEN_TIMED("real temperature map", create_tmap(TRUE));
 
   if (HAS_POLES) { /* this is a hack to terrains set with not frizzed oceans*/
     make_polar_land(); /* make extra land at poles*/
@@ -1128,14 +1207,16 @@ static void make_land(void)
   create_placed_map(); /* here it means land terrains to be placed */
   set_all_ocean_tiles_placed();
   if (MAPGEN_FRACTURE == wld.map.server.generator) {
-    make_fracture_relief();
+    MAPGEN_TIMED("relief", make_fracture_relief());
   } else {
-    make_relief(); /* base relief on map */
+    MAPGEN_TIMED("relief", make_relief()); /* base relief on map */
   }
-  make_terrains(); /* place all exept mountains and hill */
+  /* place all exept mountains and hill */
+  MAPGEN_TIMED("terrains", make_terrains());
   destroy_placed_map();
 
-  make_rivers(); /* use a new placed_map. destroy older before call */
+  /* use a new placed_map. destroy older before call */
+  MAPGEN_TIMED("rivers", make_rivers());
 }
 
 /**************************************************************************
@@ -1200,15 +1281,16 @@ static void print_mapgen_map(void)
     terrain_counts[terrain_index(pterrain)] = 0;
   } terrain_type_iterate_end;
 
-  whole_map_iterate(ptile) {
-    struct terrain *pterrain = tile_terrain(ptile);
+  whole_map_index_iterate(tindex) {
+    terrain_counts[map_packed_terrain(tindex)]++;
+    total++;
+  } whole_map_index_iterate_end;
 
-    terrain_counts[terrain_index(pterrain)]++;
+  terrain_type_iterate(pterrain) {
     if (is_ocean(pterrain)) {
-      ocean++;
+      ocean += terrain_counts[terrain_index(pterrain)];
     }
-    total++;
-  } whole_map_iterate_end;
+  } terrain_type_iterate_end;
 
   log_verbose("map settings:");
   log_verbose("  %-20s :      %5d%%", "mountain_pct", mountain_pct);
@@ -1296,7 +1378,7 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
     /* with a lower number to try again */
 
     /* create a temperature map */
-    create_tmap(FALSE);
+    MAPGEN_TIMED("temperature map", create_tmap(FALSE));
 
     if (MAPGEN_FAIR == wld.map.server.generator
         && !map_generate_fair_islands()) {
@@ -1327,20 +1409,22 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
     }
 
     if (MAPGEN_FRACTAL == wld.map.server.generator) {
-      make_pseudofractal1_hmap(1 +
-                               ((MAPSTARTPOS_DEFAULT == wld.map.server.startpos
-                                 || MAPSTARTPOS_ALL == wld.map.server.startpos)
-                                ? 0 : player_count()));
+      MAPGEN_TIMED("height map",
+        make_pseudofractal1_hmap(1 +
+                                 ((MAPSTARTPOS_DEFAULT == wld.map.server.startpos
+                                   || MAPSTARTPOS_ALL == wld.map.server.startpos)
+                                  ? 0 : player_count())));
     }
 
     if (MAPGEN_RANDOM == wld.map.server.generator) {
-      make_random_hmap(MAX(1, 1 + get_sqsize()
-                           - (MAPSTARTPOS_DEFAULT != wld.map.server.startpos
-                              ? player_count() / 4 : 0)));
+      MAPGEN_TIMED("height map",
+        make_random_hmap(MAX(1, 1 + get_sqsize()
+                             - (MAPSTARTPOS_DEFAULT != wld.map.server.startpos
+                                ? player_count() / 4 : 0))));
     }
 
     if (MAPGEN_FRACTURE == wld.map.server.generator) {
-      make_fracture_map();
+      MAPGEN_TIMED("height map", make_fracture_map());
     }
 
     /* if hmap only generator make anything else */
@@ -1348,37 +1432,38 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
         || MAPGEN_FRACTAL == wld.map.server.generator
         || MAPGEN_FRACTURE == wld.map.server.generator) {
 
-      make_land();
+      MAPGEN_TIMED("land", make_land());
       free(height_map);
       height_map = NULL;
     }
     if (!wld.map.server.tinyisles) {
-      remove_tiny_islands();
+      MAPGEN_TIMED("tiny islands", remove_tiny_islands());
     }
 
-    smooth_water_depth();
+    MAPGEN_TIMED("water depth", smooth_water_depth());
 
     /* Continent numbers must be assigned before regenerate_lakes() */
-    assign_continent_numbers();
+    MAPGEN_TIMED("continents", assign_continent_numbers());
 
     /* Turn small oceans into lakes. */
-    regenerate_lakes();
+    MAPGEN_TIMED("lakes", regenerate_lakes());
   } else {
     assign_continent_numbers();
   }
 
   /* create a temperature map if it was not done before */
   if (!temperature_is_initialized()) {
-    create_tmap(FALSE);
+    MAPGEN_TIMED("temperature map", create_tmap(FALSE));
   }
 
   /* some scenarios already provide specials */
   if (!wld.map.server.have_resources) {
-    add_resources(wld.map.server.riches);
+    MAPGEN_TIMED("resources", add_resources(wld.map.server.riches));
   }
 
   if (!wld.map.server.have_huts) {
-    make_huts(wld.map.server.huts * map_num_tiles() / 1000); 
+    MAPGEN_TIMED("huts",
+                 make_huts(wld.map.server.huts * map_num_tiles() / 1000));
   }
 
   /* restore previous random state: */
@@ -1429,7 +1514,8 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
     for (;;) {
       bool success;
 
-      success = create_start_positions(mode, initial_unit);
+      MAPGEN_TIMED("start positions",
+                   success = create_start_positions(mode, initial_unit));
       if (success) {
         wld.map.server.startpos = mode;
         break;
@@ -2193,6 +2279,7 @@ static void initworld(struct gen234_state *pstate)
     BV_CLR_ALL(ptile->extras);
     tile_set_owner(ptile, NULL, NULL);
     ptile->extras_owner = NULL;
+    map_packed_update_tile(ptile);
   } whole_map_iterate_end;
 
   if (HAS_POLES) {
@@ -3442,6 +3529,7 @@ static bool map_generate_fair_islands(void)
     BV_CLR_ALL(ptile->extras);
     tile_set_owner(ptile, NULL, NULL);
     ptile->extras_owner = NULL;
+    map_packed_update_tile(ptile);
   } whole_map_iterate_end;
 
   i = 0;
@@ -3692,6 +3780,7 @@ static bool map_generate_fair_islands(void)
     fc_assert(pftile->pterrain != NULL);
     tile_set_terrain(ptile, pftile->pterrain);
     ptile->extras = pftile->extras;
+    map_packed_update_tile(ptile);
     tile_set_resource(ptile, pftile->presource);
     if (pftile->flags & FTF_STARTPOS) {
       struct startpos *psp = map_startpos_new(ptile);
@@ -26,6 +26,9 @@
 #include "terrain.h"
 #include "tile.h"
 
+/* server */
+#include "srv_main.h"
+
 #include "mapgen_utils.h"
 
 /****************************************************************************
@@ -95,11 +98,11 @@ void map_unset_placed(struct tile *ptile)
 ****************************************************************************/
 void set_all_ocean_tiles_placed(void) 
 {
-  whole_map_iterate(ptile) {
-    if (is_ocean_tile(ptile)) {
-      map_set_placed(ptile);
+  whole_map_index_iterate(tindex) {
+    if (is_ocean(terrain_by_number(map_packed_terrain(tindex)))) {
+      map_set_placed(index_to_tile(tindex));
     }
-  } whole_map_iterate_end;
+  } whole_map_index_iterate_end;
 }
 
 /****************************************************************************
@@ -180,6 +183,74 @@ bool is_normal_nat_pos(int x, int y)
   return is_normal_map_pos(x, y);
 }
 
+/* Number of jobs whole_map_run() splits the map into. It does not depend
+ * on the number of worker threads. */
+#define WHOLE_MAP_RUN_JOBS 64
+
+struct whole_map_run_data {
+  tile_run_cb func;
+  void *data;
+  int num_jobs;
+};
+
+/**************************************************************************
+  Run the function on one range of tile indexes, see whole_map_run().
+**************************************************************************/
+static void whole_map_run_job(int job, void *data)
+{
+  const struct whole_map_run_data *run = data;
+  int first = (long long) MAP_INDEX_SIZE * job / run->num_jobs;
+  int last = (long long) MAP_INDEX_SIZE * (job + 1) / run->num_jobs;
+  int i;
+
+  for (i = first; i < last; i++) {
+    run->func(index_to_tile(i), run->data);
+  }
+}
+
+/**************************************************************************
+  Call func on every tile of the map, spreading the tiles over the worker
+  threads of the server. func may only modify what belongs to the tile
+  it is called on, and must not use the random number generator, so that
+  the result does not depend on the number of threads.
+**************************************************************************/
+void whole_map_run(tile_run_cb func, void *data)
+{
+  struct whole_map_run_data run = {
+    .func = func,
+    .data = data,
+    .num_jobs = MIN(WHOLE_MAP_RUN_JOBS, MAP_INDEX_SIZE)
+  };
+
+  server_workpool_run(run.num_jobs, whole_map_run_job, &run);
+}
+
+struct smooth_int_map_data {
+  const int *source_map;
+  int *target_map;
+  const float *weight;
+  bool axe;
+  bool zeroes_at_edges;
+};
+
+/**************************************************************************
+  Diffuse the value of one tile along one axis, see smooth_int_map().
+**************************************************************************/
+static void smooth_int_map_tile(struct tile *ptile, void *data)
+{
+  const struct smooth_int_map_data *smooth = data;
+  float N = 0, D = 0;
+
+  axis_iterate(ptile, pnear, i, 2, smooth->axe) {
+    D += smooth->weight[i + 2];
+    N += smooth->weight[i + 2] * smooth->source_map[tile_index(pnear)];
+  } axis_iterate_end;
+  if (smooth->zeroes_at_edges) {
+    D = 1;
+  }
+  smooth->target_map[tile_index(ptile)] = (float)N / D;
+}
+
 /*******************************************************************************
   Apply a Gaussian diffusion filter on the map. The size of the map is
   MAP_INDEX_SIZE and the map is indexed by native_pos_to_index function.
@@ -190,41 +261,28 @@ void smooth_int_map(int *int_map, bool zeroes_at_edges)
 {
   static const float weight_standard[5] = { 0.13, 0.19, 0.37, 0.19, 0.13 };
   static const float weight_isometric[5] = { 0.15, 0.21, 0.29, 0.21, 0.15 };
-  const float *weight;
-  bool axe = TRUE;
-  int *target_map, *source_map;
-  int *alt_int_map = fc_calloc(MAP_INDEX_SIZE, sizeof(*alt_int_map));
+  struct smooth_int_map_data smooth;
+  int *alt_int_map;
 
   fc_assert_ret(NULL != int_map);
 
-  weight = weight_standard;
-  target_map = alt_int_map;
-  source_map = int_map;
-
-  do {
-    whole_map_iterate(ptile) {
-      float N = 0, D = 0;
+  alt_int_map = fc_calloc(MAP_INDEX_SIZE, sizeof(*alt_int_map));
+  smooth.zeroes_at_edges = zeroes_at_edges;
 
-      axis_iterate(ptile, pnear, i, 2, axe) {
-        D += weight[i + 2];
-        N += weight[i + 2] * source_map[tile_index(pnear)];
-      } axis_iterate_end;
-      if (zeroes_at_edges) {
-        D = 1;
-      }
-      target_map[tile_index(ptile)] = (float)N / D;
-    } whole_map_iterate_end;
-
-    if (MAP_IS_ISOMETRIC) {
-      weight = weight_isometric;
-    }
-
-    axe = !axe;
-
-    source_map = alt_int_map;
-    target_map = int_map;
+  /* Along the x axis, then along the y axis. */
+  smooth.source_map = int_map;
+  smooth.target_map = alt_int_map;
+  smooth.weight = weight_standard;
+  smooth.axe = TRUE;
+  whole_map_run(smooth_int_map_tile, &smooth);
 
-  } while (!axe);
+  smooth.source_map = alt_int_map;
+  smooth.target_map = int_map;
+  if (MAP_IS_ISOMETRIC) {
+    smooth.weight = weight_isometric;
+  }
+  smooth.axe = FALSE;
+  whole_map_run(smooth_int_map_tile, &smooth);
 
   FC_FREE(alt_int_map);
 }
@@ -253,16 +311,17 @@ static void recalculate_lake_surrounders(void)
   lake_surrounders = fc_realloc(lake_surrounders, size);
   memset(lake_surrounders, 0, size);
 
-  whole_map_iterate(ptile) {
-    const struct terrain *pterrain = tile_terrain(ptile);
-    Continent_id cont = tile_continent(ptile);
+  whole_map_index_iterate(tindex) {
+    const struct terrain *pterrain
+      = terrain_by_number(map_packed_terrain(tindex));
+    Continent_id cont = map_packed_continent(tindex);
 
     if (T_UNKNOWN == pterrain) {
       continue;
     }
 
     if (terrain_type_terrain_class(pterrain) != TC_OCEAN) {
-      adjc_iterate(ptile, tile2) {
+      adjc_iterate(index_to_tile(tindex), tile2) {
         Continent_id cont2 = tile_continent(tile2);
 	if (is_ocean_tile(tile2)) {
 	  if (lake_surrounders[-cont2] == 0) {
@@ -273,7 +332,7 @@ static void recalculate_lake_surrounders(void)
 	}
       } adjc_iterate_end;
     }
-  } whole_map_iterate_end;
+  } whole_map_index_iterate_end;
 }
 
 /*******************************************************************************
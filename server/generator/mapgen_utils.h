@@ -14,6 +14,7 @@
 #define FC__MAPGEN_UTILS_H
 
 typedef void (*tile_knowledge_cb)(struct tile *ptile);
+typedef void (*tile_run_cb)(struct tile *ptile, void *data);
 
 #define MG_UNUSED mapgen_terrain_property_invalid()
 
@@ -96,6 +97,8 @@ struct terrain *pick_terrain(enum mapgen_terrain_property target,
 
 bool is_normal_nat_pos(int x, int y);
 
+void whole_map_run(tile_run_cb func, void *data);
+
 /* int maps tools */
 void adjust_int_map_filtered(int *int_map, int int_map_max, void *data,
 				   bool (*filter)(const struct tile *ptile,
@@ -281,6 +281,22 @@ static bool filter_starters(const struct tile *ptile, const void *data)
   return terrain_has_flag(tile_terrain(ptile), TER_STARTER);
 }
 
+/****************************************************************************
+  Store the value of the tile in the array of tile values, see
+  get_tile_value().
+
+  This runs on the worker threads (see whole_map_run()). get_tile_value()
+  evaluates effects and requirements on virtual tiles, which is only safe
+  because server_workpool_run() freezes the effect cache meanwhile. It
+  must keep only reading the game.
+****************************************************************************/
+static void tile_value_fill(struct tile *ptile, void *data)
+{
+  int *tile_value = data;
+
+  tile_value[tile_index(ptile)] = get_tile_value(ptile);
+}
+
 /****************************************************************************
   where do the different nations start on the map? well this function tries
   to spread them out on the different islands.
@@ -334,9 +350,7 @@ bool create_start_positions(enum map_startpos mode,
   tile_value = fc_calloc(MAP_INDEX_SIZE, sizeof(*tile_value));
 
   /* get the tile value */
-  whole_map_iterate(value_tile) {
-    tile_value_aux[tile_index(value_tile)] = get_tile_value(value_tile);
-  } whole_map_iterate_end;
+  whole_map_run(tile_value_fill, tile_value_aux);
 
   /* select the best tiles */
   whole_map_iterate(value_tile) {
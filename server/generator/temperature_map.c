@@ -109,6 +109,37 @@ void destroy_tmap(void)
   temperature_map = NULL;
 }
 
+/****************************************************************************
+  Set the base temperature of the tile, equal to its colatitude.
+****************************************************************************/
+static void tmap_base_tile(struct tile *ptile, void *data)
+{
+  tmap(ptile) = map_colatitude(ptile);
+}
+
+/****************************************************************************
+  Set the temperature of the tile from its colatitude, its height and
+  the ocean around it.
+****************************************************************************/
+static void tmap_real_tile(struct tile *ptile, void *data)
+{
+  /* the base temperature is equal to base map_colatitude */
+  int t = map_colatitude(ptile);
+  /* high land can be 30% cooler */
+  float height = - 0.3 * MAX(0, hmap(ptile) - hmap_shore_level)
+      / (hmap_max_level - hmap_shore_level);
+  /* near ocean temperature can be 15% more "temperate" */
+  float temperate = (0.15 * (wld.map.server.temperature / 100 - t
+                             / MAX_COLATITUDE)
+                     * 2 * MIN(50, count_terrain_class_near_tile(ptile,
+                                                                 FALSE,
+                                                                 TRUE,
+                                                                 TC_OCEAN))
+                     / 100);
+
+  tmap(ptile) =  t * (1.0 + temperate) * (1.0 + height);
+}
+
 /***************************************************************************
  * Initialize the temperature_map
  * if arg is FALSE, create a dummy tmap == map_colatitude
@@ -124,28 +155,7 @@ void create_tmap(bool real)
   fc_assert_ret(NULL == temperature_map);
 
   temperature_map = fc_malloc(sizeof(*temperature_map) * MAP_INDEX_SIZE);
-  whole_map_iterate(ptile) {
-    /* the base temperature is equal to base map_colatitude */
-    int t = map_colatitude(ptile);
-
-    if (!real) {
-      tmap(ptile) = t;
-    } else {
-      /* high land can be 30% cooler */
-      float height = - 0.3 * MAX(0, hmap(ptile) - hmap_shore_level) 
-	  / (hmap_max_level - hmap_shore_level); 
-      /* near ocean temperature can be 15% more "temperate" */
-      float temperate = (0.15 * (wld.map.server.temperature / 100 - t
-                                 / MAX_COLATITUDE)
-                         * 2 * MIN(50, count_terrain_class_near_tile(ptile,
-                                                                     FALSE,
-                                                                     TRUE,
-                                                                     TC_OCEAN))
-                         / 100);
-
-      tmap(ptile) =  t * (1.0 + temperate) * (1.0 + height);
-    }
-  } whole_map_iterate_end;
+  whole_map_run(real ? tmap_real_tile : tmap_base_tile, NULL);
   /* adjust to get well sizes frequencies */
   /* Notice: if colatitude is loaded from a scenario never call adjust.
              Scenario may have an odd colatitude distribution and adjust will
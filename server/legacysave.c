@@ -2824,51 +2824,56 @@ static void player_load_vision(struct player *plr, int plrno,
       && game.info.fogofwar
       && -1 != total_ncities
       && secfile_lookup_bool_default(file, TRUE, "game.save_private_map")) {
+    /* The resources and extras are gathered from several layers, set them
+     * all at once. */
+    struct extra_type **resources = fc_calloc(MAP_INDEX_SIZE,
+                                              sizeof(*resources));
+    bv_extras *extras = fc_calloc(MAP_INDEX_SIZE, sizeof(*extras));
+
     LOAD_MAP_DATA(ch, vnat_y, ptile,
                   secfile_lookup_str(file, "player%d.map_t%03d",
                                      plrno, vnat_y),
-                  map_get_player_tile(ptile, plr)->terrain =
-                  char2terrain(ch));
+                  player_tile_set_terrain(map_get_player_tile(ptile, plr),
+                                          char2terrain(ch)));
 
     if (special_order) {
       LOAD_MAP_DATA(ch, vnat_y, ptile,
 	secfile_lookup_str(file, "player%d.map_res%03d", plrno, vnat_y),
-	map_get_player_tile(ptile, plr)->resource
-		    = identifier_to_resource(ch));
+	resources[tile_index(ptile)] = identifier_to_resource(ch));
 
       special_halfbyte_iterate(j, num_special_types) {
 	char buf[32]; /* enough for sprintf() below */
 	sprintf (buf, "player%d.map_spe%02d_%%03d", plrno, j);
 	LOAD_MAP_DATA(ch, vnat_y, ptile,
                       secfile_lookup_str(file, buf, vnat_y),
-                      set_savegame_special(ptile, &map_get_player_tile(ptile, plr)->extras,
+                      set_savegame_special(ptile, &extras[tile_index(ptile)],
                                  ch, special_order + 4 * j));
       } special_halfbyte_iterate_end;
     } else {
       /* get 4-bit segments of 12-bit "special" field. */
       LOAD_MAP_DATA(ch, vnat_y, ptile,
                     secfile_lookup_str(file, "player%d.map_l%03d", plrno, vnat_y),
-                    set_savegame_special(ptile, &map_get_player_tile(ptile, plr)->extras,
+                    set_savegame_special(ptile, &extras[tile_index(ptile)],
                                          ch, default_specials + 0));
       LOAD_MAP_DATA(ch, vnat_y, ptile,
                     secfile_lookup_str(file, "player%d.map_u%03d", plrno, vnat_y),
-                    set_savegame_special(ptile, &map_get_player_tile(ptile, plr)->extras,
+                    set_savegame_special(ptile, &extras[tile_index(ptile)],
                                          ch, default_specials + 4));
       LOAD_MAP_DATA(ch, vnat_y, ptile,
                     secfile_lookup_str_default (file, NULL, "player%d.map_n%03d",
                                                 plrno, vnat_y),
-                    set_savegame_special(ptile, &map_get_player_tile(ptile, plr)->extras,
+                    set_savegame_special(ptile, &extras[tile_index(ptile)],
                                          ch, default_specials + 8));
       LOAD_MAP_DATA(ch, vnat_y, ptile,
                     secfile_lookup_str(file, "map.l%03d", vnat_y),
-                    set_savegame_old_resource(&map_get_player_tile(ptile, plr)->resource,
+                    set_savegame_old_resource(&resources[tile_index(ptile)],
                                               ptile->terrain,
-                                              &map_get_player_tile(ptile, plr)->extras, ch, 0));
+                                              &extras[tile_index(ptile)], ch, 0));
       LOAD_MAP_DATA(ch, vnat_y, ptile,
                     secfile_lookup_str(file, "map.n%03d", vnat_y),
-                    set_savegame_old_resource(&map_get_player_tile(ptile, plr)->resource,
+                    set_savegame_old_resource(&resources[tile_index(ptile)],
                                               ptile->terrain,
-                                              &map_get_player_tile(ptile, plr)->extras, ch, 1));
+                                              &extras[tile_index(ptile)], ch, 1));
     }
 
     if (has_capability("bases", savefile_options)) {
@@ -2889,17 +2894,26 @@ static void player_load_vision(struct player *plr, int plrno,
 
         LOAD_MAP_DATA(ch, vnat_y, ptile,
                       secfile_lookup_str_default(file, zeroline, buf, vnat_y),
-                      set_savegame_bases(&map_get_player_tile(ptile, plr)->extras,
+                      set_savegame_bases(&extras[tile_index(ptile)],
                                          ch, base_order + 4 * j));
       } bases_halfbyte_iterate_end;
     } else {
       /* Already loaded fortresses and airbases as part of specials */
     }
 
+    whole_map_iterate(ptile) {
+      player_tile_set_resource(map_get_player_tile(ptile, plr),
+                               resources[tile_index(ptile)]);
+    } whole_map_iterate_end;
+    player_map_set_extras(plr, extras);
+    free(resources);
+    free(extras);
+
     if (game.server.foggedborders) {
       LOAD_MAP_DATA(ch, vnat_y, ptile,
                     secfile_lookup_str(file, "player%d.map_owner%03d", plrno, vnat_y),
-                    map_get_player_tile(ptile, plr)->owner = identifier_to_player(ch));
+                    player_tile_set_owner(map_get_player_tile(ptile, plr),
+                                          identifier_to_player(ch)));
     }
 
     /* get 4-bit segments of 16-bit "updated" field */
@@ -3032,8 +3046,7 @@ static void player_load_vision(struct player *plr, int plrno,
       }
       sz_strlcpy(pdcity->name, secfile_lookup_str(file, "player%d.dc%d.name", plrno, i));
 
-      change_playertile_site(map_get_player_tile(pdcity->location, plr),
-                             pdcity);
+      change_playertile_site(pdcity->location, plr, pdcity);
       identity_number_reserve(pdcity->identity);
     }
 
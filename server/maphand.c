@@ -26,6 +26,7 @@
 /* common */
 #include "base.h"
 #include "borders.h"
+#include "effects.h"
 #include "events.h"
 #include "game.h"
 #include "map.h"
@@ -38,6 +39,9 @@
 #include "unitlist.h"
 #include "vision.h"
 
+/* common/aicore */
+#include "path_finding.h"
+
 /* server */
 #include "citytools.h"
 #include "cityturn.h"
@@ -59,8 +63,64 @@
 /* Suppress send_tile_info() during game_load() */
 static bool send_tile_suppressed = FALSE;
 
+/* A tile whose border change is waiting for map_borders_thaw(). */
+struct border_send {
+  struct tile *ptile;
+  bv_player players;    /* Players whose map of the tile changed. */
+  bool all;             /* The owner changed, send to everybody. */
+};
+
+#define SPECLIST_TAG border_send
+#define SPECLIST_TYPE struct border_send
+#include "speclist.h"
+#define border_send_list_iterate(plist, psend)                              \
+  TYPED_LIST_ITERATE(struct border_send, plist, psend)
+#define border_send_list_iterate_end LIST_ITERATE_END
+
+/* See map_borders_freeze(). The list keeps the order in which the tiles
+ * changed, the hash finds the entry of a tile. */
+static int borders_frozen = 0;
+static struct border_send_list *border_sends = NULL;
+static struct tile_hash *border_send_tiles = NULL;
+
+/* The extras of a player tile are the index of their set in this table,
+ * shared by all the player maps. The hash finds the index of a set;
+ * its keys are indexes too, hashed and compared by the set they stand
+ * for. There are very few different sets in practice, when the table is
+ * full it is rebuilt with the sets still in use. */
+#define SPECHASH_TAG known_extras
+#define SPECHASH_INT_KEY_TYPE
+#define SPECHASH_INT_DATA_TYPE
+#include "spechash.h"
+
+#define KNOWN_EXTRAS_MAX (1 << 15)      /* See player_tile.extras_id */
+#define KNOWN_EXTRAS_NONE 0             /* Index of the empty set */
+
+static struct {
+  bv_extras *sets;
+  int num;
+  int alloc;
+  struct known_extras_hash *index;
+} known_extras = { NULL, 0, 0, NULL };
+
+/* The tiles whose info waits to be sent to a connection, see
+ * send_tile_info(). Each tile is queued once, with its latest state sent
+ * when the queue is flushed. */
+struct tile_info_queue {
+  int *tiles;                   /* Indexes of the queued tiles. */
+  int num_tiles;
+  int alloc_tiles;
+  unsigned char *queued;        /* TILE_QUEUED_* flags by tile index. */
+  int map_size;
+};
+
+#define TILE_QUEUED 1
+#define TILE_QUEUED_UNKNOWN 2   /* Also sent if the tile is unknown. */
+
 static void player_tile_init(struct tile *ptile, struct player *pplayer);
-static void player_tile_free(struct tile *ptile, struct player *pplayer);
+static void known_extras_init(void);
+static void send_tile_info_now(struct conn_list *dest, struct tile *ptile,
+                               bool send_unknown);
 static void give_tile_info_from_player_to_player(struct player *pfrom,
 						 struct player *pdest,
 						 struct tile *ptile);
@@ -441,7 +501,7 @@ void send_all_known_tiles(struct conn_list *dest)
       conn_list_do_buffer(dest);
     }
 
-    send_tile_info(dest, ptile, FALSE);
+    send_tile_info_now(dest, ptile, FALSE);
   } whole_map_iterate_end;
 
   conn_list_do_unbuffer(dest);
@@ -459,18 +519,236 @@ bool send_tile_suppression(bool now)
   return formerly;
 }
 
+/**************************************************************************
+  Queue the tile for the connection, see send_tile_info().
+**************************************************************************/
+static void tile_info_queue_add(struct connection *pconn,
+                                struct tile *ptile, bool send_unknown)
+{
+  struct tile_info_queue *pqueue = pconn->server.tile_info_queue;
+  int index = tile_index(ptile);
+
+  if (NULL == pqueue) {
+    pqueue = fc_calloc(1, sizeof(*pqueue));
+    pconn->server.tile_info_queue = pqueue;
+  }
+
+  if (pqueue->map_size != MAP_INDEX_SIZE) {
+    /* First use, or a new map: the tiles queued are gone. */
+    free(pqueue->queued);
+    pqueue->queued = fc_calloc(MAP_INDEX_SIZE, sizeof(*pqueue->queued));
+    pqueue->num_tiles = 0;
+    pqueue->map_size = MAP_INDEX_SIZE;
+  }
+
+  if (0 == pqueue->queued[index]) {
+    if (pqueue->num_tiles == pqueue->alloc_tiles) {
+      pqueue->alloc_tiles = MAX(2 * pqueue->alloc_tiles, 64);
+      pqueue->tiles = fc_realloc(pqueue->tiles, pqueue->alloc_tiles
+                                                * sizeof(*pqueue->tiles));
+    }
+    pqueue->tiles[pqueue->num_tiles++] = index;
+    pqueue->queued[index] = TILE_QUEUED;
+  }
+  if (send_unknown) {
+    pqueue->queued[index] |= TILE_QUEUED_UNKNOWN;
+  }
+}
+
+/**************************************************************************
+  Compare two tile indexes, for qsort().
+**************************************************************************/
+static int compare_tile_indexes(const void *a, const void *b)
+{
+  return *(const int *) a - *(const int *) b;
+}
+
+/**************************************************************************
+  Send the info of the tiles queued for the connection, in map order.
+**************************************************************************/
+void flush_tile_info(struct connection *pconn)
+{
+  struct tile_info_queue *pqueue = pconn->server.tile_info_queue;
+  int i;
+
+  if (NULL == pqueue || 0 == pqueue->num_tiles) {
+    return;
+  }
+
+  qsort(pqueue->tiles, pqueue->num_tiles, sizeof(*pqueue->tiles),
+        compare_tile_indexes);
+
+  connection_do_buffer(pconn);
+  for (i = 0; i < pqueue->num_tiles; i++) {
+    int index = pqueue->tiles[i];
+
+    send_tile_info_now(pconn->self, index_to_tile(index),
+                       TILE_QUEUED_UNKNOWN & pqueue->queued[index]);
+    pqueue->queued[index] = 0;
+  }
+  pqueue->num_tiles = 0;
+  connection_do_unbuffer(pconn);
+}
+
+/**************************************************************************
+  Send the info of the tiles queued for all the connections, in map
+  order. Each tile is sent at once to all the connections which queued
+  it, so its info is serialised once for them (see send_tile_info_now()).
+**************************************************************************/
+void flush_all_tile_info(void)
+{
+  struct conn_list *queued, *dest, *dest_unknown;
+  int *tiles;
+  int num_tiles = 0, i;
+
+  queued = conn_list_new();
+  conn_list_iterate(game.all_connections, pconn) {
+    struct tile_info_queue *pqueue = pconn->server.tile_info_queue;
+
+    if (NULL != pqueue && 0 < pqueue->num_tiles) {
+      conn_list_append(queued, pconn);
+      num_tiles += pqueue->num_tiles;
+    }
+  } conn_list_iterate_end;
+
+  if (2 > conn_list_size(queued)) {
+    conn_list_iterate(queued, pconn) {
+      flush_tile_info(pconn);
+    } conn_list_iterate_end;
+    conn_list_destroy(queued);
+    return;
+  }
+
+  /* The union of the queues, in map order. */
+  tiles = fc_malloc(num_tiles * sizeof(*tiles));
+  num_tiles = 0;
+  conn_list_iterate(queued, pconn) {
+    struct tile_info_queue *pqueue = pconn->server.tile_info_queue;
+
+    memcpy(tiles + num_tiles, pqueue->tiles,
+           pqueue->num_tiles * sizeof(*tiles));
+    num_tiles += pqueue->num_tiles;
+  } conn_list_iterate_end;
+  qsort(tiles, num_tiles, sizeof(*tiles), compare_tile_indexes);
+
+  dest = conn_list_new();
+  dest_unknown = conn_list_new();
+  conn_list_do_buffer(queued);
+  for (i = 0; i < num_tiles; i++) {
+    int index = tiles[i];
+
+    if (0 < i && tiles[i - 1] == index) {
+      continue;
+    }
+
+    conn_list_iterate(queued, pconn) {
+      struct tile_info_queue *pqueue = pconn->server.tile_info_queue;
+
+      if (0 == pqueue->queued[index]) {
+        continue;
+      }
+      if (TILE_QUEUED_UNKNOWN & pqueue->queued[index]) {
+        conn_list_append(dest_unknown, pconn);
+      } else {
+        conn_list_append(dest, pconn);
+      }
+      pqueue->queued[index] = 0;
+    } conn_list_iterate_end;
+
+    if (0 < conn_list_size(dest)) {
+      send_tile_info_now(dest, index_to_tile(index), FALSE);
+      conn_list_clear(dest);
+    }
+    if (0 < conn_list_size(dest_unknown)) {
+      send_tile_info_now(dest_unknown, index_to_tile(index), TRUE);
+      conn_list_clear(dest_unknown);
+    }
+  }
+  conn_list_iterate(queued, pconn) {
+    pconn->server.tile_info_queue->num_tiles = 0;
+  } conn_list_iterate_end;
+  conn_list_do_unbuffer(queued);
+
+  conn_list_destroy(dest_unknown);
+  conn_list_destroy(dest);
+  conn_list_destroy(queued);
+  free(tiles);
+}
+
+/**************************************************************************
+  Called before a packet is sent to the connection: the client handles
+  the other packets about a tile with the tile info it has, so the queued
+  tiles are sent first. The other connections are flushed with it: they
+  usually queued the same tiles and are about to get the same packet.
+**************************************************************************/
+void tile_info_packet_notify(struct connection *pconn, int packet_type,
+                             int size, int request_id)
+{
+  if (PACKET_TILE_INFO != packet_type
+      && NULL != pconn->server.tile_info_queue
+      && 0 < pconn->server.tile_info_queue->num_tiles) {
+    flush_all_tile_info();
+  }
+}
+
+/**************************************************************************
+  Drop the tiles queued for the connection, without sending them.
+**************************************************************************/
+void free_tile_info_queue(struct connection *pconn)
+{
+  struct tile_info_queue *pqueue = pconn->server.tile_info_queue;
+
+  if (NULL == pqueue) {
+    return;
+  }
+
+  free(pqueue->tiles);
+  free(pqueue->queued);
+  free(pqueue);
+  pconn->server.tile_info_queue = NULL;
+}
+
 /**************************************************************************
   Send tile information to all the clients in dest which know and see
   the tile. If dest is NULL, sends to all clients (game.est_connections)
   which know and see tile.
 
+  The tile is only queued for each connection, so a tile changing several
+  times is sent once. The queue of a connection is flushed before any
+  other packet is sent to it, and by flush_packets() and the main loop
+  before waiting for the network.
+
   Note that this function does not update the playermap.  For that call
   update_tile_knowledge().
 **************************************************************************/
 void send_tile_info(struct conn_list *dest, struct tile *ptile,
                     bool send_unknown)
 {
-  struct packet_tile_info info;
+  if (send_tile_suppressed) {
+    return;
+  }
+
+  if (!dest) {
+    dest = game.est_connections;
+  }
+
+  conn_list_iterate(dest, pconn) {
+    if (NULL != pconn->playing || pconn->observer) {
+      tile_info_queue_add(pconn, ptile, send_unknown);
+    }
+  } conn_list_iterate_end;
+}
+
+/**************************************************************************
+  Send tile information to the clients in dest right away; see
+  send_tile_info().
+**************************************************************************/
+static void send_tile_info_now(struct conn_list *dest, struct tile *ptile,
+                               bool send_unknown)
+{
+  struct packet_tile_info info, seen;
+  struct packet_broadcast broadcast;
+  bool seen_done = FALSE;
   const struct player *owner;
   const struct player *eowner;
 
@@ -490,6 +768,10 @@ void send_tile_info(struct conn_list *dest, struct tile *ptile,
     info.spec_sprite[0] = '\0';
   }
 
+  /* What is seen of the tile is the same for everybody, serialise it
+   * once for all the connections sharing the same delta state. */
+  packet_broadcast_begin(&broadcast, dest, &seen);
+
   conn_list_iterate(dest, pconn) {
     struct player *pplayer = pconn->playing;
 
@@ -498,32 +780,37 @@ void send_tile_info(struct conn_list *dest, struct tile *ptile,
     }
 
     if (!pplayer || map_is_known_and_seen(ptile, pplayer, V_MAIN)) {
-      info.known = TILE_KNOWN_SEEN;
-      info.continent = tile_continent(ptile);
-      owner = tile_owner(ptile);
-      eowner = extra_owner(ptile);
-      info.owner = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
-      info.extras_owner = (eowner ? player_number(eowner) : MAP_TILE_OWNER_NULL);
-      info.worked = (NULL != tile_worked(ptile))
-                     ? tile_worked(ptile)->id
-                     : IDENTITY_NUMBER_ZERO;
-
-      info.terrain = (NULL != tile_terrain(ptile))
-                      ? terrain_number(tile_terrain(ptile))
-                      : terrain_count();
-      info.resource = (NULL != tile_resource(ptile))
-                       ? extra_number(tile_resource(ptile))
-                       : extra_count();
-
-      info.extras = ptile->extras;
-
-      if (ptile->label != NULL) {
-        strncpy(info.label, ptile->label, sizeof(info.label));
-      } else {
-        info.label[0] = '\0';
+      if (!seen_done) {
+        seen = info;
+        seen.known = TILE_KNOWN_SEEN;
+        seen.continent = tile_continent(ptile);
+        owner = tile_owner(ptile);
+        eowner = extra_owner(ptile);
+        seen.owner = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
+        seen.extras_owner = (eowner ? player_number(eowner)
+                             : MAP_TILE_OWNER_NULL);
+        seen.worked = (NULL != tile_worked(ptile))
+                       ? tile_worked(ptile)->id
+                       : IDENTITY_NUMBER_ZERO;
+
+        seen.terrain = (NULL != tile_terrain(ptile))
+                        ? terrain_number(tile_terrain(ptile))
+                        : terrain_count();
+        seen.resource = (NULL != tile_resource(ptile))
+                         ? extra_number(tile_resource(ptile))
+                         : extra_count();
+
+        seen.extras = ptile->extras;
+
+        if (ptile->label != NULL) {
+          strncpy(seen.label, ptile->label, sizeof(seen.label));
+        } else {
+          seen.label[0] = '\0';
+        }
+        seen_done = TRUE;
       }
 
-      send_packet_tile_info(pconn, &info);
+      send_packet_tile_info(pconn, &seen);
     } else if (pplayer && map_is_known(ptile, pplayer)) {
       struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
       struct vision_site *psite = map_get_player_site(ptile, pplayer);
@@ -531,23 +818,23 @@ void send_tile_info(struct conn_list *dest, struct tile *ptile,
       info.known = TILE_KNOWN_UNSEEN;
       info.continent = tile_continent(ptile);
       owner = (game.server.foggedborders
-               ? plrtile->owner
+               ? player_tile_owner(plrtile)
                : tile_owner(ptile));
-      eowner = plrtile->extras_owner;
+      eowner = player_tile_extras_owner(plrtile);
       info.owner = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
       info.extras_owner = (eowner ? player_number(eowner) : MAP_TILE_OWNER_NULL);
       info.worked = (NULL != psite)
                     ? psite->identity
                     : IDENTITY_NUMBER_ZERO;
 
-      info.terrain = (NULL != plrtile->terrain)
-                      ? terrain_number(plrtile->terrain)
+      info.terrain = (0 != plrtile->terrain_id)
+                      ? plrtile->terrain_id - 1
                       : terrain_count();
-      info.resource = (NULL != plrtile->resource)
-                       ? extra_number(plrtile->resource)
+      info.resource = (0 != plrtile->resource_id)
+                       ? plrtile->resource_id - 1
                        : extra_count();
 
-      info.extras = plrtile->extras;
+      info.extras = player_tile_extras(plrtile);
 
       /* Labels never change, so they are not subject to fog of war */
       if (ptile->label != NULL) {
@@ -575,6 +862,8 @@ void send_tile_info(struct conn_list *dest, struct tile *ptile,
     }
   }
   conn_list_iterate_end;
+
+  packet_broadcast_end(&broadcast);
 }
 
 /****************************************************************************
@@ -619,6 +908,51 @@ static void shared_vision_change_seen(struct player *pplayer,
   } players_iterate_end;
 }
 
+/****************************************************************************
+  The players whose seen counts follow the vision of a player: the player
+  itself and the ones it gives shared vision to.
+****************************************************************************/
+struct vision_players {
+  struct player *players[MAX_NUM_PLAYER_SLOTS + 1];
+  int num;
+  bool can_reveal_tiles;
+};
+
+/****************************************************************************
+  Gathers the players seeing through the vision of pplayer, so the shared
+  vision is only looked up once for the many tiles of a vision change.
+****************************************************************************/
+static void vision_players_init(struct vision_players *pvp,
+                                struct player *pplayer,
+                                bool can_reveal_tiles)
+{
+  pvp->players[0] = pplayer;
+  pvp->num = 1;
+  pvp->can_reveal_tiles = can_reveal_tiles;
+
+  players_iterate(pplayer2) {
+    if (really_gives_vision(pplayer, pplayer2)) {
+      pvp->players[pvp->num++] = pplayer2;
+    }
+  } players_iterate_end;
+}
+
+/****************************************************************************
+  Same as shared_vision_change_seen() for the players gathered by
+  vision_players_init().
+****************************************************************************/
+static void vision_players_change_seen(const struct vision_players *pvp,
+                                       struct tile *ptile,
+                                       const v_radius_t change)
+{
+  int i;
+
+  map_change_own_seen(pvp->players[0], ptile, change);
+  for (i = 0; i < pvp->num; i++) {
+    map_change_seen(pvp->players[i], ptile, change, pvp->can_reveal_tiles);
+  }
+}
+
 /**************************************************************************
   There doesn't have to be a city.
 **************************************************************************/
@@ -627,16 +961,19 @@ void map_vision_update(struct player *pplayer, struct tile *ptile,
                        const v_radius_t new_radius_sq,
                        bool can_reveal_tiles)
 {
+  struct vision_players vp;
   v_radius_t change;
-  int max_radius;
+  int max_radius, min_radius;
 
   if (old_radius_sq[V_MAIN] == new_radius_sq[V_MAIN]
       && old_radius_sq[V_INVIS] == new_radius_sq[V_INVIS]) {
     return;
   }
 
-  /* Determines 'max_radius' value. */
+  /* Determines 'max_radius' value, and 'min_radius' below which the
+   * tiles are in both the old and new circles of every layer. */
   max_radius = 0;
+  min_radius = FC_INFINITY;
   vision_layer_iterate(v) {
     if (max_radius < old_radius_sq[v]) {
       max_radius = old_radius_sq[v];
@@ -644,6 +981,7 @@ void map_vision_update(struct player *pplayer, struct tile *ptile,
     if (max_radius < new_radius_sq[v]) {
       max_radius = new_radius_sq[v];
     }
+    min_radius = MIN(min_radius, MIN(old_radius_sq[v], new_radius_sq[v]));
   } vision_layer_iterate_end;
 
 #ifdef FREECIV_DEBUG
@@ -655,8 +993,13 @@ void map_vision_update(struct player *pplayer, struct tile *ptile,
   } vision_layer_iterate_end;
 #endif /* FREECIV_DEBUG */
 
+  vision_players_init(&vp, pplayer, can_reveal_tiles);
   buffer_shared_vision(pplayer);
   circle_dxyr_iterate(ptile, max_radius, tile1, dx, dy, dr) {
+    if (dr <= min_radius) {
+      /* No change. */
+      continue;
+    }
     vision_layer_iterate(v) {
       if (dr > old_radius_sq[v] && dr <= new_radius_sq[v]) {
         change[v] = 1;
@@ -666,7 +1009,48 @@ void map_vision_update(struct player *pplayer, struct tile *ptile,
         change[v] = 0;
       }
     } vision_layer_iterate_end;
-    shared_vision_change_seen(pplayer, tile1, change, can_reveal_tiles);
+    if (0 != change[V_MAIN] || 0 != change[V_INVIS]) {
+      vision_players_change_seen(&vp, tile1, change);
+    }
+  } circle_dxyr_iterate_end;
+  unbuffer_shared_vision(pplayer);
+}
+
+/****************************************************************************
+  Changes by 'sign' the seen counts of the tiles in the circles of
+  'radius_sq' around 'ptile', for the vision layers where the tile is
+  inside the circle of 'other_radius_sq' around 'other' if 'inside' is
+  TRUE, outside of it otherwise.
+****************************************************************************/
+static void map_vision_change_circles(struct player *pplayer,
+                                      bool can_reveal_tiles,
+                                      struct tile *ptile,
+                                      const v_radius_t radius_sq,
+                                      const struct tile *other,
+                                      const v_radius_t other_radius_sq,
+                                      bool inside, int sign)
+{
+  struct vision_players vp;
+  int max_radius = MAX(radius_sq[V_MAIN], radius_sq[V_INVIS]);
+
+  vision_players_init(&vp, pplayer, can_reveal_tiles);
+  buffer_shared_vision(pplayer);
+  circle_dxyr_iterate(ptile, max_radius, tile1, dx, dy, dr) {
+    const int other_dr = sq_map_distance(other, tile1);
+    v_radius_t change;
+    bool changed = FALSE;
+
+    vision_layer_iterate(v) {
+      if (dr <= radius_sq[v] && (other_dr <= other_radius_sq[v]) == inside) {
+        change[v] = sign;
+        changed = TRUE;
+      } else {
+        change[v] = 0;
+      }
+    } vision_layer_iterate_end;
+    if (changed) {
+      vision_players_change_seen(&vp, tile1, change);
+    }
   } circle_dxyr_iterate_end;
   unbuffer_shared_vision(pplayer);
 }
@@ -680,6 +1064,7 @@ void map_set_border_vision(struct player *pplayer,
                            const bool is_enabled)
 {
   const v_radius_t radius_sq = V_RADIUS(is_enabled ? 1 : -1, 0);
+  const int plrno = player_number(pplayer);
 
   if (pplayer->server.border_vision == is_enabled) {
     /* No change. Changing the seen count beyond what already exists would
@@ -690,12 +1075,13 @@ void map_set_border_vision(struct player *pplayer,
   /* Set the new border seer value. */
   pplayer->server.border_vision = is_enabled;
 
-  whole_map_iterate(ptile) {
-    if (pplayer == ptile->owner) {
+  whole_map_index_iterate(tindex) {
+    if (plrno == map_packed_owner(tindex)) {
       /* The tile is within the player's borders. */
-      shared_vision_change_seen(pplayer, ptile, radius_sq, TRUE);
+      shared_vision_change_seen(pplayer, index_to_tile(tindex), radius_sq,
+                                TRUE);
     }
-  } whole_map_iterate_end;
+  } whole_map_index_iterate_end;
 }
 
 /****************************************************************************
@@ -948,10 +1334,11 @@ void map_change_seen(struct player *pplayer,
 
     update_player_tile_last_seen(pplayer, ptile);
     if (game.server.foggedborders) {
-      plrtile->owner = tile_owner(ptile);
+      player_tile_set_owner(plrtile, tile_owner(ptile));
     }
-    plrtile->extras_owner = extra_owner(ptile);
+    player_tile_set_extras_owner(plrtile, extra_owner(ptile));
     send_tile_info(pplayer->connections, ptile, FALSE);
+    pf_map_pool_tile_changed(ptile);
   }
 
   if ((revealing_tile && 0 < plrtile->seen_count[V_MAIN])
@@ -971,6 +1358,7 @@ void map_change_seen(struct player *pplayer,
      */
     update_player_tile_knowledge(pplayer, ptile);
     send_tile_info(pplayer->connections, ptile, FALSE);
+    pf_map_pool_tile_changed(ptile);
 
     /* Discover units. */
     unit_list_iterate(ptile->units, punit) {
@@ -1032,20 +1420,28 @@ static void map_change_own_seen(struct player *pplayer,
 /***************************************************************
  Changes site information for player tile.
 ***************************************************************/
-void change_playertile_site(struct player_tile *ptile,
+void change_playertile_site(struct tile *ptile,
+                            struct player *pplayer,
                             struct vision_site *new_site)
 {
-  if (ptile->site == new_site) {
+  struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+  struct vision_site *old_site = map_get_player_site(ptile, pplayer);
+
+  if (old_site == new_site) {
     /* Do nothing. */
     return;
   }
 
-  if (ptile->site != NULL) {
+  if (old_site != NULL) {
     /* Releasing old site from tile */
-    vision_site_destroy(ptile->site);
+    tile_hash_remove(pplayer->server.private_sites, ptile);
+    vision_site_destroy(old_site);
   }
 
-  ptile->site = new_site;
+  if (new_site != NULL) {
+    tile_hash_insert(pplayer->server.private_sites, ptile, new_site);
+  }
+  plrtile->has_site = (new_site != NULL);
 }
 
 /***************************************************************
@@ -1054,6 +1450,7 @@ void change_playertile_site(struct player_tile *ptile,
 void map_set_known(struct tile *ptile, struct player *pplayer)
 {
   dbv_set(&pplayer->tile_known, tile_index(ptile));
+  pf_map_pool_tile_changed(ptile);
 }
 
 /***************************************************************
@@ -1062,6 +1459,7 @@ void map_set_known(struct tile *ptile, struct player *pplayer)
 void map_clear_known(struct tile *ptile, struct player *pplayer)
 {
   dbv_clr(&pplayer->tile_known, tile_index(ptile));
+  pf_map_pool_tile_changed(ptile);
 }
 
 /****************************************************************************
@@ -1099,6 +1497,10 @@ void player_map_init(struct player *pplayer)
   pplayer->server.private_map
     = fc_realloc(pplayer->server.private_map,
                  MAP_INDEX_SIZE * sizeof(*pplayer->server.private_map));
+  if (NULL == pplayer->server.private_sites) {
+    pplayer->server.private_sites = tile_hash_new();
+  }
+  known_extras_init();
 
   whole_map_iterate(ptile) {
     player_tile_init(ptile, pplayer);
@@ -1116,9 +1518,12 @@ void player_map_free(struct player *pplayer)
     return;
   }
 
-  whole_map_iterate(ptile) {
-    player_tile_free(ptile, pplayer);
-  } whole_map_iterate_end;
+  TYPED_HASH_DATA_ITERATE(struct vision_site *,
+                          pplayer->server.private_sites, psite) {
+    vision_site_destroy(psite);
+  } HASH_DATA_ITERATE_END;
+  tile_hash_destroy(pplayer->server.private_sites);
+  pplayer->server.private_sites = NULL;
 
   free(pplayer->server.private_map);
   pplayer->server.private_map = NULL;
@@ -1150,19 +1555,20 @@ void remove_player_from_maps(struct player *pplayer)
       aplrtile = map_get_player_tile(ptile, aplayer);
 
       /* Free vision sites (cities) for removed and other players */
-      if (aplrtile && aplrtile->site &&
-          vision_site_owner(aplrtile->site) == pplayer) {
-        change_playertile_site(aplrtile, NULL);
+      if (aplrtile->has_site
+          && vision_site_owner(map_get_player_site(ptile, aplayer))
+             == pplayer) {
+        change_playertile_site(ptile, aplayer, NULL);
         changed = TRUE;
       }
 
       /* Remove references to player from others' maps */
-      if (aplrtile->owner == pplayer) {
-        aplrtile->owner = NULL;
+      if (player_tile_owner(aplrtile) == pplayer) {
+        player_tile_set_owner(aplrtile, NULL);
         changed = TRUE;
       }
-      if (aplrtile->extras_owner == pplayer) {
-        aplrtile->extras_owner = NULL;
+      if (player_tile_extras_owner(aplrtile) == pplayer) {
+        player_tile_set_extras_owner(aplrtile, NULL);
         changed = TRUE;
       }
 
@@ -1205,12 +1611,12 @@ static void player_tile_init(struct tile *ptile, struct player *pplayer)
 {
   struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
 
-  plrtile->terrain = T_UNKNOWN;
-  plrtile->resource = NULL;
-  plrtile->owner = NULL;
-  plrtile->extras_owner = NULL;
-  plrtile->site = NULL;
-  BV_CLR_ALL(plrtile->extras);
+  plrtile->terrain_id = 0;
+  plrtile->resource_id = 0;
+  plrtile->owner_id = 0;
+  plrtile->extras_owner_id = 0;
+  plrtile->has_site = FALSE;
+  plrtile->extras_id = KNOWN_EXTRAS_NONE;
   if (!game.server.last_updated_year) {
     plrtile->last_updated = game.info.turn;
   } else {
@@ -1222,18 +1628,6 @@ static void player_tile_init(struct tile *ptile, struct player *pplayer)
   memcpy(plrtile->own_seen, plrtile->seen_count, sizeof(v_radius_t));
 }
 
-/****************************************************************************
-  Free the memory stored into the player tile.
-****************************************************************************/
-static void player_tile_free(struct tile *ptile, struct player *pplayer)
-{
-  struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
-
-  if (plrtile->site != NULL) {
-    vision_site_destroy(plrtile->site);
-  }
-}
-
 /****************************************************************************
   Returns city located at given tile from player map.
 ****************************************************************************/
@@ -1253,7 +1647,15 @@ struct vision_site *map_get_player_city(const struct tile *ptile,
 struct vision_site *map_get_player_site(const struct tile *ptile,
 					const struct player *pplayer)
 {
-  return map_get_player_tile(ptile, pplayer)->site;
+  struct vision_site *psite;
+
+  if (!map_get_player_tile(ptile, pplayer)->has_site
+      || !tile_hash_lookup(pplayer->server.private_sites,
+                           (struct tile *) ptile, (void **) &psite)) {
+    return NULL;
+  }
+
+  return psite;
 }
 
 /****************************************************************************
@@ -1269,6 +1671,276 @@ struct player_tile *map_get_player_tile(const struct tile *ptile,
   return pplayer->server.private_map + tile_index(ptile);
 }
 
+/****************************************************************************
+  Hash function of known_extras, hashing the set the index stands for.
+****************************************************************************/
+static genhash_val_t known_extras_val(const void *key)
+{
+  const unsigned char *vec = known_extras.sets[FC_PTR_TO_INT(key)].vec;
+  genhash_val_t result = 0;
+  size_t i;
+
+  for (i = 0; i < sizeof(known_extras.sets[0].vec); i++) {
+    result = result * 31 + vec[i];
+  }
+
+  return result;
+}
+
+/****************************************************************************
+  Comparison function of known_extras, comparing the sets the indexes
+  stand for.
+****************************************************************************/
+static bool known_extras_comp(const void *key1, const void *key2)
+{
+  return BV_ARE_EQUAL(known_extras.sets[FC_PTR_TO_INT(key1)],
+                      known_extras.sets[FC_PTR_TO_INT(key2)]);
+}
+
+/****************************************************************************
+  Makes the table of the known extras only hold the sets in use in the
+  player maps, and renumber the player tiles.
+****************************************************************************/
+static void known_extras_rebuild(void)
+{
+  bv_extras *old_sets = known_extras.sets;
+  int *old_to_new = fc_malloc(known_extras.num * sizeof(*old_to_new));
+  int i;
+
+  for (i = 0; i < known_extras.num; i++) {
+    old_to_new[i] = -1;
+  }
+
+  known_extras.sets = fc_malloc(known_extras.alloc
+                                * sizeof(*known_extras.sets));
+  known_extras.sets[KNOWN_EXTRAS_NONE] = old_sets[KNOWN_EXTRAS_NONE];
+  known_extras.num = 1;
+  old_to_new[KNOWN_EXTRAS_NONE] = KNOWN_EXTRAS_NONE;
+  known_extras_hash_clear(known_extras.index);
+  known_extras_hash_insert(known_extras.index, KNOWN_EXTRAS_NONE,
+                           KNOWN_EXTRAS_NONE);
+
+  players_iterate(pplayer) {
+    if (NULL == pplayer->server.private_map) {
+      continue;
+    }
+
+    whole_map_iterate(ptile) {
+      struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+      int old_id = plrtile->extras_id;
+
+      if (0 > old_to_new[old_id]) {
+        old_to_new[old_id] = known_extras.num;
+        known_extras.sets[known_extras.num] = old_sets[old_id];
+        known_extras_hash_insert(known_extras.index, known_extras.num,
+                                 known_extras.num);
+        known_extras.num++;
+      }
+      plrtile->extras_id = old_to_new[old_id];
+    } whole_map_iterate_end;
+  } players_iterate_end;
+
+  log_verbose("Rebuilt the table of the known extras, %d sets in use.",
+              known_extras.num);
+
+  free(old_to_new);
+  free(old_sets);
+}
+
+/****************************************************************************
+  Returns the index of the set of extras in the known extras table,
+  adding it if needed. Only to be called from the main thread.
+****************************************************************************/
+static int known_extras_index(const bv_extras *extras)
+{
+  int id;
+
+  /* One more slot than the sets, to look the new one up from there. */
+  if (known_extras.num + 1 >= known_extras.alloc) {
+    known_extras.alloc = MIN(MAX(2 * known_extras.alloc, 64),
+                             KNOWN_EXTRAS_MAX + 1);
+    known_extras.sets = fc_realloc(known_extras.sets,
+                                   known_extras.alloc
+                                   * sizeof(*known_extras.sets));
+  }
+
+  known_extras.sets[known_extras.num] = *extras;
+  if (known_extras_hash_lookup(known_extras.index, known_extras.num, &id)) {
+    return id;
+  }
+
+  if (KNOWN_EXTRAS_MAX == known_extras.num) {
+    known_extras_rebuild();
+    if (KNOWN_EXTRAS_MAX == known_extras.num) {
+      log_error("Too many different sets of extras in the player maps.");
+      return KNOWN_EXTRAS_NONE;
+    }
+    known_extras.sets[known_extras.num] = *extras;
+  }
+
+  known_extras_hash_insert(known_extras.index, known_extras.num,
+                           known_extras.num);
+
+  return known_extras.num++;
+}
+
+/****************************************************************************
+  Create the table of the extras known by the players, holding the empty
+  set.
+****************************************************************************/
+static void known_extras_init(void)
+{
+  if (NULL != known_extras.index) {
+    return;
+  }
+
+  known_extras.index = known_extras_hash_new_full(known_extras_val,
+                                                  known_extras_comp,
+                                                  NULL, NULL, NULL, NULL);
+  known_extras.alloc = 64;
+  known_extras.sets = fc_malloc(known_extras.alloc
+                                * sizeof(*known_extras.sets));
+  BV_CLR_ALL(known_extras.sets[KNOWN_EXTRAS_NONE]);
+  known_extras_hash_insert(known_extras.index, KNOWN_EXTRAS_NONE,
+                           KNOWN_EXTRAS_NONE);
+  known_extras.num = 1;
+}
+
+/****************************************************************************
+  Free the table of the extras known by the players. To be called once
+  all the player maps are freed.
+****************************************************************************/
+void player_map_extras_free(void)
+{
+  if (NULL != known_extras.index) {
+    known_extras_hash_destroy(known_extras.index);
+    known_extras.index = NULL;
+  }
+  free(known_extras.sets);
+  known_extras.sets = NULL;
+  known_extras.num = 0;
+  known_extras.alloc = 0;
+}
+
+/****************************************************************************
+  Returns the terrain of the player tile, T_UNKNOWN if it is not known.
+****************************************************************************/
+struct terrain *player_tile_terrain(const struct player_tile *plrtile)
+{
+  return (0 != plrtile->terrain_id
+          ? terrain_by_number(plrtile->terrain_id - 1) : T_UNKNOWN);
+}
+
+/****************************************************************************
+  Sets the terrain of the player tile.
+****************************************************************************/
+void player_tile_set_terrain(struct player_tile *plrtile,
+                             const struct terrain *pterrain)
+{
+  plrtile->terrain_id = (T_UNKNOWN != pterrain
+                         ? terrain_number(pterrain) + 1 : 0);
+}
+
+/****************************************************************************
+  Returns the resource of the player tile, if any.
+****************************************************************************/
+struct extra_type *player_tile_resource(const struct player_tile *plrtile)
+{
+  return (0 != plrtile->resource_id
+          ? extra_by_number(plrtile->resource_id - 1) : NULL);
+}
+
+/****************************************************************************
+  Sets the resource of the player tile.
+****************************************************************************/
+void player_tile_set_resource(struct player_tile *plrtile,
+                              const struct extra_type *presource)
+{
+  plrtile->resource_id = (NULL != presource
+                          ? extra_number(presource) + 1 : 0);
+}
+
+/****************************************************************************
+  Returns the owner of the player tile, if any.
+****************************************************************************/
+struct player *player_tile_owner(const struct player_tile *plrtile)
+{
+  return (0 != plrtile->owner_id
+          ? player_by_number(plrtile->owner_id - 1) : NULL);
+}
+
+/****************************************************************************
+  Sets the owner of the player tile.
+****************************************************************************/
+void player_tile_set_owner(struct player_tile *plrtile,
+                           const struct player *powner)
+{
+  plrtile->owner_id = (NULL != powner ? player_number(powner) + 1 : 0);
+}
+
+/****************************************************************************
+  Returns the owner of the extras of the player tile, if any.
+****************************************************************************/
+struct player *player_tile_extras_owner(const struct player_tile *plrtile)
+{
+  return (0 != plrtile->extras_owner_id
+          ? player_by_number(plrtile->extras_owner_id - 1) : NULL);
+}
+
+/****************************************************************************
+  Sets the owner of the extras of the player tile.
+****************************************************************************/
+void player_tile_set_extras_owner(struct player_tile *plrtile,
+                                  const struct player *powner)
+{
+  plrtile->extras_owner_id = (NULL != powner
+                              ? player_number(powner) + 1 : 0);
+}
+
+/****************************************************************************
+  Returns the extras of the player tile.
+****************************************************************************/
+bv_extras player_tile_extras(const struct player_tile *plrtile)
+{
+  return known_extras.sets[plrtile->extras_id];
+}
+
+/****************************************************************************
+  Sets the extras of the player tile. Only to be called from the main
+  thread.
+****************************************************************************/
+void player_tile_set_extras(struct player_tile *plrtile,
+                            const bv_extras *extras)
+{
+  plrtile->extras_id = known_extras_index(extras);
+}
+
+/****************************************************************************
+  Sets the extras of all the tiles of the map of pplayer, 'extras' being
+  indexed by tile index. Only to be called from the main thread.
+****************************************************************************/
+void player_map_set_extras(struct player *pplayer, const bv_extras *extras)
+{
+  const struct player_tile *prev = NULL;
+  int prev_index = 0;
+
+  whole_map_iterate(ptile) {
+    struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+    int index = tile_index(ptile);
+
+    /* Most neighbouring tiles share their set, skip the table lookup
+     * then. The previous tile is renumbered along with the others if the
+     * table is rebuilt, so its id stays valid. */
+    if (NULL != prev && BV_ARE_EQUAL(extras[index], extras[prev_index])) {
+      plrtile->extras_id = prev->extras_id;
+    } else {
+      player_tile_set_extras(plrtile, &extras[index]);
+    }
+    prev = plrtile;
+    prev_index = index;
+  } whole_map_iterate_end;
+}
+
 /****************************************************************************
   Give pplayer the correct knowledge about tile; return TRUE iff
   knowledge changed.
@@ -1283,21 +1955,22 @@ bool update_player_tile_knowledge(struct player *pplayer, struct tile *ptile)
   bool plrtile_owner_valid = game.server.foggedborders
                              && !map_is_known_and_seen(ptile, pplayer, V_MAIN);
   struct player *owner = plrtile_owner_valid
-                         ? plrtile->owner
+                         ? player_tile_owner(plrtile)
                          : tile_owner(ptile);
+  bv_extras extras = player_tile_extras(plrtile);
 
-  if (plrtile->terrain != ptile->terrain
-      || !BV_ARE_EQUAL(plrtile->extras, ptile->extras)
-      || plrtile->resource != ptile->resource
+  if (player_tile_terrain(plrtile) != ptile->terrain
+      || !BV_ARE_EQUAL(extras, ptile->extras)
+      || player_tile_resource(plrtile) != ptile->resource
       || owner != tile_owner(ptile)
-      || plrtile->extras_owner != extra_owner(ptile)) {
-    plrtile->terrain = ptile->terrain;
-    plrtile->extras = ptile->extras;
-    plrtile->resource = ptile->resource;
+      || player_tile_extras_owner(plrtile) != extra_owner(ptile)) {
+    player_tile_set_terrain(plrtile, ptile->terrain);
+    player_tile_set_extras(plrtile, &ptile->extras);
+    player_tile_set_resource(plrtile, ptile->resource);
     if (plrtile_owner_valid) {
-      plrtile->owner = tile_owner(ptile);
+      player_tile_set_owner(plrtile, tile_owner(ptile));
     }
-    plrtile->extras_owner = extra_owner(ptile);
+    player_tile_set_extras_owner(plrtile, extra_owner(ptile));
 
     return TRUE;
   }
@@ -1316,6 +1989,8 @@ bool update_player_tile_knowledge(struct player *pplayer, struct tile *ptile)
 ****************************************************************************/
 void update_tile_knowledge(struct tile *ptile)
 {
+  pf_map_pool_tile_changed(ptile);
+
   /* Players */
   players_iterate(pplayer) {
     if (map_is_known_and_seen(ptile, pplayer, V_MAIN)) {
@@ -1356,6 +2031,8 @@ static void really_give_tile_info_from_player_to_player(struct player *pfrom,
 							struct tile *ptile)
 {
   struct player_tile *from_tile, *dest_tile;
+  struct vision_site *from_site, *dest_site;
+
   if (!map_is_known_and_seen(ptile, pdest, V_MAIN)) {
     /* I can just hear people scream as they try to comprehend this if :).
      * Let me try in words:
@@ -1373,24 +2050,26 @@ static void really_give_tile_info_from_player_to_player(struct player *pfrom,
       dest_tile = map_get_player_tile(ptile, pdest);
       /* Update and send tile knowledge */
       map_set_known(ptile, pdest);
-      dest_tile->terrain = from_tile->terrain;
-      dest_tile->extras   = from_tile->extras;
-      dest_tile->resource = from_tile->resource;
-      dest_tile->owner    = from_tile->owner;
-      dest_tile->extras_owner = from_tile->extras_owner;
+      /* The ids are the same for all the players. */
+      dest_tile->terrain_id = from_tile->terrain_id;
+      dest_tile->extras_id = from_tile->extras_id;
+      dest_tile->resource_id = from_tile->resource_id;
+      dest_tile->owner_id = from_tile->owner_id;
+      dest_tile->extras_owner_id = from_tile->extras_owner_id;
       dest_tile->last_updated = from_tile->last_updated;
       send_tile_info(pdest->connections, ptile, FALSE);
 
       /* update and send city knowledge */
       /* remove outdated cities */
-      if (dest_tile->site) {
-	if (!from_tile->site) {
+      from_site = map_get_player_site(ptile, pfrom);
+      dest_site = map_get_player_site(ptile, pdest);
+      if (dest_site) {
+	if (!from_site) {
 	  /* As the city was gone on the newer from_tile
 	     it will be removed by this function */
 	  reality_check_city(pdest, ptile);
 	} else /* We have a dest_city. update */
-	  if (from_tile->site->identity
-              != dest_tile->site->identity) {
+	  if (from_site->identity != dest_site->identity) {
 	    /* As the city was gone on the newer from_tile
 	       it will be removed by this function */
 	    reality_check_city(pdest, ptile);
@@ -1398,12 +2077,11 @@ static void really_give_tile_info_from_player_to_player(struct player *pfrom,
       }
 
       /* Set and send new city info */
-      if (from_tile->site) {
-	if (!dest_tile->site) {
-          /* We cannot assign new vision site with change_playertile_site(),
-           * since location is not yet set up for new site */
-          dest_tile->site = vision_site_new(0, ptile, NULL);
-          *dest_tile->site = *from_tile->site;
+      if (from_site) {
+	if (!map_get_player_site(ptile, pdest)) {
+          dest_site = vision_site_new(0, ptile, NULL);
+          *dest_site = *from_site;
+          change_playertile_site(ptile, pdest, dest_site);
 	}
         /* Note that we don't care if receiver knows vision source city
          * or not. */
@@ -1488,6 +2166,7 @@ void give_shared_vision(struct player *pfrom, struct player *pto)
 
   BV_SET(pfrom->gives_shared_vision, player_index(pto));
   create_vision_dependencies();
+  effect_cache_invalidate();
   log_debug("giving shared vision from %s to %s",
             player_name(pfrom), player_name(pto));
 
@@ -1547,6 +2226,7 @@ void remove_shared_vision(struct player *pfrom, struct player *pto)
 
   BV_CLR(pfrom->gives_shared_vision, player_index(pto));
   create_vision_dependencies();
+  effect_cache_invalidate();
 
   players_iterate(pplayer) {
     buffer_shared_vision(pplayer);
@@ -1920,6 +2600,103 @@ static void map_unit_homecity_enqueue(struct tile *ptile)
   } unit_list_iterate_end;
 }
 
+/*************************************************************************
+  Returns the pending send of a tile changed while the borders are
+  frozen, adding it if needed.
+*************************************************************************/
+static struct border_send *border_send_get(struct tile *ptile)
+{
+  struct border_send *psend;
+
+  if (NULL == border_sends) {
+    border_sends = border_send_list_new_full((border_send_list_free_fn_t)
+                                             free);
+    border_send_tiles = tile_hash_new();
+  } else if (tile_hash_lookup(border_send_tiles, ptile,
+                              (void **) &psend)) {
+    return psend;
+  }
+
+  psend = fc_malloc(sizeof(*psend));
+  psend->ptile = ptile;
+  BV_CLR_ALL(psend->players);
+  psend->all = FALSE;
+  border_send_list_append(border_sends, psend);
+  tile_hash_insert(border_send_tiles, ptile, psend);
+
+  return psend;
+}
+
+/*************************************************************************
+  Hold back the tile info packets of the border changes until the
+  matching map_borders_thaw(). A tile which changes hands several times
+  in between, like when the border of a conquered city is cleared and
+  claimed again, is then sent only once. Ownership, vision and the player
+  maps are still updated immediately. Calls may be nested.
+*************************************************************************/
+void map_borders_freeze(void)
+{
+  borders_frozen++;
+}
+
+/*************************************************************************
+  Send the tiles changed since the outermost map_borders_freeze().
+*************************************************************************/
+void map_borders_thaw(void)
+{
+  struct border_send_list *sends = border_sends;
+
+  fc_assert_ret(0 < borders_frozen);
+
+  if (0 < --borders_frozen || NULL == sends) {
+    return;
+  }
+
+  border_sends = NULL;
+  tile_hash_destroy(border_send_tiles);
+  border_send_tiles = NULL;
+
+  border_send_list_iterate(sends, psend) {
+    if (psend->all) {
+      send_tile_info(NULL, psend->ptile, FALSE);
+      continue;
+    }
+
+    players_iterate(pplayer) {
+      if (BV_ISSET(psend->players, player_index(pplayer))) {
+        send_tile_info(pplayer->connections, psend->ptile, FALSE);
+      }
+    } players_iterate_end;
+
+    /* Global observers */
+    conn_list_iterate(game.est_connections, pconn) {
+      if (NULL == pconn->playing && pconn->observer) {
+        send_tile_info(pconn->self, psend->ptile, FALSE);
+      }
+    } conn_list_iterate_end;
+  } border_send_list_iterate_end;
+
+  border_send_list_destroy(sends);
+}
+
+/*************************************************************************
+  Like update_tile_knowledge(), but only records who needs the tile sent
+  when the borders are thawed.
+*************************************************************************/
+static void update_tile_knowledge_frozen(struct tile *ptile)
+{
+  struct border_send *psend = border_send_get(ptile);
+
+  pf_map_pool_tile_changed(ptile);
+
+  players_iterate(pplayer) {
+    if (map_is_known_and_seen(ptile, pplayer, V_MAIN)
+        && update_player_tile_knowledge(pplayer, ptile)) {
+      BV_SET(psend->players, player_index(pplayer));
+    }
+  } players_iterate_end;
+}
+
 /*************************************************************************
   Claim ownership of a single tile.
 *************************************************************************/
@@ -1952,7 +2729,11 @@ static void map_claim_border_ownership(struct tile *ptile,
   /* Needed only when foggedborders enabled, but we do it unconditionally
    * in case foggedborders ever gets enabled later. Better to have correct
    * information in player map just in case. */
-  update_tile_knowledge(ptile);
+  if (0 < borders_frozen) {
+    update_tile_knowledge_frozen(ptile);
+  } else {
+    update_tile_knowledge(ptile);
+  }
 
   if (ploser != powner) {
     if (S_S_RUNNING == server_state() && game.info.happyborders != HB_DISABLED) {
@@ -1960,7 +2741,11 @@ static void map_claim_border_ownership(struct tile *ptile,
     }
 
     if (!city_map_update_tile_frozen(ptile)) {
-      send_tile_info(NULL, ptile, FALSE);
+      if (0 < borders_frozen) {
+        border_send_get(ptile)->all = TRUE;
+      } else {
+        send_tile_info(NULL, ptile, FALSE);
+      }
     }
   }
 }
@@ -2002,6 +2787,7 @@ void map_clear_border(struct tile *ptile)
 {
   int radius_sq = tile_border_source_radius_sq(ptile);
 
+  map_borders_freeze();
   circle_dxyr_iterate(ptile, radius_sq, dtile, dx, dy, dr) {
     struct tile *claimer = tile_claimer(dtile);
 
@@ -2009,6 +2795,7 @@ void map_clear_border(struct tile *ptile)
       map_claim_ownership(dtile, NULL, NULL, FALSE);
     }
   } circle_dxyr_iterate_end;
+  map_borders_thaw();
 }
 
 /*************************************************************************
@@ -2030,6 +2817,7 @@ void map_update_border(struct tile *ptile, struct player *owner,
   if (old_radius_sq < new_radius_sq) {
     map_claim_border(ptile, owner, new_radius_sq);
   } else {
+    map_borders_freeze();
     circle_dxyr_iterate(ptile, old_radius_sq, dtile, dx, dy, dr) {
       if (dr > new_radius_sq) {
         struct tile *claimer = tile_claimer(dtile);
@@ -2039,6 +2827,7 @@ void map_update_border(struct tile *ptile, struct player *owner,
         }
       }
     } circle_dxyr_iterate_end;
+    map_borders_thaw();
   }
 }
 
@@ -2066,6 +2855,7 @@ void map_claim_border(struct tile *ptile, struct player *owner,
     radius_sq = tile_border_source_radius_sq(ptile);
   }
 
+  map_borders_freeze();
   circle_dxyr_iterate(ptile, radius_sq, dtile, dx, dy, dr) {
     struct tile *dclaimer = tile_claimer(dtile);
 
@@ -2129,6 +2919,7 @@ void map_claim_border(struct tile *ptile, struct player *owner,
       }
     }
   } circle_dxyr_iterate_end;
+  map_borders_thaw();
 }
 
 /*************************************************************************
@@ -2147,11 +2938,14 @@ void map_calculate_borders(void)
 
   log_verbose("map_calculate_borders()");
 
+  /* A tile taken over by several sources in turn is sent once. */
+  map_borders_freeze();
   whole_map_iterate(ptile) {
     if (is_border_source(ptile)) {
       map_claim_border(ptile, ptile->owner, -1);
     }
   } whole_map_iterate_end;
+  map_borders_thaw();
 
   log_verbose("map_calculate_borders() workers");
   city_thaw_workers_queue();
@@ -2257,6 +3051,23 @@ void map_claim_base(struct tile *ptile, struct extra_type *pextra,
   }
 }
 
+/****************************************************************************
+  Ends the replacement of a vision by 'vision', started by
+  vision_replace_sight(): the tiles seen by both are counted again for
+  each of them.
+****************************************************************************/
+static void vision_replace_end(struct vision *vision)
+{
+  struct vision *old_vision = vision->replaces;
+
+  map_vision_change_circles(vision->player, vision->can_reveal_tiles,
+                            vision->tile, vision->radius_sq,
+                            old_vision->tile, old_vision->radius_sq,
+                            TRUE, 1);
+  old_vision->replaced_by = NULL;
+  vision->replaces = NULL;
+}
+
 /****************************************************************************
   Change the sight points for the vision source, fogging or unfogging tiles
   as needed.
@@ -2265,11 +3076,82 @@ void map_claim_base(struct tile *ptile, struct extra_type *pextra,
 ****************************************************************************/
 void vision_change_sight(struct vision *vision, const v_radius_t radius_sq)
 {
+  if (NULL != vision->replaced_by) {
+    struct vision *new_vision = vision->replaced_by;
+
+    if (-1 == radius_sq[V_MAIN] && -1 == radius_sq[V_INVIS]) {
+      /* The usual end of a move: the new vision keeps the sight points
+       * on the tiles both see, only the others are removed. */
+      map_vision_change_circles(vision->player, vision->can_reveal_tiles,
+                                vision->tile, vision->radius_sq,
+                                new_vision->tile, new_vision->radius_sq,
+                                FALSE, -1);
+      new_vision->replaces = NULL;
+      vision->replaced_by = NULL;
+      memcpy(vision->radius_sq, radius_sq, sizeof(v_radius_t));
+      return;
+    }
+    vision_replace_end(new_vision);
+  } else if (NULL != vision->replaces) {
+    vision_replace_end(vision);
+  }
+
   map_vision_update(vision->player, vision->tile, vision->radius_sq,
                     radius_sq, vision->can_reveal_tiles);
   memcpy(vision->radius_sq, radius_sq, sizeof(v_radius_t));
 }
 
+/****************************************************************************
+  Whether the sight points of 'vision' and 'old_vision' fit in the map
+  without wrapping onto themselves, so the tiles both see are found the
+  same way from either of them.
+****************************************************************************/
+static bool vision_replace_fits(const struct vision *vision,
+                                const struct vision *old_vision,
+                                const v_radius_t radius_sq)
+{
+  int max_radius = 0;
+
+  vision_layer_iterate(v) {
+    max_radius = MAX(max_radius, MAX(radius_sq[v], old_vision->radius_sq[v]));
+  } vision_layer_iterate_end;
+  max_radius = (int) sqrt((double) MAX(max_radius, 0));
+
+  return 4 * max_radius + 2 <= MIN(wld.map.xsize, wld.map.ysize);
+}
+
+/****************************************************************************
+  Sets the first sight points of the new vision source 'vision', which
+  replaces 'old_vision' of the same player (as a unit moving from the tile
+  of 'old_vision'). Only the tiles 'old_vision' does not see get sight
+  points now, the others are kept from 'old_vision' when it is cleared.
+  Either vision changing before then counts them for each again.
+
+  See documentation in vision.h.
+****************************************************************************/
+void vision_replace_sight(struct vision *vision, struct vision *old_vision,
+                          const v_radius_t radius_sq)
+{
+  if (NULL == old_vision
+      || old_vision->player != vision->player
+      || old_vision->can_reveal_tiles != vision->can_reveal_tiles
+      || NULL != old_vision->replaces || NULL != old_vision->replaced_by
+      || NULL != vision->replaces || NULL != vision->replaced_by
+      || -1 != vision->radius_sq[V_MAIN] || -1 != vision->radius_sq[V_INVIS]
+      || !vision_replace_fits(vision, old_vision, radius_sq)) {
+    vision_change_sight(vision, radius_sq);
+    return;
+  }
+
+  map_vision_change_circles(vision->player, vision->can_reveal_tiles,
+                            vision->tile, radius_sq,
+                            old_vision->tile, old_vision->radius_sq,
+                            FALSE, 1);
+  memcpy(vision->radius_sq, radius_sq, sizeof(v_radius_t));
+  vision->replaces = old_vision;
+  old_vision->replaced_by = vision;
+}
+
 /****************************************************************************
   Clear all sight points from this vision source.
 
@@ -26,14 +26,13 @@ struct section_file;
 struct conn_list;
 
 
+/* What a player knows of a tile. There is one for every tile of every
+ * player, so it is kept small: the terrain, resource and owners are
+ * stored as their number plus one, 0 standing for none, and the extras
+ * as the index of the set in a table shared by all the players. Use the
+ * player_tile_*() functions to read and change them. The vision sites
+ * are kept aside, see map_get_player_site(). */
 struct player_tile {
-  struct vision_site *site;		/* NULL for no vision site */
-  struct extra_type *resource;          /* NULL for no resource */
-  struct terrain *terrain;		/* NULL for unknown tiles */
-  struct player *owner; 		/* NULL for unowned */
-  struct player *extras_owner;
-  bv_extras extras;
-
   /* If you build a city with an unknown square within city radius
      the square stays unknown. However, we still have to keep count
      of the seen points, so they are kept in here. When the tile
@@ -41,6 +40,12 @@ struct player_tile {
   v_radius_t own_seen;
   v_radius_t seen_count;
   short last_updated;
+  unsigned extras_id : 15;
+  unsigned has_site : 1;
+  unsigned char terrain_id;             /* 0 for unknown tiles */
+  unsigned char resource_id;            /* 0 for no resource */
+  unsigned char owner_id;               /* 0 for unowned */
+  unsigned char extras_owner_id;
 };
 
 void global_warming(int effect);
@@ -58,6 +63,11 @@ void send_all_known_tiles(struct conn_list *dest);
 bool send_tile_suppression(bool now);
 void send_tile_info(struct conn_list *dest, struct tile *ptile,
                     bool send_unknown);
+void flush_tile_info(struct connection *pconn);
+void flush_all_tile_info(void);
+void tile_info_packet_notify(struct connection *pconn, int packet_type,
+                             int size, int request_id);
+void free_tile_info_queue(struct connection *pconn);
 
 void send_map_info(struct conn_list *dest);
 
@@ -92,6 +102,23 @@ struct vision_site *map_get_player_site(const struct tile *ptile,
 					const struct player *pplayer);
 struct player_tile *map_get_player_tile(const struct tile *ptile,
 					const struct player *pplayer);
+struct terrain *player_tile_terrain(const struct player_tile *plrtile);
+void player_tile_set_terrain(struct player_tile *plrtile,
+                             const struct terrain *pterrain);
+struct extra_type *player_tile_resource(const struct player_tile *plrtile);
+void player_tile_set_resource(struct player_tile *plrtile,
+                              const struct extra_type *presource);
+struct player *player_tile_owner(const struct player_tile *plrtile);
+void player_tile_set_owner(struct player_tile *plrtile,
+                           const struct player *powner);
+struct player *player_tile_extras_owner(const struct player_tile *plrtile);
+void player_tile_set_extras_owner(struct player_tile *plrtile,
+                                  const struct player *powner);
+bv_extras player_tile_extras(const struct player_tile *plrtile);
+void player_tile_set_extras(struct player_tile *plrtile,
+                            const bv_extras *extras);
+void player_map_set_extras(struct player *pplayer, const bv_extras *extras);
+void player_map_extras_free(void);
 bool update_player_tile_knowledge(struct player *pplayer,struct tile *ptile);
 void update_tile_knowledge(struct tile *ptile);
 void update_player_tile_last_seen(struct player *pplayer, struct tile *ptile);
@@ -105,6 +132,8 @@ void disable_fog_of_war(void);
 void enable_fog_of_war_player(struct player *pplayer);
 void disable_fog_of_war_player(struct player *pplayer);
 
+void map_borders_freeze(void);
+void map_borders_thaw(void);
 void map_calculate_borders(void);
 void map_claim_border(struct tile *ptile, struct player *powner,
                       int radius_sq);
@@ -130,8 +159,11 @@ void bounce_units_on_terrain_change(struct tile *ptile);
 void vision_change_sight(struct vision *vision,
                          const v_radius_t radius_sq);
 void vision_clear_sight(struct vision *vision);
+void vision_replace_sight(struct vision *vision, struct vision *old_vision,
+                          const v_radius_t radius_sq);
 
-void change_playertile_site(struct player_tile *ptile,
+void change_playertile_site(struct tile *ptile,
+                            struct player *pplayer,
                             struct vision_site *new_site);
 
 void create_extra(struct tile *ptile, struct extra_type *pextra,
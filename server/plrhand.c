@@ -29,6 +29,7 @@
 /* common */
 #include "citizens.h"
 #include "diptreaty.h"
+#include "effects.h"
 #include "government.h"
 #include "movement.h"
 #include "multipliers.h"
@@ -40,6 +41,9 @@
 #include "tech.h"
 #include "unitlist.h"
 
+/* common/aicore */
+#include "path_finding.h"
+
 /* common/scriptcore */
 #include "luascript_types.h"
 
@@ -122,6 +126,7 @@ void kill_player(struct player *pplayer)
   struct player *barbarians = NULL;
 
   pplayer->is_alive = FALSE;
+  effect_cache_invalidate();
 
   /* reset player status */
   player_status_reset(pplayer);
@@ -177,6 +182,7 @@ void kill_player(struct player *pplayer)
       /* out of sheer cruelty we reanimate the player 
        * so he can behold what happens to his empire */
       pplayer->is_alive = TRUE;
+      effect_cache_invalidate();
       (void) civil_war(pplayer);
     } else {
       log_verbose("The empire of %s is too small for civil war.",
@@ -184,6 +190,7 @@ void kill_player(struct player *pplayer)
     }
   }
   pplayer->is_alive = FALSE;
+  effect_cache_invalidate();
 
   if (game.info.gameloss_style & GAMELOSS_STYLE_BARB) {
     /* if parameter, create a barbarian, if possible */
@@ -233,6 +240,7 @@ void kill_player(struct player *pplayer)
   } unit_list_iterate_safe_end;
 
   /* Remove ownership of tiles */
+  map_borders_freeze();
   whole_map_iterate(ptile) {
     if (tile_owner(ptile) == pplayer) {
       map_claim_ownership(ptile, NULL, NULL, FALSE);
@@ -241,6 +249,7 @@ void kill_player(struct player *pplayer)
       ptile->extras_owner = NULL;
     }
   } whole_map_iterate_end;
+  map_borders_thaw();
 
   /* Ensure this dead player doesn't win with a spaceship.
    * Now that would be truly unbelievably dumb - Per */
@@ -746,6 +755,8 @@ void handle_diplomacy_cancel_pact(struct player *pplayer,
   /* do the change */
   ds_plrplr2->type = ds_plr2plr->type = new_type;
   ds_plrplr2->turns_left = ds_plr2plr->turns_left = 16;
+  pf_map_pool_flush();
+  effect_cache_invalidate();
 
   if (new_type == DS_WAR) {
     pplayer->last_war_action = game.info.turn;
@@ -789,6 +800,7 @@ void handle_diplomacy_cancel_pact(struct player *pplayer,
     enter_war(pplayer, pplayer2);
   }
   ds_plrplr2->has_reason_to_cancel = 0;
+  effect_cache_invalidate();
 
   send_player_all_c(pplayer, NULL);
   send_player_all_c(pplayer2, NULL);
@@ -831,6 +843,7 @@ void handle_diplomacy_cancel_pact(struct player *pplayer,
                       player_name(pplayer),
                       player_name(pplayer2));
         player_diplstate_get(other, pplayer)->has_reason_to_cancel = 1;
+        effect_cache_invalidate();
         handle_diplomacy_cancel_pact(other, player_number(pplayer),
                                      CLAUSE_ALLIANCE);
       } else {
@@ -1614,6 +1627,7 @@ struct player *server_create_player(int player_id, const char *ai_tname,
   if (NULL == pplayer) {
     return NULL;
   }
+  effect_cache_invalidate();
 
   if (allow_ai_type_fallbacking) {
     pplayer->savegame_ai_type_name = fc_strdup(ai_tname);
@@ -1685,6 +1699,7 @@ void server_remove_player(struct player *pplayer)
       remove_shared_vision(aplayer, pplayer);
     }
   } players_iterate_end;
+  effect_cache_invalidate();
 
   /* Remove citizens of this player from the cities of all other players. */
   /* FIXME: add a special case if the server quits - no need to run this for
@@ -2023,6 +2038,8 @@ void make_contact(struct player *pplayer1, struct player *pplayer2,
 
     ds_plr1plr2->type = new_state;
     ds_plr2plr1->type = new_state;
+    pf_map_pool_flush();
+    effect_cache_invalidate();
     ds_plr1plr2->first_contact_turn = game.info.turn;
     ds_plr2plr1->first_contact_turn = game.info.turn;
     notify_player(pplayer1, ptile, E_FIRST_CONTACT, ftc_server,
@@ -2506,6 +2523,7 @@ static struct player *split_player(struct player *pplayer)
     ds_oc->has_reason_to_cancel = 0;
     ds_oc->turns_left = 0;
     ds_oc->contact_turns_left = 0;
+    effect_cache_invalidate();
 
     /* Send so that other_player sees updated diplomatic info;
      * pplayer will be sent later anyway
@@ -2537,7 +2555,7 @@ static struct player *split_player(struct player *pplayer)
   cplayer->phase_done = TRUE; /* Have other things to think
 				 about - paralysis */
   BV_CLR_ALL(cplayer->real_embassy);   /* all embassies destroyed */
-  research_update(new_research);
+  research_update(new_research);  /* Also invalidates the effect cache. */
 
   /* Do the ai */
   set_as_ai(cplayer);
@@ -2555,6 +2573,7 @@ static struct player *split_player(struct player *pplayer)
   old_research->bulbs_researched = 0;
   old_research->researching_saved = A_UNKNOWN;
   BV_CLR_ALL(pplayer->real_embassy);   /* all embassies destroyed */
+  effect_cache_invalidate();
 
   /* give splitted player the embassies to his team mates back, if any */
   if (pplayer->team) {
@@ -15,6 +15,8 @@
 #include <fc_config.h>
 #endif
 
+#include <string.h>
+
 /* utility */
 #include "bitvector.h"
 #include "log.h"
@@ -106,6 +108,41 @@ static void check_specials(const char *file, const char *function, int line)
   } whole_map_iterate_end;
 }
 
+/**************************************************************************
+  Sanity checking on the packed map arrays; they must match the tiles.
+**************************************************************************/
+static void check_packed_map(const char *file, const char *function,
+                             int line)
+{
+  int extra_tiles[MAX_EXTRA_TYPES];
+
+  memset(extra_tiles, 0, sizeof(extra_tiles));
+  whole_map_iterate(ptile) {
+    int tindex = tile_index(ptile);
+
+    SANITY_TILE(ptile, map_packed_terrain(tindex)
+                       == terrain_number(tile_terrain(ptile)));
+    SANITY_TILE(ptile, map_packed_owner(tindex)
+                       == (NULL != tile_owner(ptile)
+                           ? player_number(tile_owner(ptile))
+                           : MAP_TILE_OWNER_NULL));
+    SANITY_TILE(ptile, map_packed_continent(tindex)
+                       == tile_continent(ptile));
+    SANITY_TILE(ptile, BV_ARE_EQUAL(*map_packed_extras(tindex),
+                                    *tile_extras(ptile)));
+    extra_type_iterate(pextra) {
+      if (tile_has_extra(ptile, pextra)) {
+        extra_tiles[extra_index(pextra)]++;
+      }
+    } extra_type_iterate_end;
+  } whole_map_iterate_end;
+
+  extra_type_iterate(pextra) {
+    SANITY_CHECK(map_packed_extra_tiles(extra_index(pextra))
+                 == extra_tiles[extra_index(pextra)]);
+  } extra_type_iterate_end;
+}
+
 /**************************************************************************
   Sanity checking on fog-of-war (visibility, shared vision, etc.).
 **************************************************************************/
@@ -648,6 +685,7 @@ void real_sanity_check(const char *file, const char *function, int line)
     /* Don't sanity-check the map if it hasn't been created yet (this
      * happens when loading scenarios). */
     check_specials(file, function, line);
+    check_packed_map(file, function, line);
     check_map(file, function, line);
     check_cities(file, function, line);
     check_units(file, function, line);
@@ -114,6 +114,14 @@ struct loaddata {
 
   /* loaded in sg_load_map_worked(); needed in sg_load_player_cities() */
   int *worked_tiles;
+
+  /* Time spent in the steps done player by player (savegame3 only). */
+  struct {
+    struct timer *main;
+    struct timer *cities;
+    struct timer *units;
+    struct timer *vision;
+  } timers;
 };
 
 #define log_sg log_error
@@ -0,0 +1,537 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <string.h>
+
+/* utility */
+#include "log.h"
+#include "mem.h"
+#include "registry.h"
+#include "shared.h"
+#include "string_vector.h"
+#include "support.h"
+
+#include "savedelta.h"
+
+/* The section of a delta save which refers to its base. */
+#define SAVEDELTA_SECTION "savedelta"
+
+/* Longest "section.entry" path of an entry. */
+#define SAVEDELTA_MAX_PATH 1024
+
+/* Builds "section.entry" paths, formatting the section part once. */
+struct delta_path {
+  char buf[SAVEDELTA_MAX_PATH];
+  size_t prefix_len;
+};
+
+/* What is known of an entry of the base. */
+struct delta_entry {
+  uint64_t digest;
+  int seen;             /* Number of the last delta save having the entry. */
+};
+
+#define SPECHASH_TAG delta_entry
+#define SPECHASH_ASTR_KEY_TYPE
+#define SPECHASH_IDATA_TYPE struct delta_entry *
+#define SPECHASH_IDATA_FREE (delta_entry_hash_data_free_fn_t) free
+#include "spechash.h"
+#define delta_entry_hash_iterate(hash, path, pdelta)                        \
+  TYPED_HASH_ITERATE(const char *, struct delta_entry *, hash, path, pdelta)
+#define delta_entry_hash_iterate_end HASH_ITERATE_END
+
+/* The last full save made in delta mode. Delta saves started by a
+ * separate process (see save_game_background()) work on its copy, so it
+ * is only ever updated by the base saves. */
+static struct {
+  char filename[MAX_LEN_PATH];
+  struct delta_entry_hash *entries;     /* By entry path. */
+  uint64_t id;                          /* Identifies the base file. */
+  int deltas;                           /* Delta saves made against it. */
+  bool complete;                        /* The base was saved. */
+} base;
+
+/**************************************************************************
+  Add 'len' bytes of 'data' to the FNV-1a digest.
+**************************************************************************/
+static uint64_t digest_add(uint64_t digest, const void *data, size_t len)
+{
+  const unsigned char *bytes = data;
+  size_t i;
+
+  for (i = 0; i < len; i++) {
+    digest ^= bytes[i];
+    digest *= 0x100000001b3ULL;
+  }
+
+  return digest;
+}
+
+/**************************************************************************
+  Returns the digest of the path, the type and the value of the entry.
+  Without 'exact', float values are left out, as they don't come back
+  unchanged from a text file.
+**************************************************************************/
+static uint64_t entry_digest(const char *path, const struct entry *pentry,
+                             bool exact)
+{
+  uint64_t digest = digest_add(0xcbf29ce484222325ULL, path,
+                               strlen(path) + 1);
+  unsigned char byte = entry_type(pentry);
+
+  digest = digest_add(digest, &byte, sizeof(byte));
+
+  switch (entry_type(pentry)) {
+  case ENTRY_BOOL:
+    {
+      bool value;
+
+      entry_bool_get(pentry, &value);
+      byte = value;
+      digest = digest_add(digest, &byte, sizeof(byte));
+    }
+    break;
+  case ENTRY_INT:
+    {
+      int value;
+
+      entry_int_get(pentry, &value);
+      digest = digest_add(digest, &value, sizeof(value));
+    }
+    break;
+  case ENTRY_FLOAT:
+    if (exact) {
+      float value;
+
+      entry_float_get(pentry, &value);
+      digest = digest_add(digest, &value, sizeof(value));
+    }
+    break;
+  case ENTRY_STR:
+    {
+      const char *value;
+
+      entry_str_get(pentry, &value);
+      digest = digest_add(digest, value, strlen(value) + 1);
+      byte = entry_str_escaped(pentry);
+      digest = digest_add(digest, &byte, sizeof(byte));
+    }
+    break;
+  case ENTRY_FILEREFERENCE:
+    /* Not used by savegames. */
+    break;
+  }
+
+  return digest;
+}
+
+/**************************************************************************
+  Start the paths of the entries of the section.
+**************************************************************************/
+static void delta_path_section(struct delta_path *path,
+                               const struct section *psection)
+{
+  path->prefix_len = fc_snprintf(path->buf, sizeof(path->buf), "%s.",
+                                 section_name(psection));
+}
+
+/**************************************************************************
+  Returns the path of the entry, of the section last given to
+  delta_path_section().
+**************************************************************************/
+static const char *delta_path_entry(struct delta_path *path,
+                                    const struct entry *pentry)
+{
+  fc_strlcpy(path->buf + path->prefix_len, entry_name(pentry),
+             sizeof(path->buf) - path->prefix_len);
+
+  return path->buf;
+}
+
+/**************************************************************************
+  Forget the base, so the next save in delta mode has to be a full one.
+**************************************************************************/
+void savedelta_free(void)
+{
+  if (NULL != base.entries) {
+    delta_entry_hash_destroy(base.entries);
+  }
+  memset(&base, 0, sizeof(base));
+}
+
+/**************************************************************************
+  A full save in delta mode is starting: it will be the base of the
+  next delta saves. Its sections must be given to
+  savedelta_base_record() as they are completed.
+**************************************************************************/
+void savedelta_base_begin(const char *filename)
+{
+  savedelta_free();
+  sz_strlcpy(base.filename, filename);
+  base.entries = delta_entry_hash_new();
+}
+
+/**************************************************************************
+  Remember the digests of the entries of these completed sections of
+  the base.
+**************************************************************************/
+void savedelta_base_record(const struct section_list *sections)
+{
+  struct delta_path dpath;
+
+  fc_assert_ret(NULL != base.entries);
+
+  section_list_iterate(sections, psection) {
+    delta_path_section(&dpath, psection);
+    entry_list_iterate(section_entries(psection), pentry) {
+      struct delta_entry *pdelta = fc_malloc(sizeof(*pdelta));
+      const char *path = delta_path_entry(&dpath, pentry);
+
+      pdelta->digest = entry_digest(path, pentry, TRUE);
+      pdelta->seen = 0;
+      delta_entry_hash_replace(base.entries, path, pdelta);
+      base.id += entry_digest(path, pentry, FALSE);
+    } entry_list_iterate_end;
+  } section_list_iterate_end;
+}
+
+/**************************************************************************
+  The base save is over. Unless it succeeded, there is no base.
+**************************************************************************/
+void savedelta_base_end(bool ok)
+{
+  if (ok) {
+    base.complete = TRUE;
+  } else {
+    savedelta_free();
+  }
+}
+
+/**************************************************************************
+  Returns whether delta saves can be made.
+**************************************************************************/
+bool savedelta_base_exists(void)
+{
+  return base.complete;
+}
+
+/**************************************************************************
+  Returns the number of delta saves made against the base.
+**************************************************************************/
+int savedelta_count(void)
+{
+  return base.deltas;
+}
+
+/**************************************************************************
+  A delta save is starting. Its sections must be given to
+  savedelta_reduce() before being written, then savedelta_end() adds
+  the reference to the base.
+**************************************************************************/
+void savedelta_begin(void)
+{
+  fc_assert_ret(base.complete);
+
+  base.deltas++;
+}
+
+/**************************************************************************
+  Add a copy of the entry to the section.
+**************************************************************************/
+static void delta_entry_copy(struct section *psection,
+                             const struct entry *pentry)
+{
+  const char *name = entry_name(pentry);
+
+  switch (entry_type(pentry)) {
+  case ENTRY_BOOL:
+    {
+      bool value;
+
+      entry_bool_get(pentry, &value);
+      section_entry_bool_new(psection, name, value);
+    }
+    break;
+  case ENTRY_INT:
+    {
+      int value;
+
+      entry_int_get(pentry, &value);
+      section_entry_int_new(psection, name, value);
+    }
+    break;
+  case ENTRY_FLOAT:
+    {
+      float value;
+
+      entry_float_get(pentry, &value);
+      section_entry_float_new(psection, name, value);
+    }
+    break;
+  case ENTRY_STR:
+    {
+      const char *value;
+
+      entry_str_get(pentry, &value);
+      section_entry_str_new(psection, name, value,
+                            entry_str_escaped(pentry));
+    }
+    break;
+  case ENTRY_FILEREFERENCE:
+    /* Not used by savegames. */
+    break;
+  }
+}
+
+/**************************************************************************
+  Returns whether the entry differs from the base, and notes that it is
+  still there.
+**************************************************************************/
+static bool entry_changed(struct delta_path *dpath,
+                          const struct entry *pentry)
+{
+  const char *path = delta_path_entry(dpath, pentry);
+  struct delta_entry *pdelta;
+
+  if (!delta_entry_hash_lookup(base.entries, path, &pdelta)) {
+    return TRUE;
+  }
+
+  pdelta->seen = base.deltas;
+  return (pdelta->digest != entry_digest(path, pentry, TRUE));
+}
+
+/**************************************************************************
+  Returns the sections of the delta save made of these completed
+  sections, which are freed: only the entries which are not the same in
+  the base are kept, and the sections which are left with some. The
+  entries of a table row, like "u3.x" and "u3.y", are kept together when
+  one of them changed, so the text format can still write them as a
+  table.
+**************************************************************************/
+struct section_list *savedelta_reduce(struct section_list *sections)
+{
+  struct section_file *dfile;
+  struct section_list *reduced;
+
+  fc_assert_ret_val(base.complete, sections);
+
+  /* Copying the few entries to keep is much faster than removing the
+   * others from the long entry lists. */
+  dfile = secfile_new(TRUE);
+  section_list_iterate(sections, psection) {
+    const struct entry_list_link *plink =
+        entry_list_head(section_entries(psection));
+    struct section *pdelta_section = NULL;
+    struct delta_path dpath;
+
+    if (NULL == plink) {
+      /* Keep it, in case the base has entries there. */
+      secfile_section_new(dfile, section_name(psection));
+      continue;
+    }
+
+    delta_path_section(&dpath, psection);
+    while (NULL != plink) {
+      const char *name = entry_name(entry_list_link_data(plink));
+      const char *dot = strchr(name, '.');
+      size_t row_len = (NULL != dot ? dot - name + 1 : 0);
+      const struct entry_list_link *row_end = plink;
+      bool changed = FALSE;
+
+      do {
+        if (entry_changed(&dpath, entry_list_link_data(row_end))) {
+          changed = TRUE;
+        }
+        row_end = entry_list_link_next(row_end);
+      } while (NULL != row_end && 0 < row_len
+               && 0 == strncmp(entry_name(entry_list_link_data(row_end)),
+                               name, row_len));
+
+      if (changed && NULL == pdelta_section) {
+        pdelta_section = secfile_section_new(dfile, section_name(psection));
+      }
+      for (; plink != row_end; plink = entry_list_link_next(plink)) {
+        if (changed) {
+          delta_entry_copy(pdelta_section, entry_list_link_data(plink));
+        }
+      }
+    }
+  } section_list_iterate_end;
+  section_list_destroy(sections);
+
+  reduced = secfile_sections_detach(dfile);
+  secfile_destroy(dfile);
+
+  return reduced;
+}
+
+/**************************************************************************
+  Add to the delta save the reference to the base and the list of the
+  base entries which were in none of the reduced sections.
+**************************************************************************/
+void savedelta_end(struct section_file *sfile)
+{
+  struct strvec *removed = strvec_new();
+  char id[17];
+
+  fc_assert(base.complete);
+
+  delta_entry_hash_iterate(base.entries, path, pdelta) {
+    if (pdelta->seen != base.deltas) {
+      strvec_append(removed, path);
+    }
+  } delta_entry_hash_iterate_end;
+  /* The hash table order is not reproducible. */
+  strvec_sort(removed, compare_strings_strvec);
+
+  fc_snprintf(id, sizeof(id), "%08x%08x", (unsigned) (base.id >> 32),
+              (unsigned) (base.id & 0xffffffff));
+  secfile_insert_str(sfile, fc_basename(base.filename),
+                     SAVEDELTA_SECTION ".base");
+  secfile_insert_str(sfile, id, SAVEDELTA_SECTION ".id");
+  secfile_insert_int(sfile, base.deltas, SAVEDELTA_SECTION ".number");
+  secfile_insert_str_vec(sfile, strvec_data(removed), strvec_size(removed),
+                         SAVEDELTA_SECTION ".removed");
+
+  strvec_destroy(removed);
+}
+
+/**************************************************************************
+  Returns whether the loaded file is a delta save.
+**************************************************************************/
+bool savedelta_check(const struct section_file *sfile)
+{
+  return (NULL != secfile_section_by_name(sfile, SAVEDELTA_SECTION));
+}
+
+/**************************************************************************
+  Rebuild the full save from the delta save 'sfile', loaded from
+  'filename', and its base, which must be in the same directory. The
+  delta is destroyed. Returns NULL on error.
+**************************************************************************/
+struct section_file *savedelta_resolve(struct section_file *sfile,
+                                       const char *filename)
+{
+  struct section_file *bfile;
+  const char *base_name, *id;
+  const char **removed;
+  char path[MAX_LEN_PATH];
+  char base_id[17];
+  const char *slash;
+  uint64_t digests = 0;
+  size_t count, i;
+
+  base_name = secfile_lookup_str(sfile, SAVEDELTA_SECTION ".base");
+  id = secfile_lookup_str(sfile, SAVEDELTA_SECTION ".id");
+  if (NULL == base_name || NULL == id) {
+    log_error("Invalid delta save %s: %s", filename, secfile_error());
+    secfile_destroy(sfile);
+    return NULL;
+  }
+
+  /* The base must be a plain file name, in the directory of the delta;
+   * the delta may come from anywhere. */
+  if (!is_safe_filename(base_name) || NULL != strchr(base_name, '/')) {
+    log_error("Invalid delta save %s: unsafe base file name \"%s\".",
+              filename, base_name);
+    secfile_destroy(sfile);
+    return NULL;
+  }
+
+  slash = strrchr(filename, '/');
+  if (NULL != slash) {
+    fc_snprintf(path, sizeof(path), "%.*s/%s", (int) (slash - filename),
+                filename, base_name);
+  } else {
+    sz_strlcpy(path, base_name);
+  }
+
+  bfile = secfile_load(path, FALSE);
+  if (NULL == bfile) {
+    log_error("Could not load %s, the base of the delta save %s: %s",
+              path, filename, secfile_error());
+    secfile_destroy(sfile);
+    return NULL;
+  }
+
+  section_list_iterate(secfile_sections(bfile), psection) {
+    struct delta_path dpath;
+
+    delta_path_section(&dpath, psection);
+    entry_list_iterate(section_entries(psection), pentry) {
+      digests += entry_digest(delta_path_entry(&dpath, pentry), pentry,
+                              FALSE);
+    } entry_list_iterate_end;
+  } section_list_iterate_end;
+  fc_snprintf(base_id, sizeof(base_id), "%08x%08x",
+              (unsigned) (digests >> 32), (unsigned) (digests & 0xffffffff));
+  if (0 != strcmp(base_id, id)) {
+    log_error("%s is not the base of the delta save %s.", path, filename);
+    secfile_destroy(bfile);
+    secfile_destroy(sfile);
+    return NULL;
+  }
+
+  section_list_iterate(secfile_sections(sfile), pdelta_section) {
+    const char *name = section_name(pdelta_section);
+    struct section *psection;
+
+    if (0 == strcmp(name, SAVEDELTA_SECTION)) {
+      continue;
+    }
+
+    psection = secfile_section_by_name(bfile, name);
+    if (NULL == psection) {
+      psection = secfile_section_new(bfile, name);
+    }
+    entry_list_iterate(section_entries(pdelta_section), pdelta) {
+      char epath[SAVEDELTA_MAX_PATH];
+
+      /* The entries of the base are replaced rather than updated: the
+       * order doesn't matter to the loading, and this needs the fast
+       * lookup by path rather than section_entry_by_name(). */
+      entry_path(pdelta, epath, sizeof(epath));
+      entry_destroy(secfile_entry_by_path(bfile, epath));
+      delta_entry_copy(psection, pdelta);
+    } entry_list_iterate_end;
+  } section_list_iterate_end;
+
+  removed = secfile_lookup_str_vec(sfile, &count,
+                                   SAVEDELTA_SECTION ".removed");
+  for (i = 0; i < count; i++) {
+    struct entry *pentry = secfile_entry_by_path(bfile, removed[i]);
+    struct section *psection;
+
+    if (NULL == pentry) {
+      continue;
+    }
+    psection = entry_section(pentry);
+    entry_destroy(pentry);
+    if (0 == entry_list_size(section_entries(psection))
+        && NULL == secfile_section_by_name(sfile, section_name(psection))) {
+      /* Not in the game any more. */
+      section_destroy(psection);
+    }
+  }
+  free(removed);
+
+  log_verbose("Loaded the delta save %s over %s.", filename, path);
+  secfile_destroy(sfile);
+
+  return bfile;
+}
@@ -0,0 +1,46 @@
+/**********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+#ifndef FC__SAVEDELTA_H
+#define FC__SAVEDELTA_H
+
+/* utility */
+#include "support.h"            /* bool type */
+
+struct section_file;
+struct section_list;
+
+/* A delta save only holds the entries which differ from the last full
+ * save, the base, and the list of the base entries which are gone. It
+ * is always relative to the base, never to another delta, so loading
+ * it takes the base and this one file. */
+
+/* Saving the base. */
+void savedelta_base_begin(const char *filename);
+void savedelta_base_record(const struct section_list *sections);
+void savedelta_base_end(bool ok);
+
+/* Saving a delta. */
+bool savedelta_base_exists(void);
+int savedelta_count(void);
+void savedelta_begin(void);
+struct section_list *savedelta_reduce(struct section_list *sections);
+void savedelta_end(struct section_file *sfile);
+
+/* Loading. */
+bool savedelta_check(const struct section_file *sfile);
+struct section_file *savedelta_resolve(struct section_file *sfile,
+                                       const char *filename);
+
+void savedelta_free(void);
+
+#endif /* FC__SAVEDELTA_H */
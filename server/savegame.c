@@ -15,26 +15,54 @@
 #include <fc_config.h>
 #endif
 
+#include "fc_prehdrs.h"
+
+#include <errno.h>
+
+#ifdef FREECIV_HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_WAIT_H
+#include <sys/wait.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 /* utility */
+#include "fcthread.h"
+#include "genlist.h"
 #include "log.h"
 #include "mem.h"
 #include "registry.h"
 
 /* common */
 #include "capability.h"
+#include "effects.h"
 #include "game.h"
+#include "map.h"
 
 /* server */
 #include "console.h"
 #include "legacysave.h"
 #include "notify.h"
+#include "savedelta.h"
 #include "savegame2.h"
 #include "savegame3.h"
 
 #include "savegame.h"
 
+#if defined(HAVE_WORKING_FORK) && !defined(FREECIV_MSWINDOWS)
+#define HAVE_USABLE_FORK
+#endif
+
 static fc_thread *save_thread = NULL;
 
+#ifdef HAVE_USABLE_FORK
+/* The process writing a background save, or -1. */
+static pid_t save_child = -1;
+#endif
+
 /****************************************************************************
   Main entry point for loading a game.
 ****************************************************************************/
@@ -69,6 +97,9 @@ void savegame_load(struct section_file *sfile)
     secfile_allow_digital_boolean(sfile, TRUE);
     legacy_game_load(sfile);
   }
+  effect_cache_invalidate();
+  /* The loaders write the tile terrain and extras directly. */
+  map_packed_update_all();
 
 #ifdef DEBUG_TIMERS
   timer_stop(loadtimer);
@@ -81,53 +112,277 @@ void savegame_load(struct section_file *sfile)
   Main entry point for saving a game.
 ****************************************************************************/
 void savegame_save(struct section_file *sfile, const char *save_reason,
-                   bool scenario)
+                   bool scenario, savegame_flush_fn flush,
+                   void *flush_data)
 {
-  savegame3_save(sfile, save_reason, scenario);
+  savegame3_save(sfile, save_reason, scenario, flush, flush_data);
 }
 
+/* How a save relates to the delta saves (see savedelta.h). */
+enum save_delta_mode {
+  SDM_NONE,     /* Not in delta mode. */
+  SDM_BASE,     /* Full save the next delta saves will refer to. */
+  SDM_DELTA     /* Only the differences with the base. */
+};
+
 struct save_thread_data
 {
-  struct section_file *sfile;
   char filepath[600];
   int save_compress_level;
   enum fz_method save_compress_type;
+  bool save_compress_long;
+  bool save_binary;
+  enum save_delta_mode delta;
+
+  /* The sections are written to 'fs' as soon as savegame_save() has
+   * completed them, so only the sections of the current step sit in
+   * memory. The main thread still builds every entry of the registry,
+   * so saving blocks it as long as before. With a saving thread, it
+   * only detaches the sections and queues them in 'pending'. */
+  fz_FILE *fs;
+  struct binfile_writer *writer;  /* Only for binary saves. */
+  bool ok;
+  bool threaded;
+  fc_mutex mutex;              /* Protects 'pending' and 'complete'. */
+  fc_thread_cond cond;         /* Signaled when either changes. */
+  struct genlist *pending;     /* Of struct section_list *. */
+  bool complete;
 };
 
 /*************************************************************************
-  Run game saving thread.
+  Open the save file and prepare the queue of sections.
 *************************************************************************/
-static void save_thread_run(void *arg)
+static void save_stream_open(struct save_thread_data *stdata)
 {
-  struct save_thread_data *stdata = (struct save_thread_data *)arg;
-  
-  if (!secfile_save(stdata->sfile, stdata->filepath, stdata->save_compress_level,
-                    stdata->save_compress_type)) {
+  stdata->fs = fz_from_file(stdata->filepath, "w",
+                            stdata->save_compress_type,
+                            stdata->save_compress_level);
+  if (NULL != stdata->fs && stdata->save_compress_long) {
+    /* Not an error for the methods without long range mode. */
+    fz_set_long_range(stdata->fs, TRUE);
+  }
+  stdata->ok = (NULL != stdata->fs);
+  stdata->writer = (stdata->ok && stdata->save_binary
+                    ? binfile_writer_new(stdata->fs, stdata->filepath)
+                    : NULL);
+  stdata->pending = genlist_new();
+  stdata->complete = FALSE;
+}
+
+/*************************************************************************
+  Write the sections to the save file and free them.
+*************************************************************************/
+static void save_stream_write(struct save_thread_data *stdata,
+                              struct section_list *sections)
+{
+  if (!stdata->ok) {
+    /* Nothing more to write. */
+  } else if (NULL != stdata->writer) {
+    stdata->ok = binfile_writer_add(stdata->writer, sections);
+  } else {
+    stdata->ok = secfile_sections_save(sections, stdata->fs,
+                                       stdata->filepath);
+  }
+  section_list_destroy(sections);
+}
+
+/*************************************************************************
+  savegame_save() callback: take out the completed sections and write
+  them, or queue them for the saving thread.
+*************************************************************************/
+static void save_stream_flush(struct section_file *sfile, void *data)
+{
+  struct save_thread_data *stdata = (struct save_thread_data *) data;
+  struct section_list *sections;
+
+  if (0 == section_list_size(secfile_sections(sfile))) {
+    return;
+  }
+
+  sections = secfile_sections_detach(sfile);
+  if (SDM_BASE == stdata->delta) {
+    savedelta_base_record(sections);
+  } else if (SDM_DELTA == stdata->delta) {
+    sections = savedelta_reduce(sections);
+  }
+
+  if (stdata->threaded) {
+    fc_allocate_mutex(&stdata->mutex);
+    genlist_append(stdata->pending, sections);
+    fc_thread_cond_signal(&stdata->cond);
+    fc_release_mutex(&stdata->mutex);
+  } else {
+    save_stream_write(stdata, sections);
+  }
+}
+
+/*************************************************************************
+  Flush what savegame_save() left in the section file. A delta save ends
+  with the reference to its base, which can only be made once all the
+  other sections are reduced.
+*************************************************************************/
+static void save_stream_flush_last(struct section_file *sfile,
+                                   struct save_thread_data *stdata)
+{
+  save_stream_flush(sfile, stdata);
+  if (SDM_DELTA == stdata->delta) {
+    savedelta_end(sfile);
+    save_stream_flush(sfile, stdata);
+  }
+}
+
+/*************************************************************************
+  Close the save file and report the result. Returns TRUE iff the game
+  was successfully saved.
+*************************************************************************/
+static bool save_stream_close(struct save_thread_data *stdata)
+{
+  genlist_destroy(stdata->pending);
+
+  if (NULL != stdata->writer) {
+    /* Write the section index. */
+    stdata->ok = binfile_writer_close(stdata->writer) && stdata->ok;
+    stdata->writer = NULL;
+  }
+
+  if (NULL == stdata->fs) {
+    con_write(C_FAIL, _("Failed saving game as %s"), stdata->filepath);
+    log_error("Game saving failed: could not open %s", stdata->filepath);
+  } else if (!stdata->ok || 0 != fz_ferror(stdata->fs)) {
+    con_write(C_FAIL, _("Failed saving game as %s"), stdata->filepath);
+    log_error("Game saving failed: %s", fz_strerror(stdata->fs));
+    fz_fclose(stdata->fs);
+  } else if (0 != fz_fclose(stdata->fs)) {
     con_write(C_FAIL, _("Failed saving game as %s"), stdata->filepath);
-    log_error("Game saving failed: %s", secfile_error());
+    log_error("Game saving failed: error closing %s", stdata->filepath);
   } else {
     con_write(C_OK, _("Game saved as %s"), stdata->filepath);
+    return TRUE;
   }
 
-  secfile_destroy(stdata->sfile);
+  return FALSE;
+}
+
+/*************************************************************************
+  Run game saving thread: write the queued sections until the game is
+  completely saved, then close the file.
+*************************************************************************/
+static void save_thread_run(void *arg)
+{
+  struct save_thread_data *stdata = (struct save_thread_data *)arg;
+  bool ok;
+
+  if (stdata->threaded) {
+    fc_allocate_mutex(&stdata->mutex);
+    for (;;) {
+      struct section_list *sections;
+
+      if (0 == genlist_size(stdata->pending)) {
+        if (stdata->complete) {
+          break;
+        }
+        fc_thread_cond_wait(&stdata->cond, &stdata->mutex);
+        continue;
+      }
+
+      sections = genlist_front(stdata->pending);
+      genlist_pop_front(stdata->pending);
+      fc_release_mutex(&stdata->mutex);
+      save_stream_write(stdata, sections);
+      fc_allocate_mutex(&stdata->mutex);
+    }
+    fc_release_mutex(&stdata->mutex);
+
+    fc_thread_cond_destroy(&stdata->cond);
+    fc_destroy_mutex(&stdata->mutex);
+  }
+  ok = save_stream_close(stdata);
+  if (SDM_BASE == stdata->delta) {
+    /* Base saves are not threaded: this is the main thread. */
+    savedelta_base_end(ok);
+  }
   free(arg);
 }
 
+#ifdef HAVE_USABLE_FORK
+/*************************************************************************
+  Wait for the end of the background save process, if any.
+*************************************************************************/
+static void save_child_wait(void)
+{
+  int status;
+  pid_t ret;
+
+  if (0 >= save_child) {
+    return;
+  }
+
+  do {
+    ret = waitpid(save_child, &status, 0);
+  } while (0 > ret && EINTR == errno);
+
+  if (0 > ret) {
+    log_error("Could not wait for the saving process: %s",
+              fc_strerror(fc_get_errno()));
+  } else if (!WIFEXITED(status)) {
+    log_error("The saving process died unexpectedly.");
+  }
+  save_child = -1;
+}
+
+/*************************************************************************
+  Body of the background save process. Its memory is a copy-on-write
+  snapshot of the server taken by fork(), so it can collect the game
+  state at leisure while the server goes on. Never returns.
+*************************************************************************/
+static void save_child_run(struct save_thread_data *stdata,
+                           const char *save_reason)
+{
+  struct section_file *sfile;
+  bool ok;
+
+  /* The connections are shared with the server: log messages must not
+   * be sent to the clients from here. */
+  log_set_callback(NULL);
+
+  save_stream_open(stdata);
+  stdata->threaded = FALSE;
+
+  sfile = secfile_new(TRUE);
+  savegame_save(sfile, save_reason, FALSE, save_stream_flush, stdata);
+  save_stream_flush_last(sfile, stdata);
+
+  ok = save_stream_close(stdata);
+  con_flush();
+
+  /* Don't run the exit handlers of the server, nor free anything. */
+  _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+#endif /* HAVE_USABLE_FORK */
+
 /**************************************************************************
-  Unconditionally save the game, with specified filename.
-  Always prints a message: either save ok, or failed.
+  Save the game with specified filename. With 'background', the game is
+  saved by a separate process where the platform allows it, and this
+  returns as soon as that process is started. Base saves for the delta
+  saves are always made by the server itself, without saving thread, as
+  the delta saves need to know what is in them.
 **************************************************************************/
-void save_game(const char *orig_filename, const char *save_reason,
-               bool scenario)
+static void save_game_real(const char *orig_filename,
+                           const char *save_reason, bool scenario,
+                           bool background, enum save_delta_mode delta)
 {
   char *dot, *filename;
   struct timer *timer_cpu, *timer_user;
   struct save_thread_data *stdata;
+  struct section_file *sfile;
 
   stdata = fc_malloc(sizeof(*stdata));
 
   stdata->save_compress_type = game.server.save_compress_type;
   stdata->save_compress_level = game.server.save_compress_level;
+  stdata->save_compress_long = game.server.save_compress_long;
+  stdata->save_binary = game.server.save_binary;
+  stdata->delta = delta;
 
   if (!orig_filename) {
     stdata->filepath[0] = '\0';
@@ -149,7 +404,8 @@ void save_game(const char *orig_filename, const char *save_reason,
       filename[0] = '\0';
     } else {
       char *end_dot;
-      char *strip_extensions[] = { ".sav", ".gz", ".bz2", ".xz", NULL };
+      char *strip_extensions[] = { ".sav", ".gz", ".bz2", ".xz", ".zst",
+                                   ".lz4", NULL };
       bool stripped = TRUE;
 
       while ((end_dot = strrchr(dot, '.')) && stripped) {
@@ -179,16 +435,6 @@ void save_game(const char *orig_filename, const char *save_reason,
   timer_user = timer_new(TIMER_USER, TIMER_ACTIVE);
   timer_start(timer_user);
 
-  /* Allowing duplicates shouldn't be allowed. However, it takes very too
-   * long time for huge game saving... */
-  stdata->sfile = secfile_new(TRUE);
-  savegame_save(stdata->sfile, save_reason, scenario);
-
-  /* We have consistent game state in stdata->sfile now, so
-   * we could pass it to the saving thread already. We want to
-   * handle below notify_conn() and directory creation in
-   * main thread, though. */
-
   /* Append ".sav" to filename. */
   sz_strlcat(stdata->filepath, ".sav");
 
@@ -211,6 +457,18 @@ void save_game(const char *orig_filename, const char *save_reason,
       /* Append ".xz" to filename. */
       sz_strlcat(stdata->filepath, ".xz");
       break;
+#endif
+#ifdef FREECIV_HAVE_LIBZSTD
+    case FZ_ZSTD:
+      /* Append ".zst" to filename. */
+      sz_strlcat(stdata->filepath, ".zst");
+      break;
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+    case FZ_LZ4:
+      /* Append ".lz4" to filename. */
+      sz_strlcat(stdata->filepath, ".lz4");
+      break;
 #endif
     case FZ_PLAIN:
       break;
@@ -246,21 +504,86 @@ void save_game(const char *orig_filename, const char *save_reason,
     sz_strlcpy(stdata->filepath, tmpname);
   }
 
+#ifdef HAVE_USABLE_FORK
+  /* Previously started process */
+  save_child_wait();
+#endif
+
   if (save_thread != NULL) {
-    /* Previously started thread */
+    /* Previously started thread. Not kept, as the next save may not
+     * start it again. */
     fc_thread_wait(save_thread);
-    if (!game.server.threaded_save) {
-      /* Setting has changed since the last save */
-      free(save_thread);
-      save_thread = NULL;
+    free(save_thread);
+    save_thread = NULL;
+  }
+
+  if (SDM_BASE == delta) {
+    savedelta_base_begin(stdata->filepath);
+    background = FALSE;
+  } else if (SDM_DELTA == delta) {
+    savedelta_begin();
+  }
+
+#ifdef HAVE_USABLE_FORK
+  if (background) {
+    pid_t pid;
+
+    /* Don't let the child output again what is still buffered. */
+    fflush(NULL);
+    pid = fork();
+    if (0 == pid) {
+      save_child_run(stdata, save_reason);
+    } else if (0 < pid) {
+      save_child = pid;
+      free(stdata);
+
+#ifdef LOG_TIMERS
+      log_verbose("Save time: %g seconds (%g apparent) to start the "
+                  "saving process", timer_read_seconds(timer_cpu),
+                  timer_read_seconds(timer_user));
+#endif
+
+      timer_destroy(timer_cpu);
+      timer_destroy(timer_user);
+      return;
     }
-  } else if (game.server.threaded_save) {
-    save_thread = fc_malloc(sizeof(save_thread));
+
+    log_error("Could not start the saving process: %s",
+              fc_strerror(fc_get_errno()));
   }
+#endif /* HAVE_USABLE_FORK */
 
-  if (save_thread != NULL) {
+  if (game.server.threaded_save && has_thread_cond_impl()
+      && SDM_BASE != delta) {
+    save_thread = fc_malloc(sizeof(*save_thread));
+  }
+
+  save_stream_open(stdata);
+  stdata->threaded = (save_thread != NULL);
+
+  if (stdata->threaded) {
+    fc_init_mutex(&stdata->mutex);
+    fc_thread_cond_init(&stdata->cond);
     fc_thread_start(save_thread, &save_thread_run, stdata);
+  }
+
+  /* Allowing duplicates shouldn't be allowed. However, it takes very too
+   * long time for huge game saving...
+   * The game is still saved through the registry, on this thread; only
+   * the writing of the completed sections is streamed. */
+  sfile = secfile_new(TRUE);
+  savegame_save(sfile, save_reason, scenario, save_stream_flush, stdata);
+  /* Anything not flushed by the savegame writer. */
+  save_stream_flush_last(sfile, stdata);
+  secfile_destroy(sfile);
+
+  if (stdata->threaded) {
+    fc_allocate_mutex(&stdata->mutex);
+    stdata->complete = TRUE;
+    fc_thread_cond_signal(&stdata->cond);
+    fc_release_mutex(&stdata->mutex);
   } else {
+    stdata->complete = TRUE;
     save_thread_run(stdata);
   }
 
@@ -273,15 +596,63 @@ void save_game(const char *orig_filename, const char *save_reason,
   timer_destroy(timer_user);
 }
 
+/**************************************************************************
+  Unconditionally save the game, with specified filename.
+  Always prints a message: either save ok, or failed.
+**************************************************************************/
+void save_game(const char *orig_filename, const char *save_reason,
+               bool scenario)
+{
+  save_game_real(orig_filename, save_reason, scenario, FALSE, SDM_NONE);
+}
+
+/**************************************************************************
+  Save the game like save_game(), but let the game go on meanwhile: where
+  fork() is usable, the whole save (collecting the game state included)
+  is done by a separate process working on a snapshot of the server.
+  Elsewhere, this is the same as save_game(), which may still compress
+  and write the file in a thread (see the 'threaded_save' setting).
+  The result is only printed to the console.
+**************************************************************************/
+void save_game_background(const char *filename, const char *save_reason)
+{
+  save_game_real(filename, save_reason, FALSE, TRUE, SDM_NONE);
+}
+
+/**************************************************************************
+  Save the game as a delta save when possible: only the entries which
+  differ from the last full save made by this function, the base, are
+  written. A full save is made when there is no base yet, or when
+  'savedeltas' delta saves were already made against it. Delta saves are
+  made in the background like with save_game_background(), but not the
+  base ones.
+**************************************************************************/
+void save_game_delta(const char *filename, const char *save_reason)
+{
+  if (savedelta_base_exists()
+      && savedelta_count() < game.server.save_deltas) {
+    save_game_real(filename, save_reason, FALSE,
+                   game.server.threaded_save, SDM_DELTA);
+  } else {
+    save_game_real(filename, save_reason, FALSE, FALSE, SDM_BASE);
+  }
+}
+
 /**************************************************************************
   Close saving system.
 **************************************************************************/
 void save_system_close(void)
 {
+#ifdef HAVE_USABLE_FORK
+  save_child_wait();
+#endif
+
   if (save_thread != NULL) {
     fc_thread_wait(save_thread);
     free(save_thread);
     save_thread = NULL;
   }
+
+  savedelta_free();
 }
 
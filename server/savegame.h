@@ -18,12 +18,20 @@
 
 struct section_file;
 
+/* Called by the savegame writer each time the sections of 'sfile' are
+ * complete, so they can be written out and freed (see
+ * secfile_sections_detach()) before the rest of the game is saved. */
+typedef void (*savegame_flush_fn) (struct section_file *sfile, void *data);
+
 void savegame_load(struct section_file *sfile);
 void savegame_save(struct section_file *sfile, const char *save_reason,
-                   bool scenario);
+                   bool scenario, savegame_flush_fn flush,
+                   void *flush_data);
 
 void save_game(const char *orig_filename, const char *save_reason,
                bool scenario);
+void save_game_background(const char *filename, const char *save_reason);
+void save_game_delta(const char *filename, const char *save_reason);
 
 void save_system_close(void);
 
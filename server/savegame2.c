@@ -84,6 +84,7 @@
 #include "capability.h"
 #include "citizens.h"
 #include "city.h"
+#include "effects.h"
 #include "game.h"
 #include "government.h"
 #include "map.h"
@@ -190,8 +191,9 @@ extern bool sg_success;
  *                  will be the the y coordinate
  * Example:
  *   LOAD_MAP_CHAR(ch, ptile,
- *                 map_get_player_tile(ptile, plr)->terrain
- *                   = char2terrain(ch), file, "player%d.map_t%04d", plrno);
+ *                 player_tile_set_terrain(map_get_player_tile(ptile, plr),
+ *                                         char2terrain(ch)),
+ *                 file, "player%d.map_t%04d", plrno);
  *
  * Note: some (but not all) of the code this is replacing used to skip over
  *       lines that did not exist. This allowed for backward-compatibility.
@@ -2627,6 +2629,9 @@ static void sg_load_players(struct loaddata *loading)
     } players_iterate_alive_end;
   } players_iterate_alive_end;
 
+  /* Effects evaluated while loading may have seen partial data. */
+  effect_cache_invalidate();
+
   /* Update cached city illness. This can depend on trade routes,
    * so can't be calculated until all players have been loaded. */
   if (game.info.illness_on) {
@@ -4418,6 +4423,7 @@ static void sg_load_player_vision(struct loaddata *loading,
       secfile_lookup_int_default(loading->file, -1,
                                  "player%d.dc_total", plrno);
   int i;
+  bv_extras *extras;
 
   /* Check status and return if not OK (sg_success != TRUE). */
   sg_check_ret();
@@ -4461,15 +4467,18 @@ static void sg_load_player_vision(struct loaddata *loading,
 
   /* Load player map (terrain). */
   LOAD_MAP_CHAR(ch, ptile,
-                map_get_player_tile(ptile, plr)->terrain
-                  = char2terrain(ch), loading->file,
-                "player%d.map_t%04d", plrno);
+                player_tile_set_terrain(map_get_player_tile(ptile, plr),
+                                        char2terrain(ch)),
+                loading->file, "player%d.map_t%04d", plrno);
 
   /* Load player map (resources). */
   LOAD_MAP_CHAR(ch, ptile,
-                map_get_player_tile(ptile, plr)->resource
-                  = char2resource(ch), loading->file,
-                "player%d.map_res%04d", plrno);
+                player_tile_set_resource(map_get_player_tile(ptile, plr),
+                                         char2resource(ch)),
+                loading->file, "player%d.map_res%04d", plrno);
+
+  /* The extras are gathered from several layers, set them all at once. */
+  extras = fc_calloc(MAP_INDEX_SIZE, sizeof(*extras));
 
   if (loading->version >= 30) {
     /* 2.6.0 or newer */
@@ -4477,7 +4486,7 @@ static void sg_load_player_vision(struct loaddata *loading,
     /* Load player map (extras). */
     halfbyte_iterate_extras(j, loading->extra.size) {
       LOAD_MAP_CHAR(ch, ptile,
-                    sg_extras_set(&map_get_player_tile(ptile, plr)->extras,
+                    sg_extras_set(&extras[tile_index(ptile)],
                                   ch, loading->extra.order + 4 * j),
                     loading->file, "player%d.map_e%02d_%04d", plrno, j);
     } halfbyte_iterate_extras_end;
@@ -4485,7 +4494,7 @@ static void sg_load_player_vision(struct loaddata *loading,
     /* Load player map (specials). */
     halfbyte_iterate_special(j, loading->special.size) {
       LOAD_MAP_CHAR(ch, ptile,
-                    sg_special_set(ptile, &map_get_player_tile(ptile, plr)->extras,
+                    sg_special_set(ptile, &extras[tile_index(ptile)],
                                    ch, loading->special.order + 4 * j, FALSE),
                     loading->file, "player%d.map_spe%02d_%04d", plrno, j);
     } halfbyte_iterate_special_end;
@@ -4493,7 +4502,7 @@ static void sg_load_player_vision(struct loaddata *loading,
     /* Load player map (bases). */
     halfbyte_iterate_bases(j, loading->base.size) {
       LOAD_MAP_CHAR(ch, ptile,
-                    sg_bases_set(&map_get_player_tile(ptile, plr)->extras,
+                    sg_bases_set(&extras[tile_index(ptile)],
                                  ch, loading->base.order + 4 * j),
                     loading->file, "player%d.map_b%02d_%04d", plrno, j);
     } halfbyte_iterate_bases_end;
@@ -4503,13 +4512,16 @@ static void sg_load_player_vision(struct loaddata *loading,
       /* 2.5.0 or newer */
       halfbyte_iterate_roads(j, loading->road.size) {
         LOAD_MAP_CHAR(ch, ptile,
-                      sg_roads_set(&map_get_player_tile(ptile, plr)->extras,
+                      sg_roads_set(&extras[tile_index(ptile)],
                                    ch, loading->road.order + 4 * j),
                       loading->file, "player%d.map_r%02d_%04d", plrno, j);
       } halfbyte_iterate_roads_end;
     }
   }
 
+  player_map_set_extras(plr, extras);
+  free(extras);
+
   if (game.server.foggedborders) {
     /* Load player map (border). */
     int x, y;
@@ -4536,12 +4548,13 @@ static void sg_load_player_vision(struct loaddata *loading,
         sg_failure_ret('\0' != token[0],
                        "Savegame corrupt - map size not correct.");
         if (strcmp(token, "-") == 0) {
-          map_get_player_tile(ptile, plr)->owner = NULL;
+          player_tile_set_owner(map_get_player_tile(ptile, plr), NULL);
         } else  {
           sg_failure_ret(str_to_int(token, &number),
                          "Savegame corrupt - got tile owner=%s in (%d, %d).",
                          token, x, y);
-          map_get_player_tile(ptile, plr)->owner = player_by_number(number);
+          player_tile_set_owner(map_get_player_tile(ptile, plr),
+                                player_by_number(number));
         }
 
         if (loading->version >= 30) {
@@ -4549,16 +4562,19 @@ static void sg_load_player_vision(struct loaddata *loading,
           sg_failure_ret('\0' != token2[0],
                          "Savegame corrupt - map size not correct.");
           if (strcmp(token2, "-") == 0) {
-            map_get_player_tile(ptile, plr)->extras_owner = NULL;
+            player_tile_set_extras_owner(map_get_player_tile(ptile, plr),
+                                         NULL);
           } else  {
             sg_failure_ret(str_to_int(token2, &number),
                            "Savegame corrupt - got extras owner=%s in (%d, %d).",
                            token, x, y);
-            map_get_player_tile(ptile, plr)->extras_owner = player_by_number(number);
+            player_tile_set_extras_owner(map_get_player_tile(ptile, plr),
+                                         player_by_number(number));
           }
         } else {
-          map_get_player_tile(ptile, plr)->extras_owner
-            = map_get_player_tile(ptile, plr)->owner;
+          struct player_tile *plrtile = map_get_player_tile(ptile, plr);
+
+          player_tile_set_extras_owner(plrtile, player_tile_owner(plrtile));
         }
       }
     }
@@ -4588,8 +4604,7 @@ static void sg_load_player_vision(struct loaddata *loading,
 
     pdcity = vision_site_new(0, NULL, NULL);
     if (sg_load_player_vision_city(loading, plr, pdcity, buf)) {
-      change_playertile_site(map_get_player_tile(pdcity->location, plr),
-                             pdcity);
+      change_playertile_site(pdcity->location, plr, pdcity);
       identity_number_reserve(pdcity->identity);
     } else {
       /* Error loading the data. */
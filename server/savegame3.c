@@ -90,6 +90,7 @@
 #include "capability.h"
 #include "citizens.h"
 #include "city.h"
+#include "effects.h"
 #include "game.h"
 #include "government.h"
 #include "map.h"
@@ -104,6 +105,9 @@
 #include "unitlist.h"
 #include "version.h"
 
+/* common/aicore */
+#include "path_finding.h"
+
 /* server */
 #include "barbarian.h"
 #include "citizenshand.h"
@@ -150,6 +154,35 @@ extern bool sg_success;
 #define SAVE_DUMMY_TURN_CHANGE_TIME 1
 #endif
 
+/*
+ * Run a step of the loading and log how long it took, so one can see
+ * where the loading time goes (use '-d 3').
+ */
+#ifdef LOG_TIMERS
+#define SG_LOAD_TIMED(_what, _step)                                         \
+{                                                                           \
+  struct timer *_timer = timer_new(TIMER_USER, TIMER_ACTIVE);               \
+                                                                            \
+  timer_start(_timer);                                                      \
+  _step;                                                                    \
+  log_verbose("Loading %s: %.3f seconds.", _what,                           \
+              timer_read_seconds(_timer));                                  \
+  timer_destroy(_timer);                                                    \
+}
+#define SG_LOAD_TIMER_USE TIMER_ACTIVE
+#else  /* LOG_TIMERS */
+#define SG_LOAD_TIMED(_what, _step) _step
+#define SG_LOAD_TIMER_USE TIMER_IGNORE
+#endif /* LOG_TIMERS */
+
+/* Same for a step run many times: the time adds up in '_timer'. */
+#define SG_LOAD_TIMED_ADD(_timer, _step)                                    \
+{                                                                           \
+  timer_start(_timer);                                                      \
+  _step;                                                                    \
+  timer_stop(_timer);                                                       \
+}
+
 /*
  * This loops over the entire map to save data. It collects all the data of
  * a line using GET_XY_CHAR and then executes the macro SECFILE_INSERT_LINE.
@@ -200,8 +233,9 @@ extern bool sg_success;
  *                  will be the the y coordinate
  * Example:
  *   LOAD_MAP_CHAR(ch, ptile,
- *                 map_get_player_tile(ptile, plr)->terrain
- *                   = char2terrain(ch), file, "player%d.map_t%04d", plrno);
+ *                 player_tile_set_terrain(map_get_player_tile(ptile, plr),
+ *                                         char2terrain(ch)),
+ *                 file, "player%d.map_t%04d", plrno);
  *
  * Note: some (but not all) of the code this is replacing used to skip over
  *       lines that did not exist. This allowed for backward-compatibility.
@@ -212,8 +246,23 @@ extern bool sg_success;
  */
 #define LOAD_MAP_CHAR(ch, ptile, SET_XY_CHAR, secfile, secpath, ...)        \
 {                                                                           \
-  int _nat_x, _nat_y;                                                       \
   bool _printed_warning = FALSE;                                            \
+  LOAD_MAP_CHAR_NOWARN(ch, ptile, SET_XY_CHAR, _printed_warning, secfile,   \
+                       secpath, ## __VA_ARGS__);                            \
+  if (_printed_warning) {                                                   \
+    sg_incomplete_map_warning();                                            \
+  }                                                                         \
+}
+
+/*
+ * Same as LOAD_MAP_CHAR(), but only sets 'incomplete' to TRUE if some map
+ * line is missing or has a wrong length. Unlike LOAD_MAP_CHAR() it may be
+ * used by worker threads.
+ */
+#define LOAD_MAP_CHAR_NOWARN(ch, ptile, SET_XY_CHAR, incomplete, secfile,    \
+                             secpath, ...)                                  \
+{                                                                           \
+  int _nat_x, _nat_y;                                                       \
   for (_nat_y = 0; _nat_y < wld.map.ysize; _nat_y++) {                      \
     const char *_line = secfile_lookup_str(secfile, secpath,                \
                                            ## __VA_ARGS__, _nat_y);         \
@@ -221,14 +270,14 @@ extern bool sg_success;
       char buf[64];                                                         \
       fc_snprintf(buf, sizeof(buf), secpath, ## __VA_ARGS__, _nat_y);       \
       log_verbose("Line not found='%s'", buf);                              \
-      _printed_warning = TRUE;                                              \
+      (incomplete) = TRUE;                                                  \
       continue;                                                             \
     } else if (strlen(_line) != wld.map.xsize) {                            \
       char buf[64];                                                         \
       fc_snprintf(buf, sizeof(buf), secpath, ## __VA_ARGS__, _nat_y);       \
       log_verbose("Line too short (expected %d got %lu)='%s'",              \
                   wld.map.xsize, (unsigned long) strlen(_line), buf);       \
-      _printed_warning = TRUE;                                              \
+      (incomplete) = TRUE;                                                  \
       continue;                                                             \
     }                                                                       \
     for (_nat_x = 0; _nat_x < wld.map.xsize; _nat_x++) {                    \
@@ -237,12 +286,6 @@ extern bool sg_success;
       (SET_XY_CHAR);                                                        \
     }                                                                       \
   }                                                                         \
-  if (_printed_warning) {                                                   \
-    /* TRANS: Minor error message. */                                       \
-    log_sg(_("Saved game contains incomplete map data. This can"            \
-             " happen with old saved games, or it may indicate an"          \
-             " invalid saved game file. Proceed at your own risk."));       \
-  }                                                                         \
 }
 
 /* Iterate on the extras half-bytes */
@@ -265,6 +308,10 @@ struct savedata {
 
   /* Set in sg_save_game(); needed in sg_save_map_*(); ... */
   bool save_players;
+
+  /* Called when the sections written so far are complete. */
+  savegame_flush_fn flush;
+  void *flush_data;
 };
 
 #define TOKEN_SIZE 10
@@ -280,7 +327,8 @@ static const char num_chars[] =
 
 static void savegame3_save_real(struct section_file *file,
                                 const char *save_reason,
-                                bool scenario);
+                                bool scenario, savegame_flush_fn flush,
+                                void *flush_data);
 static struct loaddata *loaddata_new(struct section_file *file);
 static void loaddata_destroy(struct loaddata *loading);
 
@@ -288,6 +336,7 @@ static struct savedata *savedata_new(struct section_file *file,
                                      const char *save_reason,
                                      bool scenario);
 static void savedata_destroy(struct savedata *saving);
+static void sg_save_flush(struct savedata *saving);
 
 static enum unit_orders char2order(char order);
 static char order2char(enum unit_orders order);
@@ -305,6 +354,7 @@ static void worklist_save(struct section_file *file,
                           int max_length, const char *path, ...);
 static void unit_ordering_calc(void);
 static void unit_ordering_apply(void);
+static void sg_incomplete_map_warning(void);
 static void sg_extras_set(bv_extras *extras, char ch, struct extra_type **idx);
 static char sg_extras_get(bv_extras extras, struct extra_type *presource,
                           const int *idx);
@@ -377,8 +427,32 @@ static void sg_load_player_units_transport(struct loaddata *loading,
                                            struct player *plr);
 static void sg_load_player_attributes(struct loaddata *loading,
                                       struct player *plr);
+
+/* The private map of a player, decoded by a worker thread. */
+struct sg_vision_job {
+  struct loaddata *loading;
+  struct player *plr;
+
+  /* The known extras are shared by all the players, so they are only set
+   * by the main thread from this per tile array. */
+  bv_extras *extras;
+
+  bool ok;
+  bool incomplete;
+  char error[256];
+};
+
 static void sg_load_player_vision(struct loaddata *loading,
-                                  struct player *plr);
+                                  struct player *plr,
+                                  const struct sg_vision_job *pjob);
+static bool sg_load_player_vision_reveal(const struct player *plr);
+static bool sg_load_player_vision_has_map(struct loaddata *loading,
+                                          const struct player *plr);
+static bool sg_load_player_private_map(struct loaddata *loading,
+                                       struct player *plr,
+                                       bv_extras *extras, bool *incomplete,
+                                       char *error, size_t error_len);
+static void sg_load_player_vision_job(int job, void *data);
 static bool sg_load_player_vision_city(struct loaddata *loading,
                                        struct player *plr,
                                        struct vision_site *pdcity,
@@ -415,10 +489,13 @@ static void sg_save_sanitycheck(struct savedata *saving);
 
 
 /****************************************************************************
-  Main entry point for saving a game in savegame3 format.
+  Main entry point for saving a game in savegame3 format. If 'flush' is
+  not NULL, it is called each time the sections inserted so far in 'sfile'
+  are complete; no section is modified after it has been flushed.
 ****************************************************************************/
 void savegame3_save(struct section_file *sfile, const char *save_reason,
-                    bool scenario)
+                    bool scenario, savegame_flush_fn flush,
+                    void *flush_data)
 {
   fc_assert_ret(sfile != NULL);
 
@@ -428,7 +505,7 @@ void savegame3_save(struct section_file *sfile, const char *save_reason,
 #endif
 
   log_verbose("saving game in new format ...");
-  savegame3_save_real(sfile, save_reason, scenario);
+  savegame3_save_real(sfile, save_reason, scenario, flush, flush_data);
 
 #ifdef DEBUG_TIMERS
   timer_stop(savetimer);
@@ -457,40 +534,40 @@ void savegame3_load(struct section_file *file)
 
   /* Load the savegame data. */
   /* [compat] */
-  sg_load_compat(loading);
+  SG_LOAD_TIMED("[compat]", sg_load_compat(loading));
   /* [scenario] */
-  sg_load_scenario(loading);
+  SG_LOAD_TIMED("[scenario]", sg_load_scenario(loading));
   /* [savefile] */
-  sg_load_savefile(loading);
+  SG_LOAD_TIMED("[savefile]", sg_load_savefile(loading));
   /* [game] */
-  sg_load_game(loading);
+  SG_LOAD_TIMED("[game]", sg_load_game(loading));
   /* [random] */
-  sg_load_random(loading);
+  SG_LOAD_TIMED("[random]", sg_load_random(loading));
   /* [script] */
-  sg_load_script(loading);
+  SG_LOAD_TIMED("[script]", sg_load_script(loading));
   /* [settings] */
-  sg_load_settings(loading);
+  SG_LOAD_TIMED("[settings]", sg_load_settings(loading));
   /* [ruldata] */
-  sg_load_ruledata(loading);
+  SG_LOAD_TIMED("[ruledata]", sg_load_ruledata(loading));
   /* [players] (basic data) */
-  sg_load_players_basic(loading);
+  SG_LOAD_TIMED("[players]", sg_load_players_basic(loading));
   /* [map]; needs width and height loaded by [settings]  */
-  sg_load_map(loading);
+  SG_LOAD_TIMED("[map]", sg_load_map(loading));
   /* [research] */
-  sg_load_researches(loading);
+  SG_LOAD_TIMED("[research]", sg_load_researches(loading));
   /* [player<i>] */
-  sg_load_players(loading);
+  SG_LOAD_TIMED("[player<i>]", sg_load_players(loading));
   /* [event_cache] */
-  sg_load_event_cache(loading);
+  SG_LOAD_TIMED("[event_cache]", sg_load_event_cache(loading));
   /* [treaties] */
-  sg_load_treaties(loading);
+  SG_LOAD_TIMED("[treaties]", sg_load_treaties(loading));
   /* [history] */
-  sg_load_history(loading);
+  SG_LOAD_TIMED("[history]", sg_load_history(loading));
   /* [mapimg] */
-  sg_load_mapimg(loading);
+  SG_LOAD_TIMED("[mapimg]", sg_load_mapimg(loading));
 
   /* Sanity checks for the loaded game. */
-  sg_load_sanitycheck(loading);
+  SG_LOAD_TIMED("sanity checks", sg_load_sanitycheck(loading));
 
   /* deinitialise loading */
   loaddata_destroy(loading);
@@ -508,21 +585,26 @@ void savegame3_load(struct section_file *file)
 ****************************************************************************/
 static void savegame3_save_real(struct section_file *file,
                                 const char *save_reason,
-                                bool scenario)
+                                bool scenario, savegame_flush_fn flush,
+                                void *flush_data)
 {
   struct savedata *saving;
 
   /* initialise loading */
   saving = savedata_new(file, save_reason, scenario);
+  saving->flush = flush;
+  saving->flush_data = flush_data;
   sg_success = TRUE;
 
   /* [scenario] */
   /* This should be first section so scanning through all scenarios just for
    * names and descriptions would go faster. */
   sg_save_scenario(saving);
+  sg_save_flush(saving);
   /* [savefile] */
   sg_save_savefile(saving);
-  /* [game] */
+  sg_save_flush(saving);
+  /* [game]; not flushed before sg_save_map_known() is done with it. */
   sg_save_game(saving);
   /* [random] */
   sg_save_random(saving);
@@ -534,18 +616,25 @@ static void savegame3_save_real(struct section_file *file,
   sg_save_ruledata(saving);
   /* [map] */
   sg_save_map(saving);
-  /* [player<i>] */
+  sg_save_flush(saving);
+  /* [player<i>]; flushed player by player. */
   sg_save_players(saving);
+  sg_save_flush(saving);
   /* [research] */
   sg_save_researches(saving);
+  sg_save_flush(saving);
   /* [event_cache] */
   sg_save_event_cache(saving);
+  sg_save_flush(saving);
   /* [treaty<i>] */
   sg_save_treaties(saving);
+  sg_save_flush(saving);
   /* [history] */
   sg_save_history(saving);
+  sg_save_flush(saving);
   /* [mapimg] */
   sg_save_mapimg(saving);
+  sg_save_flush(saving);
 
   /* Sanity checks for the saved game. */
   sg_save_sanitycheck(saving);
@@ -594,6 +683,11 @@ static struct loaddata *loaddata_new(struct section_file *file)
 ****************************************************************************/
 static void loaddata_destroy(struct loaddata *loading)
 {
+  timer_destroy(loading->timers.main);
+  timer_destroy(loading->timers.cities);
+  timer_destroy(loading->timers.units);
+  timer_destroy(loading->timers.vision);
+
   if (loading->improvement.order != NULL) {
     free(loading->improvement.order);
   }
@@ -656,6 +750,16 @@ static void savedata_destroy(struct savedata *saving)
   free(saving);
 }
 
+/****************************************************************************
+  Hand the sections saved so far to the flush callback, if any.
+****************************************************************************/
+static void sg_save_flush(struct savedata *saving)
+{
+  if (NULL != saving->flush) {
+    saving->flush(saving->file, saving->flush_data);
+  }
+}
+
 /* =======================================================================
  * Helper functions.
  * ======================================================================= */
@@ -1076,6 +1180,17 @@ static void unit_ordering_apply(void)
   } whole_map_iterate_end;
 }
 
+/****************************************************************************
+  Warn that some map data is missing from the savegame.
+****************************************************************************/
+static void sg_incomplete_map_warning(void)
+{
+  /* TRANS: Minor error message. */
+  log_sg(_("Saved game contains incomplete map data. This can"
+           " happen with old saved games, or it may indicate an"
+           " invalid saved game file. Proceed at your own risk."));
+}
+
 /****************************************************************************
   Helper function for loading extras from a savegame.
 
@@ -2425,12 +2540,12 @@ static void sg_load_map(struct loaddata *loading)
     return;
   }
 
-  sg_load_map_tiles(loading);
-  sg_load_map_startpos(loading);
-  sg_load_map_tiles_extras(loading);
-  sg_load_map_known(loading);
-  sg_load_map_owner(loading);
-  sg_load_map_worked(loading);
+  SG_LOAD_TIMED("map terrain", sg_load_map_tiles(loading));
+  SG_LOAD_TIMED("map start positions", sg_load_map_startpos(loading));
+  SG_LOAD_TIMED("map extras", sg_load_map_tiles_extras(loading));
+  SG_LOAD_TIMED("map known", sg_load_map_known(loading));
+  SG_LOAD_TIMED("map owners", sg_load_map_owner(loading));
+  SG_LOAD_TIMED("map worked", sg_load_map_worked(loading));
 }
 
 /****************************************************************************
@@ -2986,6 +3101,34 @@ static void sg_save_map_worked(struct savedata *saving)
   }
 }
 
+/* The known tiles of all players, as read from the savegame. */
+struct sg_known_job {
+  const unsigned int *known;
+  struct player **players;
+};
+
+/****************************************************************************
+  Worker thread job setting the known tiles of one player; see
+  sg_load_map_known().
+****************************************************************************/
+static void sg_load_map_known_job(int job, void *data)
+{
+  const struct sg_known_job *pjob = (const struct sg_known_job *) data;
+  struct player *pplayer = pjob->players[job];
+  int p = player_index(pplayer);
+  const unsigned int *known = pjob->known + (p / 32) * MAP_INDEX_SIZE;
+  unsigned int bit = 1u << (p % 32);
+
+  dbv_clr_all(&pplayer->tile_known);
+  whole_map_iterate(ptile) {
+    if (known[tile_index(ptile)] & bit) {
+      /* map_set_known() without the path-finding pool update, which is
+       * not thread safe; the pool is flushed by the caller instead. */
+      dbv_set(&pplayer->tile_known, tile_index(ptile));
+    }
+  } whole_map_iterate_end;
+}
+
 /****************************************************************************
   Load tile known status
 ****************************************************************************/
@@ -3004,6 +3147,7 @@ static void sg_load_map_known(struct loaddata *loading)
                                   "game.save_known")) {
     int lines = player_slot_max_used_number()/32 + 1, j, p, l, i;
     unsigned int *known = fc_calloc(lines * MAP_INDEX_SIZE, sizeof(*known));
+    struct sg_known_job job;
 
     for (l = 0; l < lines; l++) {
       for (j = 0; j < 8; j++) {
@@ -3021,22 +3165,21 @@ static void sg_load_map_known(struct loaddata *loading)
       }
     }
 
+    /* HACK: we read the known data from hex into 32-bit integers, and
+     * now we convert it to the known tile data of each player. Each
+     * player only has its own bit vector modified, so this is done by
+     * the worker threads. */
+    job.known = known;
+    job.players = fc_malloc(player_count() * sizeof(*job.players));
+    p = 0;
     players_iterate(pplayer) {
-      dbv_clr_all(&pplayer->tile_known);
+      job.players[p++] = pplayer;
     } players_iterate_end;
+    server_workpool_run(p, sg_load_map_known_job, &job);
+    free(job.players);
 
-    /* HACK: we read the known data from hex into 32-bit integers, and
-     * now we convert it to the known tile data of each player. */
-    whole_map_iterate(ptile) {
-      players_iterate(pplayer) {
-        p = player_index(pplayer);
-        l = player_index(pplayer) / 32;
-
-        if (known[l * MAP_INDEX_SIZE + tile_index(ptile)] & (1u << (p % 32))) {
-          map_set_known(ptile, pplayer);
-        }
-      } players_iterate_end;
-    } whole_map_iterate_end;
+    /* The pooled path-finding maps may rely on the old known tiles. */
+    pf_map_pool_flush();
 
     FC_FREE(known);
   }
@@ -3364,10 +3507,18 @@ static void sg_load_players(struct loaddata *loading)
     return;
   }
 
+  loading->timers.main = timer_new(TIMER_USER, SG_LOAD_TIMER_USE);
+  loading->timers.cities = timer_new(TIMER_USER, SG_LOAD_TIMER_USE);
+  loading->timers.units = timer_new(TIMER_USER, SG_LOAD_TIMER_USE);
+  loading->timers.vision = timer_new(TIMER_USER, SG_LOAD_TIMER_USE);
+
   players_iterate(pplayer) {
-    sg_load_player_main(loading, pplayer);
-    sg_load_player_cities(loading, pplayer);
-    sg_load_player_units(loading, pplayer);
+    SG_LOAD_TIMED_ADD(loading->timers.main,
+                      sg_load_player_main(loading, pplayer));
+    SG_LOAD_TIMED_ADD(loading->timers.cities,
+                      sg_load_player_cities(loading, pplayer));
+    SG_LOAD_TIMED_ADD(loading->timers.units,
+                      sg_load_player_units(loading, pplayer));
     sg_load_player_attributes(loading, pplayer);
 
     /* Check the sucess of the functions above. */
@@ -3430,6 +3581,9 @@ static void sg_load_players(struct loaddata *loading)
     } players_iterate_alive_end;
   } players_iterate_alive_end;
 
+  /* Effects evaluated while loading may have seen partial data. */
+  effect_cache_invalidate();
+
   /* Update cached city illness. This can depend on trade routes,
    * so can't be calculated until all players have been loaded. */
   if (game.info.illness_on) {
@@ -3453,11 +3607,58 @@ static void sg_load_players(struct loaddata *loading)
 
   /* Since the cities must be placed on the map to put them on the
      player map we do this afterwards */
-  players_iterate(pplayer) {
-    sg_load_player_vision(loading, pplayer);
-    /* Check the sucess of the function above. */
-    sg_check_ret();
-  } players_iterate_end;
+  timer_start(loading->timers.vision);
+  {
+    /* The private maps are the bulk of the player data, and each one only
+     * touches the map of its own player: decode them on the worker
+     * threads first. The maps of the players the whole map is revealed
+     * to first are still loaded in order by sg_load_player_vision(). */
+    struct sg_vision_job *jobs = fc_calloc(player_count(), sizeof(*jobs));
+    int num_jobs = 0, i = 0;
+
+    players_iterate(pplayer) {
+      if (sg_load_player_vision_has_map(loading, pplayer)
+          && !sg_load_player_vision_reveal(pplayer)) {
+        jobs[num_jobs].loading = loading;
+        jobs[num_jobs].plr = pplayer;
+        jobs[num_jobs].extras = fc_calloc(MAP_INDEX_SIZE,
+                                          sizeof(*jobs[num_jobs].extras));
+        num_jobs++;
+      }
+    } players_iterate_end;
+
+    server_workpool_run(num_jobs, sg_load_player_vision_job, jobs);
+
+    players_iterate(pplayer) {
+      if (i < num_jobs && jobs[i].plr == pplayer) {
+        sg_load_player_vision(loading, pplayer, &jobs[i++]);
+      } else {
+        sg_load_player_vision(loading, pplayer, NULL);
+      }
+      /* Check the sucess of the function above. */
+      if (!sg_success) {
+        break;
+      }
+    } players_iterate_end;
+
+    for (i = 0; i < num_jobs; i++) {
+      free(jobs[i].extras);
+    }
+    free(jobs);
+  }
+  timer_stop(loading->timers.vision);
+  sg_check_ret();
+
+#ifdef LOG_TIMERS
+  log_verbose("Loading players main data: %.3f seconds.",
+              timer_read_seconds(loading->timers.main));
+  log_verbose("Loading player cities: %.3f seconds.",
+              timer_read_seconds(loading->timers.cities));
+  log_verbose("Loading player units: %.3f seconds.",
+              timer_read_seconds(loading->timers.units));
+  log_verbose("Loading player vision: %.3f seconds.",
+              timer_read_seconds(loading->timers.vision));
+#endif /* LOG_TIMERS */
 
   /* Check shared vision. */
   players_iterate(pplayer) {
@@ -3563,12 +3764,14 @@ static void sg_save_players(struct savedata *saving)
   unit_ordering_calc();
 
   /* Save players. */
+  sg_save_flush(saving);
   players_iterate(pplayer) {
     sg_save_player_main(saving, pplayer);
     sg_save_player_cities(saving, pplayer);
     sg_save_player_units(saving, pplayer);
     sg_save_player_attributes(saving, pplayer);
     sg_save_player_vision(saving, pplayer);
+    sg_save_flush(saving);
   } players_iterate_end;
 }
 
@@ -5991,32 +6194,31 @@ static void sg_save_player_attributes(struct savedata *saving,
 }
 
 /****************************************************************************
-  Load vision data
+  Load vision data. If 'pjob' is not NULL, the private map of the player
+  has already been decoded by sg_load_player_vision_job().
 ****************************************************************************/
 static void sg_load_player_vision(struct loaddata *loading,
-                                  struct player *plr)
+                                  struct player *plr,
+                                  const struct sg_vision_job *pjob)
 {
   int plrno = player_number(plr);
   int total_ncities =
       secfile_lookup_int_default(loading->file, -1,
                                  "player%d.dc_total", plrno);
   int i;
+  bool ok, incomplete = FALSE;
+  char error[256];
+  bv_extras *extras = NULL;
 
   /* Check status and return if not OK (sg_success != TRUE). */
   sg_check_ret();
 
-  if (!plr->is_alive) {
-    if (game.server.revealmap & REVEAL_MAP_DEAD
-        && player_list_size(team_members(plr->team)) == 1) {
-      /* Reveal all for dead players. */
-      map_know_and_see_all(plr);
-    }
+  if (sg_load_player_vision_reveal(plr)) {
+    /* Reveal all for dead players. */
+    map_know_and_see_all(plr);
   }
 
-  if (-1 == total_ncities
-      || FALSE == game.info.fogofwar
-      || !secfile_lookup_bool_default(loading->file, TRUE,
-                                      "game.save_private_map")) {
+  if (!sg_load_player_vision_has_map(loading, plr)) {
     /* We have:
      * - a dead player;
      * - fogged cities are not saved for any reason;
@@ -6041,18 +6243,115 @@ static void sg_load_player_vision(struct loaddata *loading,
     return;
   }
 
+  if (NULL != pjob) {
+    ok = pjob->ok;
+    incomplete = pjob->incomplete;
+    sz_strlcpy(error, pjob->error);
+    if (ok) {
+      player_map_set_extras(plr, pjob->extras);
+    }
+  } else {
+    extras = fc_calloc(MAP_INDEX_SIZE, sizeof(*extras));
+    ok = sg_load_player_private_map(loading, plr, extras, &incomplete,
+                                    error, sizeof(error));
+    if (ok) {
+      player_map_set_extras(plr, extras);
+    }
+    free(extras);
+  }
+  if (incomplete) {
+    sg_incomplete_map_warning();
+  }
+  sg_failure_ret(ok, "%s", error);
+
+  /* Load player map known cities. */
+  for (i = 0; i < total_ncities; i++) {
+    struct vision_site *pdcity;
+    char buf[32];
+    fc_snprintf(buf, sizeof(buf), "player%d.dc%d", plrno, i);
+
+    pdcity = vision_site_new(0, NULL, NULL);
+    if (sg_load_player_vision_city(loading, plr, pdcity, buf)) {
+      change_playertile_site(pdcity->location, plr, pdcity);
+      identity_number_reserve(pdcity->identity);
+    } else {
+      /* Error loading the data. */
+      log_sg("Skipping seen city %d for player %d.", i, plrno);
+      if (pdcity != NULL) {
+        vision_site_destroy(pdcity);
+      }
+    }
+  }
+
+  /* Repair inconsistent player maps. */
+  whole_map_iterate(ptile) {
+    if (map_is_known_and_seen(ptile, plr, V_MAIN)) {
+      struct city *pcity = tile_city(ptile);
+
+      update_player_tile_knowledge(plr, ptile);
+      reality_check_city(plr, ptile);
+
+      if (NULL != pcity) {
+        update_dumb_city(plr, pcity);
+      }
+    }
+  } whole_map_iterate_end;
+}
+
+/****************************************************************************
+  Whether the whole map is revealed to 'plr' before its vision is loaded.
+****************************************************************************/
+static bool sg_load_player_vision_reveal(const struct player *plr)
+{
+  return (!plr->is_alive
+          && game.server.revealmap & REVEAL_MAP_DEAD
+          && player_list_size(team_members(plr->team)) == 1);
+}
+
+/****************************************************************************
+  Whether the savegame contains the private map of 'plr'.
+****************************************************************************/
+static bool sg_load_player_vision_has_map(struct loaddata *loading,
+                                          const struct player *plr)
+{
+  return (-1 != secfile_lookup_int_default(loading->file, -1,
+                                           "player%d.dc_total",
+                                           player_number(plr))
+          && game.info.fogofwar
+          && secfile_lookup_bool_default(loading->file, TRUE,
+                                         "game.save_private_map"));
+}
+
+/****************************************************************************
+  Load the private map (terrain, extras, borders and update time) of
+  'plr'. The extras are loaded into 'extras', indexed by tile index, to be
+  set with player_map_set_extras(). This only modifies the private map of
+  'plr', and reports the problems in 'incomplete' and 'error' instead of
+  logging them, so it can be run by a worker thread. Returns FALSE if the
+  map is corrupt.
+****************************************************************************/
+static bool sg_load_player_private_map(struct loaddata *loading,
+                                       struct player *plr,
+                                       bv_extras *extras, bool *incomplete,
+                                       char *error, size_t error_len)
+{
+  int plrno = player_number(plr);
+  int i;
+
   /* Load player map (terrain). */
-  LOAD_MAP_CHAR(ch, ptile,
-                map_get_player_tile(ptile, plr)->terrain
-                  = char2terrain(ch), loading->file,
-                "player%d.map_t%04d", plrno);
+  LOAD_MAP_CHAR_NOWARN(ch, ptile,
+                       player_tile_set_terrain(map_get_player_tile(ptile, plr),
+                                               char2terrain(ch)),
+                       *incomplete, loading->file,
+                       "player%d.map_t%04d", plrno);
 
   /* Load player map (extras). */
   halfbyte_iterate_extras(j, loading->extra.size) {
-    LOAD_MAP_CHAR(ch, ptile,
-                  sg_extras_set(&map_get_player_tile(ptile, plr)->extras,
-                                ch, loading->extra.order + 4 * j),
-                  loading->file, "player%d.map_e%02d_%04d", plrno, j);
+    LOAD_MAP_CHAR_NOWARN(ch, ptile,
+                         sg_extras_set(&extras[tile_index(ptile)],
+                                       ch, loading->extra.order + 4 * j),
+                         *incomplete, loading->file,
+                         "player%d.map_e%02d_%04d", plrno, j);
   } halfbyte_iterate_extras_end;
 
   if (game.server.foggedborders) {
@@ -6069,8 +6368,11 @@ static void sg_load_player_vision(struct loaddata *loading,
       const char *ptr = buffer;
       const char *ptr2 = buffer2;
 
-      sg_failure_ret(NULL != buffer,
+      if (NULL == buffer) {
+        fc_snprintf(error, error_len,
                     "Savegame corrupt - map line %d not found.", y);
+        return FALSE;
+      }
       for (x = 0; x < wld.map.xsize; x++) {
         char token[TOKEN_SIZE];
         char token2[TOKEN_SIZE];
@@ -6078,27 +6380,42 @@ static void sg_load_player_vision(struct loaddata *loading,
         struct tile *ptile = native_pos_to_tile(x, y);
 
         scanin(&ptr, ",", token, sizeof(token));
-        sg_failure_ret('\0' != token[0],
-                       "Savegame corrupt - map size not correct.");
+        if ('\0' == token[0]) {
+          fc_snprintf(error, error_len,
+                      "Savegame corrupt - map size not correct.");
+          return FALSE;
+        }
         if (strcmp(token, "-") == 0) {
-          map_get_player_tile(ptile, plr)->owner = NULL;
+          player_tile_set_owner(map_get_player_tile(ptile, plr), NULL);
         } else  {
-          sg_failure_ret(str_to_int(token, &number),
-                         "Savegame corrupt - got tile owner=%s in (%d, %d).",
-                         token, x, y);
-          map_get_player_tile(ptile, plr)->owner = player_by_number(number);
+          if (!str_to_int(token, &number)) {
+            fc_snprintf(error, error_len,
+                        "Savegame corrupt - got tile owner=%s in (%d, %d).",
+                        token, x, y);
+            return FALSE;
+          }
+          player_tile_set_owner(map_get_player_tile(ptile, plr),
+                                player_by_number(number));
         }
 
         scanin(&ptr2, ",", token2, sizeof(token2));
-        sg_failure_ret('\0' != token2[0],
-                       "Savegame corrupt - map size not correct.");
+        if ('\0' == token2[0]) {
+          fc_snprintf(error, error_len,
+                      "Savegame corrupt - map size not correct.");
+          return FALSE;
+        }
         if (strcmp(token2, "-") == 0) {
-          map_get_player_tile(ptile, plr)->extras_owner = NULL;
+          player_tile_set_extras_owner(map_get_player_tile(ptile, plr),
+                                       NULL);
         } else  {
-          sg_failure_ret(str_to_int(token2, &number),
-                         "Savegame corrupt - got extras owner=%s in (%d, %d).",
-                         token, x, y);
-          map_get_player_tile(ptile, plr)->extras_owner = player_by_number(number);
+          if (!str_to_int(token2, &number)) {
+            fc_snprintf(error, error_len,
+                        "Savegame corrupt - got extras owner=%s in (%d, %d).",
+                        token, x, y);
+            return FALSE;
+          }
+          player_tile_set_extras_owner(map_get_player_tile(ptile, plr),
+                                       player_by_number(number));
         }
       }
     }
@@ -6108,51 +6425,34 @@ static void sg_load_player_vision(struct loaddata *loading,
   for (i = 0; i < 4; i++) {
     /* put 4-bit segments of 16-bit "updated" field */
     if (i == 0) {
-      LOAD_MAP_CHAR(ch, ptile,
-                    map_get_player_tile(ptile, plr)->last_updated
-                      = ascii_hex2bin(ch, i),
-                    loading->file, "player%d.map_u%02d_%04d", plrno, i);
+      LOAD_MAP_CHAR_NOWARN(ch, ptile,
+                           map_get_player_tile(ptile, plr)->last_updated
+                             = ascii_hex2bin(ch, i),
+                           *incomplete, loading->file,
+                           "player%d.map_u%02d_%04d", plrno, i);
     } else {
-      LOAD_MAP_CHAR(ch, ptile,
-                    map_get_player_tile(ptile, plr)->last_updated
-                      |= ascii_hex2bin(ch, i),
-                    loading->file, "player%d.map_u%02d_%04d", plrno, i);
+      LOAD_MAP_CHAR_NOWARN(ch, ptile,
+                           map_get_player_tile(ptile, plr)->last_updated
+                             |= ascii_hex2bin(ch, i),
+                           *incomplete, loading->file,
+                           "player%d.map_u%02d_%04d", plrno, i);
     }
   }
 
-  /* Load player map known cities. */
-  for (i = 0; i < total_ncities; i++) {
-    struct vision_site *pdcity;
-    char buf[32];
-    fc_snprintf(buf, sizeof(buf), "player%d.dc%d", plrno, i);
-
-    pdcity = vision_site_new(0, NULL, NULL);
-    if (sg_load_player_vision_city(loading, plr, pdcity, buf)) {
-      change_playertile_site(map_get_player_tile(pdcity->location, plr),
-                             pdcity);
-      identity_number_reserve(pdcity->identity);
-    } else {
-      /* Error loading the data. */
-      log_sg("Skipping seen city %d for player %d.", i, plrno);
-      if (pdcity != NULL) {
-        vision_site_destroy(pdcity);
-      }
-    }
-  }
-
-  /* Repair inconsistent player maps. */
-  whole_map_iterate(ptile) {
-    if (map_is_known_and_seen(ptile, plr, V_MAIN)) {
-      struct city *pcity = tile_city(ptile);
+  return TRUE;
+}
 
-      update_player_tile_knowledge(plr, ptile);
-      reality_check_city(plr, ptile);
+/****************************************************************************
+  Worker thread job decoding the private map of one player; see
+  sg_load_players().
+****************************************************************************/
+static void sg_load_player_vision_job(int job, void *data)
+{
+  struct sg_vision_job *pjob = (struct sg_vision_job *) data + job;
 
-      if (NULL != pcity) {
-        update_dumb_city(plr, pcity);
-      }
-    }
-  } whole_map_iterate_end;
+  pjob->ok = sg_load_player_private_map(pjob->loading, pjob->plr,
+                                        pjob->extras, &pjob->incomplete,
+                                        pjob->error, sizeof(pjob->error));
 }
 
 /****************************************************************************
@@ -6269,7 +6569,8 @@ static void sg_save_player_vision(struct savedata *saving,
 
   /* Save the map (terrain). */
   SAVE_MAP_CHAR(ptile,
-                terrain2char(map_get_player_tile(ptile, plr)->terrain),
+                terrain2char(player_tile_terrain(map_get_player_tile(ptile,
+                                                                     plr))),
                 saving->file, "player%d.map_t%04d", plrno);
 
   if (game.server.foggedborders) {
@@ -6285,11 +6586,11 @@ static void sg_save_player_vision(struct savedata *saving,
         struct tile *ptile = native_pos_to_tile(x, y);
         struct player_tile *plrtile = map_get_player_tile(ptile, plr);
 
-        if (plrtile == NULL || plrtile->owner == NULL) {
+        if (plrtile == NULL || player_tile_owner(plrtile) == NULL) {
           strcpy(token, "-");
         } else {
           fc_snprintf(token, sizeof(token), "%d",
-                      player_number(plrtile->owner));
+                      player_number(player_tile_owner(plrtile)));
         }
         strcat(line, token);
         if (x < wld.map.xsize) {
@@ -6309,11 +6610,11 @@ static void sg_save_player_vision(struct savedata *saving,
         struct tile *ptile = native_pos_to_tile(x, y);
         struct player_tile *plrtile = map_get_player_tile(ptile, plr);
 
-        if (plrtile == NULL || plrtile->extras_owner == NULL) {
+        if (plrtile == NULL || player_tile_extras_owner(plrtile) == NULL) {
           strcpy(token, "-");
         } else {
           fc_snprintf(token, sizeof(token), "%d",
-                      player_number(plrtile->extras_owner));
+                      player_number(player_tile_extras_owner(plrtile)));
         }
         strcat(line, token);
         if (x < wld.map.xsize) {
@@ -6339,8 +6640,10 @@ static void sg_save_player_vision(struct savedata *saving,
     }
 
     SAVE_MAP_CHAR(ptile,
-                  sg_extras_get(map_get_player_tile(ptile, plr)->extras,
-                                map_get_player_tile(ptile, plr)->resource,
+                  sg_extras_get(player_tile_extras(map_get_player_tile(ptile,
+                                                                       plr)),
+                                player_tile_resource(map_get_player_tile(ptile,
+                                                                         plr)),
                                 mod),
                   saving->file, "player%d.map_e%02d_%04d", plrno, j);
   } halfbyte_iterate_extras_end;
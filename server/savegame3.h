@@ -13,8 +13,12 @@
 #ifndef FC__SAVEGAME3_H
 #define FC__SAVEGAME3_H
 
+/* server */
+#include "savegame.h"
+
 void savegame3_load(struct section_file *sfile);
 void savegame3_save(struct section_file *sfile, const char *save_reason,
-                    bool scenario);
+                    bool scenario, savegame_flush_fn flush,
+                    void *flush_data);
 
 #endif /* FC__SAVEGAME3_H */
@@ -45,6 +45,9 @@
 #include <readline/history.h>
 #include <readline/readline.h>
 #endif
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 #ifdef HAVE_SYS_SELECT_H
 #include <sys/select.h>
 #endif
@@ -83,6 +86,7 @@
 #include "auth.h"
 #include "connecthand.h"
 #include "console.h"
+#include "maphand.h"
 #include "meta.h"
 #include "plrhand.h"
 #include "srv_main.h"
@@ -134,6 +138,80 @@ static void send_lanserver_response(void);
 
 static bool no_input = FALSE;
 
+/* Events to wait for on a descriptor. */
+#define SNIFF_READ      (1 << 0)
+#define SNIFF_WRITE     (1 << 1)
+#define SNIFF_EXCEPT    (1 << 2)
+
+/* A set of descriptors to wait for. sniff_watch() sets the events wanted
+ * on a descriptor, which are kept until they are changed: the main loop
+ * only updates them when a connection opens or closes, or starts or stops
+ * having data to send. sniff_wait() waits for them, then sniff_ready()
+ * tells the events found on a descriptor and sniff_ready_iterate() visits
+ * the descriptors where some were found.
+ *
+ * With epoll, the descriptors stay registered between the waits, so only
+ * the changes cost a system call, a wait costs nothing per idle
+ * connection and there is no FD_SETSIZE limit. The readiness is level
+ * triggered: the main loop may leave a ready descriptor for the next
+ * wait. select() is used where epoll is not available or fails; it keeps
+ * the watched events in fd sets which each wait copies.
+ *
+ * The arrays are indexed by descriptor, but a wait only walks the lists
+ * of the changed, ready and unpollable descriptors, never the whole range
+ * of descriptors (except for select() itself). */
+struct sniff_fd_list {
+  int *fds;
+  int num, alloc;
+};
+
+struct sniff_set {
+  int size;                     /* Size of the arrays below. */
+  int *watched;                 /* Events wanted. */
+  int *ready;                   /* Events found by the last wait. */
+  void **data;                  /* Given to sniff_watch(). */
+  struct sniff_fd_list ready_fds;       /* Found ready by the last wait. */
+
+  /* select() */
+  fd_set readfs, writefs, exceptfs;     /* The watched events. */
+  int max_desc;
+
+#ifdef HAVE_SYS_EPOLL_H
+  int epoll_fd;                 /* -1 if select() is used. */
+  int *registered;              /* Events registered in epoll. */
+  bool *unpollable;             /* Regular files, always ready. */
+  bool *dirty;                  /* In 'dirty_fds'. */
+  struct sniff_fd_list dirty_fds;       /* 'watched' != 'registered'. */
+  struct sniff_fd_list unpollable_fds;
+  struct epoll_event *events;
+#endif /* HAVE_SYS_EPOLL_H */
+};
+
+/* Iterate over the descriptors found ready by the last wait, with the
+ * data given to sniff_watch() for them. The data is NULL for a
+ * descriptor which was forgotten since. */
+#define sniff_ready_iterate(_set, _fd, _data)                               \
+{                                                                           \
+  int _fd##_index;                                                          \
+                                                                            \
+  for (_fd##_index = 0; _fd##_index < (_set)->ready_fds.num;                \
+       _fd##_index++) {                                                     \
+    int _fd = (_set)->ready_fds.fds[_fd##_index];                           \
+    void *_data = (_set)->data[_fd];
+
+#define sniff_ready_iterate_end                                             \
+  }                                                                         \
+}
+
+static struct sniff_set main_sniff;     /* server_sniff_all_input() */
+static struct sniff_set flush_sniff;    /* flush_packets() */
+
+/* The connections with data to send, watched for writability by
+ * 'main_sniff'. */
+static struct conn_list *send_pending_conns;
+
+static struct sniff_stats sniff_stats;
+
 /* Avoid compiler warning about defined, but unused function
  * by defining it only when needed */
 #if defined(FREECIV_HAVE_LIBREADLINE) || \
@@ -194,6 +272,430 @@ static void handle_readline_input_callback(char *line)
 }
 #endif /* FREECIV_HAVE_LIBREADLINE */
 
+/****************************************************************************
+  Initialize the set, using epoll if possible.
+****************************************************************************/
+static void sniff_init(struct sniff_set *set)
+{
+  memset(set, 0, sizeof(*set));
+  FC_FD_ZERO(&set->readfs);
+  FC_FD_ZERO(&set->writefs);
+  FC_FD_ZERO(&set->exceptfs);
+  set->max_desc = -1;
+
+#ifdef HAVE_SYS_EPOLL_H
+  set->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (-1 == set->epoll_fd) {
+    log_error("Could not create an epoll instance (%s); "
+              "falling back to select().", fc_strerror(fc_get_errno()));
+  }
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+/****************************************************************************
+  Append the descriptor to the list.
+****************************************************************************/
+static void sniff_fd_list_append(struct sniff_fd_list *list, int fd)
+{
+  if (list->num == list->alloc) {
+    list->alloc = MAX(16, 2 * list->alloc);
+    list->fds = fc_realloc(list->fds, list->alloc * sizeof(*list->fds));
+  }
+  list->fds[list->num++] = fd;
+}
+
+/****************************************************************************
+  Release the list.
+****************************************************************************/
+static void sniff_fd_list_free(struct sniff_fd_list *list)
+{
+  FC_FREE(list->fds);
+  list->num = 0;
+  list->alloc = 0;
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+/****************************************************************************
+  Remove the descriptor from the list, if it is there. The order of the
+  list is not kept.
+****************************************************************************/
+static void sniff_fd_list_remove(struct sniff_fd_list *list, int fd)
+{
+  int i;
+
+  for (i = 0; i < list->num; i++) {
+    if (list->fds[i] == fd) {
+      list->fds[i] = list->fds[--list->num];
+      return;
+    }
+  }
+}
+
+/****************************************************************************
+  Note that the epoll registration of 'fd' may need to be changed before
+  the next wait.
+****************************************************************************/
+static void sniff_mark_dirty(struct sniff_set *set, int fd)
+{
+  if (!set->dirty[fd]) {
+    set->dirty[fd] = TRUE;
+    sniff_fd_list_append(&set->dirty_fds, fd);
+  }
+}
+#endif /* HAVE_SYS_EPOLL_H */
+
+/****************************************************************************
+  Release the set.
+****************************************************************************/
+static void sniff_free(struct sniff_set *set)
+{
+  FC_FREE(set->watched);
+  FC_FREE(set->ready);
+  FC_FREE(set->data);
+  sniff_fd_list_free(&set->ready_fds);
+  set->size = 0;
+
+#ifdef HAVE_SYS_EPOLL_H
+  if (-1 != set->epoll_fd) {
+    close(set->epoll_fd);
+    set->epoll_fd = -1;
+  }
+  FC_FREE(set->registered);
+  FC_FREE(set->unpollable);
+  FC_FREE(set->dirty);
+  sniff_fd_list_free(&set->dirty_fds);
+  sniff_fd_list_free(&set->unpollable_fds);
+  FC_FREE(set->events);
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+/****************************************************************************
+  Make the arrays of the set big enough for the descriptor 'fd'.
+****************************************************************************/
+static void sniff_grow(struct sniff_set *set, int fd)
+{
+  int old_size = set->size;
+  int new_size = MAX(fd + 1, 2 * old_size);
+
+  set->watched = fc_realloc(set->watched, new_size * sizeof(*set->watched));
+  set->ready = fc_realloc(set->ready, new_size * sizeof(*set->ready));
+  set->data = fc_realloc(set->data, new_size * sizeof(*set->data));
+  memset(set->watched + old_size, 0,
+         (new_size - old_size) * sizeof(*set->watched));
+  memset(set->ready + old_size, 0,
+         (new_size - old_size) * sizeof(*set->ready));
+  memset(set->data + old_size, 0,
+         (new_size - old_size) * sizeof(*set->data));
+
+#ifdef HAVE_SYS_EPOLL_H
+  set->registered = fc_realloc(set->registered,
+                               new_size * sizeof(*set->registered));
+  set->unpollable = fc_realloc(set->unpollable,
+                               new_size * sizeof(*set->unpollable));
+  set->dirty = fc_realloc(set->dirty, new_size * sizeof(*set->dirty));
+  set->events = fc_realloc(set->events, new_size * sizeof(*set->events));
+  memset(set->registered + old_size, 0,
+         (new_size - old_size) * sizeof(*set->registered));
+  memset(set->unpollable + old_size, 0,
+         (new_size - old_size) * sizeof(*set->unpollable));
+  memset(set->dirty + old_size, 0,
+         (new_size - old_size) * sizeof(*set->dirty));
+#endif /* HAVE_SYS_EPOLL_H */
+
+  set->size = new_size;
+}
+
+/****************************************************************************
+  Wait for the 'events' on the descriptor 'fd' from now on, instead of the
+  ones set before; 0 stops watching it. 'data' is given back by
+  sniff_ready_iterate().
+****************************************************************************/
+static void sniff_watch(struct sniff_set *set, int fd, int events,
+                        void *data)
+{
+  if (fd >= set->size) {
+    if (0 == events) {
+      return;
+    }
+    sniff_grow(set, fd);
+  }
+
+  set->data[fd] = data;
+  if (set->watched[fd] == events) {
+    return;
+  }
+  set->watched[fd] = events;
+
+#ifdef HAVE_SYS_EPOLL_H
+  if (-1 != set->epoll_fd) {
+    if (!set->unpollable[fd]) {
+      sniff_mark_dirty(set, fd);
+    }
+    return;
+  }
+#endif /* HAVE_SYS_EPOLL_H */
+
+  FD_CLR(fd, &set->readfs);
+  FD_CLR(fd, &set->writefs);
+  FD_CLR(fd, &set->exceptfs);
+  if (events & SNIFF_READ) {
+    FD_SET(fd, &set->readfs);
+  }
+  if (events & SNIFF_WRITE) {
+    FD_SET(fd, &set->writefs);
+  }
+  if (events & SNIFF_EXCEPT) {
+    FD_SET(fd, &set->exceptfs);
+  }
+  if (0 != events) {
+    set->max_desc = MAX(set->max_desc, fd);
+  } else {
+    while (0 <= set->max_desc && 0 == set->watched[set->max_desc]) {
+      set->max_desc--;
+    }
+  }
+}
+
+/****************************************************************************
+  Return the events watched on the descriptor 'fd'.
+****************************************************************************/
+static int sniff_watched(const struct sniff_set *set, int fd)
+{
+  return (0 <= fd && fd < set->size ? set->watched[fd] : 0);
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+/****************************************************************************
+  Bring the epoll registration of 'fd' in line with the events watched.
+****************************************************************************/
+static void sniff_epoll_update(struct sniff_set *set, int fd)
+{
+  struct epoll_event ev;
+  int op;
+
+  if (set->watched[fd] == set->registered[fd] || set->unpollable[fd]) {
+    return;
+  }
+
+  memset(&ev, 0, sizeof(ev));
+  ev.data.fd = fd;
+  if (set->watched[fd] & SNIFF_READ) {
+    ev.events |= EPOLLIN;
+  }
+  if (set->watched[fd] & SNIFF_WRITE) {
+    ev.events |= EPOLLOUT;
+  }
+  if (set->watched[fd] & SNIFF_EXCEPT) {
+    ev.events |= EPOLLPRI;
+  }
+
+  if (0 == set->watched[fd]) {
+    op = EPOLL_CTL_DEL;
+  } else if (0 == set->registered[fd]) {
+    op = EPOLL_CTL_ADD;
+  } else {
+    op = EPOLL_CTL_MOD;
+  }
+
+  if (0 != epoll_ctl(set->epoll_fd, op, fd, &ev)) {
+    if (EPERM == errno) {
+      /* Regular files can't be polled; like select(), consider them to be
+       * always readable and writable. */
+      set->unpollable[fd] = TRUE;
+      sniff_fd_list_append(&set->unpollable_fds, fd);
+    } else if (EPOLL_CTL_DEL != op) {
+      log_error("epoll_ctl() failed for descriptor %d: %s",
+                fd, fc_strerror(fc_get_errno()));
+    }
+  }
+  set->registered[fd] = set->watched[fd];
+}
+#endif /* HAVE_SYS_EPOLL_H */
+
+/****************************************************************************
+  Wait until one of the watched events happens, or 'tv' has elapsed.
+  Returns the number of ready descriptors, 0 on timeout or -1 on error.
+****************************************************************************/
+static int sniff_wait(struct sniff_set *set, fc_timeval *tv)
+{
+  int fd, i, n;
+
+  for (i = 0; i < set->ready_fds.num; i++) {
+    set->ready[set->ready_fds.fds[i]] = 0;
+  }
+  set->ready_fds.num = 0;
+
+#ifdef HAVE_SYS_EPOLL_H
+  if (-1 != set->epoll_fd) {
+    struct epoll_event dummy;
+    int timeout = tv->tv_sec * 1000 + tv->tv_usec / 1000;
+
+    for (i = 0; i < set->dirty_fds.num; i++) {
+      fd = set->dirty_fds.fds[i];
+      set->dirty[fd] = FALSE;
+      sniff_epoll_update(set, fd);
+    }
+    set->dirty_fds.num = 0;
+
+    for (i = 0; i < set->unpollable_fds.num; i++) {
+      if (0 != set->watched[set->unpollable_fds.fds[i]]) {
+        /* Already ready, don't wait. */
+        timeout = 0;
+      }
+    }
+
+    n = epoll_wait(set->epoll_fd,
+                   NULL != set->events ? set->events : &dummy,
+                   MAX(set->size, 1), timeout);
+    if (-1 == n) {
+      return (EINTR == errno ? 0 : -1);
+    }
+
+    for (i = 0; i < n; i++) {
+      uint32_t revents = set->events[i].events;
+      int ready = 0;
+
+      fd = set->events[i].data.fd;
+      if (revents & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+        /* Like select(), let the reader find errors and hang-ups. */
+        ready |= SNIFF_READ;
+      }
+      if (revents & (EPOLLOUT | EPOLLERR)) {
+        ready |= SNIFF_WRITE;
+      }
+      if (revents & EPOLLPRI) {
+        ready |= SNIFF_EXCEPT;
+      }
+      set->ready[fd] = ready & set->watched[fd];
+      if (0 != set->ready[fd]) {
+        sniff_fd_list_append(&set->ready_fds, fd);
+      }
+    }
+    for (i = 0; i < set->unpollable_fds.num; i++) {
+      fd = set->unpollable_fds.fds[i];
+      set->ready[fd] = set->watched[fd] & (SNIFF_READ | SNIFF_WRITE);
+      if (0 != set->ready[fd]) {
+        sniff_fd_list_append(&set->ready_fds, fd);
+      }
+    }
+
+    return set->ready_fds.num;
+  }
+#endif /* HAVE_SYS_EPOLL_H */
+
+  {
+    fd_set readfs = set->readfs;
+    fd_set writefs = set->writefs;
+    fd_set exceptfs = set->exceptfs;
+
+    n = fc_select(set->max_desc + 1, &readfs, &writefs, &exceptfs, tv);
+    if (0 >= n) {
+      return n;
+    }
+
+    for (fd = 0; fd <= set->max_desc; fd++) {
+      int ready = 0;
+
+      if (FD_ISSET(fd, &readfs)) {
+        ready |= SNIFF_READ;
+      }
+      if (FD_ISSET(fd, &writefs)) {
+        ready |= SNIFF_WRITE;
+      }
+      if (FD_ISSET(fd, &exceptfs)) {
+        ready |= SNIFF_EXCEPT;
+      }
+      if (0 != ready) {
+        set->ready[fd] = ready;
+        sniff_fd_list_append(&set->ready_fds, fd);
+      }
+    }
+
+    return set->ready_fds.num;
+  }
+}
+
+/****************************************************************************
+  Return TRUE iff the last wait found 'event' on the descriptor 'fd'.
+****************************************************************************/
+static bool sniff_ready(const struct sniff_set *set, int fd, int event)
+{
+  return (0 <= fd && fd < set->size && (set->ready[fd] & event));
+}
+
+/****************************************************************************
+  Forget the descriptor 'fd', which is about to be closed. The kernel
+  drops it from epoll when it is closed, and its number may be reused.
+****************************************************************************/
+static void sniff_forget(struct sniff_set *set, int fd)
+{
+  if (fd >= set->size) {
+    return;
+  }
+
+  /* It may stay in the lists of the set; its zeroed masks make it a
+   * no-op there. */
+  sniff_watch(set, fd, 0, NULL);
+  set->ready[fd] = 0;
+
+#ifdef HAVE_SYS_EPOLL_H
+  if (-1 != set->epoll_fd) {
+    set->registered[fd] = 0;
+    if (set->unpollable[fd]) {
+      set->unpollable[fd] = FALSE;
+      sniff_fd_list_remove(&set->unpollable_fds, fd);
+    }
+  }
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+/****************************************************************************
+  Return the name of the mechanism used to wait for the descriptors.
+****************************************************************************/
+const char *sniff_backend_name(void)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  if (-1 != main_sniff.epoll_fd) {
+    return "epoll";
+  }
+#endif /* HAVE_SYS_EPOLL_H */
+
+  return "select";
+}
+
+/****************************************************************************
+  Fill in the statistics of server_sniff_all_input().
+****************************************************************************/
+void sniff_stats_get(struct sniff_stats *stats)
+{
+  *stats = sniff_stats;
+}
+
+/****************************************************************************
+  Reset the statistics of server_sniff_all_input().
+****************************************************************************/
+void sniff_stats_reset(void)
+{
+  memset(&sniff_stats, 0, sizeof(sniff_stats));
+}
+
+/****************************************************************************
+  Account a wakeup of server_sniff_all_input() handled in the time
+  measured by 'wakeup_timer', and free the timer.
+****************************************************************************/
+static void sniff_stats_add_wakeup(struct timer *wakeup_timer)
+{
+  double seconds;
+
+  timer_stop(wakeup_timer);
+  seconds = timer_read_seconds(wakeup_timer);
+  timer_destroy(wakeup_timer);
+
+  sniff_stats.wakeups++;
+  sniff_stats.total_seconds += seconds;
+  sniff_stats.max_seconds = MAX(sniff_stats.max_seconds, seconds);
+}
+
 /****************************************************************************
   Close the connection (very low-level). See also
   server_conn_close_callback().
@@ -211,6 +713,7 @@ static void close_connection(struct connection *pconn)
 
   conn_pattern_list_destroy(pconn->server.ignore_list);
   pconn->server.ignore_list = NULL;
+  free_tile_info_queue(pconn);
 
   /* safe to do these even if not in lists: */
   conn_list_remove(game.glob_observers, pconn);
@@ -219,6 +722,11 @@ static void close_connection(struct connection *pconn)
 
   pconn->playing = NULL;
   pconn->access_level = ALLOW_NONE;
+  conn_list_remove(send_pending_conns, pconn);
+  if (pconn->sock >= 0) {
+    sniff_forget(&main_sniff, pconn->sock);
+    sniff_forget(&flush_sniff, pconn->sock);
+  }
   connection_common_close(pconn);
 
   send_updated_vote_totals(NULL);
@@ -251,6 +759,11 @@ void close_connections_and_socket(void)
   }
   FC_FREE(listen_socks);
 
+  sniff_free(&main_sniff);
+  sniff_free(&flush_sniff);
+  conn_list_destroy(send_pending_conns);
+  send_pending_conns = NULL;
+
   if (srvarg.announce != ANNOUNCE_NONE) {
     fc_closesocket(socklan);
   }
@@ -317,6 +830,34 @@ static void server_conn_close_callback(struct connection *pconn)
 {
   /* Do as little as possible here to avoid recursive evil. */
   pconn->server.is_closing = TRUE;
+  /* Nothing more is read from or sent to it. */
+  if (pconn->sock >= 0) {
+    sniff_watch(&main_sniff, pconn->sock, 0, NULL);
+  }
+  conn_list_remove(send_pending_conns, pconn);
+}
+
+/****************************************************************************
+  Called by the network code when the connection starts or stops having
+  data to send, so that 'main_sniff' waits until it can be sent.
+****************************************************************************/
+static void server_conn_send_pending_notify(struct connection *pconn,
+                                            bool data_available)
+{
+  int events = sniff_watched(&main_sniff, pconn->sock);
+
+  if (pconn->server.is_closing
+      || data_available == (0 != (events & SNIFF_WRITE))) {
+    return;
+  }
+
+  if (data_available) {
+    sniff_watch(&main_sniff, pconn->sock, events | SNIFF_WRITE, pconn);
+    conn_list_append(send_pending_conns, pconn);
+  } else {
+    sniff_watch(&main_sniff, pconn->sock, events & ~SNIFF_WRITE, pconn);
+    conn_list_remove(send_pending_conns, pconn);
+  }
 }
 
 /****************************************************************************
@@ -351,13 +892,14 @@ static void cut_lagging_connection(struct connection *pconn)
 void flush_packets(void)
 {
   int i;
-  int max_desc;
-  fd_set writefs, exceptfs;
+  bool pending;
   fc_timeval tv;
   time_t start;
 
   (void) time(&start);
 
+  flush_all_tile_info();
+
   for (;;) {
     tv.tv_sec = (game.server.netwait - (time(NULL) - start));
     tv.tv_usec = 0;
@@ -366,27 +908,29 @@ void flush_packets(void)
       return;
     }
 
-    FC_FD_ZERO(&writefs);
-    FC_FD_ZERO(&exceptfs);
-    max_desc = -1;
+    pending = FALSE;
 
     for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
       struct connection *pconn = &connections[i];
 
-      if (pconn->used
-          && !pconn->server.is_closing
-          && 0 < pconn->send_buffer->ndata) {
-        FD_SET(pconn->sock, &writefs);
-        FD_SET(pconn->sock, &exceptfs);
-        max_desc = MAX(pconn->sock, max_desc);
+      if (!pconn->used) {
+        continue;
+      }
+      if (!pconn->server.is_closing
+          && 0 < connection_send_pending(pconn)) {
+        sniff_watch(&flush_sniff, pconn->sock, SNIFF_WRITE | SNIFF_EXCEPT,
+                    pconn);
+        pending = TRUE;
+      } else {
+        sniff_watch(&flush_sniff, pconn->sock, 0, NULL);
       }
     }
 
-    if (max_desc == -1) {
+    if (!pending) {
       return;
     }
 
-    if (fc_select(max_desc + 1, NULL, &writefs, &exceptfs, &tv) <= 0) {
+    if (sniff_wait(&flush_sniff, &tv) <= 0) {
       return;
     }
 
@@ -394,13 +938,13 @@ void flush_packets(void)
       struct connection *pconn = &connections[i];
 
       if (pconn->used && !pconn->server.is_closing) {
-        if (FD_ISSET(pconn->sock, &exceptfs)) {
+        if (sniff_ready(&flush_sniff, pconn->sock, SNIFF_EXCEPT)) {
           log_verbose("connection (%s) cut due to exception data",
                       conn_description(pconn));
           connection_close_server(pconn, _("network exception"));
         } else {
-          if (pconn->send_buffer && pconn->send_buffer->ndata > 0) {
-            if (FD_ISSET(pconn->sock, &writefs)) {
+          if (0 < connection_send_pending(pconn)) {
+            if (sniff_ready(&flush_sniff, pconn->sock, SNIFF_WRITE)) {
               flush_connection_send_buffer_all(pconn);
             } else {
               cut_lagging_connection(pconn);
@@ -494,10 +1038,9 @@ functions.  That is, other functions should not need to do so.  --dwp
 enum server_events server_sniff_all_input(void)
 {
   int i, s;
-  int max_desc;
   bool excepting;
-  fd_set readfs, writefs, exceptfs;
   fc_timeval tv;
+  struct timer *wakeup_timer = NULL;
 #ifdef FREECIV_SOCKET_ZERO_NOT_STDIN
   char *bufptr;
 #endif
@@ -543,8 +1086,17 @@ enum server_events server_sniff_all_input(void)
 #endif /* FREECIV_HAVE_LIBREADLINE */
 
   while (TRUE) {
+    if (NULL != wakeup_timer) {
+      /* Account the handling of the previous wakeup. */
+      sniff_stats_add_wakeup(wakeup_timer);
+      wakeup_timer = NULL;
+    }
+
     con_prompt_on();		/* accepting new input */
 
+    /* Send the tile changes of the previous wakeup. */
+    flush_all_tile_info();
+
     if (force_end_of_sniff) {
       force_end_of_sniff = FALSE;
       con_prompt_off();
@@ -659,43 +1211,30 @@ enum server_events server_sniff_all_input(void)
     tv.tv_sec = 1;
     tv.tv_usec = 0;
 
-    FC_FD_ZERO(&readfs);
-    FC_FD_ZERO(&writefs);
-    FC_FD_ZERO(&exceptfs);
-
-    if (!no_input) {
+    /* The listening sockets and the connections are watched when they
+     * are opened; see also server_conn_send_pending_notify(). */
 #ifdef FREECIV_SOCKET_ZERO_NOT_STDIN
+    if (!no_input) {
       fc_init_console();
+    }
 #else /* FREECIV_SOCKET_ZERO_NOT_STDIN */
 #   if !defined(__VMS)
-      FD_SET(0, &readfs);
+    sniff_watch(&main_sniff, 0, no_input ? 0 : SNIFF_READ, NULL);
 #   endif /* VMS */
 #endif /* FREECIV_SOCKET_ZERO_NOT_STDIN */
-    }
+    con_prompt_off();		/* output doesn't generate a new prompt */
 
-    max_desc = 0;
-    for (i = 0; i < listen_count; i++) {
-      FD_SET(listen_socks[i], &readfs);
-      FD_SET(listen_socks[i], &exceptfs);
-      max_desc = MAX(max_desc, listen_socks[i]);
-    }
+    /* Account the CPU time of the wait too: it leaves out the time spent
+     * blocked, but not what the wait itself costs. */
+    wakeup_timer = timer_renew(wakeup_timer, TIMER_CPU, TIMER_ACTIVE);
+    timer_start(wakeup_timer);
 
-    for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
-      struct connection *pconn = connections + i;
+    sniff_stats.waits++;
+    if (sniff_wait(&main_sniff, &tv) == 0) {
+      /* timeout; only the wakeups with input are accounted. */
+      timer_destroy(wakeup_timer);
+      wakeup_timer = NULL;
 
-      if (pconn->used && !pconn->server.is_closing) {
-        FD_SET(pconn->sock, &readfs);
-        if (0 < pconn->send_buffer->ndata) {
-          FD_SET(pconn->sock, &writefs);
-        }
-        FD_SET(pconn->sock, &exceptfs);
-        max_desc = MAX(pconn->sock, max_desc);
-      }
-    }
-    con_prompt_off();		/* output doesn't generate a new prompt */
-
-    if (fc_select(max_desc + 1, &readfs, &writefs, &exceptfs, &tv) == 0) {
-      /* timeout */
       call_ai_refresh();
       script_server_signal_emit("pulse", 0);
       (void) send_server_info_to_metaserver(META_REFRESH);
@@ -735,7 +1274,7 @@ enum server_events server_sniff_all_input(void)
 	    lib$stop(status);
 	  }
 	  if (ttchar.numchars) {
-	    FD_SET(0, &readfs);
+	    sniff_watch(&main_sniff, 0, SNIFF_READ, NULL);
 	  } else {
 	    continue;
 	  }
@@ -751,7 +1290,7 @@ enum server_events server_sniff_all_input(void)
 
     excepting = FALSE;
     for (i = 0; i < listen_count; i++) {
-      if (FD_ISSET(listen_socks[i], &exceptfs)) {
+      if (sniff_ready(&main_sniff, listen_socks[i], SNIFF_EXCEPT)) {
         excepting = TRUE;
         break;
       }
@@ -761,7 +1300,7 @@ enum server_events server_sniff_all_input(void)
     }
     for (i = 0; i < listen_count; i++) {
       s = listen_socks[i];
-      if (FD_ISSET(s, &readfs)) {     /* new players connects */
+      if (sniff_ready(&main_sniff, s, SNIFF_READ)) { /* new players connects */
         log_verbose("got new connection");
         if (-1 == server_accept_connection(s)) {
           /* There will be a log_error() message from
@@ -772,18 +1311,18 @@ enum server_events server_sniff_all_input(void)
         }
       }
     }
-    for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
+    sniff_ready_iterate(&main_sniff, fd, data) {
       /* check for freaky players */
-      struct connection *pconn = &connections[i];
+      struct connection *pconn = data;
 
-      if (pconn->used
+      if (NULL != pconn
           && !pconn->server.is_closing
-          && FD_ISSET(pconn->sock, &exceptfs)) {
+          && sniff_ready(&main_sniff, fd, SNIFF_EXCEPT)) {
         log_verbose("connection (%s) cut due to exception data",
                     conn_description(pconn));
         connection_close_server(pconn, _("network exception"));
       }
-    }
+    } sniff_ready_iterate_end;
 #ifdef FREECIV_SOCKET_ZERO_NOT_STDIN
     if (!no_input && (bufptr = fc_read_console())) {
       char *bufptr_internal = local_to_internal_string_malloc(bufptr);
@@ -793,7 +1332,7 @@ enum server_events server_sniff_all_input(void)
       free(bufptr_internal);
     }
 #else  /* !FREECIV_SOCKET_ZERO_NOT_STDIN */
-    if (!no_input && FD_ISSET(0, &readfs)) {    /* input from server operator */
+    if (!no_input && sniff_ready(&main_sniff, 0, SNIFF_READ)) { /* input from server operator */
 #ifdef FREECIV_HAVE_LIBREADLINE
       rl_callback_read_char();
       if (readline_handled_input) {
@@ -843,13 +1382,13 @@ enum server_events server_sniff_all_input(void)
 #endif /* !FREECIV_SOCKET_ZERO_NOT_STDIN */
 
     {                             /* input from a player */
-      for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
-        struct connection *pconn = connections + i;
+      sniff_ready_iterate(&main_sniff, fd, data) {
+        struct connection *pconn = data;
         int nb;
 
-        if (!pconn->used
+        if (NULL == pconn
             || pconn->server.is_closing
-            || !FD_ISSET(pconn->sock, &readfs)) {
+            || !sniff_ready(&main_sniff, fd, SNIFF_READ)) {
           continue;
         }
 
@@ -863,28 +1402,26 @@ enum server_events server_sniff_all_input(void)
           /* Read failure; the connection is closed. */
           connection_close_server(pconn, _("read error"));
         }
-      }
-
-      for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
-        struct connection *pconn = &connections[i];
+      } sniff_ready_iterate_end;
 
-        if (pconn->used
-            && !pconn->server.is_closing
-            && pconn->send_buffer
-            && pconn->send_buffer->ndata > 0) {
-          if (FD_ISSET(pconn->sock, &writefs)) {
-            flush_connection_send_buffer_all(pconn);
-          } else {
-            cut_lagging_connection(pconn);
-          }
+      /* Flushing the connection may remove it from the list. */
+      conn_list_iterate(send_pending_conns, pconn) {
+        if (sniff_ready(&main_sniff, pconn->sock, SNIFF_WRITE)) {
+          flush_connection_send_buffer_all(pconn);
+        } else {
+          cut_lagging_connection(pconn);
         }
-      }
+      } conn_list_iterate_end;
       really_close_connections();
       break;
     }
   }
   con_prompt_off();
 
+  if (NULL != wakeup_timer) {
+    sniff_stats_add_wakeup(wakeup_timer);
+  }
+
   call_ai_refresh();
   script_server_signal_emit("pulse", 0);
 
@@ -1046,7 +1583,7 @@ int server_make_connection(int new_sock, const char *client_addr,
       pconn->playing = NULL;
       pconn->capability[0] = '\0';
       pconn->access_level = access_level_for_next_connection();
-      pconn->notify_of_writable_data = NULL;
+      pconn->notify_of_writable_data = server_conn_send_pending_notify;
       pconn->server.currently_processed_request_id = 0;
       pconn->server.last_request_id_seen = 0;
       pconn->server.auth_tries = 0;
@@ -1056,16 +1593,18 @@ int server_make_connection(int new_sock, const char *client_addr,
       pconn->server.granted_access_level = pconn->access_level;
       pconn->server.ignore_list =
           conn_pattern_list_new_full(conn_pattern_destroy);
+      pconn->server.tile_info_queue = NULL;
       pconn->server.is_closing = FALSE;
       pconn->ping_time = -1.0;
       pconn->incoming_packet_notify = NULL;
-      pconn->outgoing_packet_notify = NULL;
+      pconn->outgoing_packet_notify = tile_info_packet_notify;
 
       sz_strlcpy(pconn->username, makeup_connection_name(&pconn->id));
       sz_strlcpy(pconn->addr, client_addr);
       sz_strlcpy(pconn->server.ipaddr, client_ip);
 
       conn_list_append(game.all_connections, pconn);
+      sniff_watch(&main_sniff, new_sock, SNIFF_READ | SNIFF_EXCEPT, pconn);
 
       log_verbose("connection (%s) from %s (%s)", 
                   pconn->username, pconn->addr, pconn->server.ipaddr);
@@ -1188,6 +1727,7 @@ int server_open_socket(void)
          * connections. */
         fc_closesocket(s);
         for (j = 0; j < listen_count; j++) {
+          sniff_forget(&main_sniff, listen_socks[j]);
           fc_closesocket(listen_socks[j]);
         }
         listen_count = 0;
@@ -1204,6 +1744,7 @@ int server_open_socket(void)
     }
 
     listen_socks[listen_count++] = s;
+    sniff_watch(&main_sniff, s, SNIFF_READ | SNIFF_EXCEPT, NULL);
   } fc_sockaddr_list_iterate_end;
 
   if (listen_count == 0) {
@@ -1331,6 +1872,10 @@ void init_connections(void)
     pconn->self = conn_list_new();
     conn_list_prepend(pconn->self, pconn);
   }
+
+  sniff_init(&main_sniff);
+  sniff_init(&flush_sniff);
+  send_pending_conns = conn_list_new();
 #if defined(__VMS)
   {
     unsigned long status;
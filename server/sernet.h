@@ -33,6 +33,20 @@ enum server_events {
 
 enum server_events server_sniff_all_input(void);
 
+/* Statistics of server_sniff_all_input(): how often it waited, how often
+ * it woke up to handle input, and the CPU time spent in those wakeups,
+ * the wait included. */
+struct sniff_stats {
+  unsigned long waits;
+  unsigned long wakeups;
+  double total_seconds;
+  double max_seconds;
+};
+
+const char *sniff_backend_name(void);
+void sniff_stats_get(struct sniff_stats *stats);
+void sniff_stats_reset(void);
+
 int server_open_socket(void);
 void flush_packets(void);
 void close_connections_and_socket(void);
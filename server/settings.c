@@ -533,6 +533,12 @@ compresstype_name(enum fz_method compresstype)
 #endif
 #ifdef FREECIV_HAVE_LIBLZMA
   NAME_CASE(FZ_XZ, "XZ", N_("Using xz"));
+#endif
+#ifdef FREECIV_HAVE_LIBZSTD
+  NAME_CASE(FZ_ZSTD, "ZSTD", N_("Using zstd"));
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+  NAME_CASE(FZ_LZ4, "LZ4", N_("Using lz4"));
 #endif
   }
   return NULL;
@@ -2761,6 +2767,18 @@ static struct setting settings[] = {
              "includes \"New turn\"."), NULL, NULL, NULL,
           GAME_MIN_SAVETURNS, GAME_MAX_SAVETURNS, GAME_DEFAULT_SAVETURNS)
 
+  GEN_INT("savedeltas", game.server.save_deltas,
+          SSET_META, SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
+          N_("Delta autosaves between full ones"),
+          /* TRANS: The string between double quotes is also translated
+           * separately (it must match!). */
+          N_("If non-zero, each full \"New turn\" autosave is followed "
+             "by this many ones which only hold what changed since it. "
+             "They are much smaller and faster to write. Loading one of "
+             "them needs the full autosave it refers to, in the same "
+             "directory."), NULL, NULL, NULL,
+          GAME_MIN_SAVEDELTAS, GAME_MAX_SAVEDELTAS, GAME_DEFAULT_SAVEDELTAS)
+
   GEN_INT("savefrequency", game.server.save_frequency,
           SSET_META, SSET_INTERNAL, SSET_VITAL, ALLOW_HACK, ALLOW_HACK,
           N_("Minutes per auto-save"),
@@ -2801,9 +2819,22 @@ static struct setting settings[] = {
            N_("If this is turned in, compressing and saving the actual "
               "file containing the game situation takes place in "
               "the background while game otherwise continues. This way "
-              "users are not required to wait for the save to finish."),
+              "users are not required to wait for the save to finish. "
+              "Where possible, turn and timer autosaves are then done "
+              "entirely by a separate process working on a snapshot of "
+              "the game."),
            NULL, NULL, GAME_DEFAULT_THREADED_SAVE)
 
+  GEN_INT("workers", game.server.workers,
+          SSET_META, SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
+          N_("Number of worker threads"),
+          N_("How many threads help the main one with the computations "
+             "that can be split, like the danger assessment of the AI "
+             "players. The results do not depend on this setting. With "
+             "0, everything is computed in the main thread."),
+          NULL, NULL, NULL, GAME_MIN_WORKERS, GAME_MAX_WORKERS,
+          GAME_DEFAULT_WORKERS)
+
   GEN_INT("compress", game.server.save_compress_level,
           SSET_META, SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
           N_("Savegame compression level"),
@@ -2820,6 +2851,27 @@ static struct setting settings[] = {
            N_("Compression library to use for savegames."),
            NULL, NULL, NULL, compresstype_name, GAME_DEFAULT_COMPRESS_TYPE)
 
+  GEN_BOOL("compresslong", game.server.save_compress_long,
+           SSET_META, SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
+           N_("Whether to use long range savegame compression"),
+           /* TRANS: 'compresstype' setting name and 'ZSTD' value should
+            * not be translated. */
+           N_("With the 'ZSTD' 'compresstype', find repetitions much "
+              "further back in the savegame, which compresses big maps "
+              "better at the cost of more memory. Other compression "
+              "types ignore this setting."),
+           NULL, NULL, GAME_DEFAULT_COMPRESS_LONG)
+
+  GEN_BOOL("savebinary", game.server.save_binary,
+           SSET_META, SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
+           N_("Whether to save games in binary format"),
+           N_("Binary savegames hold the same data as the text ones but "
+              "are smaller and much faster to load, and a single part of "
+              "them, like the map, can be read without the rest. They "
+              "can't be read with a text editor; the freeciv-savconv tool "
+              "converts between both formats."),
+           NULL, NULL, GAME_DEFAULT_SAVE_BINARY)
+
   GEN_STRING("savename", game.server.save_name,
              SSET_META, SSET_INTERNAL, SSET_VITAL, ALLOW_HACK, ALLOW_HACK,
              N_("Definition of the save file name"),
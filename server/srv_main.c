@@ -56,9 +56,11 @@
 #include "registry.h"
 #include "support.h"
 #include "timing.h"
+#include "workpool.h"
 
 /* common/aicore */
 #include "citymap.h"
+#include "path_finding.h"
 
 /* common */
 #include "achievements.h"
@@ -104,6 +106,7 @@
 #include "report.h"
 #include "ruleset.h"
 #include "sanitycheck.h"
+#include "savedelta.h"
 #include "savegame.h"
 #include "score.h"
 #include "sernet.h"
@@ -189,6 +192,10 @@ static struct timer *eot_timer = NULL;
 
 static struct timer *between_turns = NULL;
 
+/* Worker threads, see server_workpool(). */
+static struct fc_workpool *workpool = NULL;
+static int workpool_workers = 0;
+
 /**************************************************************************
   Initialize the game seed.  This may safely be called multiple times.
 **************************************************************************/
@@ -714,11 +721,13 @@ static void update_environmental_upset(enum environment_upset_type type,
   count = 0;
   extra_type_iterate(cause) {
     if (extra_causes_env_upset(cause, type)) {
-      whole_map_iterate(ptile) {
-        if (tile_has_extra(ptile, cause)) {
+      int idx = extra_index(cause);
+
+      whole_map_index_iterate(tindex) {
+        if (BV_ISSET(*map_packed_extras(tindex), idx)) {
           count++;
         }
-      } whole_map_iterate_end;
+      } whole_map_index_iterate_end;
     }
   } extra_type_iterate_end;
 
@@ -789,6 +798,7 @@ static void update_diplomatics(void)
 
         state->has_reason_to_cancel = MAX(state->has_reason_to_cancel - 1, 0);
         state->contact_turns_left = MAX(state->contact_turns_left - 1, 0);
+        effect_cache_invalidate();
 
         if (state->type == DS_ARMISTICE
             /* Don't count down if auto canceled this turn. Auto canceling
@@ -800,6 +810,7 @@ static void update_diplomatics(void)
             state2->type = DS_PEACE;
             state->turns_left = 0;
             state2->turns_left = 0;
+            effect_cache_invalidate();
             remove_illegal_armistice_units(plr1, plr2);
           }
         }
@@ -831,6 +842,7 @@ static void update_diplomatics(void)
             state2->type = DS_WAR;
             state->turns_left = 0;
             state2->turns_left = 0;
+            effect_cache_invalidate();
 
             enter_war(plr1, plr2);
 
@@ -862,6 +874,7 @@ static void update_diplomatics(void)
                 /* Cancel the alliance. */
                 to1->has_reason_to_cancel = TRUE;
                 to2->has_reason_to_cancel = TRUE;
+                effect_cache_invalidate();
                 handle_diplomacy_cancel_pact(plr3, player_number(plr1), CLAUSE_ALLIANCE);
                 handle_diplomacy_cancel_pact(plr3, player_number(plr2), CLAUSE_ALLIANCE);
 
@@ -1045,6 +1058,9 @@ static void begin_phase(bool is_new_phase)
 {
   log_debug("Begin phase");
 
+  pf_map_pool_flush();
+  effect_cache_invalidate();
+
   conn_list_do_buffer(game.est_connections);
 
   phase_players_iterate(pplayer) {
@@ -1072,6 +1088,7 @@ static void begin_phase(bool is_new_phase)
   } phase_players_iterate_end;
 
   if (is_new_phase) {
+    city_refresh_queue_freeze();
     /* Unit "end of turn" activities - of course these actually go at
      * the start of the turn! */
     phase_players_iterate(pplayer) {
@@ -1087,6 +1104,7 @@ static void begin_phase(bool is_new_phase)
     phase_players_iterate(pplayer) {
       finalize_unit_phase_beginning(pplayer);
     } phase_players_iterate_end;
+    city_refresh_queue_thaw();
     flush_packets();
   }
 
@@ -1260,6 +1278,13 @@ static void end_phase(void)
        is initialized for human players also. */
     adv_data_phase_done(pplayer);
   } phase_players_iterate_end;
+
+  /* Path-finding maps are not kept from a phase to another. */
+  pf_map_pool_flush();
+  log_verbose("Path-finding map pool: %d hits, %d misses, %d rebuilds.",
+              pf_map_pool_stats()->hits, pf_map_pool_stats()->misses,
+              pf_map_pool_stats()->rebuilds);
+  pf_map_pool_stats_reset();
 }
 
 /**************************************************************************
@@ -1518,7 +1543,17 @@ void save_game_auto(const char *save_reason, enum autosave_type type)
   } else {
     fc_snprintf(filename, sizeof(filename), "%s-timer", game.server.save_name);
   }
-  save_game(filename, save_reason, FALSE);
+
+  if (AS_TURN == type && 0 < game.server.save_deltas) {
+    /* Only what changed since the last full autosave, when possible. */
+    save_game_delta(filename, save_reason);
+  } else if (game.server.threaded_save
+             && (AS_TURN == type || AS_TIMER == type)) {
+    /* The game goes on: don't make it wait for the save. */
+    save_game_background(filename, save_reason);
+  } else {
+    save_game(filename, save_reason, FALSE);
+  }
 }
 
 /**************************************************************************
@@ -1871,10 +1906,13 @@ bool server_packet_input(struct connection *pconn, void *packet, int type)
   /* Make sure to set this back to NULL before leaving this function: */
   pplayer->current_conn = pconn;
 
+  /* Refresh each city touched by the request only once. */
+  city_refresh_queue_freeze();
   if (!server_handle_packet(type, packet, pplayer, pconn)) {
     log_error("Received unknown packet %d from %s.",
               type, conn_description(pconn));
   }
+  city_refresh_queue_thaw();
 
   if (S_S_RUNNING == server_state()
       && type != PACKET_PLAYER_READY) {
@@ -3045,6 +3083,7 @@ static void srv_ready(void)
         }
       } players_iterate_end;
     } players_iterate_end;
+    effect_cache_invalidate();
 
     /* Assign colors from the ruleset for any players who weren't
      * explicitly assigned colors during the pregame.
@@ -3139,6 +3178,16 @@ void server_game_free(void)
   /* Free all the treaties that were left open when game finished. */
   free_treaties();
 
+  pf_map_pool_flush();
+  effect_cache_invalidate();
+  /* Don't make delta autosaves against the last game. */
+  savedelta_free();
+
+  /* The tiles queued for the clients are those of the map freed here. */
+  conn_list_iterate(game.all_connections, pconn) {
+    free_tile_info_queue(pconn);
+  } conn_list_iterate_end;
+
   /* Free the vision data, without sending updates. */
   players_iterate(pplayer) {
     unit_list_iterate(pplayer->units, punit) {
@@ -3171,7 +3220,51 @@ void server_game_free(void)
   log_civ_score_free();
   playercolor_free();
   citymap_free();
+  player_map_extras_free();
   game_free();
+
+  if (NULL != workpool) {
+    fc_workpool_destroy(workpool);
+    workpool = NULL;
+  }
+}
+
+/**************************************************************************
+  Return the pool of worker threads, matching the 'workers' server
+  setting. Returns NULL if there are no worker threads, which
+  fc_workpool_run() accepts.
+**************************************************************************/
+static struct fc_workpool *server_workpool(void)
+{
+  if (NULL != workpool && workpool_workers != game.server.workers) {
+    fc_workpool_destroy(workpool);
+    workpool = NULL;
+  }
+
+  if (NULL == workpool && 0 < game.server.workers) {
+    workpool = fc_workpool_new(game.server.workers);
+    workpool_workers = game.server.workers;
+  }
+
+  return workpool;
+}
+
+/**************************************************************************
+  Run the jobs on the worker threads of the server, see fc_workpool_run().
+  The jobs must not modify the game. The effect cache is frozen
+  meanwhile, so that the jobs can safely query effects.
+**************************************************************************/
+void server_workpool_run(int num_jobs, fc_workpool_job_fn func, void *data)
+{
+  struct fc_workpool *pool = server_workpool();
+
+  if (0 < fc_workpool_num_workers(pool) && 1 < num_jobs) {
+    effect_cache_freeze(TRUE);
+    fc_workpool_run(pool, num_jobs, func, data);
+    effect_cache_freeze(FALSE);
+  } else {
+    fc_workpool_run(pool, num_jobs, func, data);
+  }
 }
 
 /**************************************************************************
@@ -3290,7 +3383,7 @@ static struct terrain
 {
   if (knowledge && pplayer) {
     struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
-    return plrtile->terrain;
+    return player_tile_terrain(plrtile);
   }
 
   return tile_terrain(ptile);
@@ -3306,7 +3399,7 @@ static struct player *mapimg_server_tile_owner(const struct tile *ptile,
   if (knowledge && pplayer
       && tile_get_known(ptile, pplayer) != TILE_KNOWN_SEEN) {
     struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
-    return plrtile->owner;
+    return player_tile_owner(plrtile);
   }
 
   return tile_owner(ptile);
@@ -16,6 +16,7 @@
 /* utility */
 #include "log.h"        /* enum log_level */
 #include "net_types.h"  /* announce_type */
+#include "workpool.h"   /* fc_workpool_job_fn */
 
 /* common */
 #include "fc_types.h"
@@ -111,6 +112,7 @@ void identity_number_reserve(int id);
 int identity_number(void);
 void server_game_init(void);
 void server_game_free(void);
+void server_workpool_run(int num_jobs, fc_workpool_job_fn func, void *data);
 const char *aifill(int amount);
 
 extern struct server_arguments srvarg;
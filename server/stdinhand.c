@@ -36,8 +36,13 @@
 #include "support.h"            /* fc__attribute, bool type, etc. */
 #include "timing.h"
 
+/* common/aicore */
+#include "path_finding.h"
+#include "pf_tools.h"
+
 /* common */
 #include "capability.h"
+#include "effects.h"
 #include "events.h"
 #include "fc_types.h" /* LINE_BREAK */
 #include "featured_text.h"
@@ -55,6 +60,7 @@
 /* server */
 #include "aiiface.h"
 #include "citytools.h"
+#include "cityturn.h"
 #include "connecthand.h"
 #include "diplhand.h"
 #include "gamehand.h"
@@ -66,6 +72,7 @@
 #include "report.h"
 #include "ruleset.h"
 #include "sanitycheck.h"
+#include "savedelta.h"
 #include "savegame.h"
 #include "score.h"
 #include "sernet.h"
@@ -75,6 +82,9 @@
 #include "techtools.h"
 #include "voting.h"
 
+/* server/advisors */
+#include "advgoto.h"
+
 /* server/scripting */
 #include "script_server.h"
 #include "script_fcdb.h"
@@ -2622,6 +2632,217 @@ static bool cancelvote_command(struct connection *caller,
   return TRUE;
 }
 
+/******************************************************************
+  Iterate 'pfm' until 'ptile' is processed, and fill the position.
+  Returns the number of nodes expanded.
+******************************************************************/
+static int debug_pathfinding_query(struct pf_map *pfm, struct tile *ptile,
+                                   struct pf_position *pos,
+                                   struct timer *ptimer)
+{
+  int nodes = 0;
+
+  timer_start(ptimer);
+  while (pf_map_iter(pfm) != ptile && pf_map_iterate(pfm)) {
+    nodes++;
+  }
+  if (!pf_map_position(pfm, ptile, pos)) {
+    pos->total_MC = PF_IMPOSSIBLE_MC;
+    pos->total_EC = 0;
+  }
+  timer_stop(ptimer);
+
+  return nodes;
+}
+
+/******************************************************************
+  Compare the targeted path-finding maps to the flood maps for goto
+  queries of every unit to 'count' pseudo-random tiles. Does not use
+  the game random number generator.
+******************************************************************/
+static void debug_pathfinding(struct connection *caller, int count)
+{
+  struct timer *flood_timer = timer_new(TIMER_CPU, TIMER_ACTIVE);
+  struct timer *targeted_timer = timer_new(TIMER_CPU, TIMER_ACTIVE);
+  long flood_nodes = 0, targeted_nodes = 0;
+  int queries = 0, reachable = 0, mismatches = 0;
+  unsigned int seed = 1;
+
+  players_iterate(pplayer) {
+    unit_list_iterate(pplayer->units, punit) {
+      int i;
+
+      for (i = 0; i < count; i++) {
+        struct pf_parameter parameter;
+        struct adv_risk_cost risk_cost;
+        struct pf_position flood_pos, targeted_pos;
+        struct pf_map *pfm;
+        struct tile *ptile;
+
+        seed = seed * 1103515245 + 12345;
+        ptile = index_to_tile((seed >> 8) % MAP_INDEX_SIZE);
+
+        pft_fill_unit_parameter(&parameter, punit);
+        if (i % 2 == 1) {
+          /* Half of the queries avoid risks, like the advisors do. */
+          adv_avoid_risks(&parameter, &risk_cost, punit,
+                          NORMAL_STACKING_FEARFULNESS);
+        }
+
+        pfm = pf_map_new(&parameter);
+        flood_nodes += debug_pathfinding_query(pfm, ptile, &flood_pos,
+                                               flood_timer);
+        pf_map_destroy(pfm);
+
+        pfm = pf_map_new_targeted(&parameter, ptile);
+        targeted_nodes += debug_pathfinding_query(pfm, ptile, &targeted_pos,
+                                                  targeted_timer);
+        pf_map_destroy(pfm);
+
+        if (flood_pos.total_MC != targeted_pos.total_MC
+            || flood_pos.total_EC != targeted_pos.total_EC) {
+          mismatches++;
+        }
+        if (PF_IMPOSSIBLE_MC != flood_pos.total_MC) {
+          reachable++;
+        }
+        queries++;
+      }
+    } unit_list_iterate_end;
+  } players_iterate_end;
+
+  cmd_reply(CMD_DEBUG, caller, C_OK,
+            _("Path-finding: %d queries (%d reachable), "
+              "%d different results."),
+            queries, reachable, mismatches);
+  cmd_reply(CMD_DEBUG, caller, C_OK,
+            _("Flood maps: %ld nodes expanded in %.3f seconds."),
+            flood_nodes, timer_read_seconds(flood_timer));
+  cmd_reply(CMD_DEBUG, caller, C_OK,
+            _("Targeted maps: %ld nodes expanded in %.3f seconds."),
+            targeted_nodes, timer_read_seconds(targeted_timer));
+
+  timer_destroy(flood_timer);
+  timer_destroy(targeted_timer);
+}
+
+/******************************************************************
+  Evaluate the requirements of the effect, either from the requirement
+  vector, from the compiled plan, or both to compare them. Returns
+  whether the effect is active, or whether the results differ when
+  comparing.
+******************************************************************/
+static bool debug_requirements_eval(const struct effect *peffect,
+                                    const struct player *pplayer,
+                                    const struct city *pcity,
+                                    const struct unit_type *putype,
+                                    const struct output_type *poutput,
+                                    bool vector, bool plan,
+                                    enum req_problem_type prob_type)
+{
+  const struct tile *ptile = (NULL != pcity ? city_tile(pcity) : NULL);
+  bool old_active = FALSE, new_active = FALSE;
+
+  if (vector) {
+    old_active = are_reqs_active(pplayer, NULL, pcity, NULL, ptile, NULL,
+                                 putype, poutput, NULL, NULL,
+                                 &peffect->reqs, prob_type);
+  }
+  if (plan) {
+    new_active = req_plan_active(pplayer, NULL, pcity, NULL, ptile, NULL,
+                                 putype, poutput, NULL, NULL,
+                                 peffect->plan, prob_type);
+  }
+
+  return (vector && plan ? old_active != new_active
+                         : old_active || new_active);
+}
+
+/******************************************************************
+  Evaluate the requirements of every effect for every city (with every
+  output type) and for every player (with every unit type). Returns the
+  sum of the results of debug_requirements_eval(). 'evals' is increased
+  by the number of evaluations.
+******************************************************************/
+static long debug_requirements_round(bool vector, bool plan,
+                                     enum req_problem_type prob_type,
+                                     long *evals)
+{
+  long count = 0;
+  enum effect_type type;
+
+  for (type = 0; type < EFT_COUNT; type++) {
+    effect_list_iterate(get_effects(type), peffect) {
+      players_iterate_alive(pplayer) {
+        city_list_iterate(pplayer->cities, pcity) {
+          output_type_iterate(o) {
+            count += debug_requirements_eval(peffect, pplayer, pcity, NULL,
+                                             get_output_type(o),
+                                             vector, plan, prob_type);
+            (*evals)++;
+          } output_type_iterate_end;
+        } city_list_iterate_end;
+
+        unit_type_iterate(putype) {
+          count += debug_requirements_eval(peffect, pplayer, NULL, putype,
+                                           NULL, vector, plan, prob_type);
+          (*evals)++;
+        } unit_type_iterate_end;
+      } players_iterate_alive_end;
+    } effect_list_iterate_end;
+  }
+
+  return count;
+}
+
+/******************************************************************
+  Compare the evaluation of the compiled requirement plans of the
+  effects to the evaluation of their requirement vectors, 'rounds'
+  times.
+******************************************************************/
+static void debug_requirements(struct connection *caller, int rounds)
+{
+  struct timer *vector_timer = timer_new(TIMER_CPU, TIMER_ACTIVE);
+  struct timer *plan_timer = timer_new(TIMER_CPU, TIMER_ACTIVE);
+  long evals = 0, vector_active = 0, plan_active = 0, mismatches;
+  int i;
+
+  mismatches = debug_requirements_round(TRUE, TRUE, RPT_CERTAIN, &evals)
+               + debug_requirements_round(TRUE, TRUE, RPT_POSSIBLE, &evals);
+
+  evals = 0;
+  timer_start(vector_timer);
+  for (i = 0; i < rounds; i++) {
+    vector_active += debug_requirements_round(TRUE, FALSE, RPT_CERTAIN,
+                                              &evals);
+  }
+  timer_stop(vector_timer);
+
+  timer_start(plan_timer);
+  for (i = 0; i < rounds; i++) {
+    plan_active += debug_requirements_round(FALSE, TRUE, RPT_CERTAIN,
+                                            &evals);
+  }
+  timer_stop(plan_timer);
+  evals /= 2;
+
+  cmd_reply(CMD_DEBUG, caller, C_OK,
+            _("Requirements: %ld evaluations per method, "
+              "%ld different results."),
+            evals, mismatches + labs(vector_active - plan_active));
+  cmd_reply(CMD_DEBUG, caller, C_OK,
+            _("Requirement vectors: %.3f seconds (%.0f evaluations/s)."),
+            timer_read_seconds(vector_timer),
+            evals / MAX(timer_read_seconds(vector_timer), 1e-6));
+  cmd_reply(CMD_DEBUG, caller, C_OK,
+            _("Requirement plans: %.3f seconds (%.0f evaluations/s)."),
+            timer_read_seconds(plan_timer),
+            evals / MAX(timer_read_seconds(plan_timer), 1e-6));
+
+  timer_destroy(vector_timer);
+  timer_destroy(plan_timer);
+}
+
 /******************************************************************
   Turn on selective debugging.
 ******************************************************************/
@@ -2779,6 +3000,92 @@ static bool debug_command(struct connection *caller, char *str,
     } unit_list_iterate_end;
   } else if (ntokens > 0 && strcmp(arg[0], "timing") == 0) {
     TIMING_RESULTS();
+  } else if (ntokens > 0 && strcmp(arg[0], "pathfinding") == 0) {
+    int count = 1;
+
+    if (ntokens > 2
+        || (ntokens == 2 && (!str_to_int(arg[1], &count) || count <= 0))) {
+      cmd_reply(CMD_DEBUG, caller, C_SYNTAX,
+                _("Undefined argument.  Usage:\n%s"),
+                command_synopsis(command_by_number(CMD_DEBUG)));
+      goto cleanup;
+    }
+    debug_pathfinding(caller, count);
+  } else if (ntokens > 0 && strcmp(arg[0], "requirements") == 0) {
+    int rounds = 1;
+
+    if (ntokens > 2
+        || (ntokens == 2 && (!str_to_int(arg[1], &rounds) || rounds <= 0))) {
+      cmd_reply(CMD_DEBUG, caller, C_SYNTAX,
+                _("Undefined argument.  Usage:\n%s"),
+                command_synopsis(command_by_number(CMD_DEBUG)));
+      goto cleanup;
+    }
+    debug_requirements(caller, rounds);
+  } else if (ntokens > 0 && strcmp(arg[0], "effects") == 0) {
+    struct effect_cache_stats stats;
+    unsigned long lookups;
+
+    if (ntokens > 2 || (ntokens == 2 && strcmp(arg[1], "reset") != 0)) {
+      cmd_reply(CMD_DEBUG, caller, C_SYNTAX,
+                _("Undefined argument.  Usage:\n%s"),
+                command_synopsis(command_by_number(CMD_DEBUG)));
+      goto cleanup;
+    }
+    effect_cache_stats_get(&stats);
+    lookups = stats.hits + stats.misses;
+    cmd_reply(CMD_DEBUG, caller, C_OK,
+              _("Effect cache: %lu hits, %lu misses (%.1f%% hits), "
+                "%lu uncached queries, %lu invalidations."),
+              stats.hits, stats.misses,
+              0 < lookups ? 100.0 * stats.hits / lookups : 0.0,
+              stats.uncached, stats.invalidations);
+    if (ntokens == 2) {
+      effect_cache_stats_reset();
+      cmd_reply(CMD_DEBUG, caller, C_OK, _("Effect cache statistics reset."));
+    }
+  } else if (ntokens > 0 && strcmp(arg[0], "cityrefresh") == 0) {
+    struct city_refresh_stats stats;
+
+    if (ntokens > 2 || (ntokens == 2 && strcmp(arg[1], "reset") != 0)) {
+      cmd_reply(CMD_DEBUG, caller, C_SYNTAX,
+                _("Undefined argument.  Usage:\n%s"),
+                command_synopsis(command_by_number(CMD_DEBUG)));
+      goto cleanup;
+    }
+    city_refresh_stats_get(&stats);
+    cmd_reply(CMD_DEBUG, caller, C_OK,
+              _("City refreshes: %lu requested, %lu performed "
+                "(%lu coalesced)."),
+              stats.requested, stats.performed,
+              stats.requested - stats.performed);
+    if (ntokens == 2) {
+      city_refresh_stats_reset();
+      cmd_reply(CMD_DEBUG, caller, C_OK,
+                _("City refresh statistics reset."));
+    }
+  } else if (ntokens > 0 && strcmp(arg[0], "sniff") == 0) {
+    struct sniff_stats stats;
+
+    if (ntokens > 2 || (ntokens == 2 && strcmp(arg[1], "reset") != 0)) {
+      cmd_reply(CMD_DEBUG, caller, C_SYNTAX,
+                _("Undefined argument.  Usage:\n%s"),
+                command_synopsis(command_by_number(CMD_DEBUG)));
+      goto cleanup;
+    }
+    sniff_stats_get(&stats);
+    cmd_reply(CMD_DEBUG, caller, C_OK,
+              _("Input (%s): %lu waits, %lu wakeups taking "
+                "%.3f ms of CPU time on average, %.3f ms at most, "
+                "the wait included."),
+              sniff_backend_name(), stats.waits, stats.wakeups,
+              0 < stats.wakeups
+              ? 1000.0 * stats.total_seconds / stats.wakeups : 0.0,
+              1000.0 * stats.max_seconds);
+    if (ntokens == 2) {
+      sniff_stats_reset();
+      cmd_reply(CMD_DEBUG, caller, C_OK, _("Input statistics reset."));
+    }
   } else if (ntokens > 0 && strcmp(arg[0], "ferries") == 0) {
     if (game.server.debug[DEBUG_FERRIES]) {
       game.server.debug[DEBUG_FERRIES] = FALSE;
@@ -3618,7 +3925,7 @@ static bool detach_command(struct connection *caller, char *str, bool check)
 bool load_command(struct connection *caller, const char *filename, bool check,
                   bool cmdline_load)
 {
-  struct timer *loadtimer, *uloadtimer;
+  struct timer *loadtimer, *uloadtimer, *parsetimer;
   struct section_file *file;
   char arg[MAX_LEN_PATH];
   struct conn_list *global_observers;
@@ -3648,7 +3955,8 @@ bool load_command(struct connection *caller, const char *filename, bool check,
       get_save_dirs(), get_scenario_dirs(), NULL
     };
     const char *exts[] = {
-      "sav", "gz", "bz2", "xz", "sav.gz", "sav.bz2", "sav.xz", NULL
+      "sav", "gz", "bz2", "xz", "zst", "lz4", "sav.gz", "sav.bz2",
+      "sav.xz", "sav.zst", "sav.lz4", NULL
     };
     const char **ext, *found = NULL;
     const struct strvec **path;
@@ -3691,7 +3999,13 @@ bool load_command(struct connection *caller, const char *filename, bool check,
 
   /* attempt to parse the file */
 
-  if (!(file = secfile_load(arg, FALSE))) {
+  parsetimer = timer_new(TIMER_USER, TIMER_ACTIVE);
+  timer_start(parsetimer);
+  file = secfile_load(arg, FALSE);
+  log_verbose("Parse time: %g seconds", timer_read_seconds(parsetimer));
+  timer_destroy(parsetimer);
+
+  if (NULL == file) {
     log_error("Error loading savefile '%s': %s", arg, secfile_error());
     cmd_reply(CMD_LOAD, caller, C_FAIL, _("Could not load savefile: %s"),
               arg);
@@ -3699,6 +4013,17 @@ bool load_command(struct connection *caller, const char *filename, bool check,
     return FALSE;
   }
 
+  if (savedelta_check(file)) {
+    /* Rebuild the full game from the base of the delta autosave. */
+    file = savedelta_resolve(file, arg);
+    if (NULL == file) {
+      cmd_reply(CMD_LOAD, caller, C_FAIL, _("Could not load savefile: %s"),
+                arg);
+      dlsend_packet_game_load(game.est_connections, TRUE, arg);
+      return FALSE;
+    }
+  }
+
   if (check) {
     return TRUE;
   }
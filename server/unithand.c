@@ -2531,13 +2531,11 @@ void unit_change_homecity_handling(struct unit *punit, struct city *new_pcity,
   /* Send info to players and observers. */
   send_unit_info(NULL, punit);
 
-  city_refresh(new_pcity);
-  send_city_info(new_owner, new_pcity);
+  city_refresh_schedule(new_pcity);
 
   if (old_pcity) {
     fc_assert(city_owner(old_pcity) == old_owner);
-    city_refresh(old_pcity);
-    send_city_info(old_owner, old_pcity);
+    city_refresh_schedule(old_pcity);
   }
 
   unit_get_goods(punit);
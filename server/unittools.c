@@ -1475,10 +1475,11 @@ bool is_airunit_refuel_point(const struct tile *ptile,
 
   pclass = unit_class_get(punit);
   if (NULL != pclass->cache.refuel_bases) {
-    const struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+    bv_extras extras
+      = player_tile_extras(map_get_player_tile(ptile, pplayer));
 
     extra_type_list_iterate(pclass->cache.refuel_bases, pextra) {
-      if (BV_ISSET(plrtile->extras, extra_index(pextra))) {
+      if (BV_ISSET(extras, extra_index(pextra))) {
         return TRUE;
       }
     } extra_type_list_iterate_end;
@@ -1623,12 +1624,12 @@ struct unit *create_unit_full(struct player *pplayer, struct tile *ptile,
 
   unit_list_prepend(pplayer->units, punit);
   unit_list_prepend(ptile->units, punit);
+  pf_map_pool_tile_changed(ptile);
   if (pcity && !utype_has_flag(type, UTYF_NOHOME)) {
     fc_assert(city_owner(pcity) == pplayer);
     unit_list_prepend(pcity->units_supported, punit);
     /* Refresh the unit's homecity. */
-    city_refresh(pcity);
-    send_city_info(pplayer, pcity);
+    city_refresh_schedule(pcity);
   }
 
   punit->server.vision = vision_new(pplayer, ptile);
@@ -1762,6 +1763,7 @@ static void server_remove_unit_full(struct unit *punit, bool transported,
   script_server_remove_exported_object(punit);
   game_remove_unit(punit);
   punit = NULL;
+  pf_map_pool_tile_changed(ptile);
 
   if (NULL != ptrans) {
     /* Update the occupy info. */
@@ -1773,13 +1775,11 @@ static void server_remove_unit_full(struct unit *punit, bool transported,
   sync_cities();
 
   if (phomecity) {
-    city_refresh(phomecity);
-    send_city_info(city_owner(phomecity), phomecity);
+    city_refresh_schedule(phomecity);
   }
 
   if (pcity && pcity != phomecity) {
-    city_refresh(pcity);
-    send_city_info(city_owner(pcity), pcity);
+    city_refresh_schedule(pcity);
   }
 
   if (pcity && unit_list_size(ptile->units) == 0) {
@@ -2576,6 +2576,7 @@ void send_unit_info(struct conn_list *dest, struct unit *punit)
   const struct player *powner;
   struct packet_unit_info info;
   struct packet_unit_short_info sinfo;
+  struct packet_broadcast broadcast;
   struct unit_move_data *pdata;
 
   if (dest == NULL) {
@@ -2589,6 +2590,8 @@ void send_unit_info(struct conn_list *dest, struct unit *punit)
   package_short_unit(punit, &sinfo, UNIT_INFO_IDENTITY, 0);
   pdata = punit->server.moving;
 
+  packet_broadcast_begin(&broadcast, dest, &info);
+  packet_broadcast_add(&broadcast, &sinfo);
   conn_list_iterate(dest, pconn) {
     struct player *pplayer = conn_get_player(pconn);
 
@@ -2609,6 +2612,7 @@ void send_unit_info(struct conn_list *dest, struct unit *punit)
       }
     }
   } conn_list_iterate_end;
+  packet_broadcast_end(&broadcast);
 }
 
 /**************************************************************************
@@ -2816,31 +2820,33 @@ bool do_paradrop(struct unit *punit, struct tile *ptile)
   } else {
     /* Only take in account values from player map. */
     const struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+    struct terrain *pterrain = player_tile_terrain(plrtile);
+    struct player *powner = player_tile_owner(plrtile);
+    bv_extras extras = player_tile_extras(plrtile);
 
-    if (NULL == plrtile->site
-        && !is_native_to_class(unit_class_get(punit), plrtile->terrain,
-                               &(plrtile->extras))) {
+    if (!plrtile->has_site
+        && !is_native_to_class(unit_class_get(punit), pterrain, &extras)) {
       notify_player(pplayer, ptile, E_BAD_COMMAND, ftc_server,
                     _("This unit cannot paradrop into %s."),
-                    terrain_name_translation(plrtile->terrain));
+                    terrain_name_translation(pterrain));
       return FALSE;
     }
 
-    if (NULL != plrtile->site
-        && plrtile->owner != NULL
-        && pplayers_non_attack(pplayer, plrtile->owner)) {
+    if (plrtile->has_site
+        && powner != NULL
+        && pplayers_non_attack(pplayer, powner)) {
       notify_player(pplayer, ptile, E_BAD_COMMAND, ftc_server,
                     _("Cannot attack unless you declare war first."));
       return FALSE;
     }
 
     if (is_military_unit(punit)
-        && NULL != plrtile->owner
-        && players_non_invade(pplayer, plrtile->owner)) {
+        && NULL != powner
+        && players_non_invade(pplayer, powner)) {
       notify_player(pplayer, ptile, E_BAD_COMMAND, ftc_server,
                     _("Cannot invade unless you break peace with "
                       "%s first."),
-                    player_name(plrtile->owner));
+                    player_name(powner));
       return FALSE;
     }
 
@@ -3357,8 +3363,7 @@ static bool unit_move_consequences(struct unit *punit,
   if (tocity) { /* entering a city */
     if (tocity->owner == pplayer_end_pos) {
       if (tocity != homecity_end_pos && is_human(pplayer_end_pos)) {
-        city_refresh(tocity);
-        send_city_info(pplayer_end_pos, tocity);
+        city_refresh_schedule(tocity);
       }
     }
     if (homecity_start_pos) {
@@ -3373,8 +3378,7 @@ static bool unit_move_consequences(struct unit *punit,
     if (fromcity != homecity_start_pos
         && fromcity->owner == pplayer_start_pos
         && is_human(pplayer_start_pos)) {
-      city_refresh(fromcity);
-      send_city_info(pplayer_start_pos, fromcity);
+      city_refresh_schedule(fromcity);
     }
   }
 
@@ -3395,15 +3399,13 @@ static bool unit_move_consequences(struct unit *punit,
   }
 
   if (refresh_homecity_start_pos && is_human(pplayer_start_pos)) {
-    city_refresh(homecity_start_pos);
-    send_city_info(pplayer_start_pos, homecity_start_pos);
+    city_refresh_schedule(homecity_start_pos);
   }
   if (refresh_homecity_end_pos
       && (!refresh_homecity_start_pos
           || homecity_start_pos != homecity_end_pos)
       && is_human(pplayer_end_pos)) {
-    city_refresh(homecity_end_pos);
-    send_city_info(pplayer_end_pos, homecity_end_pos);
+    city_refresh_schedule(homecity_end_pos);
   }
 
   city_map_update_tile_now(dst_tile);
@@ -3491,6 +3493,8 @@ static struct unit_move_data *unit_move_data(struct unit *punit,
   /* Set new tile. */
   unit_tile_set(punit, pdesttile);
   unit_list_prepend(pdesttile->units, punit);
+  pf_map_pool_tile_changed(psrctile);
+  pf_map_pool_tile_changed(pdesttile);
 
   if (unit_transported(punit)) {
     /* Silently free orders since they won't be applicable anymore. */
@@ -3511,7 +3515,7 @@ static struct unit_move_data *unit_move_data(struct unit *punit,
   /* Enhance vision if unit steps into a fortress */
   new_vision = vision_new(powner, pdesttile);
   punit->server.vision = new_vision;
-  vision_change_sight(new_vision, radius_sq);
+  vision_replace_sight(new_vision, pdata->old_vision, radius_sq);
   ASSERT_VISION(new_vision);
 
   return pdata;
@@ -3558,6 +3562,7 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
   struct unit *ptransporter;
   struct packet_unit_info src_info, dest_info;
   struct packet_unit_short_info src_sinfo, dest_sinfo;
+  struct packet_broadcast broadcast;
   struct unit_move_data_list *plist =
       unit_move_data_list_new_full(unit_move_data_unref);
   struct unit_move_data *pdata;
@@ -3721,6 +3726,10 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
     package_unit(punit, &dest_info);
     package_short_unit(punit, &dest_sinfo, UNIT_INFO_IDENTITY, 0);
 
+    packet_broadcast_begin(&broadcast, game.est_connections, &src_info);
+    packet_broadcast_add(&broadcast, &dest_info);
+    packet_broadcast_add(&broadcast, &src_sinfo);
+    packet_broadcast_add(&broadcast, &dest_sinfo);
     conn_list_iterate(game.est_connections, pconn) {
       struct player *aplayer = conn_get_player(pconn);
 
@@ -3740,6 +3749,7 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
         }
       }
     } conn_list_iterate_end;
+    packet_broadcast_end(&broadcast);
   }
 
   /* Other moves. */
@@ -3755,6 +3765,8 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
     package_short_unit(pmove_data->punit, &dest_sinfo,
                        UNIT_INFO_IDENTITY, 0);
 
+    packet_broadcast_begin(&broadcast, game.est_connections, &dest_info);
+    packet_broadcast_add(&broadcast, &dest_sinfo);
     conn_list_iterate(game.est_connections, pconn) {
       struct player *aplayer = conn_get_player(pconn);
 
@@ -3771,6 +3783,7 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
         }
       }
     } conn_list_iterate_end;
+    packet_broadcast_end(&broadcast);
   } unit_move_data_list_iterate_end;
 
   /* Clear old vision. */
@@ -0,0 +1,213 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+/* Compare plain and pooled genlists with the way unit_list and city_list
+ * are used. Usage: genlist_bench [ROUNDS] */
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <stdlib.h>
+
+/* utility */
+#include "fciconv.h"
+#include "fcintl.h"
+#include "genlist.h"
+#include "log.h"
+#include "rand.h"
+#include "shared.h"
+#include "timing.h"
+
+#define NUM_TILES 10000         /* Unit lists of the tiles. */
+#define NUM_UNITS 20000
+#define NUM_MOVES 2000000
+#define NUM_PLAYERS 30          /* City lists of the players. */
+#define CITIES_PER_PLAYER 60
+#define NUM_CITY_TURNS 20000
+#define NUM_STACKS 1000000      /* Short-lived unit lists. */
+#define STACK_SIZE 8
+
+typedef struct genlist *(*list_new_fn_t)(void);
+
+/* The "units" and "cities" are only addresses in these arrays. */
+static char units[NUM_UNITS];
+static char cities[NUM_PLAYERS * CITIES_PER_PLAYER];
+
+static size_t checksum;
+
+/**************************************************************************
+  Add the data of all the elements of the list to the checksum, so that
+  the iterations can't be optimized away.
+**************************************************************************/
+static void list_visit(const struct genlist *plist)
+{
+  const struct genlist_link *plink;
+
+  for (plink = genlist_head(plist); NULL != plink;
+       plink = genlist_link_next(plink)) {
+    checksum += (size_t) genlist_link_data(plink);
+  }
+}
+
+/**************************************************************************
+  Units moving between tiles: every move removes the unit from the list
+  of its tile and appends it to the list of another tile, whose units are
+  then visited, as for the unit_list of the tiles.
+**************************************************************************/
+static void bench_unit_moves(list_new_fn_t list_new)
+{
+  struct genlist *tiles[NUM_TILES];
+  static int unit_tile[NUM_UNITS];
+  int i;
+
+  for (i = 0; i < NUM_TILES; i++) {
+    tiles[i] = list_new();
+  }
+  for (i = 0; i < NUM_UNITS; i++) {
+    unit_tile[i] = fc_rand(NUM_TILES);
+    genlist_append(tiles[unit_tile[i]], units + i);
+  }
+
+  for (i = 0; i < NUM_MOVES; i++) {
+    int unit = fc_rand(NUM_UNITS);
+    int dest = (unit_tile[unit] + 1 + fc_rand(8)) % NUM_TILES;
+
+    genlist_remove(tiles[unit_tile[unit]], units + unit);
+    genlist_append(tiles[dest], units + unit);
+    unit_tile[unit] = dest;
+    list_visit(tiles[dest]);
+  }
+
+  for (i = 0; i < NUM_TILES; i++) {
+    genlist_destroy(tiles[i]);
+  }
+}
+
+/**************************************************************************
+  Players iterating over their cities every turn, and now and then
+  losing a city to another player, as for the city_list of the players.
+**************************************************************************/
+static void bench_city_turns(list_new_fn_t list_new)
+{
+  struct genlist *players[NUM_PLAYERS];
+  int i, j;
+
+  for (i = 0; i < NUM_PLAYERS; i++) {
+    players[i] = list_new();
+    for (j = 0; j < CITIES_PER_PLAYER; j++) {
+      genlist_append(players[i], cities + i * CITIES_PER_PLAYER + j);
+    }
+  }
+
+  for (i = 0; i < NUM_CITY_TURNS; i++) {
+    struct genlist *from = players[fc_rand(NUM_PLAYERS)];
+
+    for (j = 0; j < NUM_PLAYERS; j++) {
+      list_visit(players[j]);
+    }
+    if (0 < genlist_size(from)) {
+      void *pcity = genlist_get(from, fc_rand(genlist_size(from)));
+
+      genlist_remove(from, pcity);
+      genlist_append(players[fc_rand(NUM_PLAYERS)], pcity);
+    }
+  }
+
+  for (i = 0; i < NUM_PLAYERS; i++) {
+    genlist_destroy(players[i]);
+  }
+}
+
+/**************************************************************************
+  Unit lists built, visited and destroyed right away, as for the stacks
+  and the candidate units of the AI.
+**************************************************************************/
+static void bench_short_lived(list_new_fn_t list_new)
+{
+  int i, j;
+
+  for (i = 0; i < NUM_STACKS; i++) {
+    struct genlist *plist = list_new();
+
+    for (j = 0; j < STACK_SIZE; j++) {
+      genlist_append(plist, units + (i + j) % NUM_UNITS);
+    }
+    list_visit(plist);
+    genlist_destroy(plist);
+  }
+}
+
+/**************************************************************************
+  Run the benchmark 'rounds' times with the same random sequence and
+  return the best time in milliseconds.
+**************************************************************************/
+static double bench_run(void (*bench)(list_new_fn_t), list_new_fn_t list_new,
+                        int rounds)
+{
+  struct timer *ptimer = timer_new(TIMER_USER, TIMER_ACTIVE);
+  double best = -1.0;
+  int i;
+
+  for (i = 0; i < rounds; i++) {
+    double t;
+
+    fc_srand(1);
+    timer_clear(ptimer);
+    timer_start(ptimer);
+    bench(list_new);
+    timer_stop(ptimer);
+
+    t = timer_read_seconds(ptimer) * 1000.0;
+    if (0 > best || t < best) {
+      best = t;
+    }
+  }
+  timer_destroy(ptimer);
+
+  return best;
+}
+
+/**************************************************************************
+  Main entry point for genlist_bench.
+**************************************************************************/
+int main(int argc, char **argv)
+{
+  const struct {
+    const char *name;
+    void (*bench)(list_new_fn_t);
+  } benches[] = {
+    { "unit moves", bench_unit_moves },
+    { "city turns", bench_city_turns },
+    { "short-lived lists", bench_short_lived }
+  };
+  int rounds = (1 < argc ? MAX(1, atoi(argv[1])) : 3);
+  size_t i;
+
+  init_nls();
+  log_init(NULL, LOG_ERROR, NULL, NULL, -1);
+
+  fc_printf("%-20s %10s %10s\n", "", "plain", "pooled");
+  for (i = 0; i < ARRAY_SIZE(benches); i++) {
+    double plain = bench_run(benches[i].bench, genlist_new, rounds);
+    double pooled = bench_run(benches[i].bench, genlist_new_pooled, rounds);
+
+    fc_printf("%-20s %7.1f ms %7.1f ms\n", benches[i].name, plain, pooled);
+  }
+  fc_printf("checksum %lu\n", (unsigned long) checksum);
+
+  log_close();
+  free_nls();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,56 @@
+#!/bin/sh
+#
+# Time saving and loading a savegame with every compression method, in
+# the text and in the binary format, with freeciv-savconv. Prints the
+# file size and the best time of ROUNDS runs. Loading is timed with
+# writing the loaded savegame back as plain text, so the plain text
+# save time is part of every load time.
+#
+# Usage: ioz_bench.sh [SAVEGAME [ROUNDS]]
+# SAVCONV is the freeciv-savconv binary.
+
+SAVCONV=${SAVCONV:-../tools/freeciv-savconv}
+SAVEGAME=${1:-${SAMPLE_SAVEGAME:-../data/scenarios/earth-80x50-v3.sav}}
+ROUNDS=${2:-5}
+
+if ! test -x "$SAVCONV" ; then
+  echo "$SAVCONV not built"
+  exit 1
+fi
+
+TMPDIR=$(mktemp -d ioz_bench.XXXXXX) || exit 1
+trap 'rm -rf "$TMPDIR"' EXIT
+
+# Run the command ROUNDS times, print the best time in milliseconds.
+best_ms() {
+  best=
+  i=0
+  while test $i -lt $ROUNDS ; do
+    start=$(date +%s%N)
+    "$@" > /dev/null 2>&1 || { echo "failed" ; return ; }
+    end=$(date +%s%N)
+    t=$(( (end - start) / 1000000 ))
+    if test -z "$best" || test $t -lt $best ; then
+      best=$t
+    fi
+    i=$((i + 1))
+  done
+  echo "$best"
+}
+
+"$SAVCONV" --text "$SAVEGAME" "$TMPDIR/ref.sav" > /dev/null 2>&1 \
+  || { echo "Cannot load $SAVEGAME" ; exit 1 ; }
+
+printf "%-14s %12s %10s %10s\n" "method" "size (B)" "save (ms)" "load (ms)"
+for format in text binary ; do
+  for ext in "" .gz .bz2 .xz .zst .lz4 ; do
+    out="$TMPDIR/out.sav$ext"
+    name="${ext#.}"
+    name="$format ${name:-plain}"
+
+    save=$(best_ms "$SAVCONV" --$format "$TMPDIR/ref.sav" "$out")
+    load=$(best_ms "$SAVCONV" --text "$out" "$TMPDIR/back.sav")
+    printf "%-14s %12s %10s %10s\n" "$name" "$(wc -c < "$out")" "$save" "$load"
+    rm -f "$out" "$TMPDIR/back.sav"
+  done
+done
@@ -0,0 +1,69 @@
+#!/bin/sh
+#
+# Save a savegame with every compression method, in the text and in the
+# binary format, and load it back with freeciv-savconv. The result must
+# be identical to the original. Methods the build does not support are
+# skipped; freeciv-savconv writes them uncompressed.
+#
+# SAVCONV is the freeciv-savconv binary, SAMPLE_SAVEGAME the savegame.
+
+SAVCONV=${SAVCONV:-../tools/freeciv-savconv}
+SAMPLE_SAVEGAME=${SAMPLE_SAVEGAME:-../data/scenarios/earth-80x50-v3.sav}
+
+if ! test -x "$SAVCONV" ; then
+  echo "$SAVCONV not built, skipping"
+  exit 77
+fi
+
+TMPDIR=$(mktemp -d ioz_roundtrip.XXXXXX) || exit 1
+trap 'rm -rf "$TMPDIR"' EXIT
+
+# Print the first four bytes of the file in hex.
+magic() {
+  od -An -tx1 -N4 "$1" | tr -d ' \n'
+}
+
+"$SAVCONV" --text "$SAMPLE_SAVEGAME" "$TMPDIR/ref.sav" > /dev/null 2>&1 \
+  || { echo "FAIL: cannot load $SAMPLE_SAVEGAME" ; exit 1 ; }
+
+FAILED=0
+for ext in "" .gz .bz2 .xz .zst .lz4 ; do
+  case "$ext" in
+    .gz)  expect=1f8b ;;
+    .bz2) expect=425a68 ;;
+    .xz)  expect=fd377a58 ;;
+    .zst) expect=28b52ffd ;;
+    .lz4) expect=04224d18 ;;
+    *)    expect= ;;
+  esac
+
+  for format in text binary ; do
+    out="$TMPDIR/out-$format.sav$ext"
+    name="${ext#.}"
+    name="$format ${name:-plain}"
+
+    if ! "$SAVCONV" --$format "$TMPDIR/ref.sav" "$out" > /dev/null 2>&1 ; then
+      echo "FAIL: $name: cannot save"
+      FAILED=1
+      continue
+    fi
+    case "$(magic "$out")" in
+      "$expect"*) ;;
+      *)
+        echo "SKIP: $name: not supported by this build"
+        continue ;;
+    esac
+    if ! "$SAVCONV" --text "$out" "$TMPDIR/back.sav" > /dev/null 2>&1 ; then
+      echo "FAIL: $name: cannot load"
+      FAILED=1
+    elif ! cmp -s "$TMPDIR/ref.sav" "$TMPDIR/back.sav" ; then
+      echo "FAIL: $name: the loaded savegame differs"
+      FAILED=1
+    else
+      echo "PASS: $name"
+    fi
+    rm -f "$TMPDIR/back.sav"
+  done
+done
+
+exit $FAILED
@@ -0,0 +1,244 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+/* Time whole-map passes reading the tiles and reading the packed map
+ * arrays, on a random map. Usage: map_bench [XSIZE YSIZE [PASSES]] */
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <stdlib.h>
+
+/* utility */
+#include "fciconv.h"
+#include "fcintl.h"
+#include "log.h"
+#include "rand.h"
+#include "shared.h"
+#include "timing.h"
+
+/* common */
+#include "game.h"
+#include "map.h"
+#include "player.h"
+#include "terrain.h"
+#include "tile.h"
+
+#define NUM_TERRAINS 12
+#define NUM_OCEANS 3            /* The first terrains are oceanic. */
+#define NUM_OWNERS 16
+#define BENCH_EXTRA 18          /* Index of the counted extra. */
+#define BENCH_OWNER 5           /* Number of the player looked for. */
+
+static size_t checksum;
+
+/**************************************************************************
+  Count the tiles with the extra, as update_environmental_upset() does.
+**************************************************************************/
+static void extra_count_tiles(void)
+{
+  whole_map_iterate(ptile) {
+    checksum += BV_ISSET(ptile->extras, BENCH_EXTRA);
+  } whole_map_iterate_end;
+}
+
+/**************************************************************************
+  Same as extra_count_tiles(), on the packed extras.
+**************************************************************************/
+static void extra_count_packed(void)
+{
+  whole_map_index_iterate(tindex) {
+    checksum += BV_ISSET(*map_packed_extras(tindex), BENCH_EXTRA);
+  } whole_map_index_iterate_end;
+}
+
+/**************************************************************************
+  Count the tiles of a player, as map_set_border_vision() does.
+**************************************************************************/
+static void owner_scan_tiles(void)
+{
+  const struct player *pplayer = player_by_number(BENCH_OWNER);
+
+  whole_map_iterate(ptile) {
+    checksum += (tile_owner(ptile) == pplayer);
+  } whole_map_iterate_end;
+}
+
+/**************************************************************************
+  Same as owner_scan_tiles(), on the packed owners.
+**************************************************************************/
+static void owner_scan_packed(void)
+{
+  whole_map_index_iterate(tindex) {
+    checksum += (map_packed_owner(tindex) == BENCH_OWNER);
+  } whole_map_index_iterate_end;
+}
+
+/**************************************************************************
+  Count the tiles of each terrain, as print_mapgen_map() does.
+**************************************************************************/
+static void terrain_histogram_tiles(void)
+{
+  int count[NUM_TERRAINS] = { 0 };
+
+  whole_map_iterate(ptile) {
+    count[terrain_index(tile_terrain(ptile))]++;
+  } whole_map_iterate_end;
+  checksum += count[NUM_TERRAINS - 1];
+}
+
+/**************************************************************************
+  Same as terrain_histogram_tiles(), on the packed terrains.
+**************************************************************************/
+static void terrain_histogram_packed(void)
+{
+  int count[NUM_TERRAINS] = { 0 };
+
+  whole_map_index_iterate(tindex) {
+    count[map_packed_terrain(tindex)]++;
+  } whole_map_index_iterate_end;
+  checksum += count[NUM_TERRAINS - 1];
+}
+
+/**************************************************************************
+  Look at the continent of the land tiles, as
+  recalculate_lake_surrounders() does.
+**************************************************************************/
+static void land_continents_tiles(void)
+{
+  whole_map_iterate(ptile) {
+    if (TC_LAND == terrain_type_terrain_class(tile_terrain(ptile))) {
+      checksum += tile_continent(ptile);
+    }
+  } whole_map_iterate_end;
+}
+
+/**************************************************************************
+  Same as land_continents_tiles(), on the packed terrains and continents.
+**************************************************************************/
+static void land_continents_packed(void)
+{
+  whole_map_index_iterate(tindex) {
+    if (TC_LAND == terrain_type_terrain_class(terrain_by_number(
+                                               map_packed_terrain(tindex)))) {
+      checksum += map_packed_continent(tindex);
+    }
+  } whole_map_index_iterate_end;
+}
+
+/**************************************************************************
+  Give random terrains, owners, continents and extras to the tiles, then
+  fill the packed arrays from them.
+**************************************************************************/
+static void map_fill(void)
+{
+  int i;
+
+  game.control.terrain_count = NUM_TERRAINS;
+  for (i = 0; i < NUM_TERRAINS; i++) {
+    terrain_by_number(i)->tclass = (i < NUM_OCEANS ? TC_OCEAN : TC_LAND);
+  }
+  for (i = 0; i < NUM_OWNERS; i++) {
+    player_new(NULL);
+  }
+
+  whole_map_iterate(ptile) {
+    ptile->terrain = terrain_by_number(fc_rand(NUM_TERRAINS));
+    ptile->owner = (0 == fc_rand(3)
+                    ? player_by_number(fc_rand(NUM_OWNERS)) : NULL);
+    ptile->continent = fc_rand(50) - 10;
+    if (0 == fc_rand(20)) {
+      BV_SET(ptile->extras, BENCH_EXTRA);
+    }
+  } whole_map_iterate_end;
+  map_packed_update_all();
+}
+
+/**************************************************************************
+  Run the pass 'passes' times and return the time of one pass in
+  milliseconds.
+**************************************************************************/
+static double bench_pass(void (*pass)(void), int passes)
+{
+  struct timer *ptimer = timer_new(TIMER_USER, TIMER_ACTIVE);
+  double t;
+  int i;
+
+  timer_start(ptimer);
+  for (i = 0; i < passes; i++) {
+    pass();
+  }
+  timer_stop(ptimer);
+  t = timer_read_seconds(ptimer) * 1000.0 / passes;
+  timer_destroy(ptimer);
+
+  return t;
+}
+
+/**************************************************************************
+  Main entry point for map_bench.
+**************************************************************************/
+int main(int argc, char **argv)
+{
+  const struct {
+    const char *name;
+    void (*tiles)(void);
+    void (*packed)(void);
+  } benches[] = {
+    { "extra count", extra_count_tiles, extra_count_packed },
+    { "owner scan", owner_scan_tiles, owner_scan_packed },
+    { "terrain histogram", terrain_histogram_tiles,
+      terrain_histogram_packed },
+    { "land continents", land_continents_tiles, land_continents_packed }
+  };
+  int passes = 200;
+  size_t i;
+
+  init_nls();
+  log_init(NULL, LOG_ERROR, NULL, NULL, -1);
+  fc_srand(1);
+
+  game_init();
+  wld.map.xsize = 512;
+  wld.map.ysize = 512;
+  if (2 < argc) {
+    wld.map.xsize = atoi(argv[1]);
+    wld.map.ysize = atoi(argv[2]);
+  }
+  if (3 < argc) {
+    passes = MAX(1, atoi(argv[3]));
+  }
+  map_init_topology();
+  map_allocate();
+  map_fill();
+
+  fc_printf("%dx%d map, %d passes, sizeof(struct tile) = %lu bytes\n",
+            wld.map.xsize, wld.map.ysize, passes,
+            (unsigned long) sizeof(struct tile));
+  fc_printf("%-20s %12s %12s\n", "ms per pass", "tiles", "packed");
+  for (i = 0; i < ARRAY_SIZE(benches); i++) {
+    double tiles = bench_pass(benches[i].tiles, passes);
+    double packed = bench_pass(benches[i].packed, passes);
+
+    fc_printf("%-20s %12.3f %12.3f  x%.1f\n", benches[i].name,
+              tiles, packed, tiles / packed);
+  }
+  fc_printf("checksum %lu\n", (unsigned long) checksum);
+
+  game_free();
+  log_close();
+  free_nls();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,43 @@
+#!/bin/sh
+#
+# Generate a map with freeciv-server and print how long each stage of the
+# map generation took, as logged at verbose level.
+#
+# XSIZE, YSIZE, GENERATOR, MAPSEED and WORKERS give the map size, the
+# generator, the map seed and the 'workers' setting. SERVER is the
+# freeciv-server binary, PORT the port it listens on meanwhile.
+
+SERVER=${SERVER:-../server/freeciv-server}
+XSIZE=${XSIZE:-1024}
+YSIZE=${YSIZE:-512}
+GENERATOR=${GENERATOR:-FRACTAL}
+MAPSEED=${MAPSEED:-12345}
+WORKERS=${WORKERS:-0}
+PORT=${PORT:-5599}
+
+if ! test -x "$SERVER" ; then
+  echo "$SERVER not built"
+  exit 1
+fi
+
+TMPDIR=$(mktemp -d mapgen_bench.XXXXXX) || exit 1
+trap 'rm -rf "$TMPDIR"' EXIT
+
+cat > "$TMPDIR/bench.serv" <<EOS
+set mapsize XYSIZE
+set xsize $XSIZE
+set ysize $YSIZE
+set generator $GENERATOR
+set mapseed $MAPSEED
+set workers $WORKERS
+set minplayers 0
+set autosaves ""
+set timeout 1
+set endturn 1
+start
+EOS
+
+echo "${XSIZE}x${YSIZE} $GENERATOR map, mapseed $MAPSEED, $WORKERS workers"
+"$SERVER" --read "$TMPDIR/bench.serv" --exit-on-end --debug 3 \
+          --port $PORT --log "$TMPDIR/log" < /dev/null > /dev/null 2>&1
+sed -n 's/.*Map generation, \(.*\): \(.*\) seconds\./\1: \2 s/p' "$TMPDIR/log"
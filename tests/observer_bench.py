@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+#
+# Start freeciv-server, connect OBSERVERS observer clients to it and
+# measure how long the server takes to answer a request while they are
+# connected. Each probe sends a heartbeat packet on one of the
+# connections and waits for the "processing finished" packet the server
+# sends back, so the latency covers a whole wakeup of the server main
+# loop: the wait for input, reading the request and answering it. At the
+# end, the server statistics of "debug sniff" are printed too.
+#
+# Environment: SERVER is the freeciv-server binary, FC_VERSION the
+# fc_version file to get the network capabilities from, OBSERVERS the
+# number of observer connections, PROBES the number of requests timed
+# and PORT the port the server listens on.
+
+import os
+import re
+import select
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+import zlib
+
+SERVER = os.environ.get("SERVER", "../server/freeciv-server")
+FC_VERSION = os.environ.get("FC_VERSION", "../fc_version")
+OBSERVERS = int(os.environ.get("OBSERVERS") or 300)
+PROBES = int(os.environ.get("PROBES") or 1000)
+PORT = int(os.environ.get("PORT") or 5599)
+
+PACKET_PROCESSING_FINISHED = 1
+PACKET_SERVER_JOIN_REQ = 4
+PACKET_CHAT_MSG_REQ = 26
+PACKET_CLIENT_HEARTBEAT = 254
+
+COMPRESSION_BORDER = 16 * 1024 + 1
+JUMBO_SIZE = 0xffff
+
+
+def read_fc_version(filename):
+    """Return the network capabilities and version of fc_version."""
+    values = {}
+    with open(filename) as f:
+        for line in f:
+            m = re.match(r'^([A-Z_]+)="(.*)"', line)
+            if m:
+                values.setdefault(m.group(1), m.group(2))
+    return (values["NETWORK_CAPSTRING_MANDATORY"],
+            int(values["MAJOR_VERSION"]), int(values["MINOR_VERSION"]),
+            int(values["PATCH_VERSION"]), values["VERSION_LABEL"])
+
+
+class Observer:
+    """A client connection, counting the packets of each type received."""
+
+    def __init__(self, name, version):
+        capstring, major, minor, patch, label = version
+        self.sock = socket.create_connection(("127.0.0.1", PORT))
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.data = b""
+        self.joined = False
+        self.finished = 0
+        # The join request is sent with a one byte packet type.
+        body = (bytes([PACKET_SERVER_JOIN_REQ])
+                + name.encode() + b"\0" + capstring.encode() + b"\0"
+                + label.encode() + b"\0"
+                + struct.pack(">III", major, minor, patch))
+        self.sock.sendall(struct.pack(">H", len(body) + 2) + body)
+        self.sock.setblocking(False)
+
+    def send(self, ptype, body=b""):
+        self.sock.sendall(struct.pack(">HH", len(body) + 4, ptype) + body)
+
+    def receive(self):
+        """Read what is available. Returns False on end of file."""
+        try:
+            data = self.sock.recv(1 << 20)
+        except BlockingIOError:
+            return True
+        if not data:
+            return False
+        self.data += data
+        self.data = self.parse(self.data)
+        return True
+
+    def parse(self, data):
+        """Handle the complete packets of 'data', return the rest."""
+        while len(data) >= 2:
+            (length,) = struct.unpack(">H", data[:2])
+            header = 2
+            compressed = False
+            if length == JUMBO_SIZE:
+                if len(data) < 6:
+                    break
+                (length,) = struct.unpack(">I", data[2:6])
+                header = 6
+                compressed = True
+            elif length >= COMPRESSION_BORDER:
+                length -= COMPRESSION_BORDER
+                compressed = True
+            if len(data) < length:
+                break
+            if compressed:
+                rest = self.parse(zlib.decompress(data[header:length]))
+                assert not rest
+            elif not self.joined:
+                # The join reply, with a one byte packet type.
+                self.joined = True
+            else:
+                (ptype,) = struct.unpack(">H", data[2:4])
+                if ptype == PACKET_PROCESSING_FINISHED:
+                    self.finished += 1
+            data = data[length:]
+        return data
+
+
+def drain(observers, timeout):
+    """Read from the observers until none has anything to read."""
+    socks = {o.sock: o for o in observers}
+    while socks:
+        readable = select.select(list(socks), [], [], timeout)[0]
+        if not readable:
+            break
+        for sock in readable:
+            if not socks[sock].receive():
+                sys.exit("The server closed a connection.")
+        timeout = 0.05
+
+
+def main():
+    version = read_fc_version(FC_VERSION)
+    tmpdir = tempfile.TemporaryDirectory(prefix="observer_bench.")
+    script = os.path.join(tmpdir.name, "bench.serv")
+    with open(script, "w") as f:
+        # A game which stays in its first turn, with AI players only.
+        f.write("set maxconnectionsperhost %d\n"
+                "set minplayers 0\n"
+                "set aifill 2\n"
+                "set size 1\n"
+                "set autosaves \"\"\n"
+                "set timeout 3600\n"
+                "start\n" % (OBSERVERS + 1))
+    server = subprocess.Popen([SERVER, "--port", str(PORT),
+                               "--read", script,
+                               "--log", os.path.join(tmpdir.name, "log")],
+                              stdin=subprocess.PIPE,
+                              stdout=subprocess.PIPE,
+                              stderr=subprocess.STDOUT,
+                              universal_newlines=True,
+                              errors="replace")
+
+    def command(line):
+        server.stdin.write(line + "\n")
+        server.stdin.flush()
+
+    try:
+        for i in range(100):
+            try:
+                socket.create_connection(("127.0.0.1", PORT)).close()
+                break
+            except ConnectionRefusedError:
+                if server.poll() is not None:
+                    sys.exit(server.stdout.read())
+                time.sleep(0.1)
+        else:
+            sys.exit("The server didn't start.")
+
+        observers = []
+        for i in range(OBSERVERS):
+            observers.append(Observer("obs%03d" % i, version))
+            drain(observers, 0.01)
+        observe = b"/observe\0"
+        for o in observers:
+            o.send(PACKET_CHAT_MSG_REQ, observe)
+        drain(observers, 1.0)
+
+        command("debug sniff reset")
+        latencies = []
+        for i in range(PROBES):
+            o = observers[i % OBSERVERS]
+            finished = o.finished
+            start = time.perf_counter()
+            o.send(PACKET_CLIENT_HEARTBEAT)
+            while o.finished == finished:
+                select.select([o.sock], [], [], 1.0)
+                if not o.receive():
+                    sys.exit("The server closed a connection.")
+            latencies.append(time.perf_counter() - start)
+        command("debug sniff")
+        command("quit")
+        output = server.communicate(timeout=30)[0]
+    finally:
+        if server.poll() is None:
+            server.kill()
+        tmpdir.cleanup()
+
+    latencies.sort()
+    print("%d observers, %d requests: latency %.3f ms median, "
+          "%.3f ms at 90%%, %.3f ms at most"
+          % (OBSERVERS, PROBES,
+             1000 * latencies[len(latencies) // 2],
+             1000 * latencies[len(latencies) * 9 // 10],
+             1000 * latencies[-1]))
+    # The statistics since "debug sniff reset".
+    stats = [line for line in output.splitlines() if "Input (" in line]
+    if stats:
+        print(stats[-1].strip())
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,114 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+/* Time secfile_load() alone, without saving or using the loaded data.
+ * Usage: secfile_bench [-r ROUNDS] FILE... */
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+/* utility */
+#include "fciconv.h"
+#include "fcintl.h"
+#include "log.h"
+#include "registry.h"
+#include "timing.h"
+
+/**************************************************************************
+  Load the file 'rounds' times, print the best load and destroy times.
+  Returns FALSE if the file can't be loaded.
+**************************************************************************/
+static bool bench_file(const char *filename, int rounds)
+{
+  struct timer *load_timer = timer_new(TIMER_USER, TIMER_ACTIVE);
+  struct timer *destroy_timer = timer_new(TIMER_USER, TIMER_ACTIVE);
+  double load_best = -1.0, destroy_best = -1.0;
+  int i;
+
+  for (i = 0; i < rounds; i++) {
+    struct section_file *secfile;
+    double t;
+
+    timer_clear(load_timer);
+    timer_start(load_timer);
+    secfile = secfile_load(filename, FALSE);
+    timer_stop(load_timer);
+
+    if (NULL == secfile) {
+      fc_fprintf(stderr, "%s: %s\n", filename, secfile_error());
+      timer_destroy(load_timer);
+      timer_destroy(destroy_timer);
+      return FALSE;
+    }
+
+    timer_clear(destroy_timer);
+    timer_start(destroy_timer);
+    secfile_destroy(secfile);
+    timer_stop(destroy_timer);
+
+    t = timer_read_seconds(load_timer);
+    if (0 > load_best || t < load_best) {
+      load_best = t;
+    }
+    t = timer_read_seconds(destroy_timer);
+    if (0 > destroy_best || t < destroy_best) {
+      destroy_best = t;
+    }
+  }
+
+  fc_printf("%-50s load %8.2f ms  destroy %7.2f ms\n",
+            filename, load_best * 1000.0, destroy_best * 1000.0);
+
+  timer_destroy(load_timer);
+  timer_destroy(destroy_timer);
+
+  return TRUE;
+}
+
+/**************************************************************************
+  Main entry point for secfile_bench.
+**************************************************************************/
+int main(int argc, char **argv)
+{
+  int rounds = 5;
+  int i = 1;
+  bool ok = TRUE;
+
+  init_nls();
+  registry_module_init();
+  init_character_encodings(FC_DEFAULT_DATA_ENCODING, FALSE);
+  log_init(NULL, LOG_ERROR, NULL, NULL, -1);
+
+  if (i + 1 < argc && 0 == strcmp(argv[i], "-r")) {
+    rounds = MAX(1, atoi(argv[i + 1]));
+    i += 2;
+  }
+  if (i >= argc) {
+    fc_fprintf(stderr, "Usage: %s [-r ROUNDS] FILE...\n", argv[0]);
+    ok = FALSE;
+  }
+
+  for (; i < argc; i++) {
+    ok = bench_file(argv[i], rounds) && ok;
+  }
+
+  registry_module_close();
+  log_close();
+  free_nls();
+
+  return (ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,193 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <string.h>
+
+/* utility */
+#include "fc_cmdline.h"
+#include "fciconv.h"
+#include "fcintl.h"
+#include "log.h"
+#include "registry.h"
+
+/* common */
+#include "fc_cmdhelp.h"
+#include "game.h"
+
+enum savconv_format {
+  SCF_AUTO,     /* The other format than the one of the input file. */
+  SCF_TEXT,
+  SCF_BINARY
+};
+
+static enum savconv_format out_format = SCF_AUTO;
+static char *section_selected = NULL;
+static const char *in_filename = NULL;
+static const char *out_filename = NULL;
+
+/**************************************************************************
+  Parse freeciv-savconv commandline parameters.
+**************************************************************************/
+static void sc_parse_cmdline(int argc, char *argv[])
+{
+  int i = 1;
+
+  while (i < argc) {
+    char *option = NULL;
+
+    if (is_option("--help", argv[i])) {
+      struct cmdhelp *help = cmdhelp_new(argv[0]);
+
+      cmdhelp_add(help, "h", "help",
+                  _("Print a summary of the options"));
+      cmdhelp_add(help, "b", "binary",
+                  _("Write the output file in binary format"));
+      cmdhelp_add(help, "t", "text",
+                  _("Write the output file in text format"));
+      cmdhelp_add(help, "s",
+                  /* TRANS: "section" is exactly what user must type, do not translate. */
+                  _("section SECTION"),
+                  _("Only convert SECTION, e.g. \"map\""));
+
+      /* The function below prints a header and footer for the options.
+       * Furthermore, the options are sorted. */
+      cmdhelp_display(help, TRUE, FALSE, TRUE);
+      fc_fprintf(stderr, _("Usage: %s [options] INPUT OUTPUT\n"), argv[0]);
+      fc_fprintf(stderr, _("Without --binary or --text, the output is in "
+                           "the other format than the input. It is "
+                           "compressed according to its extension.\n"));
+      cmdhelp_destroy(help);
+
+      cmdline_option_values_free();
+
+      exit(EXIT_SUCCESS);
+    } else if (is_option("--binary", argv[i])) {
+      out_format = SCF_BINARY;
+    } else if (is_option("--text", argv[i])) {
+      out_format = SCF_TEXT;
+    } else if ((option = get_option_malloc("--section", argv, &i, argc,
+                                           TRUE))) {
+      section_selected = option;
+    } else if ('-' != argv[i][0] && NULL == in_filename) {
+      in_filename = argv[i];
+    } else if ('-' != argv[i][0] && NULL == out_filename) {
+      out_filename = argv[i];
+    } else {
+      fc_fprintf(stderr, _("Unrecognized option: \"%s\"\n"), argv[i]);
+      cmdline_option_values_free();
+      exit(EXIT_FAILURE);
+    }
+
+    i++;
+  }
+
+  if (NULL == out_filename) {
+    fc_fprintf(stderr, _("Usage: %s [options] INPUT OUTPUT\n"), argv[0]);
+    cmdline_option_values_free();
+    exit(EXIT_FAILURE);
+  }
+}
+
+/**************************************************************************
+  Returns the compression method matching the extension of the file name.
+**************************************************************************/
+static enum fz_method sc_compression_method(const char *filename)
+{
+  const char *ext = strrchr(filename, '.');
+
+  if (NULL == ext) {
+    return FZ_PLAIN;
+  }
+#ifdef FREECIV_HAVE_LIBZ
+  if (0 == strcmp(ext, ".gz")) {
+    return FZ_ZLIB;
+  }
+#endif
+#ifdef FREECIV_HAVE_LIBBZ2
+  if (0 == strcmp(ext, ".bz2")) {
+    return FZ_BZIP2;
+  }
+#endif
+#ifdef FREECIV_HAVE_LIBLZMA
+  if (0 == strcmp(ext, ".xz")) {
+    return FZ_XZ;
+  }
+#endif
+#ifdef FREECIV_HAVE_LIBZSTD
+  if (0 == strcmp(ext, ".zst")) {
+    return FZ_ZSTD;
+  }
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+  if (0 == strcmp(ext, ".lz4")) {
+    return FZ_LZ4;
+  }
+#endif
+
+  return FZ_PLAIN;
+}
+
+/**************************************************************************
+  Main entry point for freeciv-savconv
+**************************************************************************/
+int main(int argc, char **argv)
+{
+  struct section_file *secfile;
+  enum fz_method method;
+  bool ok;
+
+  init_nls();
+
+  registry_module_init();
+  init_character_encodings(FC_DEFAULT_DATA_ENCODING, FALSE);
+
+  log_init(NULL, LOG_NORMAL, NULL, NULL, -1);
+
+  sc_parse_cmdline(argc, argv);
+
+  if (SCF_AUTO == out_format) {
+    out_format = (binfile_check(in_filename) ? SCF_TEXT : SCF_BINARY);
+  }
+
+  secfile = secfile_load_section(in_filename, section_selected, TRUE);
+  if (NULL == secfile) {
+    log_error(_("Can't load %s: %s"), in_filename, secfile_error());
+    ok = FALSE;
+  } else {
+    method = sc_compression_method(out_filename);
+    if (SCF_BINARY == out_format) {
+      ok = binfile_save(secfile, out_filename,
+                        GAME_DEFAULT_COMPRESS_LEVEL, method);
+    } else {
+      ok = secfile_save(secfile, out_filename,
+                        GAME_DEFAULT_COMPRESS_LEVEL, method);
+    }
+    if (ok) {
+      log_normal(_("Saved %s"), out_filename);
+    } else {
+      log_error(_("Can't save %s: %s"), out_filename, secfile_error());
+    }
+    secfile_destroy(secfile);
+  }
+
+  registry_module_close();
+  log_close();
+  free_nls();
+  cmdline_option_values_free();
+
+  return (ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
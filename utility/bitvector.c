@@ -183,6 +183,18 @@ void dbv_clr_all(struct dbv *pdbv)
   memset(pdbv->vec, 0, _BV_BYTES(pdbv->bits));
 }
 
+/***************************************************************************
+  Copy the bits of src to dest. Both must have the same number of bits.
+***************************************************************************/
+void dbv_copy(struct dbv *dest, const struct dbv *src)
+{
+  fc_assert_ret(dest != NULL && src != NULL);
+  fc_assert_ret(dest->vec != NULL && src->vec != NULL);
+  fc_assert_ret(dest->bits == src->bits);
+
+  memcpy(dest->vec, src->vec, _BV_BYTES(src->bits));
+}
+
 /***************************************************************************
   Check if the two dynamic bitvectors are equal.
 ***************************************************************************/
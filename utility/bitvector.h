@@ -49,6 +49,7 @@ void dbv_set_all(struct dbv *pdbv);
 void dbv_clr(struct dbv *pdbv, int bit);
 void dbv_clr_all(struct dbv *pdbv);
 
+void dbv_copy(struct dbv *dest, const struct dbv *src);
 bool dbv_are_equal(const struct dbv *pdbv1, const struct dbv *pdbv2);
 
 void dbv_debug(struct dbv *pdbv);
@@ -25,6 +25,18 @@
 
 #include "genlist.h"
 
+/* Number of links of the first and of the largest slabs of a pooled
+ * genlist. */
+#define GENLIST_SLAB_MIN 4
+#define GENLIST_SLAB_MAX 256
+
+struct genlist_slab {
+  struct genlist_slab *next;
+  int size;
+  int used;
+  struct genlist_link links[];
+};
+
 /****************************************************************************
   Create a new empty genlist.
 ****************************************************************************/
@@ -51,6 +63,36 @@ struct genlist *genlist_new_full(genlist_free_fn_t free_data_func)
   return pgenlist;
 }
 
+/****************************************************************************
+  Create a new empty pooled genlist.
+****************************************************************************/
+struct genlist *genlist_new_pooled(void)
+{
+  return genlist_new_pooled_full(NULL);
+}
+
+/****************************************************************************
+  Create a new empty pooled genlist with a free data function. Its links
+  come from slabs owned by the list and it has no mutex, so it must not
+  be used with genlist_allocate_mutex().
+****************************************************************************/
+struct genlist *genlist_new_pooled_full(genlist_free_fn_t free_data_func)
+{
+  struct genlist *pgenlist = fc_calloc(1, sizeof(*pgenlist));
+
+#ifdef ZERO_VARIABLES_FOR_SEARCHING
+  pgenlist->nelements = 0;
+  pgenlist->head_link = NULL;
+  pgenlist->tail_link = NULL;
+  pgenlist->slabs = NULL;
+  pgenlist->free_links = NULL;
+#endif /* ZERO_VARIABLES_FOR_SEARCHING */
+  pgenlist->pooled = TRUE;
+  pgenlist->free_data_func = free_data_func;
+
+  return pgenlist;
+}
+
 /****************************************************************************
   Destroys the genlist.
 ****************************************************************************/
@@ -61,10 +103,62 @@ void genlist_destroy(struct genlist *pgenlist)
   }
 
   genlist_clear(pgenlist);
-  fc_destroy_mutex(&pgenlist->mutex);
+  if (pgenlist->pooled) {
+    struct genlist_slab *pslab = pgenlist->slabs, *pnext;
+
+    for (; NULL != pslab; pslab = pnext) {
+      pnext = pslab->next;
+      free(pslab);
+    }
+  } else {
+    fc_destroy_mutex(&pgenlist->mutex);
+  }
   free(pgenlist);
 }
 
+/****************************************************************************
+  Return an unused link of a pooled genlist, reusing the removed links
+  first, then the room left in the last slab, then a new slab twice as
+  big as the last one.
+****************************************************************************/
+static struct genlist_link *genlist_pool_link(struct genlist *pgenlist)
+{
+  struct genlist_link *plink = pgenlist->free_links;
+  struct genlist_slab *pslab = pgenlist->slabs;
+
+  if (NULL != plink) {
+    pgenlist->free_links = plink->next;
+    return plink;
+  }
+
+  if (NULL == pslab || pslab->used == pslab->size) {
+    int size = (NULL != pslab ? MIN(2 * pslab->size, GENLIST_SLAB_MAX)
+                : GENLIST_SLAB_MIN);
+
+    pslab = fc_malloc(sizeof(*pslab) + size * sizeof(*pslab->links));
+    pslab->next = pgenlist->slabs;
+    pslab->size = size;
+    pslab->used = 0;
+    pgenlist->slabs = pslab;
+  }
+
+  return pslab->links + pslab->used++;
+}
+
+/****************************************************************************
+  Give back a link which is not in the list anymore.
+****************************************************************************/
+static inline void genlist_link_free(struct genlist *pgenlist,
+                                     struct genlist_link *plink)
+{
+  if (pgenlist->pooled) {
+    plink->next = pgenlist->free_links;
+    pgenlist->free_links = plink;
+  } else {
+    free(plink);
+  }
+}
+
 /****************************************************************************
   Create a new link.
 ****************************************************************************/
@@ -72,7 +166,9 @@ static void genlist_link_new(struct genlist *pgenlist, void *dataptr,
                              struct genlist_link *prev,
                              struct genlist_link *next)
 {
-  struct genlist_link *plink = fc_malloc(sizeof(*plink));
+  struct genlist_link *plink = (pgenlist->pooled
+                                ? genlist_pool_link(pgenlist)
+                                : fc_malloc(sizeof(*plink)));
 
   plink->dataptr = dataptr;
   plink->prev = prev;
@@ -115,7 +211,7 @@ static void genlist_link_destroy(struct genlist *pgenlist,
   if (NULL != pgenlist->free_data_func) {
     pgenlist->free_data_func(plink->dataptr);
   }
-  free(plink);
+  genlist_link_free(pgenlist, plink);
 }
 
 /****************************************************************************
@@ -166,7 +262,9 @@ struct genlist *genlist_copy_full(const struct genlist *pgenlist,
                                   genlist_copy_fn_t copy_data_func,
                                   genlist_free_fn_t free_data_func)
 {
-  struct genlist *pcopy = genlist_new_full(free_data_func);
+  struct genlist *pcopy = (NULL != pgenlist && pgenlist->pooled
+                           ? genlist_new_pooled_full(free_data_func)
+                           : genlist_new_full(free_data_func));
 
   if (pgenlist) {
     struct genlist_link *plink;
@@ -264,12 +362,12 @@ void genlist_clear(struct genlist *pgenlist)
       do {
         plink2 = plink->next;
         free_data_func(plink->dataptr);
-        free(plink);
+        genlist_link_free(pgenlist, plink);
       } while (NULL != (plink = plink2));
     } else {
       do {
         plink2 = plink->next;
-        free(plink);
+        genlist_link_free(pgenlist, plink);
       } while (NULL != (plink = plink2));
     }
   }
@@ -682,6 +780,7 @@ void genlist_reverse(struct genlist *pgenlist)
 ****************************************************************************/
 void genlist_allocate_mutex(struct genlist *pgenlist)
 {
+  fc_assert_ret(!pgenlist->pooled);
   fc_allocate_mutex(&pgenlist->mutex);
 }
 
@@ -690,5 +789,6 @@ void genlist_allocate_mutex(struct genlist *pgenlist)
 ****************************************************************************/
 void genlist_release_mutex(struct genlist *pgenlist)
 {
+  fc_assert_ret(!pgenlist->pooled);
   fc_release_mutex(&pgenlist->mutex);
 }
@@ -28,6 +28,12 @@ extern "C" {
   The list data structures are allocated dynamically, and list elements can
   be added or removed at arbitrary positions.
 
+  A "pooled" genlist (see genlist_new_pooled()) takes its links from slabs
+  it owns instead of allocating each link separately, and has no mutex.
+  It suits the many lists which are never shared between threads; the
+  memory of its removed links is only released when the list is
+  destroyed.
+
   Positions in the list are specified starting from 0, up to n - 1 for a
   list with n elements. The position -1 can be used to refer to the last
   element (that is, the same as n - 1, or n when adding a new element), but
@@ -47,6 +53,9 @@ extern "C" {
 /* A single element of a genlist, opaque type. */
 struct genlist_link;
 
+/* A block of links of a pooled genlist, opaque type. */
+struct genlist_slab;
+
 /* Function type definitions. */
 typedef void (*genlist_free_fn_t) (void *);
 typedef void * (*genlist_copy_fn_t) (const void *);
@@ -58,15 +67,23 @@ typedef bool (*genlist_comp_fn_t) (const void *, const void *);
  * of the list. */
 struct genlist {
   int nelements;
-  fc_mutex mutex;
+  fc_mutex mutex;             /* Not initialized for pooled lists. */
   struct genlist_link *head_link;
   struct genlist_link *tail_link;
   genlist_free_fn_t free_data_func;
+
+  /* Pooled lists only. */
+  bool pooled;
+  struct genlist_slab *slabs;
+  struct genlist_link *free_links;
 };
   
 struct genlist *genlist_new(void) fc__warn_unused_result;
 struct genlist *genlist_new_full(genlist_free_fn_t free_data_func)
                 fc__warn_unused_result;
+struct genlist *genlist_new_pooled(void) fc__warn_unused_result;
+struct genlist *genlist_new_pooled_full(genlist_free_fn_t free_data_func)
+                fc__warn_unused_result;
 void genlist_destroy(struct genlist *pgenlist);
 
 struct genlist *genlist_copy(const struct genlist *pgenlist)
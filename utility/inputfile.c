@@ -90,9 +90,13 @@
 struct inputfile {
   unsigned int magic;		/* memory check */
   char *filename;		/* filename as passed to fopen */
-  fz_FILE *fp;			/* read from this */
+  char *data;			/* whole (uncompressed) file content */
+  size_t data_len;		/* length of data */
+  size_t data_pos;		/* start of the next line in data */
+  bool data_mapped;		/* data is mapped in memory */
   bool at_eof;			/* flag for end-of-file */
   struct astring cur_line;	/* data from current line */
+  int cur_line_len;		/* length of cur_line */
   int cur_line_pos;		/* position in current line */
   int line_num;			/* line number from file in cur_line */
   struct astring token;		/* data returned to user */
@@ -165,10 +169,12 @@ static void init_zeros(struct inputfile *inf)
   fc_assert_ret(NULL != inf);
   inf->magic = INF_MAGIC;
   inf->filename = NULL;
-  inf->fp = NULL;
+  inf->data = NULL;
+  inf->data_len = inf->data_pos = 0;
+  inf->data_mapped = FALSE;
   inf->datafn = NULL;
   inf->included_from = NULL;
-  inf->line_num = inf->cur_line_pos = 0;
+  inf->line_num = inf->cur_line_len = inf->cur_line_pos = 0;
   inf->at_eof = inf->in_string = FALSE;
   inf->string_start_line = 0;
   astr_init(&inf->cur_line);
@@ -183,7 +189,7 @@ static bool inf_sanity_check(struct inputfile *inf)
 {
   fc_assert_ret_val(NULL != inf, FALSE);
   fc_assert_ret_val(INF_MAGIC == inf->magic, FALSE);
-  fc_assert_ret_val(NULL != inf->fp, FALSE);
+  fc_assert_ret_val(NULL != inf->data, FALSE);
   fc_assert_ret_val(0 <= inf->line_num, FALSE);
   fc_assert_ret_val(0 <= inf->cur_line_pos, FALSE);
   fc_assert_ret_val(FALSE == inf->at_eof
@@ -207,50 +213,95 @@ static bool inf_sanity_check(struct inputfile *inf)
 **************************************************************************/
 static const char *inf_filename(struct inputfile *inf)
 {
-  if (inf->filename) {
+  if (inf != NULL && inf->filename) {
     return inf->filename;
   } else {
     return "(anonymous)";
   }
 }
 
+/***********************************************************************
+  Return an allocated, initialized structure reading 'data', which was
+  returned by fz_read_file() or fz_read_stream().
+***********************************************************************/
+static struct inputfile *inf_from_data(char *data, size_t len,
+                                       bool mapped,
+                                       datafilename_fn_t datafn)
+{
+  struct inputfile *inf = fc_malloc(sizeof(*inf));
+
+  init_zeros(inf);
+
+  inf->data = data;
+  inf->data_len = len;
+  inf->data_mapped = mapped;
+  inf->datafn = datafn;
+
+  return inf;
+}
+
 /***********************************************************************
   Open the file, and return an allocated, initialized structure.
   Returns NULL if the file could not be opened.
+
+  The whole file is read (or mapped) in memory at once, so the lines
+  are then found with memchr() instead of being read one by one.
 ***********************************************************************/
 struct inputfile *inf_from_file(const char *filename,
                                 datafilename_fn_t datafn)
 {
-  struct inputfile *inf;
-  fz_FILE *fp;
+  char *data;
+  size_t len;
+  bool mapped;
 
   fc_assert_ret_val(NULL != filename, NULL);
   fc_assert_ret_val(0 < strlen(filename), NULL);
-  fp = fz_from_file(filename, "r", -1, 0);
-  if (!fp) {
+  data = fz_read_file(filename, &len, &mapped);
+  if (!data) {
     return NULL;
   }
+  return inf_from_contents(filename, data, len, mapped, datafn);
+}
+
+/***********************************************************************
+  Return an allocated, initialized structure reading the contents of
+  'filename', as returned by fz_read_file(). The structure takes over
+  'data'.
+***********************************************************************/
+struct inputfile *inf_from_contents(const char *filename, char *data,
+                                    size_t len, bool mapped,
+                                    datafilename_fn_t datafn)
+{
+  struct inputfile *inf;
+
+  fc_assert_ret_val(NULL != filename, NULL);
+  fc_assert_ret_val(NULL != data, NULL);
   log_debug("inputfile: opened \"%s\" ok", filename);
-  inf = inf_from_stream(fp, datafn);
+  inf = inf_from_data(data, len, mapped, datafn);
   inf->filename = fc_strdup(filename);
   return inf;
 }
 
 /***********************************************************************
-  Open the stream, and return an allocated, initialized structure.
-  Returns NULL if the file could not be opened.
+  Read the stream, and return an allocated, initialized structure.
+  The stream is closed. Returns NULL if the stream could not be read.
 ***********************************************************************/
 struct inputfile *inf_from_stream(fz_FILE *stream, datafilename_fn_t datafn)
 {
   struct inputfile *inf;
+  char *data;
+  size_t len;
 
   fc_assert_ret_val(NULL != stream, NULL);
-  inf = fc_malloc(sizeof(*inf));
-  init_zeros(inf);
 
-  inf->filename = NULL;
-  inf->fp = stream;
-  inf->datafn = datafn;
+  data = fz_read_stream(stream, &len);
+  if (fz_ferror(stream) != 0) {
+    log_error("Error reading %s: %s", inf_filename(NULL),
+              fz_strerror(stream));
+  }
+  fz_fclose(stream);
+
+  inf = inf_from_data(data, len, FALSE, datafn);
 
   log_debug("inputfile: opened \"%s\" ok", inf_filename(inf));
   return inf;
@@ -269,15 +320,7 @@ static void inf_close_partial(struct inputfile *inf)
 
   log_debug("inputfile: sub-closing \"%s\"", inf_filename(inf));
 
-  if (fz_ferror(inf->fp) != 0) {
-    log_error("Error before closing %s: %s", inf_filename(inf),
-              fz_strerror(inf->fp));
-    fz_fclose(inf->fp);
-    inf->fp = NULL;
-  }
-  else if (fz_fclose(inf->fp) != 0) {
-    log_error("Error closing %s", inf_filename(inf));
-  }
+  fz_free_contents(inf->data, inf->data_len, inf->data_mapped);
   if (inf->filename) {
     free(inf->filename);
   }
@@ -317,8 +360,7 @@ void inf_close(struct inputfile *inf)
 ***********************************************************************/
 static bool have_line(struct inputfile *inf)
 {
-  fc_assert_ret_val(inf_sanity_check(inf), FALSE);
-  return !astr_empty(&inf->cur_line);
+  return 0 < inf->cur_line_len;
 }
 
 /***********************************************************************
@@ -326,9 +368,8 @@ static bool have_line(struct inputfile *inf)
 ***********************************************************************/
 static bool at_eol(struct inputfile *inf)
 {
-  fc_assert_ret_val(inf_sanity_check(inf), TRUE);
-  fc_assert_ret_val(inf->cur_line_pos <= astr_len(&inf->cur_line), TRUE);
-  return (inf->cur_line_pos >= astr_len(&inf->cur_line));
+  fc_assert_ret_val(inf->cur_line_pos <= inf->cur_line_len, TRUE);
+  return (inf->cur_line_pos >= inf->cur_line_len);
 }
 
 /***********************************************************************
@@ -453,8 +494,8 @@ static bool check_include(struct inputfile *inf)
 static bool read_a_line(struct inputfile *inf)
 {
   struct astring *line;
-  char *ret;
-  int pos;
+  const char *start, *end;
+  size_t len;
 
   fc_assert_ret_val(inf_sanity_check(inf), FALSE);
 
@@ -465,55 +506,42 @@ static bool read_a_line(struct inputfile *inf)
   /* abbreviation: */
   line = &inf->cur_line;
 
-  /* minimum initial line length: */
-  astr_reserve(line, 80);
-  astr_clear(line);
-  pos = 0;
+  start = inf->data + inf->data_pos;
+  len = inf->data_len - inf->data_pos;
+  end = (0 < len ? memchr(start, '\n', len) : NULL);
 
-  /* Read until we get a full line:
-   * At start of this loop, pos is index to trailing null
-   * (or first position) in line.
-   */
-  for (;;) {
-    ret = fz_fgets((char *) astr_str(line) + pos,
-                   astr_capacity(line) - pos, inf->fp);
-
-    if (!ret) {
-      /* fgets failed */
-      if (pos > 0) {
-        inf_log(inf, LOG_ERROR, _("End-of-file not in line of its own"));
-      }
-      inf->at_eof = TRUE;
-      if (inf->in_string) {
-        /* Note: Don't allow multi-line strings to cross "include"
-         * boundaries */
-        inf_log(inf, LOG_ERROR, "Multi-line string went to end-of-file");
-        return FALSE;
-      }
-      break;
+  if (NULL == end) {
+    if (0 < len) {
+      inf_log(inf, LOG_ERROR, _("End-of-file not in line of its own"));
+    }
+    inf->data_pos = inf->data_len;
+    inf->at_eof = TRUE;
+    if (inf->in_string) {
+      /* Note: Don't allow multi-line strings to cross "include"
+       * boundaries */
+      inf_log(inf, LOG_ERROR, "Multi-line string went to end-of-file");
+      return FALSE;
     }
+  } else {
+    inf->data_pos = end + 1 - inf->data;
 
     /* Cope with \n\r line endings if not caught by library:
      * strip off any leading \r */
-    if (0 == pos && 0 < astr_len(line) && astr_str(line)[0] == '\r') {
-      memmove((char *)astr_str(line), astr_str(line)+1, astr_len(line));
+    if (start < end && '\r' == *start) {
+      start++;
     }
-
-    pos = astr_len(line);
-
-    if (0 < pos && astr_str(line)[pos - 1] == '\n') {
-      int end;
-      /* Cope with \r\n line endings if not caught by library:
-       * strip off any trailing \r */
-      if (1 < pos && astr_str(line)[pos - 2] == '\r') {
-        end = pos - 2;
-      } else {
-        end = pos - 1;
-      }
-      *((char *) astr_str(line) + end) = '\0';
-      break;
+    /* Cope with \r\n line endings if not caught by library:
+     * strip off any trailing \r */
+    if (start < end && '\r' == *(end - 1)) {
+      end--;
     }
-    astr_reserve(line, pos * 2);
+
+    len = end - start;
+    astr_reserve(line, len + 1);
+    memcpy((char *) astr_str(line), start, len);
+    *((char *) astr_str(line) + len) = '\0';
+    /* An embedded '\0' ends the line, as it did with fgets(). */
+    inf->cur_line_len = strlen(astr_str(line));
   }
 
   if (!inf->at_eof) {
@@ -526,6 +554,7 @@ static bool read_a_line(struct inputfile *inf)
     return TRUE;
   } else {
     astr_clear(line);
+    inf->cur_line_len = 0;
     if (inf->included_from) {
       /* Pop the include, and get next line from file above instead. */
       struct inputfile *inc = inf->included_from;
@@ -630,6 +659,20 @@ int inf_discard_tokens(struct inputfile *inf, enum inf_token_type type)
   return count;
 }
 
+/***********************************************************************
+  Set the token returned to the user to the 'len' first characters of
+  'start', and return it.
+***********************************************************************/
+static const char *inf_token_set(struct inputfile *inf, const char *start,
+                                 size_t len)
+{
+  astr_reserve(&inf->token, len + 1);
+  memcpy((char *) astr_str(&inf->token), start, len);
+  *((char *) astr_str(&inf->token) + len) = '\0';
+
+  return astr_str(&inf->token);
+}
+
 /***********************************************************************
   Returns section name in current position of inputfile. Returns NULL
   if there is no section name on that position. Sets inputfile position
@@ -652,11 +695,8 @@ static const char *get_token_section_name(struct inputfile *inf)
   if (*c != ']') {
     return NULL;
   }
-  *((char *) c) = '\0'; /* Tricky. */
-  astr_set(&inf->token, "%s", start);
-  *((char *) c) = ']';  /* Revert. */
   inf->cur_line_pos = c + 1 - astr_str(&inf->cur_line);
-  return astr_str(&inf->token);
+  return inf_token_set(inf, start, c - start);
 }
 
 /***********************************************************************
@@ -666,7 +706,6 @@ static const char *get_token_section_name(struct inputfile *inf)
 static const char *get_token_entry_name(struct inputfile *inf)
 {
   const char *c, *start, *end;
-  char trailing;
 
   fc_assert_ret_val(have_line(inf), NULL);
 
@@ -691,12 +730,8 @@ static const char *get_token_entry_name(struct inputfile *inf)
   if (*c != '=') {
     return NULL;
   }
-  trailing = *end;
-  *((char *) end) = '\0';       /* Tricky. */
-  astr_set(&inf->token, "%s", start);
-  *((char *) end) = trailing;   /* Revert. */
   inf->cur_line_pos = c + 1 - astr_str(&inf->cur_line);
-  return astr_str(&inf->token);
+  return inf_token_set(inf, start, end - start);
 }
 
 /***********************************************************************
@@ -721,10 +756,10 @@ static const char *get_token_eol(struct inputfile *inf)
 
   /* finished with this line: say that we don't have it any more: */
   astr_clear(&inf->cur_line);
+  inf->cur_line_len = 0;
   inf->cur_line_pos = 0;
 
-  astr_set(&inf->token, " ");
-  return astr_str(&inf->token);
+  return inf_token_set(inf, " ", 1);
 }
 
 /***********************************************************************
@@ -746,8 +781,7 @@ static const char *get_token_white_char(struct inputfile *inf,
     return NULL;
   }
   inf->cur_line_pos = c + 1 - astr_str(&inf->cur_line);
-  astr_set(&inf->token, "%c", target);
-  return astr_str(&inf->token);
+  return inf_token_set(inf, &target, 1);
 }
 
 /***********************************************************************
@@ -784,6 +818,7 @@ static const char *get_token_value(struct inputfile *inf)
   char trailing;
   bool has_i18n_marking = FALSE;
   char border_character = '\"';
+  char stop[3] = { '\"', '\\', '\0' };
 
   fc_assert_ret_val(have_line(inf), NULL);
 
@@ -812,16 +847,9 @@ static const char *get_token_value(struct inputfile *inf)
     if (!(*c == '\0' || *c == ',' || fc_isspace(*c) || is_comment(*c))) {
       return NULL;
     }
-    /* If its a comma, we don't want to obliterate it permanently,
-     * so remember it: */
-    trailing = *c;
-    *((char *) c) = '\0';       /* Tricky. */
 
     inf->cur_line_pos = c - astr_str(&inf->cur_line);
-    astr_set(&inf->token, "%s", start);
-
-    *((char *) c) = trailing;   /* Revert. */
-    return astr_str(&inf->token);
+    return inf_token_set(inf, start, c - start);
   }
 
   /* allow gettext marker: */
@@ -867,18 +895,17 @@ static const char *get_token_value(struct inputfile *inf)
     if (rfname == NULL) {
       inf_log(inf, LOG_ERROR, 
               _("Cannot find stringfile \"%s\"."), start);
-      *((char *) c) = trailing; /* Revert. */
+      *((char *) (c - 1)) = trailing; /* Revert. */
       return NULL;
     }
-    *((char *) c) = trailing; /* Revert. */
+    *((char *) (c - 1)) = trailing; /* Revert. */
     fp = fz_from_file(rfname, "r", -1, 0);
     if (!fp) {
       inf_log(inf, LOG_ERROR,
               _("Cannot open stringfile \"%s\"."), rfname);
       return NULL;
     }
-    log_debug("Stringfile \"%s\" opened ok", start);
-    *((char *) (c - 1)) = trailing; /* Revert. */
+    log_debug("Stringfile \"%s\" opened ok", rfname);
     astr_set(&inf->token, "*"); /* Mark as a string read from a file */
 
     eof = FALSE;
@@ -898,7 +925,8 @@ static const char *get_token_value(struct inputfile *inf)
 
     fz_fclose(fp);
 
-    inf->cur_line_pos = c + 1 - astr_str(&inf->cur_line);
+    /* 'c' is already past the closing '*'. */
+    inf->cur_line_pos = c - astr_str(&inf->cur_line);
 
     return astr_str(&inf->token);
   } else if (border_character != '\"'
@@ -913,16 +941,9 @@ static const char *get_token_value(struct inputfile *inf)
     if (!(*c == '\0' || *c == ',' || fc_isspace(*c) || is_comment(*c))) {
       return NULL;
     }
-    /* If its a comma, we don't want to obliterate it permanently,
-     * so remember it: */
-    trailing = *c;
-    *((char *) c) = '\0';       /* Tricky. */
 
     inf->cur_line_pos = c - astr_str(&inf->cur_line);
-    astr_set(&inf->token, "%s", start);
-
-    *((char *) c) = trailing;   /* Revert. */
-    return astr_str(&inf->token);
+    return inf_token_set(inf, start, c - start);
   }
 
   /* From here, we know we have a string, we just have to find the
@@ -947,11 +968,14 @@ static const char *get_token_value(struct inputfile *inf)
 
   start = c++;                  /* start includes the initial \", to
                                  * distinguish from a number */
+  stop[0] = border_character;
   for (;;) {
-    while (*c != '\0' && *c != border_character) {
+    /* strcspn() is usually vectorised, so look for the stop characters
+     * with it rather than character by character. */
+    for (c += strcspn(c, stop); *c == '\\'; c += strcspn(c, stop)) {
       /* skip over escaped chars, including backslash-doublequote,
        * and backslash-backslash: */
-      if (*c == '\\' && *(c + 1) != '\0') {
+      if (*(c + 1) != '\0') {
         c++;
       }
       c++;
@@ -974,13 +998,13 @@ static const char *get_token_value(struct inputfile *inf)
   }
 
   /* found end of string */
-  trailing = *c;
-  *((char *) c) = '\0';         /* Tricky. */
-
   inf->cur_line_pos = c + 1 - astr_str(&inf->cur_line);
-  astr_set(&inf->token, "%s%s", astr_str(partial), start);
-
-  *((char *) c) = trailing;     /* Revert. */
+  if (astr_empty(partial)) {
+    inf_token_set(inf, start, c - start);
+  } else {
+    astr_add(partial, "%.*s", (int) (c - start), start);
+    astr_copy(&inf->token, partial);
+  }
 
   /* check gettext tag at end: */
   if (has_i18n_marking) {
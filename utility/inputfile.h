@@ -36,6 +36,9 @@ struct inputfile *inf_from_file(const char *filename,
                                 datafilename_fn_t datafn);
 struct inputfile *inf_from_stream(fz_FILE * stream,
                                   datafilename_fn_t datafn);
+struct inputfile *inf_from_contents(const char *filename, char *data,
+                                    size_t len, bool mapped,
+                                    datafilename_fn_t datafn);
 void inf_close(struct inputfile *inf);
 bool inf_at_eof(struct inputfile *inf);
 
@@ -36,10 +36,19 @@
 #include "fc_prehdrs.h"
 
 #include <errno.h>
+#include <limits.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FZ_USE_MMAP
+#endif
+
 #ifdef FREECIV_HAVE_LIBZ
 #include <zlib.h>
 #endif
@@ -52,6 +61,14 @@
 #include <lzma.h>
 #endif
 
+#ifdef HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+
+#ifdef HAVE_LZ4FRAME_H
+#include <lz4frame.h>
+#endif
+
 /* utility */
 #include "log.h"
 #include "mem.h"
@@ -110,9 +127,53 @@ struct xz_struct {
 
 static bool xz_outbuffer_to_file(fz_FILE *fp, lzma_action action);
 static void xz_action(fz_FILE *fp, lzma_action action);
+static bool xz_fill(fz_FILE *fp);
 
 #endif /* FREECIV_HAVE_LIBLZMA */
 
+#if defined(FREECIV_HAVE_LIBZSTD) || defined(FREECIV_HAVE_LIBLZ4)
+
+#define FRAME_BUF_SIZE (256*1024)          /* 256kb */
+#define FRAME_MAGIC_SIZE 4
+
+/* zstd and lz4 files are both handled through a pair of buffers. When
+   writing, 'in_buf' receives the text to compress and 'out_buf' the
+   compressed data to write to the file. When reading, 'in_buf' holds
+   the data read from the file and 'out_buf' the decompressed text not
+   yet returned by fz_fgets(). */
+struct frame_struct {
+  FILE *plain;
+  char *in_buf;
+  size_t in_pos;
+  size_t in_len;
+  char *out_buf;
+  size_t out_size;
+  size_t out_pos;
+  size_t out_len;
+  bool eof;         /* Nothing more to read from 'plain'. */
+  bool out_full;    /* Last decompression filled 'out_buf'. */
+  size_t error;     /* Last error code of the library, or 0. */
+  union {
+#ifdef FREECIV_HAVE_LIBZSTD
+    ZSTD_CCtx *zstd_c;
+    ZSTD_DCtx *zstd_d;
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+    LZ4F_cctx *lz4_c;
+    LZ4F_dctx *lz4_d;
+#endif
+  } ctx;
+};
+
+static bool frame_open(fz_FILE *fp, const char *filename, const char *mode,
+                       int compress_level);
+static bool frame_write(fz_FILE *fp, const char *data, size_t len,
+                        bool end);
+static bool frame_fill(fz_FILE *fp);
+static void frame_free(fz_FILE *fp);
+
+#endif /* FREECIV_HAVE_LIBZSTD || FREECIV_HAVE_LIBLZ4 */
+
 struct mem_fzFILE {
   bool control;
   char *buffer;
@@ -135,6 +196,9 @@ struct fz_FILE_s {
 #endif
 #ifdef FREECIV_HAVE_LIBLZMA
     struct xz_struct xz;
+#endif
+#if defined(FREECIV_HAVE_LIBZSTD) || defined(FREECIV_HAVE_LIBLZ4)
+    struct frame_struct frame;   /* FZ_ZSTD, FZ_LZ4 */
 #endif
   } u;
 };
@@ -154,6 +218,12 @@ static inline bool fz_method_is_valid(enum fz_method method)
 #endif
 #ifdef FREECIV_HAVE_LIBLZMA
   case FZ_XZ:
+#endif
+#ifdef FREECIV_HAVE_LIBZSTD
+  case FZ_ZSTD:
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+  case FZ_LZ4:
 #endif
     return TRUE;
   }
@@ -213,15 +283,31 @@ fz_FILE *fz_from_file(const char *filename, const char *in_mode,
     /* Writing: */
     fp->mode = 'w';
   } else {
-#if defined(FREECIV_HAVE_LIBBZ2) || defined(FREECIV_HAVE_LIBLZMA)
+#if defined(FREECIV_HAVE_LIBBZ2) || defined(FREECIV_HAVE_LIBLZMA) \
+  || defined(FREECIV_HAVE_LIBZSTD) || defined(FREECIV_HAVE_LIBLZ4)
     char test_mode[4];
     sz_strlcpy(test_mode, mode);
     sz_strlcat(test_mode, "b");
-#endif /* FREECIV_HAVE_LIBBZ2 || FREECIV_HAVE_LIBLZMA */
+#endif /* FREECIV_HAVE_LIBBZ2 || FREECIV_HAVE_LIBLZMA || ... */
 
     /* Reading: ignore specified method and try each: */
     fp->mode = 'r';
 
+#ifdef FREECIV_HAVE_LIBZSTD
+    /* zstd and lz4 files are recognized by their magic number. */
+    fp->method = FZ_ZSTD;
+    if (frame_open(fp, filename, test_mode, 0)) {
+      return fp;
+    }
+#endif /* FREECIV_HAVE_LIBZSTD */
+
+#ifdef FREECIV_HAVE_LIBLZ4
+    fp->method = FZ_LZ4;
+    if (frame_open(fp, filename, test_mode, 0)) {
+      return fp;
+    }
+#endif /* FREECIV_HAVE_LIBLZ4 */
+
 #ifdef FREECIV_HAVE_LIBBZ2
     /* Try to open as bzip2 file
        This is simplest test, so do it first. */
@@ -350,6 +436,23 @@ fz_FILE *fz_from_file(const char *filename, const char *in_mode,
   fp->method = fz_method_validate(method);
 
   switch (fp->method) {
+#ifdef FREECIV_HAVE_LIBZSTD
+  case FZ_ZSTD:
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+  case FZ_LZ4:
+#endif
+#if defined(FREECIV_HAVE_LIBZSTD) || defined(FREECIV_HAVE_LIBLZ4)
+    /* zstd and lz4 files are binary files, so we should add "b" to mode! */
+    sz_strlcat(mode, "b");
+    /* Open for read handled earlier */
+    fc_assert_ret_val('w' == mode[0], NULL);
+    if (!frame_open(fp, filename, mode, compress_level)) {
+      free(fp);
+      fp = NULL;
+    }
+    return fp;
+#endif /* FREECIV_HAVE_LIBZSTD || FREECIV_HAVE_LIBLZ4 */
 #ifdef FREECIV_HAVE_LIBLZMA
   case FZ_XZ:
     {
@@ -449,6 +552,34 @@ fz_FILE *fz_from_stream(FILE *stream)
   return fp;
 }
 
+/***************************************************************
+  Enable or disable long distance matching when compressing the
+  file, which finds repetitions much further back in the data at
+  the cost of more memory. Must be called before anything is
+  written. Returns FALSE if the compression method of the file
+  doesn't support it (only zstd does).
+***************************************************************/
+bool fz_set_long_range(fz_FILE *fp, bool enable)
+{
+  fc_assert_ret_val(NULL != fp, FALSE);
+
+  if (fp->memory || 'w' != fp->mode) {
+    return FALSE;
+  }
+
+#ifdef FREECIV_HAVE_LIBZSTD
+  if (FZ_ZSTD == fp->method) {
+    size_t ret = ZSTD_CCtx_setParameter(fp->u.frame.ctx.zstd_c,
+                                        ZSTD_c_enableLongDistanceMatching,
+                                        enable ? 1 : 0);
+
+    return !ZSTD_isError(ret);
+  }
+#endif /* FREECIV_HAVE_LIBZSTD */
+
+  return FALSE;
+}
+
 /***************************************************************
   Close file, like fclose.
   Returns 0 on success, or non-zero for problems (but don't call
@@ -473,6 +604,23 @@ int fz_fclose(fz_FILE *fp)
   }
 
   switch (fz_method_validate(fp->method)) {
+#ifdef FREECIV_HAVE_LIBZSTD
+  case FZ_ZSTD:
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+  case FZ_LZ4:
+#endif
+#if defined(FREECIV_HAVE_LIBZSTD) || defined(FREECIV_HAVE_LIBLZ4)
+    if (fp->mode == 'w' && !frame_write(fp, NULL, 0, TRUE)) {
+      error = 1;
+    }
+    if (0 != fclose(fp->u.frame.plain)) {
+      error = 1;
+    }
+    frame_free(fp);
+    free(fp);
+    return error;
+#endif /* FREECIV_HAVE_LIBZSTD || FREECIV_HAVE_LIBLZ4 */
 #ifdef FREECIV_HAVE_LIBLZMA
   case FZ_XZ:
     if (fp->mode == 'w' && !xz_outbuffer_to_file(fp, LZMA_FINISH)) {
@@ -562,13 +710,52 @@ char *fz_fgets(char *buffer, int size, fz_FILE *fp)
   }
 
   switch (fz_method_validate(fp->method)) {
+#ifdef FREECIV_HAVE_LIBZSTD
+  case FZ_ZSTD:
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+  case FZ_LZ4:
+#endif
+#if defined(FREECIV_HAVE_LIBZSTD) || defined(FREECIV_HAVE_LIBLZ4)
+    {
+      struct frame_struct *frame = &fp->u.frame;
+      int i = 0;
+
+      while (i < size - 1) {
+        const char *start, *nl;
+        size_t len;
+
+        if (frame->out_pos == frame->out_len && !frame_fill(fp)) {
+          break;
+        }
+
+        start = frame->out_buf + frame->out_pos;
+        len = MIN(frame->out_len - frame->out_pos, size - 1 - i);
+        nl = memchr(start, '\n', len);
+        if (NULL != nl) {
+          len = nl - start + 1;
+        }
+        memcpy(buffer + i, start, len);
+        frame->out_pos += len;
+        i += len;
+        if (NULL != nl) {
+          break;
+        }
+      }
+
+      if (0 == i) {
+        return NULL;
+      }
+      buffer[i] = '\0';
+      return buffer;
+    }
+#endif /* FREECIV_HAVE_LIBZSTD || FREECIV_HAVE_LIBLZ4 */
 #ifdef FREECIV_HAVE_LIBLZMA
   case FZ_XZ:
     {
       int i, j;
 
       for (i = 0; i < size - 1; i += j) {
-        size_t len = 0;
         bool line_end;
 
         for (j = 0, line_end = FALSE; fp->u.xz.out_avail > 0
@@ -587,61 +774,14 @@ char *fz_fgets(char *buffer, int size, fz_FILE *fp)
           return buffer;
         }
 
-        if (fp->u.xz.hack_byte_used) {
-          size_t hblen = 0;
-
-          fp->u.xz.in_buf[0] = fp->u.xz.hack_byte;
-          len = fread(fp->u.xz.in_buf + 1, 1, PLAIN_FILE_BUF_SIZE - 1,
-                      fp->u.xz.plain);
-          len++;
-
-          if (len <= 1) {
-            hblen = fread(&fp->u.xz.hack_byte, 1, 1, fp->u.xz.plain);
-          }
-          if (hblen == 0) {
-            fp->u.xz.hack_byte_used = FALSE;
-          }
-        }
-        if (len == 0) {
-          if (fp->u.xz.error == LZMA_STREAM_END) {
-            if (i + j == 0) {
-              /* Plain file read complete, and there was nothing in xz buffers
-                 -> end-of-file. */
-              return NULL;
-            }
-            buffer[i + j] = '\0';
-            return buffer;
-          } else {
-            fp->u.xz.stream.next_out = fp->u.xz.out_buf;
-            fp->u.xz.stream.avail_out = PLAIN_FILE_BUF_SIZE;
-            xz_action(fp, LZMA_FINISH);
-            fp->u.xz.out_index = 0;
-            fp->u.xz.out_avail =
-              fp->u.xz.stream.total_out - fp->u.xz.total_read;
-            if (fp->u.xz.error != LZMA_OK
-                && fp->u.xz.error != LZMA_STREAM_END) {
-              return NULL;
-            }
-          }
-        } else {
-          lzma_action action;
-
-          fp->u.xz.stream.next_in = fp->u.xz.in_buf;
-          fp->u.xz.stream.avail_in = len;
-          fp->u.xz.stream.next_out = fp->u.xz.out_buf;
-          fp->u.xz.stream.avail_out = PLAIN_FILE_BUF_SIZE;
-          if (fp->u.xz.hack_byte_used) {
-            action = LZMA_RUN;
-          } else {
-            action = LZMA_FINISH;
-          }
-          xz_action(fp, action);
-          fp->u.xz.out_avail =
-            fp->u.xz.stream.total_out - fp->u.xz.total_read;
-          fp->u.xz.out_index = 0;
-          if (fp->u.xz.error != LZMA_OK && fp->u.xz.error != LZMA_STREAM_END) {
+        if (!xz_fill(fp)) {
+          if (fp->u.xz.error != LZMA_STREAM_END || i + j == 0) {
+            /* Error, or plain file read complete and there was nothing
+               in xz buffers -> end-of-file. */
             return NULL;
           }
+          buffer[i + j] = '\0';
+          return buffer;
         }
       }
 
@@ -706,6 +846,110 @@ char *fz_fgets(char *buffer, int size, fz_FILE *fp)
   return NULL;
 }
 
+/***************************************************************
+  Read up to 'size' bytes of raw data, like fread(). Unlike
+  fz_fgets() it copes with binary data. Returns the number of
+  bytes read, which is less than 'size' only at end of file or on
+  error (see fz_ferror()).
+***************************************************************/
+size_t fz_fread(fz_FILE *fp, void *buffer, size_t size)
+{
+  char *buf = buffer;
+  size_t done = 0;
+
+  fc_assert_ret_val(NULL != fp, 0);
+
+  if (fp->memory) {
+    done = MIN(size, (size_t) (fp->u.mem.size - fp->u.mem.pos));
+    memcpy(buf, fp->u.mem.buffer + fp->u.mem.pos, done);
+    fp->u.mem.pos += done;
+    return done;
+  }
+
+  switch (fz_method_validate(fp->method)) {
+#ifdef FREECIV_HAVE_LIBZSTD
+  case FZ_ZSTD:
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+  case FZ_LZ4:
+#endif
+#if defined(FREECIV_HAVE_LIBZSTD) || defined(FREECIV_HAVE_LIBLZ4)
+    {
+      struct frame_struct *frame = &fp->u.frame;
+
+      while (done < size) {
+        size_t len;
+
+        if (frame->out_pos == frame->out_len && !frame_fill(fp)) {
+          break;
+        }
+        len = MIN(frame->out_len - frame->out_pos, size - done);
+        memcpy(buf + done, frame->out_buf + frame->out_pos, len);
+        frame->out_pos += len;
+        done += len;
+      }
+      return done;
+    }
+#endif /* FREECIV_HAVE_LIBZSTD || FREECIV_HAVE_LIBLZ4 */
+#ifdef FREECIV_HAVE_LIBLZMA
+  case FZ_XZ:
+    while (done < size) {
+      if (0 < fp->u.xz.out_avail) {
+        size_t len = MIN((size_t) fp->u.xz.out_avail, size - done);
+
+        memcpy(buf + done, fp->u.xz.out_buf + fp->u.xz.out_index, len);
+        fp->u.xz.out_index += len;
+        fp->u.xz.out_avail -= len;
+        fp->u.xz.total_read += len;
+        done += len;
+      } else if (!xz_fill(fp)) {
+        break;
+      }
+    }
+    return done;
+#endif /* FREECIV_HAVE_LIBLZMA */
+#ifdef FREECIV_HAVE_LIBBZ2
+  case FZ_BZIP2:
+    if (fp->u.bz2.firstbyte >= 0 && 0 < size) {
+      buf[done++] = fp->u.bz2.firstbyte;
+      fp->u.bz2.firstbyte = -1;
+    }
+    while (done < size && !fp->u.bz2.eof) {
+      int len = BZ2_bzRead(&fp->u.bz2.error, fp->u.bz2.file, buf + done,
+                           MIN(size - done, INT_MAX));
+
+      if (fp->u.bz2.error == BZ_STREAM_END) {
+        /* EOF reached. Do not BZ2_bzRead() any more. */
+        fp->u.bz2.eof = TRUE;
+      } else if (fp->u.bz2.error != BZ_OK) {
+        break;
+      }
+      done += len;
+    }
+    return done;
+#endif /* FREECIV_HAVE_LIBBZ2 */
+#ifdef FREECIV_HAVE_LIBZ
+  case FZ_ZLIB:
+    while (done < size) {
+      int len = gzread(fp->u.zlib, buf + done, MIN(size - done, INT_MAX));
+
+      if (0 >= len) {
+        break;
+      }
+      done += len;
+    }
+    return done;
+#endif /* FREECIV_HAVE_LIBZ */
+  case FZ_PLAIN:
+    return fread(buf, 1, size, fp->u.plain);
+  }
+
+  /* Should never happen */
+  fc_assert_msg(FALSE, "Internal error in %s() (method = %d)",
+                __FUNCTION__, fp->method);
+  return 0;
+}
+
 #ifdef FREECIV_HAVE_LIBLZMA
 
 /***************************************************************
@@ -761,8 +1005,371 @@ static void xz_action(fz_FILE *fp, lzma_action action)
 
   fp->u.xz.error = lzma_code(&fp->u.xz.stream, action);
 }
+
+/***************************************************************
+  Decompress more data into the (empty) output buffer. Returns
+  FALSE at end of file or on error; fp->u.xz.error tells which.
+***************************************************************/
+static bool xz_fill(fz_FILE *fp)
+{
+  size_t len = 0;
+
+  if (fp->u.xz.hack_byte_used) {
+    size_t hblen = 0;
+
+    fp->u.xz.in_buf[0] = fp->u.xz.hack_byte;
+    len = fread(fp->u.xz.in_buf + 1, 1, PLAIN_FILE_BUF_SIZE - 1,
+                fp->u.xz.plain);
+    len++;
+
+    if (len <= 1) {
+      hblen = fread(&fp->u.xz.hack_byte, 1, 1, fp->u.xz.plain);
+    }
+    if (hblen == 0) {
+      fp->u.xz.hack_byte_used = FALSE;
+    }
+  }
+
+  if (len == 0) {
+    if (fp->u.xz.error == LZMA_STREAM_END) {
+      return FALSE;
+    }
+    fp->u.xz.stream.next_out = fp->u.xz.out_buf;
+    fp->u.xz.stream.avail_out = PLAIN_FILE_BUF_SIZE;
+    xz_action(fp, LZMA_FINISH);
+  } else {
+    fp->u.xz.stream.next_in = fp->u.xz.in_buf;
+    fp->u.xz.stream.avail_in = len;
+    fp->u.xz.stream.next_out = fp->u.xz.out_buf;
+    fp->u.xz.stream.avail_out = PLAIN_FILE_BUF_SIZE;
+    xz_action(fp, fp->u.xz.hack_byte_used ? LZMA_RUN : LZMA_FINISH);
+  }
+  fp->u.xz.out_index = 0;
+  fp->u.xz.out_avail = fp->u.xz.stream.total_out - fp->u.xz.total_read;
+
+  return (fp->u.xz.error == LZMA_OK || fp->u.xz.error == LZMA_STREAM_END);
+}
 #endif /* FREECIV_HAVE_LIBLZMA */
 
+#if defined(FREECIV_HAVE_LIBZSTD) || defined(FREECIV_HAVE_LIBLZ4)
+
+/***************************************************************
+  Open the zstd or lz4 file (according to fp->method). When
+  reading, fails if the file doesn't start with the magic number
+  of the format. Returns FALSE on failure, leaving nothing to
+  free in 'fp'.
+***************************************************************/
+static bool frame_open(fz_FILE *fp, const char *filename, const char *mode,
+                       int compress_level)
+{
+  struct frame_struct *frame = &fp->u.frame;
+
+  memset(frame, 0, sizeof(*frame));
+  frame->plain = fc_fopen(filename, mode);
+  if (NULL == frame->plain) {
+    return FALSE;
+  }
+
+  if ('r' == fp->mode) {
+    static const unsigned char magic[][FRAME_MAGIC_SIZE] = {
+#ifdef FREECIV_HAVE_LIBZSTD
+      { 0x28, 0xb5, 0x2f, 0xfd },       /* ZSTD_MAGICNUMBER */
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+      { 0x04, 0x22, 0x4d, 0x18 },       /* LZ4F_MAGICNUMBER */
+#endif
+    };
+    int idx = 0;
+
+#ifdef FREECIV_HAVE_LIBLZ4
+    if (FZ_LZ4 == fp->method) {
+      idx = ARRAY_SIZE(magic) - 1;
+    }
+#endif
+
+    frame->in_buf = fc_malloc(FRAME_BUF_SIZE);
+    frame->in_len = fread(frame->in_buf, 1, FRAME_MAGIC_SIZE, frame->plain);
+    if (FRAME_MAGIC_SIZE != frame->in_len
+        || 0 != memcmp(frame->in_buf, magic[idx], FRAME_MAGIC_SIZE)) {
+      /* Not a file of this format. */
+      fclose(frame->plain);
+      free(frame->in_buf);
+      return FALSE;
+    }
+
+    switch (fp->method) {
+#ifdef FREECIV_HAVE_LIBZSTD
+    case FZ_ZSTD:
+      frame->ctx.zstd_d = ZSTD_createDCtx();
+      frame->out_size = ZSTD_DStreamOutSize();
+      break;
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+    case FZ_LZ4:
+      frame->error = LZ4F_createDecompressionContext(&frame->ctx.lz4_d,
+                                                     LZ4F_VERSION);
+      if (LZ4F_isError(frame->error)) {
+        frame->ctx.lz4_d = NULL;
+      }
+      frame->out_size = FRAME_BUF_SIZE;
+      break;
+#endif
+    default:
+      break;
+    }
+  } else {
+    frame->in_buf = fc_malloc(FRAME_BUF_SIZE);
+
+    switch (fp->method) {
+#ifdef FREECIV_HAVE_LIBZSTD
+    case FZ_ZSTD:
+      frame->ctx.zstd_c = ZSTD_createCCtx();
+      if (NULL != frame->ctx.zstd_c) {
+        ZSTD_CCtx_setParameter(frame->ctx.zstd_c, ZSTD_c_compressionLevel,
+                               compress_level);
+        ZSTD_CCtx_setParameter(frame->ctx.zstd_c, ZSTD_c_checksumFlag, 1);
+      }
+      frame->out_size = ZSTD_CStreamOutSize();
+      break;
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+    case FZ_LZ4:
+      {
+        LZ4F_preferences_t prefs;
+
+        memset(&prefs, 0, sizeof(prefs));
+        prefs.compressionLevel = compress_level;
+        prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+
+        frame->error = LZ4F_createCompressionContext(&frame->ctx.lz4_c,
+                                                     LZ4F_VERSION);
+        if (LZ4F_isError(frame->error)) {
+          frame->ctx.lz4_c = NULL;
+          break;
+        }
+        /* Room for the compressed data of a full 'in_buf', plus what
+         * lz4 may still buffer, the frame header and its end mark. */
+        frame->out_size = LZ4F_compressBound(FRAME_BUF_SIZE, &prefs)
+          + LZ4F_HEADER_SIZE_MAX;
+        frame->out_buf = fc_malloc(frame->out_size);
+        frame->out_len = LZ4F_compressBegin(frame->ctx.lz4_c,
+                                            frame->out_buf,
+                                            frame->out_size, &prefs);
+        if (LZ4F_isError(frame->out_len)) {
+          frame->error = frame->out_len;
+          frame->out_len = 0;
+        } else if (frame->out_len != fwrite(frame->out_buf, 1,
+                                            frame->out_len,
+                                            frame->plain)) {
+          frame->error = 1;
+        }
+      }
+      break;
+#endif
+    default:
+      break;
+    }
+  }
+
+  if (NULL == frame->out_buf && 0 < frame->out_size) {
+    frame->out_buf = fc_malloc(frame->out_size);
+  }
+
+#ifdef FREECIV_HAVE_LIBZSTD
+  if (FZ_ZSTD == fp->method && NULL == frame->ctx.zstd_c) {
+    /* Same position in the union as zstd_d. */
+    frame->error = 1;
+  }
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+  if (FZ_LZ4 == fp->method && NULL == frame->ctx.lz4_c) {
+    /* Same position in the union as lz4_d. */
+    frame->error = 1;
+  }
+#endif
+
+  if (0 != frame->error) {
+    fclose(frame->plain);
+    frame_free(fp);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/***************************************************************
+  Compress 'len' bytes of 'data' and write the result to the
+  file. With 'end', finish the frame instead: everything still
+  buffered by the library is written out.
+***************************************************************/
+static bool frame_write(fz_FILE *fp, const char *data, size_t len,
+                        bool end)
+{
+  struct frame_struct *frame = &fp->u.frame;
+  size_t ret = 0;
+
+  if (0 != frame->error) {
+    return FALSE;
+  }
+
+  switch (fp->method) {
+#ifdef FREECIV_HAVE_LIBZSTD
+  case FZ_ZSTD:
+    {
+      ZSTD_inBuffer input = { data, len, 0 };
+
+      do {
+        ZSTD_outBuffer output = { frame->out_buf, frame->out_size, 0 };
+
+        ret = ZSTD_compressStream2(frame->ctx.zstd_c, &output, &input,
+                                   end ? ZSTD_e_end : ZSTD_e_continue);
+        if (ZSTD_isError(ret)) {
+          frame->error = ret;
+          return FALSE;
+        }
+        if (output.pos != fwrite(frame->out_buf, 1, output.pos,
+                                 frame->plain)) {
+          return FALSE;
+        }
+      } while (end ? 0 != ret : input.pos < input.size);
+    }
+    return TRUE;
+#endif /* FREECIV_HAVE_LIBZSTD */
+#ifdef FREECIV_HAVE_LIBLZ4
+  case FZ_LZ4:
+    if (end) {
+      ret = LZ4F_compressEnd(frame->ctx.lz4_c, frame->out_buf,
+                             frame->out_size, NULL);
+    } else {
+      fc_assert_ret_val(FRAME_BUF_SIZE >= len, FALSE);
+      ret = LZ4F_compressUpdate(frame->ctx.lz4_c, frame->out_buf,
+                                frame->out_size, data, len, NULL);
+    }
+    if (LZ4F_isError(ret)) {
+      frame->error = ret;
+      return FALSE;
+    }
+    return ret == fwrite(frame->out_buf, 1, ret, frame->plain);
+#endif /* FREECIV_HAVE_LIBLZ4 */
+  default:
+    break;
+  }
+
+  return FALSE;
+}
+
+/***************************************************************
+  Decompress more text into the (empty) output buffer. Returns
+  FALSE at end of file or on error.
+***************************************************************/
+static bool frame_fill(fz_FILE *fp)
+{
+  struct frame_struct *frame = &fp->u.frame;
+
+  frame->out_pos = 0;
+  frame->out_len = 0;
+
+  while (0 == frame->error) {
+    size_t ret;
+
+    if (frame->in_pos == frame->in_len && !frame->out_full) {
+      if (frame->eof) {
+        return FALSE;
+      }
+      frame->in_pos = 0;
+      frame->in_len = fread(frame->in_buf, 1, FRAME_BUF_SIZE,
+                            frame->plain);
+      if (frame->in_len < FRAME_BUF_SIZE) {
+        frame->eof = TRUE;
+      }
+    }
+
+    switch (fp->method) {
+#ifdef FREECIV_HAVE_LIBZSTD
+    case FZ_ZSTD:
+      {
+        ZSTD_inBuffer input = { frame->in_buf, frame->in_len,
+                                frame->in_pos };
+        ZSTD_outBuffer output = { frame->out_buf, frame->out_size, 0 };
+
+        ret = ZSTD_decompressStream(frame->ctx.zstd_d, &output, &input);
+        if (ZSTD_isError(ret)) {
+          frame->error = ret;
+          return FALSE;
+        }
+        frame->in_pos = input.pos;
+        frame->out_len = output.pos;
+      }
+      break;
+#endif /* FREECIV_HAVE_LIBZSTD */
+#ifdef FREECIV_HAVE_LIBLZ4
+    case FZ_LZ4:
+      {
+        size_t src_size = frame->in_len - frame->in_pos;
+        size_t dst_size = frame->out_size;
+
+        ret = LZ4F_decompress(frame->ctx.lz4_d, frame->out_buf, &dst_size,
+                              frame->in_buf + frame->in_pos, &src_size,
+                              NULL);
+        if (LZ4F_isError(ret)) {
+          frame->error = ret;
+          return FALSE;
+        }
+        frame->in_pos += src_size;
+        frame->out_len = dst_size;
+      }
+      break;
+#endif /* FREECIV_HAVE_LIBLZ4 */
+    default:
+      return FALSE;
+    }
+
+    /* The library may hold more output even without more input. */
+    frame->out_full = (frame->out_len == frame->out_size);
+    if (0 < frame->out_len) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/***************************************************************
+  Free the compression context and the buffers of the zstd or
+  lz4 file.
+***************************************************************/
+static void frame_free(fz_FILE *fp)
+{
+  struct frame_struct *frame = &fp->u.frame;
+
+  switch (fp->method) {
+#ifdef FREECIV_HAVE_LIBZSTD
+  case FZ_ZSTD:
+    if ('w' == fp->mode) {
+      ZSTD_freeCCtx(frame->ctx.zstd_c);
+    } else {
+      ZSTD_freeDCtx(frame->ctx.zstd_d);
+    }
+    break;
+#endif /* FREECIV_HAVE_LIBZSTD */
+#ifdef FREECIV_HAVE_LIBLZ4
+  case FZ_LZ4:
+    if ('w' == fp->mode) {
+      LZ4F_freeCompressionContext(frame->ctx.lz4_c);
+    } else {
+      LZ4F_freeDecompressionContext(frame->ctx.lz4_d);
+    }
+    break;
+#endif /* FREECIV_HAVE_LIBLZ4 */
+  default:
+    break;
+  }
+
+  free(frame->in_buf);
+  free(frame->out_buf);
+}
+#endif /* FREECIV_HAVE_LIBZSTD || FREECIV_HAVE_LIBLZ4 */
+
 /***************************************************************
   Print formated, like fprintf.
   
@@ -783,6 +1390,24 @@ int fz_fprintf(fz_FILE *fp, const char *format, ...)
   fc_assert_ret_val(!fp->memory, 0);
 
   switch (fz_method_validate(fp->method)) {
+#ifdef FREECIV_HAVE_LIBZSTD
+  case FZ_ZSTD:
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+  case FZ_LZ4:
+#endif
+#if defined(FREECIV_HAVE_LIBZSTD) || defined(FREECIV_HAVE_LIBLZ4)
+    va_start(ap, format);
+    num = fc_vsnprintf(fp->u.frame.in_buf, FRAME_BUF_SIZE, format, ap);
+    va_end(ap);
+
+    if (num == -1) {
+      log_error("Too much data: truncated in fz_fprintf (%u)",
+                FRAME_BUF_SIZE);
+      num = strlen(fp->u.frame.in_buf);
+    }
+    return frame_write(fp, fp->u.frame.in_buf, num, FALSE) ? num : 0;
+#endif /* FREECIV_HAVE_LIBZSTD || FREECIV_HAVE_LIBLZ4 */
 #ifdef FREECIV_HAVE_LIBLZMA
   case FZ_XZ:
     {
@@ -854,6 +1479,83 @@ int fz_fprintf(fz_FILE *fp, const char *format, ...)
   return 0;
 }
 
+/***************************************************************
+  Write 'len' bytes of raw data, like fwrite(). Unlike fz_fprintf()
+  it copes with binary data and doesn't truncate long buffers.
+  Returns TRUE on success.
+***************************************************************/
+bool fz_fwrite(fz_FILE *fp, const void *data, size_t len)
+{
+  const char *pos = data;
+
+  fc_assert_ret_val(NULL != fp, FALSE);
+  fc_assert_ret_val(!fp->memory, FALSE);
+
+  switch (fz_method_validate(fp->method)) {
+#ifdef FREECIV_HAVE_LIBZSTD
+  case FZ_ZSTD:
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+  case FZ_LZ4:
+#endif
+#if defined(FREECIV_HAVE_LIBZSTD) || defined(FREECIV_HAVE_LIBLZ4)
+    while (0 < len) {
+      size_t chunk = MIN(len, FRAME_BUF_SIZE);
+
+      if (!frame_write(fp, pos, chunk, FALSE)) {
+        return FALSE;
+      }
+      pos += chunk;
+      len -= chunk;
+    }
+    return TRUE;
+#endif /* FREECIV_HAVE_LIBZSTD || FREECIV_HAVE_LIBLZ4 */
+#ifdef FREECIV_HAVE_LIBLZMA
+  case FZ_XZ:
+    if (0 == len) {
+      return TRUE;
+    }
+    fp->u.xz.stream.next_in = (const uint8_t *) data;
+    fp->u.xz.stream.avail_in = len;
+    return xz_outbuffer_to_file(fp, LZMA_RUN);
+#endif /* FREECIV_HAVE_LIBLZMA */
+#ifdef FREECIV_HAVE_LIBBZ2
+  case FZ_BZIP2:
+    while (0 < len) {
+      int chunk = MIN(len, 65536);
+
+      BZ2_bzWrite(&fp->u.bz2.error, fp->u.bz2.file, (void *) pos, chunk);
+      if (fp->u.bz2.error != BZ_OK) {
+        return FALSE;
+      }
+      pos += chunk;
+      len -= chunk;
+    }
+    return TRUE;
+#endif /* FREECIV_HAVE_LIBBZ2 */
+#ifdef FREECIV_HAVE_LIBZ
+  case FZ_ZLIB:
+    while (0 < len) {
+      unsigned int chunk = MIN(len, 65536);
+
+      if (gzwrite(fp->u.zlib, pos, chunk) != (int) chunk) {
+        return FALSE;
+      }
+      pos += chunk;
+      len -= chunk;
+    }
+    return TRUE;
+#endif /* FREECIV_HAVE_LIBZ */
+  case FZ_PLAIN:
+    return len == fwrite(data, 1, len, fp->u.plain);
+  }
+
+  /* Should never happen */
+  fc_assert_msg(FALSE, "Internal error in %s() (method = %d)",
+                __FUNCTION__, fp->method);
+  return FALSE;
+}
+
 /***************************************************************
   Return non-zero if there is an error status associated with
   this stream.  Check fz_strerror for details.
@@ -867,6 +1569,15 @@ int fz_ferror(fz_FILE *fp)
   }
 
   switch (fz_method_validate(fp->method)) {
+#ifdef FREECIV_HAVE_LIBZSTD
+  case FZ_ZSTD:
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+  case FZ_LZ4:
+#endif
+#if defined(FREECIV_HAVE_LIBZSTD) || defined(FREECIV_HAVE_LIBLZ4)
+    return (0 != fp->u.frame.error || ferror(fp->u.frame.plain));
+#endif
 #ifdef FREECIV_HAVE_LIBLZMA
   case FZ_XZ:
     if (fp->u.xz.error != LZMA_OK
@@ -916,6 +1627,28 @@ const char *fz_strerror(fz_FILE *fp)
   fc_assert_ret_val(!fp->memory, NULL);
 
   switch (fz_method_validate(fp->method)) {
+#ifdef FREECIV_HAVE_LIBZSTD
+  case FZ_ZSTD:
+    if (ZSTD_isError(fp->u.frame.error)) {
+      static char zstderror[80];
+
+      fc_snprintf(zstderror, sizeof(zstderror), "Zstd: \"%s\"",
+                  ZSTD_getErrorName(fp->u.frame.error));
+      return zstderror;
+    }
+    return fc_strerror(fc_get_errno());
+#endif /* FREECIV_HAVE_LIBZSTD */
+#ifdef FREECIV_HAVE_LIBLZ4
+  case FZ_LZ4:
+    if (LZ4F_isError(fp->u.frame.error)) {
+      static char lz4error[80];
+
+      fc_snprintf(lz4error, sizeof(lz4error), "Lz4: \"%s\"",
+                  LZ4F_getErrorName(fp->u.frame.error));
+      return lz4error;
+    }
+    return fc_strerror(fc_get_errno());
+#endif /* FREECIV_HAVE_LIBLZ4 */
 #ifdef FREECIV_HAVE_LIBLZMA
   case FZ_XZ:
     {
@@ -1053,3 +1786,133 @@ const char *fz_strerror(fz_FILE *fp)
                 __FUNCTION__, fp->method);
   return NULL;
 }
+
+/***************************************************************
+  Return TRUE if 'data' starts like a file of one of the
+  compression methods known to fz_from_file().
+***************************************************************/
+static bool fz_data_is_compressed(const unsigned char *data, size_t len)
+{
+  static const struct {
+    size_t len;
+    const char *magic;
+  } magics[] = {
+    { 2, "\x1f\x8b" },                  /* gzip */
+    { 3, "BZh" },                       /* bzip2 */
+    { 6, "\xfd" "7zXZ\x00" },            /* xz */
+    { 4, "\x28\xb5\x2f\xfd" },          /* zstd */
+    { 4, "\x04\x22\x4d\x18" },          /* lz4 */
+  };
+  size_t i;
+
+  for (i = 0; i < ARRAY_SIZE(magics); i++) {
+    if (len >= magics[i].len
+        && 0 == memcmp(data, magics[i].magic, magics[i].len)) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/***************************************************************
+  Read everything left in the stream into one malloced buffer,
+  uncompressing it if needed. The buffer is always terminated by
+  an extra '\0' not counted in 'len'. The stream is not closed.
+***************************************************************/
+char *fz_read_stream(fz_FILE *fp, size_t *len)
+{
+  size_t size = 64 * 1024, pos = 0;
+  char *data;
+
+  fc_assert_ret_val(NULL != fp, NULL);
+
+  data = fc_malloc(size);
+  for (;;) {
+    size_t nread;
+
+    if (size - pos < 64 * 1024) {
+      size *= 2;
+      data = fc_realloc(data, size);
+    }
+    /* Keep room for the final '\0'. */
+    nread = fz_fread(fp, data + pos, size - pos - 1);
+    if (0 == nread) {
+      break;
+    }
+    pos += nread;
+  }
+  data[pos] = '\0';
+
+  *len = pos;
+  return data;
+}
+
+/***************************************************************
+  Read the whole file into memory, uncompressing it if needed.
+  An uncompressed file is mapped in memory when the system
+  supports it, and then 'mapped' is set to TRUE. The data is not
+  '\0' terminated in that case. Free the data with
+  fz_free_contents(). Returns NULL if the file cannot be read.
+***************************************************************/
+char *fz_read_file(const char *filename, size_t *len, bool *mapped)
+{
+  fz_FILE *fp;
+  char *data;
+
+  if (!is_reg_file_for_access(filename, FALSE)) {
+    return NULL;
+  }
+
+#ifdef FZ_USE_MMAP
+  {
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+
+    if (0 <= fd && 0 == fstat(fd, &st) && 0 < st.st_size) {
+      data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (MAP_FAILED != data) {
+        if (!fz_data_is_compressed((const unsigned char *) data,
+                                   st.st_size)) {
+          close(fd);
+          *len = st.st_size;
+          *mapped = TRUE;
+          return data;
+        }
+        munmap(data, st.st_size);
+      }
+    }
+    if (0 <= fd) {
+      close(fd);
+    }
+  }
+#endif /* FZ_USE_MMAP */
+
+  fp = fz_from_file(filename, "r", -1, 0);
+  if (NULL == fp) {
+    return NULL;
+  }
+  data = fz_read_stream(fp, len);
+  if (0 != fz_ferror(fp)) {
+    log_error("Error reading %s: %s", filename, fz_strerror(fp));
+  }
+  fz_fclose(fp);
+
+  *mapped = FALSE;
+  return data;
+}
+
+/***************************************************************
+  Free data returned by fz_read_file() or fz_read_stream().
+***************************************************************/
+void fz_free_contents(char *data, size_t len, bool mapped)
+{
+#ifdef FZ_USE_MMAP
+  if (mapped) {
+    munmap(data, len);
+    return;
+  }
+#endif /* FZ_USE_MMAP */
+
+  free(data);
+}
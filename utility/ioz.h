@@ -44,20 +44,33 @@ enum fz_method {
 #ifdef FREECIV_HAVE_LIBLZMA
   FZ_XZ,
 #endif
+#ifdef FREECIV_HAVE_LIBZSTD
+  FZ_ZSTD,
+#endif
+#ifdef FREECIV_HAVE_LIBLZ4
+  FZ_LZ4,
+#endif
 };
 
 fz_FILE *fz_from_file(const char *filename, const char *in_mode,
 		      enum fz_method method, int compress_level);
 fz_FILE *fz_from_stream(FILE *stream);
   fz_FILE *fz_from_memory(char *buffer, int size, bool control);
+bool fz_set_long_range(fz_FILE *fp, bool enable);
 int fz_fclose(fz_FILE *fp);
 char *fz_fgets(char *buffer, int size, fz_FILE *fp);
+size_t fz_fread(fz_FILE *fp, void *buffer, size_t size);
 int fz_fprintf(fz_FILE *fp, const char *format, ...)
      fc__attribute((__format__ (__printf__, 2, 3)));
+bool fz_fwrite(fz_FILE *fp, const void *data, size_t len);
 
 int fz_ferror(fz_FILE *fp);     
 const char *fz_strerror(fz_FILE *fp);
 
+char *fz_read_stream(fz_FILE *fp, size_t *len);
+char *fz_read_file(const char *filename, size_t *len, bool *mapped);
+void fz_free_contents(char *data, size_t len, bool mapped);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -45,6 +45,9 @@
 #ifdef HAVE_SYS_SIGNAL_H
 #include <sys/signal.h>
 #endif
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
 #ifdef FREECIV_MSWINDOWS
 #include <windows.h>	/* GetTempPath */
 #endif
@@ -176,6 +179,52 @@ int fc_writesocket(int sock, const void *buf, size_t size)
   return result;
 }
 
+/***************************************************************
+  Write several pieces of data to a socket with a single system call
+  where possible. Returns the number of bytes written, which may stop
+  in the middle of any piece, or -1 on error.
+***************************************************************/
+int fc_writevsocket(int sock, const struct fc_iovec *iov, int iovcnt)
+{
+#if defined(HAVE_SYS_UIO_H) && !defined(FREECIV_HAVE_WINSOCK)
+  struct iovec vec[iovcnt];
+  struct msghdr msg;
+  int i;
+
+  for (i = 0; i < iovcnt; i++) {
+    vec[i].iov_base = (void *) iov[i].base;
+    vec[i].iov_len = iov[i].len;
+  }
+
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = vec;
+  msg.msg_iovlen = iovcnt;
+
+#  ifdef MSG_NOSIGNAL
+  return sendmsg(sock, &msg, MSG_NOSIGNAL);
+#  else  /* MSG_NOSIGNAL */
+  return sendmsg(sock, &msg, 0);
+#  endif /* MSG_NOSIGNAL */
+#else  /* HAVE_SYS_UIO_H && !FREECIV_HAVE_WINSOCK */
+  int total = 0;
+  int i;
+
+  for (i = 0; i < iovcnt; i++) {
+    int result = fc_writesocket(sock, iov[i].base, iov[i].len);
+
+    if (-1 == result) {
+      return (0 < total ? total : -1);
+    }
+    total += result;
+    if (result < iov[i].len) {
+      break;
+    }
+  }
+
+  return total;
+#endif /* HAVE_SYS_UIO_H && !FREECIV_HAVE_WINSOCK */
+}
+
 /***************************************************************
   Close a socket.
 ***************************************************************/
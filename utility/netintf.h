@@ -90,11 +90,18 @@ typedef TIMEVAL fc_timeval;
 typedef struct timeval fc_timeval;
 #endif /* FREECIV_MSWINDOWS */
 
+/* One piece of data for fc_writevsocket(). */
+struct fc_iovec {
+  const void *base;
+  size_t len;
+};
+
 int fc_connect(int sockfd, const struct sockaddr *serv_addr, socklen_t addrlen);
 int fc_select(int n, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
               fc_timeval *timeout);
 int fc_readsocket(int sock, void *buf, size_t size);
 int fc_writesocket(int sock, const void *buf, size_t size);
+int fc_writevsocket(int sock, const struct fc_iovec *iov, int iovcnt);
 void fc_closesocket(int sock);
 
 void fc_nonblock(int sockfd);
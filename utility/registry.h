@@ -36,6 +36,7 @@ const char *secfile_error(void);
 const char *section_name(const struct section *psection);
 
 #include "registry_ini.h"
+#include "registry_bin.h"
 
 #ifdef __cplusplus
 }
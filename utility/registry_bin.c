@@ -0,0 +1,734 @@
+/**********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <limits.h>
+#include <string.h>
+
+/* utility */
+#include "log.h"
+#include "mem.h"
+#include "registry.h"
+#include "section_file.h"
+#include "shared.h"
+
+#include "registry_bin.h"
+
+#define BINFILE_MAGIC "FCSECBIN"
+#define BINFILE_END_MAGIC "FCSECEND"
+#define BINFILE_MAGIC_LEN 8
+#define BINFILE_HEADER_LEN (BINFILE_MAGIC_LEN + 4)
+#define BINFILE_TRAILER_LEN (8 + BINFILE_MAGIC_LEN)
+#define BINFILE_MAX_NAME_LEN 1024
+
+/* The type byte of the entries. The values are part of the format. */
+enum binfile_type {
+  BT_BOOL = 0,
+  BT_INT = 1,
+  BT_FLOAT = 2,
+  BT_STR = 3,           /* Saved as $string$ in text files. */
+  BT_STR_ESCAPED = 4    /* Saved as "string" in text files. */
+};
+
+/* A growing buffer the sections are encoded into before being written. */
+struct binfile_buffer {
+  unsigned char *data;
+  size_t len;
+  size_t size;
+};
+
+struct binfile_index {
+  char *name;
+  size_t offset;
+  size_t len;
+};
+
+struct binfile_writer {
+  fz_FILE *fs;
+  char *filename;               /* Only for log messages. */
+  bool ok;
+  size_t offset;                /* Bytes written so far. */
+  struct binfile_buffer buf;
+  struct binfile_index *index;
+  int index_num;
+  int index_size;
+};
+
+/* Decoding position in a mapped file. 'error' is set when trying to read
+ * past 'end', and every later read then returns zero. */
+struct binfile_reader {
+  const unsigned char *pos;
+  const unsigned char *end;
+  bool error;
+};
+
+/**************************************************************************
+  Make room for 'len' more bytes at the end of the buffer.
+**************************************************************************/
+static unsigned char *binbuf_reserve(struct binfile_buffer *buf,
+                                     size_t len)
+{
+  if (buf->size - buf->len < len) {
+    buf->size = MAX(2 * buf->size, buf->len + len);
+    buf->size = MAX(buf->size, 4096);
+    buf->data = fc_realloc(buf->data, buf->size);
+  }
+
+  return buf->data + buf->len;
+}
+
+/**************************************************************************
+  Append raw bytes to the buffer.
+**************************************************************************/
+static void binbuf_put(struct binfile_buffer *buf, const void *data,
+                       size_t len)
+{
+  memcpy(binbuf_reserve(buf, len), data, len);
+  buf->len += len;
+}
+
+/**************************************************************************
+  Append a byte to the buffer.
+**************************************************************************/
+static void binbuf_put_u8(struct binfile_buffer *buf, unsigned char value)
+{
+  *binbuf_reserve(buf, 1) = value;
+  buf->len++;
+}
+
+/**************************************************************************
+  Append a fixed size little-endian integer to the buffer.
+**************************************************************************/
+static void binbuf_put_fixed(struct binfile_buffer *buf,
+                             unsigned long long value, int bytes)
+{
+  unsigned char *p = binbuf_reserve(buf, bytes);
+  int i;
+
+  for (i = 0; i < bytes; i++) {
+    p[i] = value & 0xFF;
+    value >>= 8;
+  }
+  buf->len += bytes;
+}
+
+/**************************************************************************
+  Append a variable length unsigned integer to the buffer, 7 bits per
+  byte, low bits first.
+**************************************************************************/
+static void binbuf_put_uint(struct binfile_buffer *buf,
+                            unsigned long long value)
+{
+  unsigned char *p = binbuf_reserve(buf, 10);
+  int n = 0;
+
+  while (value >= 0x80) {
+    p[n++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  p[n++] = value;
+  buf->len += n;
+}
+
+/**************************************************************************
+  Append a signed integer, zigzag encoded so small negative values stay
+  short.
+**************************************************************************/
+static void binbuf_put_int(struct binfile_buffer *buf, int value)
+{
+  long long v = value;
+
+  binbuf_put_uint(buf, ((unsigned long long) v << 1)
+                       ^ (unsigned long long) (v >> 63));
+}
+
+/**************************************************************************
+  Append a string: its length, its bytes and a '\0'.
+**************************************************************************/
+static void binbuf_put_str(struct binfile_buffer *buf, const char *str)
+{
+  size_t len = strlen(str);
+
+  binbuf_put_uint(buf, len);
+  binbuf_put(buf, str, len + 1);
+}
+
+/**************************************************************************
+  Read a byte.
+**************************************************************************/
+static unsigned char binread_u8(struct binfile_reader *rd)
+{
+  if (rd->error || rd->pos >= rd->end) {
+    rd->error = TRUE;
+    return 0;
+  }
+
+  return *rd->pos++;
+}
+
+/**************************************************************************
+  Read a fixed size little-endian integer.
+**************************************************************************/
+static unsigned long long binread_fixed(struct binfile_reader *rd,
+                                        int bytes)
+{
+  unsigned long long value = 0;
+  int i;
+
+  if (rd->error || rd->end - rd->pos < bytes) {
+    rd->error = TRUE;
+    return 0;
+  }
+
+  for (i = bytes - 1; i >= 0; i--) {
+    value = (value << 8) | rd->pos[i];
+  }
+  rd->pos += bytes;
+
+  return value;
+}
+
+/**************************************************************************
+  Read a variable length unsigned integer.
+**************************************************************************/
+static unsigned long long binread_uint(struct binfile_reader *rd)
+{
+  unsigned long long value = 0;
+  int shift;
+
+  for (shift = 0; shift < 64; shift += 7) {
+    unsigned char byte = binread_u8(rd);
+
+    value |= (unsigned long long) (byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return value;
+    }
+  }
+
+  rd->error = TRUE;
+  return 0;
+}
+
+/**************************************************************************
+  Read a zigzag encoded signed integer.
+**************************************************************************/
+static int binread_int(struct binfile_reader *rd)
+{
+  unsigned long long u = binread_uint(rd);
+  long long value = (long long) (u >> 1) ^ -(long long) (u & 1);
+
+  if (value < INT_MIN || value > INT_MAX) {
+    rd->error = TRUE;
+    return 0;
+  }
+
+  return value;
+}
+
+/**************************************************************************
+  Read a string. The returned pointer is in the file data, which has the
+  terminating '\0'. Returns NULL on error.
+**************************************************************************/
+static const char *binread_str(struct binfile_reader *rd)
+{
+  unsigned long long len = binread_uint(rd);
+  const char *str;
+
+  if (rd->error || (unsigned long long) (rd->end - rd->pos) <= len
+      || '\0' != rd->pos[len]) {
+    rd->error = TRUE;
+    return NULL;
+  }
+
+  str = (const char *) rd->pos;
+  rd->pos += len + 1;
+
+  return str;
+}
+
+/**************************************************************************
+  Read an entry name into 'name', which holds the previous name of the
+  section on entry. Returns FALSE on error.
+**************************************************************************/
+static bool binread_name(struct binfile_reader *rd,
+                         char name[BINFILE_MAX_NAME_LEN])
+{
+  unsigned long long shared = binread_uint(rd);
+  unsigned long long len = binread_uint(rd);
+
+  if (rd->error || shared > strlen(name)
+      || shared + len >= BINFILE_MAX_NAME_LEN
+      || (unsigned long long) (rd->end - rd->pos) < len) {
+    rd->error = TRUE;
+    return FALSE;
+  }
+
+  memcpy(name + shared, rd->pos, len);
+  name[shared + len] = '\0';
+  rd->pos += len;
+
+  return TRUE;
+}
+
+/**************************************************************************
+  Returns TRUE iff the file contents, as returned by fz_read_file(), are
+  those of a binary section file.
+**************************************************************************/
+bool binfile_contents_check(const char *data, size_t len)
+{
+  return (len >= BINFILE_MAGIC_LEN
+          && 0 == memcmp(data, BINFILE_MAGIC, BINFILE_MAGIC_LEN));
+}
+
+/**************************************************************************
+  Returns TRUE iff the file is a binary section file.
+**************************************************************************/
+bool binfile_check(const char *filename)
+{
+  char buf[BINFILE_MAGIC_LEN + 1];
+  fz_FILE *fp = fz_from_file(filename, "r", FZ_PLAIN, 0);
+  bool binary;
+
+  if (NULL == fp) {
+    return FALSE;
+  }
+
+  binary = (NULL != fz_fgets(buf, sizeof(buf), fp)
+            && 0 == memcmp(buf, BINFILE_MAGIC, BINFILE_MAGIC_LEN));
+  fz_fclose(fp);
+
+  return binary;
+}
+
+/**************************************************************************
+  Create the entries of a section from their encoded form.
+**************************************************************************/
+static bool binfile_load_entries(struct section *psection,
+                                 struct binfile_reader *rd)
+{
+  unsigned long long num = binread_uint(rd);
+  char name[BINFILE_MAX_NAME_LEN] = "";
+
+  for (; 0 < num && !rd->error; num--) {
+    unsigned char type;
+    struct entry *pentry = NULL;
+
+    if (!binread_name(rd, name)) {
+      break;
+    }
+    type = binread_u8(rd);
+
+    switch (type) {
+    case BT_BOOL:
+      pentry = section_entry_bool_new(psection, name,
+                                      0 != binread_u8(rd));
+      break;
+    case BT_INT:
+      pentry = section_entry_int_new(psection, name, binread_int(rd));
+      break;
+    case BT_FLOAT:
+      {
+        unsigned int bits = binread_fixed(rd, 4);
+        float value;
+
+        FC_STATIC_ASSERT(sizeof(value) == sizeof(bits),
+                         float_not_32_bits);
+        memcpy(&value, &bits, sizeof(value));
+        pentry = section_entry_float_new(psection, name, value);
+      }
+      break;
+    case BT_STR:
+    case BT_STR_ESCAPED:
+      {
+        const char *value = binread_str(rd);
+
+        if (NULL != value) {
+          pentry = section_entry_str_new(psection, name, value,
+                                         BT_STR_ESCAPED == type);
+        }
+      }
+      break;
+    default:
+      SECFILE_LOG(psection->secfile, psection,
+                  "Unknown type %d for entry \"%s\".", type, name);
+      return FALSE;
+    }
+
+    if (NULL == pentry && !rd->error) {
+      return FALSE;
+    }
+  }
+
+  if (rd->error) {
+    SECFILE_LOG(psection->secfile, psection, "Truncated section.");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**************************************************************************
+  Load a binary section file, or only the section named 'section' if not
+  NULL. Thanks to the index, the other sections are not even looked at.
+  Returns NULL on error.
+**************************************************************************/
+struct section_file *binfile_load_section(const char *filename,
+                                          const char *section,
+                                          bool allow_duplicates)
+{
+  char *contents;
+  size_t len;
+  bool mapped;
+
+  contents = fz_read_file(filename, &len, &mapped);
+  if (NULL == contents) {
+    SECFILE_LOG(NULL, NULL, "Could not read %s.", filename);
+    return NULL;
+  }
+
+  return binfile_load_contents(filename, contents, len, mapped, section,
+                               allow_duplicates);
+}
+
+/**************************************************************************
+  Like binfile_load_section(), for the contents of 'filename' already
+  returned by fz_read_file(). The contents are freed.
+**************************************************************************/
+struct section_file *binfile_load_contents(const char *filename,
+                                           char *contents, size_t len,
+                                           bool mapped,
+                                           const char *section,
+                                           bool allow_duplicates)
+{
+  struct section_file *secfile;
+  struct binfile_reader rd;
+  unsigned long long index_offset, num;
+  const unsigned char *data = (const unsigned char *) contents;
+  bool found = FALSE, ok = TRUE;
+
+  if (len < BINFILE_HEADER_LEN + BINFILE_TRAILER_LEN
+      || 0 != memcmp(data, BINFILE_MAGIC, BINFILE_MAGIC_LEN)
+      || 0 != memcmp(data + len - BINFILE_MAGIC_LEN, BINFILE_END_MAGIC,
+                     BINFILE_MAGIC_LEN)) {
+    SECFILE_LOG(NULL, NULL, "%s is not a binary section file, or is "
+                "truncated.", filename);
+    fz_free_contents(contents, len, mapped);
+    return NULL;
+  }
+
+  rd.pos = data + BINFILE_MAGIC_LEN;
+  rd.end = data + BINFILE_HEADER_LEN;
+  rd.error = FALSE;
+  if (BINFILE_VERSION != binread_fixed(&rd, 4)) {
+    SECFILE_LOG(NULL, NULL, "%s: unsupported binary format version.",
+                filename);
+    fz_free_contents(contents, len, mapped);
+    return NULL;
+  }
+
+  rd.pos = data + len - BINFILE_TRAILER_LEN;
+  rd.end = data + len;
+  index_offset = binread_fixed(&rd, 8);
+  if (index_offset < BINFILE_HEADER_LEN
+      || index_offset > len - BINFILE_TRAILER_LEN) {
+    SECFILE_LOG(NULL, NULL, "%s: corrupt section index.", filename);
+    fz_free_contents(contents, len, mapped);
+    return NULL;
+  }
+
+  /* Assign the real value later, to speed up the creation of new
+   * entries, like the text loader does. */
+  secfile = secfile_new(TRUE);
+  secfile->name = fc_strdup(filename);
+  secfile_names_init(secfile);
+
+  rd.pos = data + index_offset;
+  rd.end = data + len - BINFILE_TRAILER_LEN;
+  for (num = binread_uint(&rd); 0 < num && ok && !found; num--) {
+    const char *name = binread_str(&rd);
+    unsigned long long offset = binread_uint(&rd);
+    unsigned long long length = binread_uint(&rd);
+    struct binfile_reader section_rd;
+    struct section *psection;
+
+    if (rd.error || offset < BINFILE_HEADER_LEN || offset > index_offset
+        || length > index_offset - offset) {
+      SECFILE_LOG(secfile, NULL, "Corrupt section index.");
+      ok = FALSE;
+      break;
+    }
+
+    if (NULL != section && 0 != strcmp(name, section)) {
+      continue;
+    }
+    found = (NULL != section);
+
+    psection = secfile_section_new(secfile, name);
+    if (NULL == psection) {
+      ok = FALSE;
+      break;
+    }
+
+    section_rd.pos = data + offset;
+    section_rd.end = data + offset + length;
+    section_rd.error = FALSE;
+    ok = binfile_load_entries(psection, &section_rd);
+  }
+
+  if (ok && rd.error) {
+    SECFILE_LOG(secfile, NULL, "Corrupt section index.");
+    ok = FALSE;
+  }
+  if (ok && NULL != section && !found) {
+    ok = FALSE;
+  }
+
+  fz_free_contents(contents, len, mapped);
+
+  if (!ok || !secfile_hash_build(secfile, allow_duplicates)) {
+    secfile_destroy(secfile);
+    return NULL;
+  }
+
+  return secfile;
+}
+
+/**************************************************************************
+  Encode the entries of a section into the buffer.
+**************************************************************************/
+static bool binfile_put_entries(struct binfile_buffer *buf,
+                                const struct section *psection)
+{
+  const char *prev = "";
+
+  binbuf_put_uint(buf, entry_list_size(section_entries(psection)));
+
+  entry_list_iterate(section_entries(psection), pentry) {
+    const char *name = entry_name(pentry);
+    size_t shared = 0, len;
+
+    /* The entries of the tables are named like "u12.id", "u12.x", so
+     * most of the name is usually the same as the previous one. */
+    while ('\0' != name[shared] && name[shared] == prev[shared]) {
+      shared++;
+    }
+    len = strlen(name + shared);
+    binbuf_put_uint(buf, shared);
+    binbuf_put_uint(buf, len);
+    binbuf_put(buf, name + shared, len);
+    prev = name;
+
+    switch (entry_type(pentry)) {
+    case ENTRY_BOOL:
+      {
+        bool value;
+
+        entry_bool_get(pentry, &value);
+        binbuf_put_u8(buf, BT_BOOL);
+        binbuf_put_u8(buf, value ? 1 : 0);
+      }
+      break;
+    case ENTRY_INT:
+      {
+        int value;
+
+        entry_int_get(pentry, &value);
+        binbuf_put_u8(buf, BT_INT);
+        binbuf_put_int(buf, value);
+      }
+      break;
+    case ENTRY_FLOAT:
+      {
+        float value;
+        unsigned int bits;
+
+        entry_float_get(pentry, &value);
+        memcpy(&bits, &value, sizeof(bits));
+        binbuf_put_u8(buf, BT_FLOAT);
+        binbuf_put_fixed(buf, bits, 4);
+      }
+      break;
+    case ENTRY_STR:
+      {
+        const char *value;
+
+        entry_str_get(pentry, &value);
+        binbuf_put_u8(buf, entry_str_escaped(pentry)
+                      ? BT_STR_ESCAPED : BT_STR);
+        binbuf_put_str(buf, value);
+      }
+      break;
+    case ENTRY_FILEREFERENCE:
+      SECFILE_LOG(psection->secfile, psection,
+                  "File reference \"%s\" can't be saved in binary format.",
+                  entry_name(pentry));
+      return FALSE;
+    }
+  } entry_list_iterate_end;
+
+  return TRUE;
+}
+
+/**************************************************************************
+  Start writing a binary section file to an already opened stream.
+  'filename' is only used in log messages.
+**************************************************************************/
+struct binfile_writer *binfile_writer_new(fz_FILE *fs, const char *filename)
+{
+  struct binfile_writer *writer = fc_calloc(1, sizeof(*writer));
+
+  writer->fs = fs;
+  writer->filename = fc_strdup(NULL != filename ? filename : "");
+
+  binbuf_put(&writer->buf, BINFILE_MAGIC, BINFILE_MAGIC_LEN);
+  binbuf_put_fixed(&writer->buf, BINFILE_VERSION, 4);
+  writer->ok = fz_fwrite(fs, writer->buf.data, writer->buf.len);
+  writer->offset = writer->buf.len;
+
+  return writer;
+}
+
+/**************************************************************************
+  Write the sections. Like secfile_sections_save(), a file can be written
+  section list by section list. Long comment sections are left out, as
+  the text loader drops them too. Returns FALSE on error.
+**************************************************************************/
+bool binfile_writer_add(struct binfile_writer *writer,
+                        const struct section_list *sections)
+{
+  fc_assert_ret_val(NULL != writer, FALSE);
+  fc_assert_ret_val(NULL != sections, FALSE);
+
+  section_list_iterate(sections, psection) {
+    struct binfile_index *pindex;
+
+    if (!writer->ok) {
+      break;
+    }
+
+    if (EST_COMMENT == psection->special) {
+      continue;
+    } else if (EST_INCLUDE == psection->special) {
+      SECFILE_LOG(psection->secfile, psection,
+                  "Includes can't be saved in binary format.");
+      writer->ok = FALSE;
+      break;
+    }
+
+    writer->buf.len = 0;
+    if (!binfile_put_entries(&writer->buf, psection)) {
+      writer->ok = FALSE;
+      break;
+    }
+    if (!fz_fwrite(writer->fs, writer->buf.data, writer->buf.len)) {
+      SECFILE_LOG(psection->secfile, psection, "Error writing %s: %s",
+                  writer->filename, fz_strerror(writer->fs));
+      writer->ok = FALSE;
+      break;
+    }
+
+    if (writer->index_num == writer->index_size) {
+      writer->index_size = MAX(2 * writer->index_size, 64);
+      writer->index = fc_realloc(writer->index, writer->index_size
+                                 * sizeof(*writer->index));
+    }
+    pindex = writer->index + writer->index_num++;
+    pindex->name = fc_strdup(section_name(psection));
+    pindex->offset = writer->offset;
+    pindex->len = writer->buf.len;
+    writer->offset += writer->buf.len;
+  } section_list_iterate_end;
+
+  return writer->ok;
+}
+
+/**************************************************************************
+  Write the section index and free the writer. The stream is left open.
+  Returns FALSE if anything could not be written.
+**************************************************************************/
+bool binfile_writer_close(struct binfile_writer *writer)
+{
+  bool ok;
+  int i;
+
+  fc_assert_ret_val(NULL != writer, FALSE);
+
+  writer->buf.len = 0;
+  binbuf_put_uint(&writer->buf, writer->index_num);
+  for (i = 0; i < writer->index_num; i++) {
+    binbuf_put_str(&writer->buf, writer->index[i].name);
+    binbuf_put_uint(&writer->buf, writer->index[i].offset);
+    binbuf_put_uint(&writer->buf, writer->index[i].len);
+    free(writer->index[i].name);
+  }
+  binbuf_put_fixed(&writer->buf, writer->offset, 8);
+  binbuf_put(&writer->buf, BINFILE_END_MAGIC, BINFILE_MAGIC_LEN);
+
+  ok = (writer->ok
+        && fz_fwrite(writer->fs, writer->buf.data, writer->buf.len)
+        && 0 == fz_ferror(writer->fs));
+
+  free(writer->index);
+  free(writer->buf.data);
+  free(writer->filename);
+  free(writer);
+
+  return ok;
+}
+
+/**************************************************************************
+  Save the section file in binary format. See secfile_save() for the
+  arguments. Returns TRUE on success.
+**************************************************************************/
+bool binfile_save(const struct section_file *secfile, const char *filename,
+                  int compression_level, enum fz_method compression_method)
+{
+  char real_filename[1024];
+  struct binfile_writer *writer;
+  fz_FILE *fs;
+  bool ok;
+
+  SECFILE_RETURN_VAL_IF_FAIL(secfile, NULL, NULL != secfile, FALSE);
+
+  if (NULL == filename) {
+    filename = secfile->name;
+  }
+
+  interpret_tilde(real_filename, sizeof(real_filename), filename);
+  fs = fz_from_file(real_filename, "w",
+                    compression_method, compression_level);
+
+  if (!fs) {
+    return FALSE;
+  }
+
+  writer = binfile_writer_new(fs, real_filename);
+  binfile_writer_add(writer, secfile->sections);
+  ok = binfile_writer_close(writer);
+
+  if (!ok) {
+    SECFILE_LOG(secfile, NULL, "Error before closing %s: %s",
+                real_filename, fz_strerror(fs));
+    fz_fclose(fs);
+    return FALSE;
+  }
+  if (0 != fz_fclose(fs)) {
+    SECFILE_LOG(secfile, NULL, "Error closing %s", real_filename);
+    return FALSE;
+  }
+
+  return TRUE;
+}
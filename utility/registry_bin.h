@@ -0,0 +1,68 @@
+/**********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+#ifndef FC__REGISTRY_BIN_H
+#define FC__REGISTRY_BIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* utility */
+#include "ioz.h"
+#include "registry_ini.h"
+#include "support.h"            /* bool type */
+
+/* Binary section files hold the same sections and entries as the text
+ * ones, without the quoting and number formatting. The sections are
+ * length-prefixed and listed in an index at the end of the file, so a
+ * single section can be read without parsing the others.
+ *
+ * Layout (all integers little-endian):
+ *   "FCSECBIN" 4-byte version
+ *   sections   entry count, then for each entry: name, type byte, value
+ *   index      section count, then name, offset and length of each
+ *   trailer    8-byte index offset, "FCSECEND"
+ *
+ * Counts, lengths, offsets and int values are variable length (7 bits a
+ * byte, ints zigzag encoded). Strings and section names are stored as a
+ * length followed by the bytes and a terminating '\0'. Entry names are
+ * stored as the length of the start they share with the previous entry
+ * name of the section, then the length and the bytes of the rest. */
+
+#define BINFILE_VERSION 1
+
+struct binfile_writer;
+
+bool binfile_check(const char *filename);
+bool binfile_contents_check(const char *data, size_t len);
+struct section_file *binfile_load_section(const char *filename,
+                                          const char *section,
+                                          bool allow_duplicates);
+struct section_file *binfile_load_contents(const char *filename,
+                                           char *contents, size_t len,
+                                           bool mapped,
+                                           const char *section,
+                                           bool allow_duplicates);
+bool binfile_save(const struct section_file *secfile, const char *filename,
+                  int compression_level, enum fz_method compression_method);
+
+struct binfile_writer *binfile_writer_new(fz_FILE *fs, const char *filename);
+bool binfile_writer_add(struct binfile_writer *writer,
+                        const struct section_list *sections);
+bool binfile_writer_close(struct binfile_writer *writer);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif  /* FC__REGISTRY_BIN_H */
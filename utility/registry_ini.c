@@ -192,6 +192,7 @@ static void entry_from_inf_token(struct section *psection, const char *name,
 struct entry {
   struct section *psection;     /* Parent section. */
   char *name;                   /* Name, not including section prefix. */
+  bool name_interned;           /* 'name' is owned by the section file. */
   enum entry_type type;         /* The type of the entry. */
   int used;                     /* Number of times entry looked up. */
   char *comment;                /* Comment, may be NULL. */
@@ -293,6 +294,27 @@ static bool secfile_hash_delete(struct section_file *secfile,
   return entry_hash_remove(secfile->hash.entries, buf);
 }
 
+/**************************************************************************
+  Build the entry hash table of a section file whose entries were all
+  created with duplicates allowed, then apply 'allow_duplicates'.
+  Returns FALSE if the entries don't respect it.
+**************************************************************************/
+bool secfile_hash_build(struct section_file *secfile, bool allow_duplicates)
+{
+  secfile->allow_duplicates = allow_duplicates;
+  secfile->hash.entries = entry_hash_new_nentries(secfile->num_entries);
+
+  section_list_iterate(secfile->sections, hashing_section) {
+    entry_list_iterate(section_entries(hashing_section), pentry) {
+      if (!secfile_hash_insert(secfile, pentry)) {
+        return FALSE;
+      }
+    } entry_list_iterate_end;
+  } section_list_iterate_end;
+
+  return TRUE;
+}
+
 /**************************************************************************
   Base function to load a section file.  Note it closes the inputfile.
 **************************************************************************/
@@ -325,6 +347,7 @@ static struct section_file *secfile_from_input_file(struct inputfile *inf,
   } else {
     secfile->name = NULL;
   }
+  secfile_names_init(secfile);
 
   astring_vector_init(&columns);
 
@@ -549,21 +572,7 @@ END:
   }
 
   if (!error) {
-    /* Build the entry hash table. */
-    secfile->allow_duplicates = allow_duplicates;
-    secfile->hash.entries = entry_hash_new_nentries(secfile->num_entries);
-
-    section_list_iterate(secfile->sections, hashing_section) {
-      entry_list_iterate(section_entries(hashing_section), pentry) {
-        if (!secfile_hash_insert(secfile, pentry)) {
-          error = TRUE;
-          break;
-        }
-      } entry_list_iterate_end;
-      if (error) {
-        break;
-      }
-    } section_list_iterate_end;
+    error = !secfile_hash_build(secfile, allow_duplicates);
   }
   if (error) {
     secfile_destroy(secfile);
@@ -582,9 +591,24 @@ struct section_file *secfile_load_section(const char *filename,
                                           bool allow_duplicates)
 {
   char real_filename[1024];
+  char *contents;
+  size_t len;
+  bool mapped;
 
   interpret_tilde(real_filename, sizeof(real_filename), filename);
-  return secfile_from_input_file(inf_from_file(real_filename, datafilename),
+
+  /* Read the file once, and choose the parser from its contents. */
+  contents = fz_read_file(real_filename, &len, &mapped);
+  if (NULL == contents) {
+    return NULL;
+  }
+  if (binfile_contents_check(contents, len)) {
+    return binfile_load_contents(real_filename, contents, len, mapped,
+                                 section, allow_duplicates);
+  }
+  return secfile_from_input_file(inf_from_contents(real_filename, contents,
+                                                   len, mapped,
+                                                   datafilename),
                                  filename, section, allow_duplicates);
 }
 
@@ -607,240 +631,251 @@ static bool is_legal_table_entry_name(char c, bool num)
 }
 
 /**************************************************************************
-  Save the previously filled in section_file to disk.
-
-  There is now limited ability to save in the new tabular format
-  (to give smaller savefiles).
-  The start of a table is detected by an entry with name of the form:
-    (alphabetical_component)(zero)(period)(alphanumeric_component)
-  Eg: u0.id, or c0.id, in the freeciv savefile.
-  The alphabetical component is taken as the "name" of the table,
-  and the component after the period as the first column name.
-  This should be followed by the other column values for u0,
-  and then subsequent u1, u2, etc, in strict order with no omissions,
-  and with all of the columns for all uN in the same order as for u0.
-
-  If compression_level is non-zero, then compress using zlib.  (Should
-  only supply non-zero compression_level if already know that FREECIV_HAVE_LIBZ.)
-  Below simply specifies FZ_ZLIB method, since fz_fromFile() automatically
-  changes to FZ_PLAIN method when level == 0.
+  Write one section to the stream, in the format described for
+  secfile_save(). 'filename' is only used in log messages.
 **************************************************************************/
-bool secfile_save(const struct section_file *secfile, const char *filename,
-                  int compression_level, enum fz_method compression_method)
+static void section_to_file(const struct section *psection, fz_FILE *fs,
+                            const char *filename)
 {
-  char real_filename[1024];
   char pentry_name[128];
   const char *col_entry_name;
-  fz_FILE *fs;
   const struct entry_list_link *ent_iter, *save_iter, *col_iter;
   struct entry *pentry, *col_pentry;
   int i;
 
-  SECFILE_RETURN_VAL_IF_FAIL(secfile, NULL, NULL != secfile, FALSE);
+  if (psection->special == EST_INCLUDE) {
+    for (ent_iter = entry_list_head(section_entries(psection));
+         ent_iter && (pentry = entry_list_link_data(ent_iter));
+         ent_iter = entry_list_link_next(ent_iter)) {
 
-  if (NULL == filename) {
-    filename = secfile->name;
-  }
+      fc_assert(!strcmp(entry_name(pentry), "file"));
 
-  interpret_tilde(real_filename, sizeof(real_filename), filename);
-  fs = fz_from_file(real_filename, "w",
-                    compression_method, compression_level);
+      fz_fprintf(fs, "*include ");
+      entry_to_file(pentry, fs);
+      fz_fprintf(fs, "\n");
+    }
+  } else if (psection->special == EST_COMMENT) {
+    for (ent_iter = entry_list_head(section_entries(psection));
+         ent_iter && (pentry = entry_list_link_data(ent_iter));
+         ent_iter = entry_list_link_next(ent_iter)) {
 
-  if (!fs) {
-    return FALSE;
-  }
+      fc_assert(!strcmp(entry_name(pentry), "comment"));
 
-  section_list_iterate(secfile->sections, psection) {
-    if (psection->special == EST_INCLUDE) {
-      for (ent_iter = entry_list_head(section_entries(psection));
-           ent_iter && (pentry = entry_list_link_data(ent_iter));
-           ent_iter = entry_list_link_next(ent_iter)) {
+      entry_to_file(pentry, fs);
+      fz_fprintf(fs, "\n");
+    }
+  } else {
+    fz_fprintf(fs, "\n[%s]\n", section_name(psection));
+
+    /* Following doesn't use entry_list_iterate() because we want to do
+     * tricky things with the iterators...
+     */
+    for (ent_iter = entry_list_head(section_entries(psection));
+         ent_iter && (pentry = entry_list_link_data(ent_iter));
+         ent_iter = entry_list_link_next(ent_iter)) {
+      const char *comment;
+
+      /* Tables: break out of this loop if this is a non-table
+       * entry (pentry and ent_iter unchanged) or after table (pentry
+       * and ent_iter suitably updated, pentry possibly NULL).
+       * After each table, loop again in case the next entry
+       * is another table.
+       */
+      for (;;) {
+        char *c, *first, base[64];
+        int offset, irow, icol, ncol;
+
+        /* Example: for first table name of "xyz0.blah":
+         *  first points to the original string pentry->name
+         *  base contains "xyz";
+         *  offset = 5 (so first+offset gives "blah")
+         *  note strlen(base) = offset - 2
+         */
 
-        fc_assert(!strcmp(entry_name(pentry), "file"));
+        if (!SAVE_TABLES) {
+          break;
+        }
 
-        fz_fprintf(fs, "*include ");
-        entry_to_file(pentry, fs);
-        fz_fprintf(fs, "\n");
-      }
-    } else if (psection->special == EST_COMMENT) {
-      for (ent_iter = entry_list_head(section_entries(psection));
-           ent_iter && (pentry = entry_list_link_data(ent_iter));
-           ent_iter = entry_list_link_next(ent_iter)) {
+        sz_strlcpy(pentry_name, entry_name(pentry));
+        c = first = pentry_name;
+        if (*c == '\0' || !is_legal_table_entry_name(*c, FALSE)) {
+          break;
+        }
+        for (; *c != '\0' && is_legal_table_entry_name(*c, FALSE); c++) {
+          /* nothing */
+        }
+        if (0 != strncmp(c, "0.", 2)) {
+          break;
+        }
+        c += 2;
+        if (*c == '\0' || !is_legal_table_entry_name(*c, TRUE)) {
+          break;
+        }
 
-        fc_assert(!strcmp(entry_name(pentry), "comment"));
+        offset = c - first;
+        first[offset - 2] = '\0';
+        sz_strlcpy(base, first);
+        first[offset - 2] = '0';
+        fz_fprintf(fs, "%s={", base);
 
-        entry_to_file(pentry, fs);
+        /* Save an iterator at this first entry, which we can later use
+         * to repeatedly iterate over column names:
+         */
+        save_iter = ent_iter;
+
+        /* write the column names, and calculate ncol: */
+        ncol = 0;
+        col_iter = save_iter;
+        for (; (col_pentry = entry_list_link_data(col_iter));
+             col_iter = entry_list_link_next(col_iter)) {
+          col_entry_name = entry_name(col_pentry);
+          if (strncmp(col_entry_name, first, offset) != 0) {
+            break;
+          }
+          fz_fprintf(fs, "%s\"%s\"", (ncol == 0 ? "" : ","),
+                     col_entry_name + offset);
+          ncol++;
+        }
         fz_fprintf(fs, "\n");
-      }
-    } else {
-      fz_fprintf(fs, "\n[%s]\n", section_name(psection));
 
-      /* Following doesn't use entry_list_iterate() because we want to do
-       * tricky things with the iterators...
-       */
-      for (ent_iter = entry_list_head(section_entries(psection));
-           ent_iter && (pentry = entry_list_link_data(ent_iter));
-           ent_iter = entry_list_link_next(ent_iter)) {
-        const char *comment;
-
-        /* Tables: break out of this loop if this is a non-table
-         * entry (pentry and ent_iter unchanged) or after table (pentry
-         * and ent_iter suitably updated, pentry possibly NULL).
-         * After each table, loop again in case the next entry
-         * is another table.
+        /* Iterate over rows and columns, incrementing ent_iter as we go,
+         * and writing values to the table.  Have a separate iterator
+         * to the column names to check they all match.
          */
+        irow = icol = 0;
+        col_iter = save_iter;
         for (;;) {
-          char *c, *first, base[64];
-          int offset, irow, icol, ncol;
+          char expect[128];     /* pentry->name we're expecting */
 
-          /* Example: for first table name of "xyz0.blah":
-           *  first points to the original string pentry->name
-           *  base contains "xyz";
-           *  offset = 5 (so first+offset gives "blah")
-           *  note strlen(base) = offset - 2
-           */
-
-          if (!SAVE_TABLES) {
-            break;
-          }
+          pentry = entry_list_link_data(ent_iter);
+          col_pentry = entry_list_link_data(col_iter);
 
-          sz_strlcpy(pentry_name, entry_name(pentry));
-          c = first = pentry_name;
-          if (*c == '\0' || !is_legal_table_entry_name(*c, FALSE)) {
-            break;
-          }
-          for (; *c != '\0' && is_legal_table_entry_name(*c, FALSE); c++) {
-            /* nothing */
-          }
-          if (0 != strncmp(c, "0.", 2)) {
-            break;
-          }
-          c += 2;
-          if (*c == '\0' || !is_legal_table_entry_name(*c, TRUE)) {
+          fc_snprintf(expect, sizeof(expect), "%s%d.%s",
+                      base, irow, entry_name(col_pentry) + offset);
+
+          /* break out of tabular if doesn't match: */
+          if ((!pentry) || (strcmp(entry_name(pentry), expect) != 0)) {
+            if (icol != 0) {
+              /* If the second or later row of a table is missing some
+               * entries that the first row had, we drop out of the tabular
+               * format.  This is inefficient so we print a warning message;
+               * the calling code probably needs to be fixed so that it can
+               * use the more efficient tabular format.
+               *
+               * FIXME: If the first row is missing some entries that the
+               * second or later row has, then we'll drop out of tabular
+               * format without an error message. */
+              log_error("In file %s, there is no entry in the registry for\n"
+                        "%s.%s (or the entries are out of order). This means\n"
+                        "a less efficient non-tabular format will be used.\n"
+                        "To avoid this make sure all rows of a table are\n"
+                        "filled out with an entry for every column.",
+                        filename, section_name(psection), expect);
+              /* TRANS: No full stop after the URL, could cause confusion. */
+              log_error(_("Please report this message at %s"), BUG_URL);
+              fz_fprintf(fs, "\n");
+            }
+            fz_fprintf(fs, "}\n");
             break;
           }
 
-          offset = c - first;
-          first[offset - 2] = '\0';
-          sz_strlcpy(base, first);
-          first[offset - 2] = '0';
-          fz_fprintf(fs, "%s={", base);
-
-          /* Save an iterator at this first entry, which we can later use
-           * to repeatedly iterate over column names:
-           */
-          save_iter = ent_iter;
-
-          /* write the column names, and calculate ncol: */
-          ncol = 0;
-          col_iter = save_iter;
-          for (; (col_pentry = entry_list_link_data(col_iter));
-               col_iter = entry_list_link_next(col_iter)) {
-            col_entry_name = entry_name(col_pentry);
-            if (strncmp(col_entry_name, first, offset) != 0) {
-              break;
-            }
-            fz_fprintf(fs, "%s\"%s\"", (ncol == 0 ? "" : ","),
-                       col_entry_name + offset);
-            ncol++;
+          if (icol > 0) {
+            fz_fprintf(fs, ",");
           }
-          fz_fprintf(fs, "\n");
-
-          /* Iterate over rows and columns, incrementing ent_iter as we go,
-           * and writing values to the table.  Have a separate iterator
-           * to the column names to check they all match.
-           */
-          irow = icol = 0;
-          col_iter = save_iter;
-          for (;;) {
-            char expect[128];     /* pentry->name we're expecting */
-
-            pentry = entry_list_link_data(ent_iter);
-            col_pentry = entry_list_link_data(col_iter);
-
-            fc_snprintf(expect, sizeof(expect), "%s%d.%s",
-                        base, irow, entry_name(col_pentry) + offset);
-
-            /* break out of tabular if doesn't match: */
-            if ((!pentry) || (strcmp(entry_name(pentry), expect) != 0)) {
-              if (icol != 0) {
-                /* If the second or later row of a table is missing some
-                 * entries that the first row had, we drop out of the tabular
-                 * format.  This is inefficient so we print a warning message;
-                 * the calling code probably needs to be fixed so that it can
-                 * use the more efficient tabular format.
-                 *
-                 * FIXME: If the first row is missing some entries that the
-                 * second or later row has, then we'll drop out of tabular
-                 * format without an error message. */
-                log_error("In file %s, there is no entry in the registry for\n"
-                          "%s.%s (or the entries are out of order). This means\n"
-                          "a less efficient non-tabular format will be used.\n"
-                          "To avoid this make sure all rows of a table are\n"
-                          "filled out with an entry for every column.",
-                          real_filename, section_name(psection), expect);
-                /* TRANS: No full stop after the URL, could cause confusion. */
-                log_error(_("Please report this message at %s"), BUG_URL);
-                fz_fprintf(fs, "\n");
-              }
-              fz_fprintf(fs, "}\n");
-              break;
-            }
+          entry_to_file(pentry, fs);
 
-            if (icol > 0) {
-              fz_fprintf(fs, ",");
-            }
-            entry_to_file(pentry, fs);
-
-            ent_iter = entry_list_link_next(ent_iter);
-            col_iter = entry_list_link_next(col_iter);
+          ent_iter = entry_list_link_next(ent_iter);
+          col_iter = entry_list_link_next(col_iter);
 
-            icol++;
-            if (icol == ncol) {
-              fz_fprintf(fs, "\n");
-              irow++;
-              icol = 0;
-              col_iter = save_iter;
-            }
-          }
-          if (!pentry) {
-            break;
+          icol++;
+          if (icol == ncol) {
+            fz_fprintf(fs, "\n");
+            irow++;
+            icol = 0;
+            col_iter = save_iter;
           }
         }
         if (!pentry) {
           break;
         }
+      }
+      if (!pentry) {
+        break;
+      }
 
-        /* Classic entry. */
-        col_entry_name = entry_name(pentry);
-        fz_fprintf(fs, "%s=", col_entry_name);
-        entry_to_file(pentry, fs);
+      /* Classic entry. */
+      col_entry_name = entry_name(pentry);
+      fz_fprintf(fs, "%s=", col_entry_name);
+      entry_to_file(pentry, fs);
 
-        /* Check for vector. */
-        for (i = 1;; i++) {
-          col_iter = entry_list_link_next(ent_iter);
-          col_pentry = entry_list_link_data(col_iter);
-          if (NULL == col_pentry) {
-            break;
-          }
-          fc_snprintf(pentry_name, sizeof(pentry_name),
-                      "%s,%d", col_entry_name, i);
-          if (0 != strcmp(pentry_name, entry_name(col_pentry))) {
-            break;
-          }
-          fz_fprintf(fs, ",");
-          entry_to_file(col_pentry, fs);
-          ent_iter = col_iter;
+      /* Check for vector. */
+      for (i = 1;; i++) {
+        col_iter = entry_list_link_next(ent_iter);
+        col_pentry = entry_list_link_data(col_iter);
+        if (NULL == col_pentry) {
+          break;
         }
-
-        comment = entry_comment(pentry);
-        if (comment) {
-          fz_fprintf(fs, "#%s\n", comment);
-        } else {
-          fz_fprintf(fs, "\n");
+        fc_snprintf(pentry_name, sizeof(pentry_name),
+                    "%s,%d", col_entry_name, i);
+        if (0 != strcmp(pentry_name, entry_name(col_pentry))) {
+          break;
         }
+        fz_fprintf(fs, ",");
+        entry_to_file(col_pentry, fs);
+        ent_iter = col_iter;
+      }
+
+      comment = entry_comment(pentry);
+      if (comment) {
+        fz_fprintf(fs, "#%s\n", comment);
+      } else {
+        fz_fprintf(fs, "\n");
       }
     }
+  }
+}
+
+/**************************************************************************
+  Save the previously filled in section_file to disk.
+
+  There is now limited ability to save in the new tabular format
+  (to give smaller savefiles).
+  The start of a table is detected by an entry with name of the form:
+    (alphabetical_component)(zero)(period)(alphanumeric_component)
+  Eg: u0.id, or c0.id, in the freeciv savefile.
+  The alphabetical component is taken as the "name" of the table,
+  and the component after the period as the first column name.
+  This should be followed by the other column values for u0,
+  and then subsequent u1, u2, etc, in strict order with no omissions,
+  and with all of the columns for all uN in the same order as for u0.
+
+  If compression_level is non-zero, then compress using zlib.  (Should
+  only supply non-zero compression_level if already know that FREECIV_HAVE_LIBZ.)
+  Below simply specifies FZ_ZLIB method, since fz_fromFile() automatically
+  changes to FZ_PLAIN method when level == 0.
+**************************************************************************/
+bool secfile_save(const struct section_file *secfile, const char *filename,
+                  int compression_level, enum fz_method compression_method)
+{
+  char real_filename[1024];
+  fz_FILE *fs;
+
+  SECFILE_RETURN_VAL_IF_FAIL(secfile, NULL, NULL != secfile, FALSE);
+
+  if (NULL == filename) {
+    filename = secfile->name;
+  }
+
+  interpret_tilde(real_filename, sizeof(real_filename), filename);
+  fs = fz_from_file(real_filename, "w",
+                    compression_method, compression_level);
+
+  if (!fs) {
+    return FALSE;
+  }
+
+  section_list_iterate(secfile->sections, psection) {
+    section_to_file(psection, fs, real_filename);
   } section_list_iterate_end;
 
   if (0 != fz_ferror(fs)) {
@@ -857,6 +892,61 @@ bool secfile_save(const struct section_file *secfile, const char *filename,
   return TRUE;
 }
 
+/**************************************************************************
+  Write the sections to an already opened stream, in the format of
+  secfile_save(). Writing a file section list by section list gives
+  exactly the same output as saving it at once. 'filename' is only used
+  in log messages. Returns FALSE if the stream is in error.
+**************************************************************************/
+bool secfile_sections_save(const struct section_list *sections,
+                           fz_FILE *fs, const char *filename)
+{
+  fc_assert_ret_val(NULL != sections, FALSE);
+  fc_assert_ret_val(NULL != fs, FALSE);
+
+  section_list_iterate(sections, psection) {
+    section_to_file(psection, fs, filename);
+  } section_list_iterate_end;
+
+  return (0 == fz_ferror(fs));
+}
+
+/**************************************************************************
+  Take all the sections out of the section file, so they can be written
+  and freed (with section_list_destroy()) without the section file, even
+  from another thread. The section file is left empty; entries inserted
+  later go to new sections.
+**************************************************************************/
+struct section_list *secfile_sections_detach(struct section_file *secfile)
+{
+  struct section_list *sections;
+
+  SECFILE_RETURN_VAL_IF_FAIL(secfile, NULL, NULL != secfile, NULL);
+
+  sections = secfile->sections;
+  secfile->sections = section_list_new_full(section_destroy);
+
+  section_list_iterate(sections, psection) {
+    entry_list_iterate(section_entries(psection), pentry) {
+      secfile->num_entries--;
+      secfile_hash_delete(secfile, pentry);
+      if (pentry->name_interned) {
+        /* The names must outlive the section file. */
+        pentry->name = fc_strdup(pentry->name);
+        pentry->name_interned = FALSE;
+      }
+    } entry_list_iterate_end;
+    section_hash_remove(secfile->hash.sections, section_name(psection));
+    if (psection->name_interned) {
+      psection->name = fc_strdup(psection->name);
+      psection->name_interned = FALSE;
+    }
+    psection->secfile = NULL;
+  } section_list_iterate_end;
+
+  return sections;
+}
+
 /**************************************************************************
   Print log messages for any entries in the file which have
   not been looked up -- ie, unused or unrecognised entries.
@@ -2815,6 +2905,24 @@ secfile_sections_by_name_prefix(const struct section_file *secfile,
   return matches;
 }
 
+/**************************************************************************
+  Set the name of a new or renamed section, sharing the interned copy of
+  the section file if it keeps some.
+**************************************************************************/
+static void section_name_set(struct section *psection,
+                             struct section_file *secfile, const char *name)
+{
+  const char *interned = secfile_name_intern(secfile, name);
+
+  if (NULL != interned) {
+    psection->name = (char *) interned;
+    psection->name_interned = TRUE;
+  } else {
+    psection->name = fc_strdup(name);
+    psection->name_interned = FALSE;
+  }
+}
+
 /**************************************************************************
   Create a new section in the secfile.
 **************************************************************************/
@@ -2845,7 +2953,7 @@ struct section *secfile_section_new(struct section_file *secfile,
 
   psection = fc_malloc(sizeof(struct section));
   psection->special = EST_NORMAL;
-  psection->name = fc_strdup(name);
+  section_name_set(psection, secfile, name);
   psection->entries = entry_list_new_full(entry_destroy);
 
   /* Append to secfile. */
@@ -2882,7 +2990,9 @@ void section_destroy(struct section *psection)
   }
 
   entry_list_destroy(psection->entries);
-  free(psection->name);
+  if (!psection->name_interned) {
+    free(psection->name);
+  }
   free(psection);
 }
 
@@ -2946,8 +3056,10 @@ bool section_set_name(struct section *psection, const char *name)
   }
 
   /* Really rename. */
-  free(psection->name);
-  psection->name = fc_strdup(name);
+  if (!psection->name_interned) {
+    free(psection->name);
+  }
+  section_name_set(psection, secfile, name);
 
   /* Reinsert new references into the hash tables. */
   if (NULL != secfile->hash.sections) {
@@ -3019,6 +3131,24 @@ struct entry *section_entry_lookup(const struct section *psection,
   return NULL;
 }
 
+/**************************************************************************
+  Set the name of a new or renamed entry, sharing the interned copy of
+  the section file if it keeps some.
+**************************************************************************/
+static void entry_name_set(struct entry *pentry,
+                           struct section_file *secfile, const char *name)
+{
+  const char *interned = secfile_name_intern(secfile, name);
+
+  if (NULL != interned) {
+    pentry->name = (char *) interned;
+    pentry->name_interned = TRUE;
+  } else {
+    pentry->name = fc_strdup(name);
+    pentry->name_interned = FALSE;
+  }
+}
+
 /**************************************************************************
   Returns a new entry.
 **************************************************************************/
@@ -3048,7 +3178,7 @@ static struct entry *entry_new(struct section *psection, const char *name)
   }
 
   pentry = fc_malloc(sizeof(struct entry));
-  pentry->name = fc_strdup(name);
+  entry_name_set(pentry, secfile, name);
   pentry->type = -1;    /* Invalid case. */
   pentry->used = 0;
   pentry->comment = NULL;
@@ -3161,16 +3291,19 @@ void entry_destroy(struct entry *pentry)
   }
 
   if ((psection = pentry->psection)) {
-    /* Detach from section. */
-    if (entry_list_remove(psection->entries, pentry)) {
-      /* This has called entry_destroy() already then. */
-      return;
-    }
     if ((secfile = psection->secfile)) {
       /* Detach from secfile. */
       secfile->num_entries--;
       secfile_hash_delete(secfile, pentry);
     }
+    /* Detach from section. Clear 'psection' first, so the call to
+     * entry_destroy() made by the list doesn't look for the entry in it
+     * again. */
+    pentry->psection = NULL;
+    if (entry_list_remove(psection->entries, pentry)) {
+      /* This has called entry_destroy() already then. */
+      return;
+    }
   }
 
   /* Specific type free. */
@@ -3187,7 +3320,9 @@ void entry_destroy(struct entry *pentry)
   }
 
   /* Common free. */
-  free(pentry->name);
+  if (!pentry->name_interned) {
+    free(pentry->name);
+  }
   if (NULL != pentry->comment) {
     free(pentry->comment);
   }
@@ -3268,8 +3403,10 @@ bool entry_set_name(struct entry *pentry, const char *name)
   secfile_hash_delete(secfile, pentry);
 
   /* Really rename the entry. */
-  free(pentry->name);
-  pentry->name = fc_strdup(name);
+  if (!pentry->name_interned) {
+    free(pentry->name);
+  }
+  entry_name_set(pentry, secfile, name);
 
   /* Insert into hash table the new path. */
   secfile_hash_insert(secfile, pentry);
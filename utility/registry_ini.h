@@ -65,6 +65,9 @@ struct section_file *secfile_from_stream(fz_FILE *stream,
 
 bool secfile_save(const struct section_file *secfile, const char *filename,
                   int compression_level, enum fz_method compression_method);
+bool secfile_sections_save(const struct section_list *sections,
+                           fz_FILE *fs, const char *filename);
+struct section_list *secfile_sections_detach(struct section_file *secfile);
 void secfile_check_unused(const struct section_file *secfile);
 const char *secfile_name(const struct section_file *secfile);
 
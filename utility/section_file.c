@@ -16,15 +16,39 @@
 #endif
 
 #include <stdarg.h>
+#include <string.h>
 
 /* utility */
 #include "mem.h"
 #include "registry.h"
+#include "shared.h"
 
 #include "section_file.h"
 
 #define MAX_LEN_ERRORBUF 1024
 
+#define SPECHASH_TAG interned_name
+#define SPECHASH_CSTR_KEY_TYPE
+#define SPECHASH_CSTR_DATA_TYPE
+#include "spechash.h"
+
+/* Names are copied into big blocks, so a loaded file with hundreds of
+ * thousands of entries doesn't do one allocation per entry name. The
+ * same name in several sections is stored once. */
+#define NAME_BLOCK_SIZE (64 * 1024)
+
+struct name_block {
+  struct name_block *prev;
+  size_t size;
+  size_t used;
+  /* The names follow. */
+};
+
+struct secfile_names {
+  struct interned_name_hash *hash;
+  struct name_block *block;
+};
+
 static char error_buffer[MAX_LEN_ERRORBUF] = "\0";
 
 /* Debug function for every new entry. */
@@ -85,6 +109,7 @@ struct section_file *secfile_new(bool allow_duplicates)
   secfile->hash.sections = section_hash_new();
   /* Maybe allocated later. */
   secfile->hash.entries = NULL;
+  secfile->names = NULL;
 
   return secfile;
 }
@@ -109,6 +134,18 @@ void secfile_destroy(struct section_file *secfile)
 
   section_list_destroy(secfile->sections);
 
+  if (NULL != secfile->names) {
+    struct name_block *block = secfile->names->block, *prev;
+
+    while (NULL != block) {
+      prev = block->prev;
+      free(block);
+      block = prev;
+    }
+    interned_name_hash_destroy(secfile->names->hash);
+    free(secfile->names);
+  }
+
   if (NULL != secfile->name) {
     free(secfile->name);
   }
@@ -116,6 +153,60 @@ void secfile_destroy(struct section_file *secfile)
   free(secfile);
 }
 
+/**************************************************************************
+  Make the section file intern the names of the sections and entries
+  created from now on.
+**************************************************************************/
+void secfile_names_init(struct section_file *secfile)
+{
+  fc_assert_ret(NULL != secfile);
+  fc_assert_ret(NULL == secfile->names);
+
+  secfile->names = fc_malloc(sizeof(*secfile->names));
+  secfile->names->hash = interned_name_hash_new();
+  secfile->names->block = NULL;
+}
+
+/**************************************************************************
+  Returns a copy of 'name' which lives as long as the section file, or
+  NULL if the section file doesn't intern names (see section_file.h).
+**************************************************************************/
+const char *secfile_name_intern(struct section_file *secfile,
+                                const char *name)
+{
+  struct secfile_names *names;
+  struct name_block *block;
+  char *interned;
+  size_t len;
+
+  if (NULL == secfile || NULL == (names = secfile->names)) {
+    return NULL;
+  }
+
+  if (interned_name_hash_lookup(names->hash, name, &interned)) {
+    return interned;
+  }
+
+  len = strlen(name) + 1;
+  block = names->block;
+  if (NULL == block || block->size - block->used < len) {
+    size_t size = MAX(NAME_BLOCK_SIZE, len);
+
+    block = fc_malloc(sizeof(*block) + size);
+    block->prev = names->block;
+    block->size = size;
+    block->used = 0;
+    names->block = block;
+  }
+
+  interned = (char *) (block + 1) + block->used;
+  memcpy(interned, name, len);
+  block->used += len;
+  interned_name_hash_insert(names->hash, interned, interned);
+
+  return interned;
+}
+
 /****************************************************************************
   Set if we could consider values 0 and 1 as boolean. By default, this is
   not allowed, but we need to keep compatibility with old Freeciv version
@@ -29,6 +29,7 @@ struct section {
   struct section_file *secfile; /* Parent structure. */
   enum entry_special_type special;
   char *name;                   /* Name of the section. */
+  bool name_interned;           /* 'name' is owned by the section file. */
   struct entry_list *entries;   /* The list of the children. */
 };
 
@@ -48,6 +49,9 @@ struct section_file {
     struct section_hash *sections;
     struct entry_hash *entries;
   } hash;
+  /* Interned section and entry names, owned by the section file. Only
+   * set up when loading a file, NULL otherwise. */
+  struct secfile_names *names;
 };
 
 void secfile_log(const struct section_file *secfile,
@@ -80,6 +84,12 @@ void secfile_log(const struct section_file *secfile,
 #define SPECHASH_IDATA_TYPE struct entry *
 #include "spechash.h"
 
+bool secfile_hash_build(struct section_file *secfile, bool allow_duplicates);
+
+void secfile_names_init(struct section_file *secfile);
+const char *secfile_name_intern(struct section_file *secfile,
+                                const char *name);
+
 bool entry_from_token(struct section *psection, const char *name,
                       const char *tok);
 
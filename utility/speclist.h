@@ -23,6 +23,9 @@
  *   SPECLIST_TAG - this tag will be used to form names for functions etc.
  * You may also define:
  *   SPECLIST_TYPE - the typed genlist will contain pointers to this type;
+ *   SPECLIST_POOLED - the lists are pooled genlists (see genlist.h),
+ *                     without mutex: foo_list_allocate_mutex() and
+ *                     foo_list_release_mutex() must not be used.
  * If SPECLIST_TYPE is not defined, then 'struct SPECLIST_TAG' is used.
  * At the end of this file, these (and other defines) are undef-ed.
  *
@@ -167,7 +170,11 @@ fc__warn_unused_result;
 
 static inline SPECLIST_LIST *SPECLIST_FOO(_list_new) (void)
 {
+#ifdef SPECLIST_POOLED
+  return (SPECLIST_LIST *) genlist_new_pooled();
+#else
   return (SPECLIST_LIST *) genlist_new();
+#endif
 }
 
 /****************************************************************************
@@ -180,8 +187,13 @@ fc__warn_unused_result;
 static inline SPECLIST_LIST *
 SPECLIST_FOO(_list_new_full) (SPECLIST_FOO(_list_free_fn_t) free_data_func)
 {
+#ifdef SPECLIST_POOLED
+  return ((SPECLIST_LIST *)
+          genlist_new_pooled_full((genlist_free_fn_t) free_data_func));
+#else
   return ((SPECLIST_LIST *)
           genlist_new_full((genlist_free_fn_t) free_data_func));
+#endif
 }
 
 /****************************************************************************
@@ -546,6 +558,7 @@ SPECLIST_FOO(_list_link_next) (const SPECLIST_LINK *plink)
 
 #undef SPECLIST_TAG
 #undef SPECLIST_TYPE
+#undef SPECLIST_POOLED
 #undef SPECLIST_PASTE_
 #undef SPECLIST_PASTE
 #undef SPECLIST_LIST
@@ -0,0 +1,182 @@
+/**********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+/* utility */
+#include "fcthread.h"
+#include "log.h"
+#include "mem.h"
+
+#include "workpool.h"
+
+struct fc_workpool {
+  int num_workers;
+  fc_thread *workers;
+
+  fc_mutex mutex;            /* Protects all the fields below. */
+  fc_thread_cond work_cond;  /* Signaled when jobs are available. */
+  fc_thread_cond done_cond;  /* Signaled when the last job is done. */
+  bool quit;
+
+  /* The current batch. */
+  fc_workpool_job_fn func;
+  void *data;
+  int num_jobs;
+  int next_job;              /* Next job to be taken. */
+  int jobs_done;
+};
+
+/**********************************************************************
+  Take and run the jobs of the current batch until there is no job left
+  to take. Must be called with the mutex held; it is still held on
+  return.
+***********************************************************************/
+static void fc_workpool_work(struct fc_workpool *pool)
+{
+  while (pool->next_job < pool->num_jobs) {
+    int job = pool->next_job++;
+
+    fc_release_mutex(&pool->mutex);
+    pool->func(job, pool->data);
+    fc_allocate_mutex(&pool->mutex);
+
+    if (++pool->jobs_done == pool->num_jobs) {
+      fc_thread_cond_signal(&pool->done_cond);
+    }
+  }
+}
+
+/**********************************************************************
+  Main function of the worker threads.
+***********************************************************************/
+static void fc_workpool_worker(void *arg)
+{
+  struct fc_workpool *pool = (struct fc_workpool *) arg;
+
+  fc_allocate_mutex(&pool->mutex);
+  while (!pool->quit) {
+    if (pool->next_job < pool->num_jobs) {
+      fc_workpool_work(pool);
+    } else {
+      fc_thread_cond_wait(&pool->work_cond, &pool->mutex);
+    }
+  }
+  fc_release_mutex(&pool->mutex);
+}
+
+/**********************************************************************
+  Create a pool of 'num_workers' threads. With no worker, the jobs are
+  just run by the caller of fc_workpool_run().
+***********************************************************************/
+struct fc_workpool *fc_workpool_new(int num_workers)
+{
+  struct fc_workpool *pool = fc_calloc(1, sizeof(*pool));
+  int i;
+
+  if (!has_thread_cond_impl()) {
+    num_workers = 0;
+  }
+
+  fc_init_mutex(&pool->mutex);
+  fc_thread_cond_init(&pool->work_cond);
+  fc_thread_cond_init(&pool->done_cond);
+
+  if (0 < num_workers) {
+    pool->workers = fc_malloc(num_workers * sizeof(*pool->workers));
+    for (i = 0; i < num_workers; i++) {
+      if (0 != fc_thread_start(&pool->workers[i], fc_workpool_worker,
+                               pool)) {
+        log_error("Could not start worker thread %d.", i);
+        break;
+      }
+    }
+    pool->num_workers = i;
+  }
+
+  return pool;
+}
+
+/**********************************************************************
+  Stop the worker threads and free the pool.
+***********************************************************************/
+void fc_workpool_destroy(struct fc_workpool *pool)
+{
+  int i;
+
+  fc_allocate_mutex(&pool->mutex);
+  pool->quit = TRUE;
+  for (i = 0; i < pool->num_workers; i++) {
+    fc_thread_cond_signal(&pool->work_cond);
+  }
+  fc_release_mutex(&pool->mutex);
+
+  for (i = 0; i < pool->num_workers; i++) {
+    fc_thread_wait(&pool->workers[i]);
+  }
+
+  fc_thread_cond_destroy(&pool->work_cond);
+  fc_thread_cond_destroy(&pool->done_cond);
+  fc_destroy_mutex(&pool->mutex);
+  free(pool->workers);
+  free(pool);
+}
+
+/**********************************************************************
+  Return the number of worker threads of the pool.
+***********************************************************************/
+int fc_workpool_num_workers(const struct fc_workpool *pool)
+{
+  return (NULL != pool ? pool->num_workers : 0);
+}
+
+/**********************************************************************
+  Call func(job, data) for every job in [0, num_jobs[, using the worker
+  threads and the calling thread. The order in which the jobs run is
+  not defined. Returns when all the jobs are done. 'pool' may be NULL to
+  run all the jobs in the calling thread. Must not be called from a job.
+***********************************************************************/
+void fc_workpool_run(struct fc_workpool *pool, int num_jobs,
+                     fc_workpool_job_fn func, void *data)
+{
+  int i;
+
+  if (NULL == pool || 0 == pool->num_workers || 1 >= num_jobs) {
+    for (i = 0; i < num_jobs; i++) {
+      func(i, data);
+    }
+    return;
+  }
+
+  fc_allocate_mutex(&pool->mutex);
+  pool->func = func;
+  pool->data = data;
+  pool->num_jobs = num_jobs;
+  pool->next_job = 0;
+  pool->jobs_done = 0;
+  for (i = 0; i < pool->num_workers && i < num_jobs - 1; i++) {
+    fc_thread_cond_signal(&pool->work_cond);
+  }
+
+  fc_workpool_work(pool);
+  while (pool->jobs_done < pool->num_jobs) {
+    fc_thread_cond_wait(&pool->done_cond, &pool->mutex);
+  }
+
+  /* Nothing left to take for late workers. */
+  pool->num_jobs = 0;
+  pool->next_job = 0;
+  fc_release_mutex(&pool->mutex);
+}
@@ -0,0 +1,43 @@
+/**********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+#ifndef FC__WORKPOOL_H
+#define FC__WORKPOOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* utility */
+#include "support.h" /* bool */
+
+/* A pool of worker threads running batches of independent jobs. The
+ * caller of fc_workpool_run() takes part in the batch and returns only
+ * when all the jobs are done, so the jobs may freely read any data the
+ * caller doesn't modify meanwhile. A pool without workers (or without a
+ * thread condition implementation) runs the jobs in the caller. */
+struct fc_workpool;
+
+typedef void (*fc_workpool_job_fn) (int job, void *data);
+
+struct fc_workpool *fc_workpool_new(int num_workers);
+void fc_workpool_destroy(struct fc_workpool *pool);
+
+int fc_workpool_num_workers(const struct fc_workpool *pool);
+void fc_workpool_run(struct fc_workpool *pool, int num_jobs,
+                     fc_workpool_job_fn func, void *data);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif  /* FC__WORKPOOL_H */